@@ -0,0 +1,69 @@
+pragma Singleton
+import QtQuick
+import QtQuick.Studio.Application
+
+QtObject {
+    readonly property int width: 1920
+    readonly property int height: 1080
+
+    property string relativeFontDirectory: "fonts"
+
+    readonly property font font: Qt.font({
+        family: Qt.application.font.family,
+        pixelSize: Qt.application.font.pixelSize
+    })
+    readonly property font largeFont: Qt.font({
+        family: Qt.application.font.family,
+        pixelSize: Qt.application.font.pixelSize * 1.6
+    })
+
+    readonly property color backgroundColor: "#EAEAEA"
+
+    // Theme definitions
+    readonly property var lightTheme: ({
+        windowBackground: "#eddcd2",
+        sectionBackground: "#fff1e6",
+        border: "#c5dedd",
+        highlight: "#99c1de",
+        text: "#d6e2e9",
+        extra1: "#fde2e4",
+        extra2: "#fad2e1",
+        extra3: "#bcd4e6",
+        extra4: "#f0efeb",
+        extra5: "#dbe7e4"
+    })
+
+    readonly property var darkTheme: ({
+        windowBackground: "#001233",
+        sectionBackground: "#023e7d",
+        border: "#33415c",
+        highlight: "#7d8597",
+        text: "#979dac",
+        extra1: "#0466c8",
+        extra2: "#0353a4",
+        extra3: "#002855",
+        extra4: "#001845",
+        extra5: "#5c677d"
+    })
+
+    readonly property var customTheme: ({
+        windowBackground: "#1a0d2e",
+        sectionBackground: "#2e1a4e",
+        border: "#5a3f7a",
+        highlight: "#8b6fb0",
+        text: "#d9cce8",
+        extra1: "#6a2e8c",
+        extra2: "#4b1d6b",
+        extra3: "#a47fd3",
+        extra4: "#c2a1e6",
+        extra5: "#7b4fa8"
+    })
+
+    // Current theme selection; App.qml restores it from and saves it to
+    // Settings.theme
+    property var currentTheme: darkTheme
+
+    property StudioApplication application: StudioApplication {
+        fontPath: Qt.resolvedUrl("../AtlasContent/" + relativeFontDirectory)
+    }
+}
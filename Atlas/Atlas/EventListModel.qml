@@ -0,0 +1,33 @@
+import QtQuick
+
+ListModel {
+    id: eventListModel
+
+    ListElement {
+        eventId: "enterPressed"
+        eventDescription: "Emitted when pressing the enter button"
+        shortcut: "Return"
+        parameters: "Enter"
+    }
+
+    ListElement {
+        eventId: "openCommandPalette"
+        eventDescription: "Opens the command palette over commands, pages and vehicles"
+        shortcut: "Ctrl+K"
+        parameters: ""
+    }
+
+    ListElement {
+        eventId: "toggleInputRecording"
+        eventDescription: "Starts or stops recording operator input and telemetry"
+        shortcut: "Ctrl+Shift+R"
+        parameters: ""
+    }
+
+    ListElement {
+        eventId: "replayInputRecording"
+        eventDescription: "Replays the last input recording against its telemetry"
+        shortcut: "Ctrl+Shift+P"
+        parameters: ""
+    }
+}
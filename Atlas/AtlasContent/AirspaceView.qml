@@ -0,0 +1,89 @@
+import QtQuick 2.15
+import QtQuick3D
+import QtQuick3D.Helpers
+import Atlas
+import AtlasBackend
+
+// Optional 3D airspace page, loaded only when picked. Every aircraft is one
+// instance of a single model and every operation volume part of a single
+// mesh, both unlit, without antialiasing or shadows, so 2,000 aircraft hold
+// 30 fps on software rendering (Mesa llvmpipe) too.
+Rectangle {
+    id: airspaceView
+    color: Constants.currentTheme.windowBackground
+
+    // A model converted into Generated/ by balsam, e.g.
+    // "../Generated/meshes/aircraft.mesh"; the built-in dart when empty.
+    property url aircraftMesh: ""
+
+    View3D {
+        id: view
+        anchors.fill: parent
+        camera: camera
+
+        environment: SceneEnvironment {
+            backgroundMode: SceneEnvironment.Color
+            clearColor: airspaceView.color
+            antialiasingMode: SceneEnvironment.NoAA
+        }
+
+        Node {
+            id: cameraOrigin
+            y: 300
+            eulerRotation.x: -35
+
+            PerspectiveCamera {
+                id: camera
+                z: 15000
+                clipNear: 10
+                clipFar: 500000
+            }
+        }
+
+        AirspaceInstancing {
+            id: aircraftInstances
+            vehicles: Vehicles
+            armedColor: Constants.currentTheme.extra1
+            disarmedColor: Constants.currentTheme.text
+        }
+
+        AircraftGeometry {
+            id: dart
+        }
+
+        OperationVolumeGeometry {
+            id: volumeMesh
+            volumes: Volumes
+            originLatitude: aircraftInstances.originLatitude
+            originLongitude: aircraftInstances.originLongitude
+        }
+
+        Model {
+            source: airspaceView.aircraftMesh
+            geometry: airspaceView.aircraftMesh.toString() === "" ? dart : null
+            instancing: aircraftInstances
+            materials: DefaultMaterial {
+                lighting: DefaultMaterial.NoLighting
+                diffuseColor: "white"
+                cullMode: Material.NoCulling
+            }
+        }
+
+        Model {
+            geometry: volumeMesh
+            materials: DefaultMaterial {
+                lighting: DefaultMaterial.NoLighting
+                vertexColorsEnabled: true
+                opacity: 0.3
+                cullMode: Material.NoCulling
+                depthDrawMode: Material.NeverDepthDraw
+            }
+        }
+    }
+
+    OrbitCameraController {
+        anchors.fill: view
+        origin: cameraOrigin
+        camera: camera
+    }
+}
@@ -0,0 +1,74 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Window 2.15
+import Atlas
+import AtlasBackend
+import "./components"
+
+ApplicationWindow {
+    id: window
+    width: Screen.width * 2 / 3
+    height: Screen.height * 2 / 3
+    visible: true
+    title: "Atlas"
+    color: Constants.currentTheme.windowBackground
+
+    // Constants stays free of backend imports, so the theme is persisted here.
+    Component.onCompleted: Constants.currentTheme = Settings.theme === "light" ? Constants.lightTheme
+                                                  : Settings.theme === "custom" ? Constants.customTheme
+                                                  : Constants.darkTheme
+
+    Connections {
+        target: Constants
+        function onCurrentThemeChanged() {
+            Settings.theme = Constants.currentTheme === Constants.lightTheme ? "light"
+                           : Constants.currentTheme === Constants.customTheme ? "custom"
+                           : "dark"
+        }
+    }
+
+    MainWindow {
+        id: mainScreen
+        anchors.fill: parent
+    }
+
+    CommandPalettePopup {
+        id: commandPalette
+    }
+
+    Connections {
+        target: CommandPalette
+        function onActivated(kind, key) {
+            if (kind === "page") {
+                mainScreen.showPage(key)
+            } else if (kind === "command") {
+                if (key === "toggleInputRecording")
+                    InputRecorder.toggleRecording()
+                else if (key === "replayInputRecording")
+                    InputRecorder.replay()
+                else if (key === "toggleTheme")
+                    Constants.currentTheme = Constants.currentTheme === Constants.darkTheme
+                            ? Constants.lightTheme : Constants.darkTheme
+            }
+        }
+    }
+
+    Shortcut {
+        sequence: "Ctrl+K"
+        context: Qt.ApplicationShortcut
+        onActivated: commandPalette.open()
+    }
+
+    // Same shortcuts as toggleInputRecording/replayInputRecording in EventListModel.qml.
+    Shortcut {
+        sequence: "Ctrl+Shift+R"
+        context: Qt.ApplicationShortcut
+        onActivated: InputRecorder.toggleRecording()
+    }
+
+    Shortcut {
+        sequence: "Ctrl+Shift+P"
+        context: Qt.ApplicationShortcut
+        onActivated: InputRecorder.replay()
+    }
+}
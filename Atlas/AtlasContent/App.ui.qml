@@ -0,0 +1,21 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import Atlas
+import "./components"
+
+Item {
+    id: app
+    implicitWidth: 1280 // 2/3 of 1920
+    implicitHeight: 720 // 2/3 of 1080
+    anchors.fill: parent
+
+    Rectangle {
+        anchors.fill: parent
+        color: Constants.currentTheme.windowBackground
+    }
+
+    MainWindow {
+        id: mainScreen
+        anchors.fill: parent
+    }
+}
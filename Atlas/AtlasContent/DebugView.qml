@@ -0,0 +1,230 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import Atlas
+import AtlasBackend
+
+// Debug page: live attitude, vibration and current of one aircraft at the
+// rate they arrive. The plots read samples in C++; nothing passes through QML.
+// Above them, each daemon link's health over the last two minutes.
+Rectangle {
+    id: debugView
+    color: Constants.currentTheme.windowBackground
+
+    property int timeSpanMs: 10000
+
+    // "–" for values LinkHealth has no samples for.
+    function formatValue(value, digits, unit) {
+        return value === undefined || isNaN(value) ? "–" : value.toFixed(digits) + unit
+    }
+
+    // One second per point, newest at the right edge, scaled from 0 to the
+    // peak in view below the title. Seconds without samples are left as gaps.
+    component HistoryPlot: Canvas {
+        id: plot
+        property string title
+        property var points: []
+        property string unit
+        property color lineColor: Constants.currentTheme.highlight
+        readonly property real peak: {
+            let peak = 0
+            for (let i = 0; i < points.length; ++i) {
+                if (!isNaN(points[i]))
+                    peak = Math.max(peak, points[i])
+            }
+            return peak
+        }
+
+        onPointsChanged: requestPaint()
+        onLineColorChanged: requestPaint()
+        onWidthChanged: requestPaint()
+        onHeightChanged: requestPaint()
+
+        onPaint: {
+            const ctx = getContext("2d")
+            ctx.reset()
+            if (peak <= 0)
+                return
+
+            const step = width / Math.max(1, LinkHealth.historyLength - 1)
+            ctx.strokeStyle = lineColor
+            ctx.lineWidth = 1.5
+            ctx.beginPath()
+            let drawing = false
+            for (let i = 0; i < points.length; ++i) {
+                if (isNaN(points[i])) {
+                    drawing = false
+                    continue
+                }
+                const x = width - (points.length - 1 - i) * step
+                const y = height - 1 - points[i] / peak * (height - 16)
+                if (drawing)
+                    ctx.lineTo(x, y)
+                else
+                    ctx.moveTo(x, y)
+                drawing = true
+            }
+            ctx.stroke()
+        }
+
+        Text {
+            anchors.left: parent.left
+            anchors.top: parent.top
+            text: plot.title + ", peak " + debugView.formatValue(plot.peak, 1, plot.unit)
+            color: Constants.currentTheme.text
+            font.pixelSize: 11
+        }
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 12
+        spacing: 8
+
+        RowLayout {
+            spacing: 12
+
+            Text {
+                text: "Aircraft"
+                color: Constants.currentTheme.text
+            }
+            ComboBox {
+                id: aircraft
+                model: Vehicles
+                textRole: "systemId"
+                valueRole: "systemId"
+            }
+            Text {
+                text: "Window"
+                color: Constants.currentTheme.text
+            }
+            ComboBox {
+                model: [5, 10, 30, 60]
+                currentIndex: 1
+                displayText: currentValue + " s"
+                onActivated: debugView.timeSpanMs = currentValue * 1000
+            }
+        }
+
+        // Frames the daemon shed since it started, by priority class, and
+        // its backlog now. Bulk goes first; critical should stay at 0.
+        RowLayout {
+            spacing: 12
+
+            Text {
+                text: "Shed"
+                color: Constants.currentTheme.text
+            }
+            Repeater {
+                model: ["critical", "telemetry", "normal", "bulk"]
+
+                delegate: Text {
+                    readonly property real count: Traffic.shedFramesByClass[index] || 0
+                    text: modelData + " " + count
+                    color: count > 0 && index < 2 ? Constants.currentTheme.highlight : Constants.currentTheme.text
+                }
+            }
+            Text {
+                text: "backlog " + Traffic.backlogFrames
+                color: Constants.currentTheme.text
+            }
+        }
+
+        // Link health: loss, jitter (95th percentile) and round trip
+        // (median) per daemon link, now and over the last two minutes.
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: linkRows.implicitHeight + 12
+            visible: links.count > 0
+            color: Constants.currentTheme.sectionBackground
+            border.color: Constants.currentTheme.border
+            border.width: 1
+
+            ColumnLayout {
+                id: linkRows
+                anchors.fill: parent
+                anchors.margins: 6
+                spacing: 6
+
+                Repeater {
+                    id: links
+                    model: LinkHealth
+
+                    delegate: RowLayout {
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: 56
+                        spacing: 12
+
+                        Text {
+                            Layout.preferredWidth: 200
+                            Layout.alignment: Qt.AlignTop
+                            text: model.name + "\n"
+                                  + "loss " + debugView.formatValue(model.lossPercent, 1, " %")
+                                  + ", " + debugView.formatValue(model.throughput / 1000, 1, " kB/s") + "\n"
+                                  + "jitter " + debugView.formatValue(model.jitter, 0, " ms")
+                                  + ", RTT " + debugView.formatValue(model.roundTrip, 0, " ms")
+                            color: Constants.currentTheme.text
+                        }
+                        HistoryPlot {
+                            Layout.fillWidth: true
+                            Layout.fillHeight: true
+                            title: "Loss"
+                            unit: " %"
+                            points: model.lossHistory
+                        }
+                        HistoryPlot {
+                            Layout.fillWidth: true
+                            Layout.fillHeight: true
+                            title: "Jitter"
+                            unit: " ms"
+                            points: model.jitterHistory
+                            lineColor: Constants.currentTheme.extra1
+                        }
+                        HistoryPlot {
+                            Layout.fillWidth: true
+                            Layout.fillHeight: true
+                            title: "Round trip"
+                            unit: " ms"
+                            points: model.roundTripHistory
+                            lineColor: Constants.currentTheme.extra3
+                        }
+                    }
+                }
+            }
+        }
+
+        Repeater {
+            model: [
+                { title: "Attitude (°): roll, pitch, yaw", fields: ["roll", "pitch", "yaw"] },
+                { title: "Vibration (m/s²)", fields: ["vibration"] },
+                { title: "Current (A)", fields: ["batteryCurrent"] }
+            ]
+
+            delegate: Rectangle {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                color: Constants.currentTheme.sectionBackground
+                border.color: Constants.currentTheme.border
+                border.width: 1
+
+                Text {
+                    anchors.left: parent.left
+                    anchors.top: parent.top
+                    anchors.margins: 6
+                    text: modelData.title
+                    color: Constants.currentTheme.text
+                }
+
+                StreamingPlot {
+                    anchors.fill: parent
+                    anchors.margins: 6
+                    anchors.topMargin: 24
+                    vehicles: Vehicles
+                    systemId: aircraft.currentValue !== undefined ? aircraft.currentValue : 0
+                    fields: modelData.fields
+                    timeSpanMs: debugView.timeSpanMs
+                }
+            }
+        }
+    }
+}
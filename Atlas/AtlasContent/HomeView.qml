@@ -0,0 +1,105 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import Atlas
+import AtlasBackend
+
+// Home page map. Every layer fills the page and binds to the same centre
+// and zoom; dragging pans and the wheel zooms about the cursor.
+Rectangle {
+    id: homeView
+    color: Constants.currentTheme.windowBackground
+    clip: true
+
+    property real centerLatitude: 36.8
+    property real centerLongitude: -119.8
+    property real zoomLevel: 10
+
+    DensityMapLayer {
+        anchors.fill: parent
+        density: Density
+        centerLatitude: homeView.centerLatitude
+        centerLongitude: homeView.centerLongitude
+        zoomLevel: homeView.zoomLevel
+        color: Qt.rgba(Constants.currentTheme.extra2.r, Constants.currentTheme.extra2.g, Constants.currentTheme.extra2.b, 0.6)
+    }
+
+    VolumeMapLayer {
+        id: volumeLayer
+        anchors.fill: parent
+        meshes: VolumeMeshes
+        centerLatitude: homeView.centerLatitude
+        centerLongitude: homeView.centerLongitude
+        zoomLevel: homeView.zoomLevel
+        intentColor: Qt.rgba(Constants.currentTheme.extra1.r, Constants.currentTheme.extra1.g, Constants.currentTheme.extra1.b, 0.25)
+        constraintColor: Qt.rgba(Constants.currentTheme.extra3.r, Constants.currentTheme.extra3.g, Constants.currentTheme.extra3.b, 0.25)
+    }
+
+    AircraftMapLayer {
+        anchors.fill: parent
+        timeline: Timeline
+        centerLatitude: homeView.centerLatitude
+        centerLongitude: homeView.centerLongitude
+        zoomLevel: homeView.zoomLevel
+        recordedColor: Constants.currentTheme.text
+        intentColor: Constants.currentTheme.extra1
+    }
+
+    // Heatmap history: traffic fades with a half-life of an hour or a day.
+    // Exclusive, so a click never unchecks a button and both stay in step
+    // with Density.halfLifeMs.
+    Row {
+        anchors.top: parent.top
+        anchors.right: parent.right
+        anchors.margins: 8
+        spacing: 4
+        z: 1
+
+        Button {
+            text: "1 h"
+            checkable: true
+            autoExclusive: true
+            checked: Density.halfLifeMs === 3600000
+            onToggled: if (checked) Density.halfLifeMs = 3600000
+        }
+        Button {
+            text: "24 h"
+            checkable: true
+            autoExclusive: true
+            checked: Density.halfLifeMs === 86400000
+            onToggled: if (checked) Density.halfLifeMs = 86400000
+        }
+    }
+
+    function moveCenterTo(coordinate) {
+        centerLatitude = coordinate.latitude
+        centerLongitude = coordinate.longitude
+    }
+
+    DragHandler {
+        id: panHandler
+        target: null
+        property point last
+
+        onActiveChanged: last = Qt.point(0, 0)
+        onTranslationChanged: {
+            const dx = translation.x - last.x
+            const dy = translation.y - last.y
+            last = translation
+            homeView.moveCenterTo(volumeLayer.toCoordinate(volumeLayer.width / 2 - dx,
+                                                           volumeLayer.height / 2 - dy))
+        }
+    }
+
+    WheelHandler {
+        target: null
+        onWheel: (event) => {
+            // Keep the coordinate under the cursor where it is.
+            const anchor = volumeLayer.toCoordinate(point.position.x, point.position.y)
+            homeView.zoomLevel = Math.max(2, Math.min(19, homeView.zoomLevel + event.angleDelta.y / 480))
+            const drifted = volumeLayer.toPoint(anchor.latitude, anchor.longitude)
+            homeView.moveCenterTo(volumeLayer.toCoordinate(
+                volumeLayer.width / 2 + drifted.x - point.position.x,
+                volumeLayer.height / 2 + drifted.y - point.position.y))
+        }
+    }
+}
@@ -0,0 +1,192 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import Atlas
+import AtlasBackend
+import "./components"
+
+Item {
+    id: mainWindowWrapper
+    anchors.fill: parent
+
+    // Properties to control sidebar
+    property real sidebarWidth: mainWindowUi.width * 0.2
+    property real lastSidebarWidth: sidebarWidth
+
+    // Checks the sidebar button labelled name, as if it had been clicked.
+    function showPage(name) {
+        const buttons = mainWindowUi.sidebar.buttonGroup.buttons
+        for (let i = 0; i < buttons.length; ++i) {
+            if (buttons[i].buttonText === name) {
+                buttons[i].checked = true
+                return
+            }
+        }
+    }
+
+    // Pages with a QML file of their own; the rest show the placeholder.
+    readonly property var pageFiles: ({
+        "Home": "HomeView.qml",
+        "Airspace": "AirspaceView.qml",
+        "Roster": "RosterView.qml",
+        "Debug": "DebugView.qml",
+        "Settings": "SettingsView.qml"
+    })
+
+    MainWindow {
+        id: mainWindowUi
+        anchors.fill: parent
+        sidebarWidth: mainWindowWrapper.sidebarWidth
+    }
+
+    Binding {
+        target: mainWindowUi.pages
+        property: "source"
+        value: {
+            const button = mainWindowUi.sidebar.buttonGroup.checkedButton
+            const file = button ? mainWindowWrapper.pageFiles[button.buttonText] : undefined
+            return file ? Qt.resolvedUrl(file) : ""
+        }
+    }
+
+    // Timeline scrubber: Live returns to now, dragging moves the map in time.
+    Binding {
+        target: mainWindowUi.liveButton
+        property: "highlighted"
+        value: Timeline.live
+    }
+
+    Binding {
+        target: mainWindowUi.scrubber
+        property: "from"
+        value: Timeline.startMs
+    }
+
+    Binding {
+        target: mainWindowUi.scrubber
+        property: "to"
+        value: Timeline.endMs
+    }
+
+    Binding {
+        target: mainWindowUi.scrubber
+        property: "value"
+        value: Timeline.timeMs
+    }
+
+    Binding {
+        target: mainWindowUi.timeLabel
+        property: "text"
+        value: new Date(Timeline.timeMs).toLocaleTimeString(Qt.locale(), "HH:mm:ss")
+    }
+
+    // Frames the daemon shed to keep up; essential ones stand out.
+    Binding {
+        target: mainWindowUi.shedLabel
+        property: "visible"
+        value: Traffic.shedFrames > 0
+    }
+
+    Binding {
+        target: mainWindowUi.shedLabel
+        property: "text"
+        value: Traffic.shedSummary
+    }
+
+    Binding {
+        target: mainWindowUi.shedLabel
+        property: "color"
+        value: Traffic.shedEssential ? Constants.currentTheme.highlight : Constants.currentTheme.text
+    }
+
+    Connections {
+        target: mainWindowUi.liveButton
+        function onClicked() {
+            Timeline.live = true
+        }
+    }
+
+    Connections {
+        target: mainWindowUi.scrubber
+        function onMoved() {
+            Timeline.timeMs = mainWindowUi.scrubber.value
+        }
+    }
+
+    // Page switches go into input recordings as markers.
+    Connections {
+        target: mainWindowUi.sidebar.buttonGroup
+        function onCheckedButtonChanged() {
+            const button = mainWindowUi.sidebar.buttonGroup.checkedButton
+            InputRecorder.mark("page", button ? button.buttonText : "")
+        }
+    }
+
+    // Resize handle interaction
+    MouseArea {
+        id: resizeArea
+        x: mainWindowWrapper.sidebarWidth
+        y: mainWindowUi.topRow1.height + mainWindowUi.topRow2.height
+        width: 6
+        height: mainWindowUi.height - mainWindowUi.topRow1.height - mainWindowUi.topRow2.height - mainWindowUi.footer.height
+        cursorShape: Qt.SizeHorCursor
+        enabled: mainWindowWrapper.sidebarWidth > 0
+
+        property real startX: 0
+        property real startWidth: 0
+
+        onPressed: {
+            console.log("Resize started: sidebarWidth:", mainWindowWrapper.sidebarWidth)
+            startX = mouse.x
+            startWidth = mainWindowWrapper.sidebarWidth
+        }
+
+        onPositionChanged: {
+            var delta = mouse.x - startX
+            mainWindowWrapper.sidebarWidth = Math.max(
+                0,
+                Math.min(startWidth + delta, 400)
+            )
+            if (mainWindowWrapper.sidebarWidth > 0) {
+                mainWindowWrapper.lastSidebarWidth = mainWindowWrapper.sidebarWidth
+            }
+            console.log("Resizing: sidebarWidth:", mainWindowWrapper.sidebarWidth)
+        }
+
+        onReleased: {
+            console.log("Resize ended: sidebarWidth:", mainWindowWrapper.sidebarWidth)
+        }
+    }
+
+    // Drag tab interaction
+    MouseArea {
+        id: dragTabArea
+        x: 0
+        y: mainWindowUi.topRow1.height + mainWindowUi.topRow2.height
+        width: 10
+        height: mainWindowUi.height - mainWindowUi.topRow1.height - mainWindowUi.topRow2.height - mainWindowUi.footer.height
+        cursorShape: Qt.SizeHorCursor
+        enabled: mainWindowWrapper.sidebarWidth <= 0
+
+        property real startX: 0
+        property real startWidth: 0
+
+        onPressed: {
+            console.log("Tab drag started: sidebarWidth:", mainWindowWrapper.sidebarWidth)
+            startX = mouse.x
+            startWidth = mainWindowWrapper.sidebarWidth
+        }
+
+        onPositionChanged: {
+            var delta = mouse.x - startX
+            mainWindowWrapper.sidebarWidth = Math.max(
+                0,
+                Math.min(startWidth + delta, mainWindowWrapper.lastSidebarWidth)
+            )
+            console.log("Tab dragging: sidebarWidth:", mainWindowWrapper.sidebarWidth)
+        }
+
+        onReleased: {
+            console.log("Tab drag ended: sidebarWidth:", mainWindowWrapper.sidebarWidth)
+        }
+    }
+}
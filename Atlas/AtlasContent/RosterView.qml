@@ -0,0 +1,223 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import QtQuick.Dialogs
+import Atlas
+import AtlasBackend
+
+// Roster page: every airframe with its pilot and expiry dates, and live
+// battery and link health for those flying. Rows page in from the
+// database as the list scrolls, so a large roster opens at once; sorting
+// and search apply to the rows loaded so far, and later pages slot in
+// where they belong.
+Rectangle {
+    id: rosterView
+    color: Constants.currentTheme.windowBackground
+
+    // Shared by the header and the rows; role is the Roster role shown.
+    readonly property var columns: [
+        { title: "Registration", role: "registration", width: 120 },
+        { title: "Make / model", role: "makeModel", width: 180 },
+        { title: "Serial", role: "serialNumber", width: 120 },
+        { title: "Pilot", role: "pilotName", width: 160 },
+        { title: "Registration expiry", role: "registrationExpiry", width: 140 },
+        { title: "Certification expiry", role: "certificationExpiry", width: 140 },
+        { title: "System", role: "systemId", width: 70 },
+        { title: "Battery", role: "batteryRemaining", width: 70 },
+        { title: "Link", role: "linkLoss", width: 280 }
+    ]
+
+    function cellText(row, role) {
+        const value = row[role]
+        if (value === undefined || value === null)
+            return ""
+        if (value instanceof Date)
+            return isNaN(value) ? "" : Qt.formatDate(value, "yyyy-MM-dd")
+        if (role === "systemId")
+            return value > 0 ? value : ""
+        if (role === "batteryRemaining")
+            return Math.round(value) + " %"
+        // The vehicle's best link with its loss, jitter and round trip;
+        // sorting by the column sorts by loss.
+        if (role === "linkLoss")
+            return Traffic.linkName(row.bestLink) + ": loss " + value.toFixed(1) + " %"
+                   + (row.linkJitter !== undefined ? ", jitter " + Math.round(row.linkJitter) + " ms" : "")
+                   + (row.linkRoundTrip !== undefined ? ", RTT " + Math.round(row.linkRoundTrip) + " ms" : "")
+        return value
+    }
+
+    // Expired dates stand out.
+    function cellColor(row, role) {
+        const value = row[role]
+        return value instanceof Date && !isNaN(value) && value < new Date()
+               ? Constants.currentTheme.highlight : Constants.currentTheme.text
+    }
+
+    // Re-sorts only the rows whose key changed, so sorting by a live
+    // column such as battery stays cheap.
+    LiveSortFilterModel {
+        id: rosterRows
+        sourceModel: Roster
+        sortRoleName: "registration"
+        filterRoleName: searchRole.currentValue
+        filterText: search.text
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 12
+        spacing: 8
+
+        RowLayout {
+            spacing: 12
+
+            Text {
+                text: "Roster"
+                color: Constants.currentTheme.text
+                font.pixelSize: 18
+            }
+            Text {
+                text: rosterRows.count + " shown of " + Roster.totalCount + " aircraft"
+                      + (Roster.loading ? ", loading…" : "")
+                color: Constants.currentTheme.text
+            }
+            Item {
+                Layout.fillWidth: true
+            }
+            ComboBox {
+                id: searchRole
+                model: rosterView.columns.slice(0, 4)
+                textRole: "title"
+                valueRole: "role"
+            }
+            TextField {
+                id: search
+                Layout.preferredWidth: 220
+                placeholderText: "Search"
+            }
+            Button {
+                text: "Import…"
+                enabled: !RosterImport.running
+                onClicked: importDialog.open()
+            }
+        }
+
+        // Import progress while one runs, then its outcome until the next.
+        RowLayout {
+            spacing: 12
+            visible: RosterImport.running || importResult.text !== ""
+
+            ProgressBar {
+                Layout.preferredWidth: 240
+                visible: RosterImport.running
+                value: RosterImport.progress
+            }
+            Text {
+                visible: RosterImport.running
+                text: RosterImport.phase
+                color: Constants.currentTheme.text
+            }
+            Text {
+                id: importResult
+                visible: !RosterImport.running
+                color: Constants.currentTheme.text
+            }
+        }
+
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            color: Constants.currentTheme.sectionBackground
+            border.color: Constants.currentTheme.border
+            border.width: 1
+
+            ListView {
+                id: list
+                anchors.fill: parent
+                anchors.margins: 6
+                clip: true
+                model: rosterRows
+                headerPositioning: ListView.OverlayHeader
+                ScrollBar.vertical: ScrollBar {}
+
+                header: Rectangle {
+                    z: 2
+                    width: list.width
+                    height: 28
+                    color: Constants.currentTheme.sectionBackground
+
+                    // Click a title to sort by it, again to reverse.
+                    Row {
+                        anchors.verticalCenter: parent.verticalCenter
+                        Repeater {
+                            model: rosterView.columns
+                            delegate: Text {
+                                readonly property bool sorted: rosterRows.sortRoleName === modelData.role
+                                width: modelData.width
+                                text: modelData.title + (!sorted ? ""
+                                      : rosterRows.sortOrder === Qt.AscendingOrder ? " ▲" : " ▼")
+                                color: sorted ? Constants.currentTheme.highlight : Constants.currentTheme.text
+                                font.bold: true
+                                elide: Text.ElideRight
+
+                                MouseArea {
+                                    anchors.fill: parent
+                                    onClicked: {
+                                        if (parent.sorted) {
+                                            rosterRows.sortOrder = rosterRows.sortOrder === Qt.AscendingOrder
+                                                                   ? Qt.DescendingOrder : Qt.AscendingOrder
+                                        } else {
+                                            rosterRows.sortRoleName = modelData.role
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+
+                delegate: Rectangle {
+                    readonly property var row: model
+                    width: list.width
+                    height: 26
+                    color: index % 2 ? Constants.currentTheme.sectionBackground
+                                     : Constants.currentTheme.windowBackground
+
+                    Row {
+                        anchors.verticalCenter: parent.verticalCenter
+                        Repeater {
+                            model: rosterView.columns
+                            delegate: Text {
+                                width: modelData.width
+                                text: rosterView.cellText(row, modelData.role)
+                                color: rosterView.cellColor(row, modelData.role)
+                                elide: Text.ElideRight
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Fleet CSVs and FAA registry dumps (MASTER.txt).
+    FileDialog {
+        id: importDialog
+        title: "Import roster"
+        nameFilters: ["Fleet CSV or FAA registry (*.csv *.txt)", "All files (*)"]
+        onAccepted: {
+            importResult.text = ""
+            RosterImport.importFile(selectedFile)
+        }
+    }
+
+    Connections {
+        target: RosterImport
+        function onFinished(imported, duplicates, rejected, error) {
+            importResult.text = error !== "" ? "Import failed: " + error
+                              : "Imported " + imported + ", " + duplicates + " duplicates, "
+                                + rejected + " rejected"
+            importResult.color = error !== "" ? Constants.currentTheme.highlight : Constants.currentTheme.text
+        }
+    }
+}
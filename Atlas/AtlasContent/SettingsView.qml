@@ -0,0 +1,117 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import Atlas
+import AtlasBackend
+
+// Settings page: edits the Settings store, which validates every value
+// against its schema and saves in the background. Rejected values snap
+// back to the stored one. The UI is the only writer; atlasd reloads the
+// file after each save.
+Rectangle {
+    id: settingsView
+    color: Constants.currentTheme.windowBackground
+
+    // restart: atlasd only reads the value when it starts.
+    readonly property var interfaceFields: [
+        { key: "metricsPort", label: "Metrics port", hint: "Prometheus endpoint on localhost, 0 is off" }
+    ]
+    readonly property var daemonFields: [
+        { key: "ingestLinks", label: "Ingest links", hint: "name:port,name:port", restart: true },
+        { key: "signingKeys", label: "Signing keys", hint: "name=<64 hex digits>,...", restart: true, secret: true },
+        { key: "linkDecoders", label: "Link decoders", hint: "name=decoder,...", restart: true },
+        { key: "routerEndpoints", label: "Router endpoints",
+          hint: "name=host:port [rate=N] [only=ids | drop=ids]; ..." },
+        { key: "daemonMetricsPort", label: "Daemon metrics port", hint: "0 is off" },
+        { key: "subscriptionPort", label: "Subscription port", hint: "0 is off", restart: true },
+        { key: "subscriptionAddress", label: "Subscription address", hint: "other than localhost needs a secret",
+          restart: true },
+        { key: "subscriptionSecret", label: "Subscription secret", hint: "", restart: true, secret: true },
+        { key: "picturePort", label: "Traffic picture port", hint: "WebSocket, 0 is off", restart: true },
+        { key: "pictureAddress", label: "Traffic picture address", hint: "", restart: true }
+    ]
+
+    component SectionTitle: Text {
+        color: Constants.currentTheme.text
+        font.pixelSize: 18
+    }
+
+    // One row per setting (modelData from the lists above): label, field,
+    // hint. The field writes on Enter or when it loses focus.
+    component SettingRow: RowLayout {
+        id: settingRow
+        required property var modelData
+        spacing: 12
+
+        Text {
+            Layout.preferredWidth: 180
+            text: settingRow.modelData.label
+            color: Constants.currentTheme.text
+        }
+        TextField {
+            id: input
+            Layout.preferredWidth: 420
+            text: String(Settings[settingRow.modelData.key])
+            echoMode: settingRow.modelData.secret ? TextInput.PasswordEchoOnEdit : TextInput.Normal
+            selectByMouse: true
+            onEditingFinished: {
+                Settings[settingRow.modelData.key] = text
+                text = Qt.binding(function() { return String(Settings[settingRow.modelData.key]) })
+            }
+        }
+        Text {
+            Layout.fillWidth: true
+            text: settingRow.modelData.hint + (settingRow.modelData.restart ? (settingRow.modelData.hint ? ", " : "")
+                                                                      + "applies when atlasd restarts" : "")
+            color: Constants.currentTheme.text
+            opacity: 0.7
+            elide: Text.ElideRight
+        }
+    }
+
+    ScrollView {
+        anchors.fill: parent
+        anchors.margins: 12
+        contentWidth: availableWidth
+
+        ColumnLayout {
+            width: parent.width
+            spacing: 8
+
+            SectionTitle {
+                text: "Interface"
+            }
+            RowLayout {
+                spacing: 12
+
+                Text {
+                    Layout.preferredWidth: 180
+                    text: "Theme"
+                    color: Constants.currentTheme.text
+                }
+                // App.qml saves the theme whenever it changes.
+                ComboBox {
+                    Layout.preferredWidth: 420
+                    model: ["dark", "light", "custom"]
+                    currentIndex: model.indexOf(Settings.theme)
+                    onActivated: Constants.currentTheme = currentValue === "light" ? Constants.lightTheme
+                                                        : currentValue === "custom" ? Constants.customTheme
+                                                        : Constants.darkTheme
+                }
+            }
+            Repeater {
+                model: settingsView.interfaceFields
+                delegate: SettingRow {}
+            }
+
+            SectionTitle {
+                Layout.topMargin: 12
+                text: "Daemon (atlasd)"
+            }
+            Repeater {
+                model: settingsView.daemonFields
+                delegate: SettingRow {}
+            }
+        }
+    }
+}
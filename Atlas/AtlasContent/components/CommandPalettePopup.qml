@@ -0,0 +1,98 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import Atlas
+import AtlasBackend
+
+Popup {
+    id: palette
+    width: Math.min(parent.width * 0.6, 640)
+    height: Math.min(parent.height * 0.6, 480)
+    x: (parent.width - width) / 2
+    y: parent.height * 0.1
+    modal: true
+    focus: true
+    padding: 8
+
+    background: Rectangle {
+        color: Constants.currentTheme.sectionBackground
+        radius: 4
+        border.color: Constants.currentTheme.border
+        border.width: 1
+    }
+
+    onOpened: {
+        queryField.text = ""
+        queryField.forceActiveFocus()
+    }
+
+    function activateCurrent() {
+        if (resultList.currentIndex < 0)
+            return
+        CommandPalette.activate(resultList.currentIndex)
+        palette.close()
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 8
+
+        TextField {
+            id: queryField
+            Layout.fillWidth: true
+            placeholderText: "Type a command, page or vehicle"
+            color: Constants.currentTheme.text
+            onTextChanged: {
+                CommandPalette.query = text
+                resultList.currentIndex = 0
+            }
+            Keys.onDownPressed: resultList.incrementCurrentIndex()
+            Keys.onUpPressed: resultList.decrementCurrentIndex()
+            Keys.onReturnPressed: palette.activateCurrent()
+            Keys.onEnterPressed: palette.activateCurrent()
+        }
+
+        ListView {
+            id: resultList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: CommandPalette
+            highlightMoveDuration: 0
+            highlight: Rectangle {
+                color: Constants.currentTheme.highlight
+                radius: 4
+            }
+
+            delegate: ItemDelegate {
+                id: resultDelegate
+                required property int index
+                required property string highlightedTitle
+                required property string kind
+                required property string detail
+                width: ListView.view.width
+                background: null
+
+                contentItem: RowLayout {
+                    Text {
+                        Layout.fillWidth: true
+                        text: resultDelegate.highlightedTitle
+                        textFormat: Text.StyledText
+                        color: Constants.currentTheme.text
+                        elide: Text.ElideRight
+                    }
+                    Text {
+                        text: resultDelegate.detail !== "" ? resultDelegate.detail : resultDelegate.kind
+                        color: Constants.currentTheme.text
+                        opacity: 0.6
+                    }
+                }
+
+                onClicked: {
+                    resultList.currentIndex = index
+                    palette.activateCurrent()
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,169 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import Atlas
+
+Item {
+    id: mainWindow
+    implicitWidth: 800
+    implicitHeight: 600
+    anchors.fill: parent
+
+    // Properties for sidebar control
+    property real sidebarWidth: mainWindow.width * 0.2
+    property alias sidebar: leftCell
+    property alias liveButton: liveButton
+    property alias scrubber: scrubber
+    property alias timeLabel: timeLabel
+    property alias shedLabel: shedLabel
+    property alias pages: rightCell
+    property alias topRow1: topRow1
+    property alias topRow2: topRow2
+    property alias footer: footer
+
+    ColumnLayout {
+        id: mainLayout
+        anchors.fill: parent
+        spacing: 0
+
+        // Top Row 1 (Header)
+        Rectangle {
+            id: topRow1
+            Layout.fillWidth: true
+            Layout.preferredHeight: mainWindow.height * 0.1
+            Layout.maximumHeight: 80
+            color: Constants.currentTheme.sectionBackground
+            border.color: Constants.currentTheme.border
+            border.width: 1
+
+            Text {
+                anchors.centerIn: parent
+                text: "Header/Toolbar"
+                color: Constants.currentTheme.text
+                font.pixelSize: parent.height * 0.3
+            }
+        }
+
+        // Top Row 2 (Subheader)
+        Rectangle {
+            id: topRow2
+            Layout.fillWidth: true
+            Layout.preferredHeight: mainWindow.height * 0.1
+            Layout.maximumHeight: 80
+            color: Constants.currentTheme.sectionBackground
+            border.color: Constants.currentTheme.border
+            border.width: 1
+
+            // Timeline scrubber: drag into the recorded past or the planned
+            // future. MainWindow.qml binds it to the timeline.
+            RowLayout {
+                anchors.fill: parent
+                anchors.leftMargin: 12
+                anchors.rightMargin: 12
+                spacing: 12
+
+                Button {
+                    id: liveButton
+                    text: "Live"
+                }
+
+                Slider {
+                    id: scrubber
+                    Layout.fillWidth: true
+                    live: true
+                }
+
+                Text {
+                    id: timeLabel
+                    text: "--:--:--"
+                    color: Constants.currentTheme.text
+                    font.pixelSize: topRow2.height * 0.3
+                }
+            }
+        }
+
+        // Middle Section: Left and Right Cells
+        RowLayout {
+            id: middleSection
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            spacing: 0
+
+            // Left Cell: Sidebar
+            Sidebar {
+                id: leftCell
+                Layout.fillHeight: true
+                Layout.preferredWidth: sidebarWidth
+                Layout.minimumWidth: 0
+                Layout.maximumWidth: 400
+                visible: sidebarWidth > 0
+                border.color: Constants.currentTheme.border
+                border.width: 1
+            }
+
+            // Resize Handle (shown when sidebar visible)
+            Rectangle {
+                id: resizeHandle
+                Layout.fillHeight: true
+                Layout.preferredWidth: 6
+                color: Constants.currentTheme.border
+                visible: sidebarWidth > 0
+            }
+
+            // Right Cell: Main Content (Loader)
+            Loader {
+                id: rightCell
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                // MainWindow.qml picks the page; without one the placeholder shows.
+
+                Item {
+                    anchors.fill: parent
+                    visible: rightCell.status !== Loader.Ready
+                    Rectangle {
+                        anchors.fill: parent
+                        color: Constants.currentTheme.sectionBackground
+                        border.color: Constants.currentTheme.border
+                        border.width: 1
+
+                        Text {
+                            anchors.centerIn: parent
+                            text: "Main Content Area (Swap with Loader.source)"
+                            color: Constants.currentTheme.text
+                            font.pixelSize: parent.height * 0.05
+                        }
+                    }
+                }
+            }
+        }
+
+        // Footer
+        Rectangle {
+            id: footer
+            Layout.fillWidth: true
+            Layout.preferredHeight: mainWindow.height * 0.05
+            Layout.maximumHeight: 50
+            color: Constants.currentTheme.sectionBackground
+            border.color: Constants.currentTheme.border
+            border.width: 1
+
+            Text {
+                anchors.centerIn: parent
+                text: "Footer"
+                color: Constants.currentTheme.text
+                font.pixelSize: parent.height * 0.5
+            }
+
+            // The daemon dropping frames to keep up; bulk streams go first.
+            Text {
+                id: shedLabel
+                anchors.right: parent.right
+                anchors.rightMargin: 10
+                anchors.verticalCenter: parent.verticalCenter
+                visible: false
+                color: Constants.currentTheme.text
+                font.pixelSize: parent.height * 0.35
+            }
+        }
+    }
+}
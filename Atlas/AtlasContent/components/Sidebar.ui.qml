@@ -0,0 +1,109 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import Atlas
+
+Rectangle {
+    id: sidebar
+    implicitWidth: 200
+    implicitHeight: 600
+    color: Constants.currentTheme.windowBackground
+    radius: 4
+    border.color: Constants.currentTheme.border
+    border.width: 1
+
+    property alias buttonGroup: buttonGroup
+
+    ButtonGroup {
+        id: buttonGroup
+    }
+
+    ScrollView {
+        id: scrollView
+        anchors.fill: parent
+        clip: true
+
+        ColumnLayout {
+            id: buttonColumn
+            width: scrollView.width
+            spacing: sidebar.height * 0.0001
+
+            SidebarButton {
+                id: homebutton
+                buttonText: "Home"
+                iconSource: "../images/home.png"
+                checked: true
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+            }
+
+            SidebarButton {
+                id: airspacebutton
+                buttonText: "Airspace"
+                iconSource: "../images/airspace.png"
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+            }
+
+            SidebarButton {
+                id: commandbutton
+                buttonText: "Command"
+                iconSource: "../images/command.png"
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+            }
+
+            SidebarButton {
+                id: rosterbutton
+                buttonText: "Roster"
+                iconSource: "../images/roster.png"
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+            }
+
+            SidebarButton {
+                id: flightlogbutton
+                buttonText: "Logs"
+                iconSource: "../images/flight-logs.png"
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+            }
+
+            SidebarButton {
+                id: settingbutton
+                buttonText: "Debug"
+                iconSource: "../images/debug.png"
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+            }
+
+            SidebarButton {
+                id: profilebutton
+                buttonText: "Settings"
+                iconSource: "../images/settings.png"
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+            }
+
+            SidebarButton {
+                id: themeModeButton
+                buttonText: Constants.currentTheme === Constants.darkTheme ? "Light Mode" : "Dark Mode"
+                iconSource: Constants.currentTheme === Constants.darkTheme ? "../light-mode.png" : "../dark-mode.png"
+                Layout.fillWidth: true
+                Layout.preferredHeight: sidebar.height * 0.12
+                ButtonGroup.group: buttonGroup
+                onClicked: Constants.currentTheme
+                           === Constants.darkTheme ? Constants.currentTheme
+                                                     = Constants.lightTheme : Constants.currentTheme
+                                                     = Constants.darkTheme
+            }
+        }
+    }
+}
@@ -0,0 +1,112 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import Atlas
+
+Button {
+    id: customButton
+    implicitWidth: 120
+    implicitHeight: 48
+    leftPadding: 8
+    rightPadding: 8
+    topPadding: 4
+    bottomPadding: 4
+    checkable: true
+
+    property string buttonText: "Button"
+    property url iconSource: ""
+
+    background: Rectangle {
+        id: backgroundItem
+        width: parent.width
+        height: parent.height
+        color: Constants.currentTheme.sectionBackground
+        radius: 4
+        border.color: Constants.currentTheme.border
+        border.width: 1
+    }
+
+    contentItem: Row {
+        id: contentRow
+        spacing: customButton.height * 0.2
+        anchors.centerIn: parent
+
+        Item {
+            id: iconContainer
+            width: customButton.height * 0.4
+            height: customButton.height * 0.4
+            anchors.verticalCenter: parent.verticalCenter
+            clip: true
+
+            Image {
+                id: iconItem
+                source: customButton.iconSource
+                width: parent.width
+                height: parent.height
+                anchors.centerIn: parent
+                visible: status === Image.Ready
+                fillMode: Image.PreserveAspectFit
+            }
+
+            Rectangle {
+                id: placeholder
+                width: parent.width
+                height: parent.height
+                color: Constants.currentTheme.highlight
+                visible: !iconItem.visible && customButton.iconSource !== ""
+                anchors.centerIn: parent
+
+                Text {
+                    anchors.centerIn: parent
+                    text: "X"
+                    color: Constants.currentTheme.text
+                    font.pixelSize: parent.height * 0.5
+                }
+            }
+        }
+
+        Text {
+            id: textItem
+            text: customButton.buttonText
+            color: Constants.currentTheme.text
+            font.pixelSize: customButton.height * 0.3
+            font.family: "Arial"
+            horizontalAlignment: Text.AlignHCenter
+            verticalAlignment: Text.AlignVCenter
+            anchors.verticalCenter: parent.verticalCenter
+            width: Math.min(
+                       implicitWidth,
+                       customButton.width - iconContainer.width - contentRow.spacing
+                       - customButton.leftPadding - customButton.rightPadding)
+            elide: Text.ElideRight
+        }
+    }
+
+    states: [
+        State {
+            name: "normal"
+            when: !customButton.down && !customButton.checked
+            PropertyChanges {
+                target: backgroundItem
+                color: Constants.currentTheme.sectionBackground
+                border.color: Constants.currentTheme.border
+            }
+            PropertyChanges {
+                target: textItem
+                color: Constants.currentTheme.text
+            }
+        },
+        State {
+            name: "down"
+            when: customButton.down || customButton.checked
+            PropertyChanges {
+                target: backgroundItem
+                color: Constants.currentTheme.windowBackground
+                border.color: Constants.currentTheme.highlight
+            }
+            PropertyChanges {
+                target: textItem
+                color: Constants.currentTheme.text
+            }
+        }
+    ]
+}
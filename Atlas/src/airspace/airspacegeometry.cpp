@@ -0,0 +1,182 @@
+#include "airspacegeometry.h"
+
+#include <QTimer>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "geometry/triangulation.h"
+
+namespace {
+
+struct ColoredVertex
+{
+    float x, y, z;
+    float r, g, b, a;
+};
+
+template<typename T>
+QByteArray bytes(const std::vector<T> &values)
+{
+    return QByteArray(reinterpret_cast<const char *>(values.data()), qsizetype(values.size() * sizeof(T)));
+}
+
+} // namespace
+
+AircraftGeometry::AircraftGeometry(QQuick3DObject *parent)
+    : QQuick3DGeometry(parent)
+{
+    // Nose, wing tips, tail notch, and a spine above and below so the dart
+    // has some body seen edge-on.
+    const std::vector<QVector3D> vertices = {
+        {0.0f, 0.0f, -1.0f}, {-0.8f, 0.0f, 0.7f}, {0.8f, 0.0f, 0.7f},
+        {0.0f, 0.0f, 0.35f}, {0.0f, 0.2f, 0.2f},  {0.0f, -0.1f, 0.2f},
+    };
+    const std::vector<quint16> indices = {
+        0, 1, 4, 1, 3, 4, 3, 2, 4, 2, 0, 4, // top
+        0, 5, 1, 1, 5, 3, 3, 5, 2, 2, 5, 0, // bottom
+    };
+    setVertexData(bytes(vertices));
+    setIndexData(bytes(indices));
+    setStride(sizeof(QVector3D));
+    setPrimitiveType(PrimitiveType::Triangles);
+    addAttribute(Attribute::PositionSemantic, 0, Attribute::F32Type);
+    addAttribute(Attribute::IndexSemantic, 0, Attribute::U16Type);
+    setBounds(QVector3D(-0.8f, -0.1f, -1.0f), QVector3D(0.8f, 0.2f, 0.7f));
+}
+
+OperationVolumeGeometry::OperationVolumeGeometry(QQuick3DObject *parent)
+    : QQuick3DGeometry(parent)
+{
+}
+
+void OperationVolumeGeometry::setVolumes(OperationVolumeStore *volumes)
+{
+    if (volumes == m_volumes)
+        return;
+    if (m_volumes)
+        disconnect(m_volumes, nullptr, this, nullptr);
+    m_volumes = volumes;
+    if (m_volumes) {
+        connect(m_volumes, &OperationVolumeStore::volumeChanged, this, &OperationVolumeGeometry::scheduleRebuild);
+        connect(m_volumes, &OperationVolumeStore::volumeRemoved, this, &OperationVolumeGeometry::scheduleRebuild);
+    }
+    scheduleRebuild();
+    emit volumesChanged();
+}
+
+void OperationVolumeGeometry::setOriginLatitude(double latitude)
+{
+    if (latitude == m_frame.latitude)
+        return;
+    m_frame.latitude = latitude;
+    scheduleRebuild();
+    emit originChanged();
+}
+
+void OperationVolumeGeometry::setOriginLongitude(double longitude)
+{
+    if (longitude == m_frame.longitude)
+        return;
+    m_frame.longitude = longitude;
+    scheduleRebuild();
+    emit originChanged();
+}
+
+void OperationVolumeGeometry::setIntentColor(const QColor &color)
+{
+    if (color == m_intentColor)
+        return;
+    m_intentColor = color;
+    scheduleRebuild();
+    emit appearanceChanged();
+}
+
+void OperationVolumeGeometry::setConstraintColor(const QColor &color)
+{
+    if (color == m_constraintColor)
+        return;
+    m_constraintColor = color;
+    scheduleRebuild();
+    emit appearanceChanged();
+}
+
+void OperationVolumeGeometry::scheduleRebuild()
+{
+    // A feed replacing hundreds of volumes at once costs one rebuild.
+    if (m_rebuildPending)
+        return;
+    m_rebuildPending = true;
+    QTimer::singleShot(0, this, &OperationVolumeGeometry::rebuild);
+}
+
+void OperationVolumeGeometry::rebuild()
+{
+    m_rebuildPending = false;
+    clear();
+    if (!m_volumes || !m_frame.isValid() || m_volumes->count() == 0) {
+        update();
+        return;
+    }
+
+    std::vector<ColoredVertex> vertices;
+    std::vector<quint32> indices;
+    QVector3D minimum(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                      std::numeric_limits<float>::max());
+    QVector3D maximum = -minimum;
+    std::vector<QPointF> ring;
+    for (int v = 0; v < m_volumes->count(); ++v) {
+        const OperationVolume &volume = m_volumes->at(v);
+        const size_t n = volume.outline.size();
+        if (n < 3)
+            continue;
+        const QColor &color = volume.kind == OperationVolume::Kind::Constraint ? m_constraintColor : m_intentColor;
+        const quint32 base = quint32(vertices.size());
+
+        // Floor ring, then ceiling ring.
+        ring.clear();
+        for (const double altitude : {volume.floorMsl, volume.ceilingMsl}) {
+            for (const QPointF &point : volume.outline) {
+                const QVector3D position = m_frame.toScene(point.y(), point.x(), altitude);
+                vertices.push_back({position.x(), position.y(), position.z(), float(color.redF()),
+                                    float(color.greenF()), float(color.blueF()), float(color.alphaF())});
+                minimum = QVector3D(std::min(minimum.x(), position.x()), std::min(minimum.y(), position.y()),
+                                    std::min(minimum.z(), position.z()));
+                maximum = QVector3D(std::max(maximum.x(), position.x()), std::max(maximum.y(), position.y()),
+                                    std::max(maximum.z(), position.z()));
+                if (ring.size() < n)
+                    ring.emplace_back(position.x(), -position.z()); // east, north
+            }
+        }
+
+        const std::vector<uint32_t> cap = triangulatePolygon(ring);
+        for (size_t i = 0; i + 2 < cap.size(); i += 3) {
+            // Floor faces down, ceiling up.
+            indices.insert(indices.end(), {base + cap[i], base + cap[i + 2], base + cap[i + 1]});
+            indices.insert(indices.end(), {base + quint32(n) + cap[i], base + quint32(n) + cap[i + 1],
+                                           base + quint32(n) + cap[i + 2]});
+        }
+        for (quint32 i = 0; i < quint32(n); ++i) {
+            const quint32 j = (i + 1) % quint32(n);
+            const quint32 floorI = base + i, floorJ = base + j;
+            const quint32 ceilingI = floorI + quint32(n), ceilingJ = floorJ + quint32(n);
+            indices.insert(indices.end(), {floorI, floorJ, ceilingJ, floorI, ceilingJ, ceilingI});
+        }
+    }
+
+    if (indices.empty()) {
+        update();
+        return;
+    }
+    setVertexData(bytes(vertices));
+    setIndexData(bytes(indices));
+    setStride(sizeof(ColoredVertex));
+    setPrimitiveType(PrimitiveType::Triangles);
+    addAttribute(Attribute::PositionSemantic, 0, Attribute::F32Type);
+    addAttribute(Attribute::ColorSemantic, offsetof(ColoredVertex, r), Attribute::F32Type);
+    addAttribute(Attribute::IndexSemantic, 0, Attribute::U32Type);
+    setBounds(minimum, maximum);
+    update();
+}
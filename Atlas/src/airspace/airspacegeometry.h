@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QColor>
+#include <QPointer>
+#include <QtQuick3D/qquick3dgeometry.h>
+
+#include "airspace/localframe.h"
+#include "state/operationvolumestore.h"
+
+// A unit dart pointing north (-z): eight triangles, so thousands of
+// instances stay cheap on a software rasterizer. The fallback aircraft
+// mesh of the 3D airspace view when no converted model in Generated/ is
+// given.
+class AircraftGeometry : public QQuick3DGeometry
+{
+    Q_OBJECT
+
+public:
+    explicit AircraftGeometry(QQuick3DObject *parent = nullptr);
+};
+
+// Every operation volume in the store as one mesh: each outline
+// triangulated for the floor and ceiling and extruded into walls, coloured
+// per vertex by kind, so all volumes draw in a single call. Rebuilt once
+// per event loop pass after volumes change; they change rarely next to
+// the aircraft.
+class OperationVolumeGeometry : public QQuick3DGeometry
+{
+    Q_OBJECT
+    Q_PROPERTY(OperationVolumeStore *volumes READ volumes WRITE setVolumes NOTIFY volumesChanged)
+    Q_PROPERTY(double originLatitude READ originLatitude WRITE setOriginLatitude NOTIFY originChanged)
+    Q_PROPERTY(double originLongitude READ originLongitude WRITE setOriginLongitude NOTIFY originChanged)
+    Q_PROPERTY(QColor intentColor READ intentColor WRITE setIntentColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor constraintColor READ constraintColor WRITE setConstraintColor NOTIFY appearanceChanged)
+
+public:
+    explicit OperationVolumeGeometry(QQuick3DObject *parent = nullptr);
+
+    OperationVolumeStore *volumes() const { return m_volumes; }
+    void setVolumes(OperationVolumeStore *volumes);
+    double originLatitude() const { return m_frame.latitude; }
+    void setOriginLatitude(double latitude);
+    double originLongitude() const { return m_frame.longitude; }
+    void setOriginLongitude(double longitude);
+    QColor intentColor() const { return m_intentColor; }
+    void setIntentColor(const QColor &color);
+    QColor constraintColor() const { return m_constraintColor; }
+    void setConstraintColor(const QColor &color);
+
+signals:
+    void volumesChanged();
+    void originChanged();
+    void appearanceChanged();
+
+private:
+    void scheduleRebuild();
+    void rebuild();
+
+    QPointer<OperationVolumeStore> m_volumes;
+    LocalFrame m_frame;
+    QColor m_intentColor = QColor(0x3a, 0x8e, 0xe6);
+    QColor m_constraintColor = QColor(0xe6, 0x3a, 0x3a);
+    bool m_rebuildPending = false;
+};
@@ -0,0 +1,179 @@
+#include "airspaceinstancing.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+using Entry = QQuick3DInstancing::InstanceTableEntry;
+
+constexpr FieldMask drawnFields = fieldBit(VehicleField::Latitude) | fieldBit(VehicleField::Longitude)
+                                  | fieldBit(VehicleField::AltitudeMsl) | fieldBit(VehicleField::Heading)
+                                  | fieldBit(VehicleField::Roll) | fieldBit(VehicleField::Pitch)
+                                  | fieldBit(VehicleField::Yaw) | fieldBit(VehicleField::Armed);
+
+double valueOr(const VehicleState &state, VehicleField field, double fallback)
+{
+    const double value = state.published[int(field)];
+    return std::isnan(value) ? fallback : value;
+}
+
+} // namespace
+
+AirspaceInstancing::AirspaceInstancing(QQuick3DObject *parent)
+    : QQuick3DInstancing(parent)
+{
+}
+
+void AirspaceInstancing::setVehicles(VehicleModel *vehicles)
+{
+    if (vehicles == m_vehicles)
+        return;
+    if (m_store)
+        disconnect(m_store, nullptr, this, nullptr);
+    m_vehicles = vehicles;
+    m_store = vehicles ? vehicles->store() : nullptr;
+    if (m_store) {
+        connect(m_store, &VehicleStateStore::vehicleAdded, this, &AirspaceInstancing::onVehicleAdded);
+        connect(m_store, &VehicleStateStore::fieldsChanged, this, &AirspaceInstancing::onFieldsChanged);
+    }
+    invalidateAll();
+    emit vehiclesChanged();
+}
+
+void AirspaceInstancing::setOriginLatitude(double latitude)
+{
+    if (latitude == m_frame.latitude)
+        return;
+    m_frame.latitude = latitude;
+    invalidateAll();
+    emit originChanged();
+}
+
+void AirspaceInstancing::setOriginLongitude(double longitude)
+{
+    if (longitude == m_frame.longitude)
+        return;
+    m_frame.longitude = longitude;
+    invalidateAll();
+    emit originChanged();
+}
+
+void AirspaceInstancing::setAircraftSize(float size)
+{
+    if (size == m_aircraftSize)
+        return;
+    m_aircraftSize = size;
+    invalidateAll();
+    emit appearanceChanged();
+}
+
+void AirspaceInstancing::setArmedColor(const QColor &color)
+{
+    if (color == m_armedColor)
+        return;
+    m_armedColor = color;
+    invalidateAll();
+    emit appearanceChanged();
+}
+
+void AirspaceInstancing::setDisarmedColor(const QColor &color)
+{
+    if (color == m_disarmedColor)
+        return;
+    m_disarmedColor = color;
+    invalidateAll();
+    emit appearanceChanged();
+}
+
+void AirspaceInstancing::invalidateAll()
+{
+    m_allDirty = true;
+    markDirty();
+}
+
+void AirspaceInstancing::onVehicleAdded(int index)
+{
+    m_table.resize(qsizetype(m_store->count()) * qsizetype(sizeof(Entry)));
+    // Hidden until it reports a position.
+    std::memset(m_table.data() + qsizetype(index) * qsizetype(sizeof(Entry)), 0, sizeof(Entry));
+    markDirty();
+}
+
+void AirspaceInstancing::onFieldsChanged(const QList<VehicleFieldChange> &changes)
+{
+    bool changed = false;
+    for (const VehicleFieldChange &change : changes) {
+        if (!(change.fields & drawnFields))
+            continue;
+        if (!m_frame.isValid()) {
+            const VehicleState &state = m_store->at(change.index);
+            const double latitude = state.published[int(VehicleField::Latitude)];
+            const double longitude = state.published[int(VehicleField::Longitude)];
+            if (!std::isnan(latitude) && !std::isnan(longitude)) {
+                // Set both before either notifies, so bindings see a valid frame.
+                m_frame.latitude = latitude;
+                m_frame.longitude = longitude;
+                m_allDirty = true;
+                emit originChanged();
+            }
+        }
+        if (size_t(change.index) >= m_isDirty.size())
+            m_isDirty.resize(size_t(m_store->count()), false);
+        if (!m_isDirty[size_t(change.index)]) {
+            m_isDirty[size_t(change.index)] = true;
+            m_dirty.push_back(change.index);
+        }
+        changed = true;
+    }
+    if (changed)
+        markDirty();
+}
+
+void AirspaceInstancing::writeEntry(int index)
+{
+    const VehicleState &state = m_store->at(index);
+    const double latitude = state.published[int(VehicleField::Latitude)];
+    const double longitude = state.published[int(VehicleField::Longitude)];
+    auto *entry = reinterpret_cast<Entry *>(m_table.data()) + index;
+    if (std::isnan(latitude) || std::isnan(longitude) || !m_frame.isValid()) {
+        std::memset(static_cast<void *>(entry), 0, sizeof(Entry));
+        return;
+    }
+
+    const QVector3D position = m_frame.toScene(latitude, longitude, valueOr(state, VehicleField::AltitudeMsl, 0));
+    // The mesh points north (-z) with its wings along x. Heading and yaw
+    // turn clockwise seen from above, Quick3D's y rotation the other way;
+    // positive roll drops the right wing.
+    const double heading = valueOr(state, VehicleField::Heading, valueOr(state, VehicleField::Yaw, 0));
+    const QVector3D rotation(float(valueOr(state, VehicleField::Pitch, 0)), float(-heading),
+                             float(-valueOr(state, VehicleField::Roll, 0)));
+    const bool armed = valueOr(state, VehicleField::Armed, 0) != 0;
+    *entry = calculateTableEntry(position, QVector3D(m_aircraftSize, m_aircraftSize, m_aircraftSize), rotation,
+                                 armed ? m_armedColor : m_disarmedColor);
+}
+
+// Called from the scene graph sync, with the GUI thread blocked.
+QByteArray AirspaceInstancing::getInstanceBuffer(int *instanceCount)
+{
+    const int count = m_store ? m_store->count() : 0;
+    m_table.resize(qsizetype(count) * qsizetype(sizeof(Entry)));
+
+    if (m_allDirty) {
+        for (int i = 0; i < count; ++i)
+            writeEntry(i);
+        m_allDirty = false;
+    } else {
+        for (const int index : m_dirty) {
+            if (index < count)
+                writeEntry(index);
+        }
+    }
+    for (const int index : m_dirty)
+        m_isDirty[size_t(index)] = false;
+    m_dirty.clear();
+
+    if (instanceCount)
+        *instanceCount = count;
+    return m_table;
+}
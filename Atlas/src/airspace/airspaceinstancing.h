@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QColor>
+#include <QPointer>
+#include <QtQuick3D/qquick3dinstancing.h>
+
+#include <vector>
+
+#include "airspace/localframe.h"
+#include "models/vehiclemodel.h"
+
+// The instance table of the 3D airspace view: one entry per vehicle in
+// the state store, position and attitude from its published fields.
+// Entries are rewritten only for the vehicles in each fieldsChanged batch
+// (at most once a frame), so a frame with 2,000 aircraft moving costs one
+// pass over those entries and one buffer upload, and all of them draw in a
+// single instanced call. Vehicles without a position get scale 0.
+class AirspaceInstancing : public QQuick3DInstancing
+{
+    Q_OBJECT
+    Q_PROPERTY(VehicleModel *vehicles READ vehicles WRITE setVehicles NOTIFY vehiclesChanged)
+    // The scene origin; the first vehicle with a position while unset.
+    Q_PROPERTY(double originLatitude READ originLatitude WRITE setOriginLatitude NOTIFY originChanged)
+    Q_PROPERTY(double originLongitude READ originLongitude WRITE setOriginLongitude NOTIFY originChanged)
+    Q_PROPERTY(float aircraftSize READ aircraftSize WRITE setAircraftSize NOTIFY appearanceChanged) // metres
+    Q_PROPERTY(QColor armedColor READ armedColor WRITE setArmedColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor disarmedColor READ disarmedColor WRITE setDisarmedColor NOTIFY appearanceChanged)
+
+public:
+    explicit AirspaceInstancing(QQuick3DObject *parent = nullptr);
+
+    VehicleModel *vehicles() const { return m_vehicles; }
+    void setVehicles(VehicleModel *vehicles);
+    double originLatitude() const { return m_frame.latitude; }
+    void setOriginLatitude(double latitude);
+    double originLongitude() const { return m_frame.longitude; }
+    void setOriginLongitude(double longitude);
+    float aircraftSize() const { return m_aircraftSize; }
+    void setAircraftSize(float size);
+    QColor armedColor() const { return m_armedColor; }
+    void setArmedColor(const QColor &color);
+    QColor disarmedColor() const { return m_disarmedColor; }
+    void setDisarmedColor(const QColor &color);
+
+signals:
+    void vehiclesChanged();
+    void originChanged();
+    void appearanceChanged();
+
+protected:
+    QByteArray getInstanceBuffer(int *instanceCount) override;
+
+private:
+    void onVehicleAdded(int index);
+    void onFieldsChanged(const QList<VehicleFieldChange> &changes);
+    void invalidateAll();
+    void writeEntry(int index);
+
+    QPointer<VehicleModel> m_vehicles;
+    VehicleStateStore *m_store = nullptr;
+    LocalFrame m_frame;
+    float m_aircraftSize = 60;
+    QColor m_armedColor = QColor(0xff, 0x8c, 0x00);
+    QColor m_disarmedColor = QColor(0xb0, 0xb0, 0xb0);
+    QByteArray m_table; // InstanceTableEntry per store index
+    std::vector<int> m_dirty;
+    std::vector<bool> m_isDirty;
+    bool m_allDirty = true;
+};
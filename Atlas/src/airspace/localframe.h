@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QVector3D>
+
+#include <cmath>
+#include <limits>
+
+// Flat-earth metres around an origin, in Quick3D scene axes: x east, y up
+// (metres MSL), z south. Good to a few metres over the tens of kilometres
+// an airspace view spans, and far cheaper than a proper projection per
+// instance per frame.
+struct LocalFrame
+{
+    static constexpr double metresPerDegree = 111319.49; // WGS84 equator
+
+    double latitude = std::numeric_limits<double>::quiet_NaN();
+    double longitude = std::numeric_limits<double>::quiet_NaN();
+
+    bool isValid() const { return !std::isnan(latitude) && !std::isnan(longitude); }
+
+    QVector3D toScene(double lat, double lon, double altitudeMsl) const
+    {
+        const double east = (lon - longitude) * metresPerDegree * std::cos(latitude * M_PI / 180);
+        const double north = (lat - latitude) * metresPerDegree;
+        return QVector3D(float(east), float(altitudeMsl), float(-north));
+    }
+};
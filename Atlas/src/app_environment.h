@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// Mirrors the Environment block in Atlas.qmlproject so the compiled app
+// behaves the same as the Design Studio preview. projectRoot is the
+// directory holding Atlas.qmlproject (targetDirectory when deployed).
+inline void set_qt_environment(const QString &projectRoot)
+{
+    qputenv("QT_QUICK_CONTROLS_CONF", (projectRoot + "/qtquickcontrols2.conf").toLocal8Bit());
+    qputenv("QML_COMPAT_RESOLVE_URLS_ON_ASSIGNMENT", "1");
+    qputenv("QT_LOGGING_RULES", "qt.qml.connections=false");
+    qputenv("QT_ENABLE_HIGHDPI_SCALING", "0");
+}
@@ -0,0 +1,89 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QHash>
+#include <QHostAddress>
+#include <QStandardPaths>
+
+#include "diagnostics/metricsserver.h"
+#include "ingest/ingestservice.h"
+#include "settings/settingsstore.h"
+
+// atlasd: ingest, command and logging without a UI. Started by the first
+// Atlas window that finds no traffic snapshot, and left running across UI
+// restarts.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Same names as the UI so both resolve the same data and config dirs.
+    app.setOrganizationName(QStringLiteral("CSU Fresno UAS Research Team"));
+    app.setApplicationName(QStringLiteral("Atlas"));
+
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    const QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QDir().mkpath(configDir); // watched before the UI first saves
+
+    // The UI owns the file; the daemon follows its saves.
+    SettingsStore settings(configDir + QStringLiteral("/settings.bin"), SettingsStore::Access::ReadOnly);
+    settings.load();
+
+    MetricsServer metricsServer;
+    metricsServer.listen(quint16(settings.value(QStringLiteral("daemonMetricsPort")).toUInt()));
+    settings.onChanged(QStringLiteral("daemonMetricsPort"), &metricsServer, [&metricsServer](const QVariant &port) {
+        metricsServer.listen(quint16(port.toUInt()));
+    });
+
+    IngestService ingest(dataDir + QStringLiteral("/logs"));
+    QHash<QString, QByteArray> signingKeys;
+    const QStringList keys = settings.value(QStringLiteral("signingKeys")).toString().split(
+        QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &entry : keys) {
+        const QByteArray key = QByteArray::fromHex(entry.section(QLatin1Char('='), 1).trimmed().toLatin1());
+        if (key.size() == 32)
+            signingKeys.insert(entry.section(QLatin1Char('='), 0, 0).trimmed(), key);
+        else
+            qWarning("atlasd: ignoring signing key for \"%s\"", qPrintable(entry.section(QLatin1Char('='), 0, 0)));
+    }
+    const QStringList links = settings.value(QStringLiteral("ingestLinks")).toString().split(
+        QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &link : links) {
+        // "lte:14551", or a bare port.
+        const QString name = link.section(QLatin1Char(':'), 0, -2).trimmed();
+        const quint16 port = quint16(link.section(QLatin1Char(':'), -1).trimmed().toUInt());
+        const QString linkName = name.isEmpty() ? QStringLiteral("udp%1").arg(port) : name;
+        if (port == 0 || !ingest.addUdpLink(linkName, port, signingKeys.value(linkName)))
+            qWarning("atlasd: ignoring ingest link \"%s\"", qPrintable(link));
+    }
+    const QStringList decoders = settings.value(QStringLiteral("linkDecoders")).toString().split(
+        QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &entry : decoders) {
+        // "dji=dji-ocusync"
+        const QString link = entry.section(QLatin1Char('='), 0, 0).trimmed();
+        if (!ingest.setLinkDecoder(link, entry.section(QLatin1Char('='), 1).trimmed()))
+            qWarning("atlasd: ignoring decoder for unknown link \"%s\"", qPrintable(link));
+    }
+    // Routing follows the Settings page while the daemon runs.
+    const auto applyRouterEndpoints = [&ingest](const QString &spec) {
+        QStringList badEndpoints;
+        const auto endpoints = MavlinkRouter::parseEndpoints(spec, &badEndpoints);
+        for (const QString &endpoint : std::as_const(badEndpoints))
+            qWarning("atlasd: ignoring router endpoint \"%s\"", qPrintable(endpoint));
+        QString error;
+        if (!ingest.setRouterEndpoints(endpoints, &error))
+            qWarning("atlasd: cannot route to %s", qPrintable(error));
+    };
+    applyRouterEndpoints(settings.value(QStringLiteral("routerEndpoints")).toString());
+    settings.onChanged(QStringLiteral("routerEndpoints"), &ingest, [applyRouterEndpoints](const QVariant &spec) {
+        applyRouterEndpoints(spec.toString());
+    });
+    ingest.setSubscriptionServer(QHostAddress(settings.value(QStringLiteral("subscriptionAddress")).toString()),
+                                 quint16(settings.value(QStringLiteral("subscriptionPort")).toUInt()),
+                                 settings.value(QStringLiteral("subscriptionSecret")).toString().toUtf8());
+    ingest.setPictureServer(QHostAddress(settings.value(QStringLiteral("pictureAddress")).toString()),
+                            quint16(settings.value(QStringLiteral("picturePort")).toUInt()));
+    if (!ingest.start()) {
+        qCritical("atlasd: %s", qPrintable(ingest.errorString()));
+        return 1;
+    }
+    return app.exec();
+}
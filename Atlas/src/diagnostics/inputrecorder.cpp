@@ -0,0 +1,365 @@
+#include "inputrecorder.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QQuickWindow>
+#include <QUrl>
+#include <QWheelEvent>
+
+#include <chrono>
+
+namespace {
+
+constexpr quint32 fileMagic = 0x41524543; // "AREC"
+// 2 added the sample times to telemetry entries.
+constexpr quint16 fileVersion = 2;
+constexpr QDataStream::Version streamVersion = QDataStream::Qt_6_5;
+
+// The clock SampleTime::monotonicUs is on.
+qint64 steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+InputRecorder::InputRecorder(VehicleStateStore *store, const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_store(store)
+    , m_directory(directory)
+{
+    m_replayTimer.setSingleShot(true);
+    m_replayTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_replayTimer, &QTimer::timeout, this, &InputRecorder::dispatchDue);
+}
+
+InputRecorder::~InputRecorder()
+{
+    stopRecording();
+}
+
+void InputRecorder::setWindow(QQuickWindow *window)
+{
+    if (m_window)
+        m_window->removeEventFilter(this);
+    m_window = window;
+    if (m_window)
+        m_window->installEventFilter(this);
+}
+
+bool InputRecorder::startRecording()
+{
+    if (recording() || replaying() || !m_window)
+        return false;
+
+    QDir().mkpath(m_directory);
+    const QString path = m_directory + QStringLiteral("/input-")
+                         + QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))
+                         + QStringLiteral(".atlasrec");
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("InputRecorder: cannot write %s: %s", qPrintable(path), qPrintable(m_file.errorString()));
+        return false;
+    }
+    m_out.setDevice(&m_file);
+    m_out.setVersion(streamVersion);
+    m_out << fileMagic << fileVersion;
+
+    m_clock.start();
+    m_lastRecording = path;
+
+    // The window size goes first so replayed coordinates land on the same items.
+    Entry size;
+    size.kind = Kind::Resize;
+    size.position = QPointF(m_window->width(), m_window->height());
+    write(size);
+
+    if (m_store) {
+        m_sampleTap = m_store->addSampleTap([this](int systemId, VehicleField field, double value,
+                                                   qint64 timestampMs, const SampleTime &time) {
+            Entry sample;
+            sample.kind = Kind::Telemetry;
+            sample.systemId = systemId;
+            sample.field = int(field);
+            sample.value = value;
+            sample.sampleTimeMs = timestampMs;
+            sample.sampleAgeUs = steadyNowUs() - time.monotonicUs;
+            sample.sampleUncertaintyUs = time.uncertaintyUs;
+            write(sample);
+        });
+    }
+    emit stateChanged();
+    return true;
+}
+
+void InputRecorder::stopRecording()
+{
+    if (!recording())
+        return;
+    if (m_store && m_sampleTap != 0) {
+        m_store->removeSampleTap(m_sampleTap);
+        m_sampleTap = 0;
+    }
+    m_out.setDevice(nullptr);
+    m_file.close();
+    emit stateChanged();
+}
+
+void InputRecorder::toggleRecording()
+{
+    if (recording())
+        stopRecording();
+    else
+        startRecording();
+}
+
+void InputRecorder::mark(const QString &kind, const QString &value)
+{
+    if (!recording())
+        return;
+    Entry marker;
+    marker.kind = Kind::Marker;
+    marker.text = kind + QLatin1Char(':') + value;
+    write(marker);
+}
+
+bool InputRecorder::eventFilter(QObject *watched, QEvent *event)
+{
+    if (!recording() || watched != m_window)
+        return false;
+
+    Entry entry;
+    entry.type = int(event->type());
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove: {
+        const auto *mouse = static_cast<QMouseEvent *>(event);
+        entry.kind = Kind::Mouse;
+        entry.position = mouse->position();
+        entry.button = int(mouse->button());
+        entry.buttons = int(mouse->buttons());
+        entry.modifiers = int(mouse->modifiers());
+        break;
+    }
+    case QEvent::Wheel: {
+        const auto *wheel = static_cast<QWheelEvent *>(event);
+        entry.kind = Kind::Wheel;
+        entry.position = wheel->position();
+        entry.angleDelta = wheel->angleDelta();
+        entry.buttons = int(wheel->buttons());
+        entry.modifiers = int(wheel->modifiers());
+        break;
+    }
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease: {
+        const auto *key = static_cast<QKeyEvent *>(event);
+        entry.kind = Kind::Key;
+        entry.key = key->key();
+        entry.modifiers = int(key->modifiers());
+        entry.autoRepeat = key->isAutoRepeat();
+        entry.text = key->text();
+        break;
+    }
+    case QEvent::Resize:
+        entry.kind = Kind::Resize;
+        entry.position = QPointF(m_window->width(), m_window->height());
+        break;
+    default:
+        return false;
+    }
+    write(entry);
+    return false;
+}
+
+void InputRecorder::write(const Entry &entry)
+{
+    m_out << qint64(m_clock.nsecsElapsed() / 1000) << quint8(entry.kind);
+    switch (entry.kind) {
+    case Kind::Resize:
+        m_out << entry.position;
+        break;
+    case Kind::Mouse:
+        m_out << qint32(entry.type) << entry.position << qint32(entry.button) << qint32(entry.buttons)
+              << qint32(entry.modifiers);
+        break;
+    case Kind::Wheel:
+        m_out << entry.position << entry.angleDelta << qint32(entry.buttons) << qint32(entry.modifiers);
+        break;
+    case Kind::Key:
+        m_out << qint32(entry.type) << qint32(entry.key) << qint32(entry.modifiers) << entry.autoRepeat
+              << entry.text;
+        break;
+    case Kind::Marker:
+        m_out << entry.text;
+        break;
+    case Kind::Telemetry:
+        m_out << qint32(entry.systemId) << quint8(entry.field) << entry.value << qint64(entry.sampleTimeMs)
+              << qint64(entry.sampleAgeUs) << qint32(entry.sampleUncertaintyUs);
+        break;
+    }
+}
+
+bool InputRecorder::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("InputRecorder: cannot read %s: %s", qPrintable(path), qPrintable(file.errorString()));
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(streamVersion);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != fileMagic || version < 1 || version > fileVersion) {
+        qWarning("InputRecorder: %s is not an input recording", qPrintable(path));
+        return false;
+    }
+
+    QList<Entry> entries;
+    while (!in.atEnd()) {
+        Entry entry;
+        quint8 kind = 0;
+        in >> entry.timeUs >> kind;
+        entry.kind = Kind(kind);
+        qint32 type = 0, button = 0, buttons = 0, modifiers = 0, key = 0, systemId = 0;
+        quint8 field = 0;
+        switch (entry.kind) {
+        case Kind::Resize:
+            in >> entry.position;
+            break;
+        case Kind::Mouse:
+            in >> type >> entry.position >> button >> buttons >> modifiers;
+            break;
+        case Kind::Wheel:
+            in >> entry.position >> entry.angleDelta >> buttons >> modifiers;
+            break;
+        case Kind::Key:
+            in >> type >> key >> modifiers >> entry.autoRepeat >> entry.text;
+            break;
+        case Kind::Marker:
+            in >> entry.text;
+            break;
+        case Kind::Telemetry:
+            in >> systemId >> field >> entry.value >> entry.sampleTimeMs;
+            // Version 1 has no sample times; those replay as just arrived.
+            if (version >= 2)
+                in >> entry.sampleAgeUs >> entry.sampleUncertaintyUs;
+            break;
+        default:
+            in.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        if (in.status() != QDataStream::Ok) {
+            // A recording cut short by a crash still replays up to the tear.
+            qWarning("InputRecorder: %s is truncated after %lld events", qPrintable(path),
+                     qlonglong(entries.size()));
+            break;
+        }
+        entry.type = type;
+        entry.button = button;
+        entry.buttons = buttons;
+        entry.modifiers = modifiers;
+        entry.key = key;
+        entry.systemId = systemId;
+        entry.field = field;
+        entries.append(entry);
+    }
+    m_replay = std::move(entries);
+    return true;
+}
+
+bool InputRecorder::replay(const QString &path)
+{
+    if (recording() || replaying() || !m_window)
+        return false;
+    QString file = path.isEmpty() ? m_lastRecording : path;
+    if (file.startsWith(QLatin1String("file:")))
+        file = QUrl(file).toLocalFile();
+    if (file.isEmpty() || !load(file) || m_replay.isEmpty()) {
+        m_replay.clear();
+        return false;
+    }
+
+    m_next = 0;
+    m_clock.start();
+    emit stateChanged();
+    dispatchDue();
+    return true;
+}
+
+void InputRecorder::stopReplay()
+{
+    if (!replaying())
+        return;
+    m_replayTimer.stop();
+    m_replay.clear();
+    m_next = 0;
+    emit stateChanged();
+    emit replayFinished();
+}
+
+void InputRecorder::dispatchDue()
+{
+    // Input and telemetry share one clock, so their relative order is the
+    // recorded order even when the event loop falls behind.
+    const qint64 elapsedUs = m_clock.nsecsElapsed() / 1000;
+    while (m_next < m_replay.size() && m_replay.at(m_next).timeUs <= elapsedUs) {
+        const Entry entry = m_replay.at(m_next++);
+        dispatch(entry);
+        if (!replaying()) // stopped from a handler
+            return;
+    }
+
+    if (m_next >= m_replay.size()) {
+        stopReplay();
+        return;
+    }
+    const qint64 waitUs = m_replay.at(m_next).timeUs - elapsedUs;
+    m_replayTimer.start(int((waitUs + 999) / 1000));
+}
+
+void InputRecorder::dispatch(const Entry &entry)
+{
+    if (entry.kind == Kind::Telemetry) {
+        if (m_store)
+            m_store->update(entry.systemId, VehicleField(entry.field), entry.value, entry.sampleTimeMs,
+                            {steadyNowUs() - entry.sampleAgeUs, entry.sampleUncertaintyUs});
+        return;
+    }
+    if (entry.kind == Kind::Marker || !m_window)
+        return;
+
+    const auto modifiers = Qt::KeyboardModifiers(entry.modifiers);
+    switch (entry.kind) {
+    case Kind::Resize:
+        m_window->resize(qRound(entry.position.x()), qRound(entry.position.y()));
+        break;
+    case Kind::Mouse: {
+        QMouseEvent mouse(QEvent::Type(entry.type), entry.position, m_window->mapToGlobal(entry.position),
+                          Qt::MouseButton(entry.button), Qt::MouseButtons(entry.buttons), modifiers);
+        QCoreApplication::sendEvent(m_window, &mouse);
+        break;
+    }
+    case Kind::Wheel: {
+        QWheelEvent wheel(entry.position, m_window->mapToGlobal(entry.position), QPoint(), entry.angleDelta,
+                          Qt::MouseButtons(entry.buttons), modifiers, Qt::NoScrollPhase, false);
+        QCoreApplication::sendEvent(m_window, &wheel);
+        break;
+    }
+    case Kind::Key: {
+        QKeyEvent key(QEvent::Type(entry.type), entry.key, modifiers, entry.text, entry.autoRepeat);
+        QCoreApplication::sendEvent(m_window, &key);
+        break;
+    }
+    default:
+        break;
+    }
+}
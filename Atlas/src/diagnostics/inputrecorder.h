@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QPointF>
+#include <QPointer>
+#include <QTimer>
+
+#include "state/vehiclestatestore.h"
+
+class QQuickWindow;
+
+// Records operator input (mouse, wheel, keys, page switches) together with
+// the telemetry applied to the VehicleStateStore on one timeline, and
+// replays both against the window so a field-reported stutter can be
+// reproduced on a developer machine with a profiler attached.
+class InputRecorder : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool recording READ recording NOTIFY stateChanged)
+    Q_PROPERTY(bool replaying READ replaying NOTIFY stateChanged)
+    Q_PROPERTY(QString lastRecording READ lastRecording NOTIFY stateChanged)
+
+public:
+    InputRecorder(VehicleStateStore *store, const QString &directory, QObject *parent = nullptr);
+    ~InputRecorder() override;
+
+    void setWindow(QQuickWindow *window);
+
+    bool recording() const { return m_file.isOpen(); }
+    bool replaying() const { return !m_replay.isEmpty(); }
+    QString lastRecording() const { return m_lastRecording; }
+
+    Q_INVOKABLE bool startRecording();
+    Q_INVOKABLE void stopRecording();
+    Q_INVOKABLE void toggleRecording();
+    // Empty path replays lastRecording.
+    Q_INVOKABLE bool replay(const QString &path = QString());
+    Q_INVOKABLE void stopReplay();
+    // Semantic events that are not raw input, e.g. mark("page", "Roster").
+    Q_INVOKABLE void mark(const QString &kind, const QString &value);
+
+signals:
+    void stateChanged();
+    void replayFinished();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    enum class Kind : quint8 { Resize = 1, Mouse, Wheel, Key, Marker, Telemetry };
+
+    struct Entry
+    {
+        qint64 timeUs = 0;
+        Kind kind = Kind::Marker;
+        int type = 0; // QEvent::Type for input
+        QPointF position;
+        QPoint angleDelta;
+        int button = 0;
+        int buttons = 0;
+        int modifiers = 0;
+        int key = 0;
+        bool autoRepeat = false;
+        QString text; // key text, or "kind:value" for markers
+        int systemId = 0;
+        int field = 0;
+        double value = 0;
+        qint64 sampleTimeMs = 0;
+        // SampleTime, with the monotonic time kept relative to when the
+        // sample was recorded so it lands as far in the past on replay.
+        qint64 sampleAgeUs = 0;
+        qint32 sampleUncertaintyUs = -1;
+    };
+
+    void write(const Entry &entry);
+    bool load(const QString &path);
+    void dispatchDue();
+    void dispatch(const Entry &entry);
+
+    VehicleStateStore *m_store;
+    int m_sampleTap = 0; // while recording
+    QString m_directory;
+    QPointer<QQuickWindow> m_window;
+    QString m_lastRecording;
+
+    QFile m_file;
+    QDataStream m_out;
+    QElapsedTimer m_clock;
+
+    QList<Entry> m_replay;
+    qsizetype m_next = 0;
+    QTimer m_replayTimer;
+};
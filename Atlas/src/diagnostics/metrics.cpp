@@ -0,0 +1,191 @@
+#include "metrics.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <memory>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+enum class Kind { Counter, Gauge, Histogram };
+
+struct Series
+{
+    QByteArray labels;
+    std::unique_ptr<MetricCounter> counter;
+    std::unique_ptr<MetricGauge> gauge;
+    std::unique_ptr<MetricHistogram> histogram;
+};
+
+struct Family
+{
+    QByteArray name;
+    QByteArray help;
+    Kind kind;
+    std::vector<Series> series; // instruments are heap-allocated, so growth never moves them
+};
+
+struct Registry
+{
+    QMutex mutex;
+    std::vector<Family> families;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+Series &findOrAddSeries(Registry &r, const QByteArray &name, const QByteArray &help, Kind kind,
+                        const QByteArray &labels)
+{
+    auto family = std::find_if(r.families.begin(), r.families.end(),
+                               [&name](const Family &f) { return f.name == name; });
+    if (family == r.families.end()) {
+        r.families.push_back({name, help, kind, {}});
+        family = r.families.end() - 1;
+    }
+    Q_ASSERT(family->kind == kind);
+
+    auto series = std::find_if(family->series.begin(), family->series.end(),
+                               [&labels](const Series &s) { return s.labels == labels; });
+    if (series == family->series.end()) {
+        family->series.push_back({labels, nullptr, nullptr, nullptr});
+        series = family->series.end() - 1;
+    }
+    return *series;
+}
+
+QByteArray seriesName(const QByteArray &name, const QByteArray &labels, const QByteArray &extraLabel = {})
+{
+    QByteArray all = labels;
+    if (!extraLabel.isEmpty())
+        all += (all.isEmpty() ? "" : ",") + extraLabel;
+    return all.isEmpty() ? name : name + '{' + all + '}';
+}
+
+QByteArray number(double value)
+{
+    return QByteArray::number(value, 'g', 12);
+}
+
+void collectProcessMetrics()
+{
+#if defined(Q_OS_LINUX)
+    static MetricGauge *const resident = Metrics::gauge("process_resident_memory_bytes",
+                                                        "Resident memory size in bytes.");
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1)
+            resident->set(fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE));
+    }
+#endif
+}
+
+} // namespace
+
+MetricHistogram::MetricHistogram(std::vector<double> upperBounds)
+    : m_bounds(std::move(upperBounds))
+    , m_buckets(m_bounds.size() + 1)
+{
+    std::sort(m_bounds.begin(), m_bounds.end());
+}
+
+void MetricHistogram::observe(double value)
+{
+    const size_t bucket = size_t(std::lower_bound(m_bounds.begin(), m_bounds.end(), value) - m_bounds.begin());
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    double sum = m_sum.load(std::memory_order_relaxed);
+    while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+        ;
+}
+
+namespace Metrics {
+
+MetricCounter *counter(const QByteArray &name, const QByteArray &help, const QByteArray &labels)
+{
+    Registry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    Series &series = findOrAddSeries(r, name, help, Kind::Counter, labels);
+    if (!series.counter)
+        series.counter = std::make_unique<MetricCounter>();
+    return series.counter.get();
+}
+
+MetricGauge *gauge(const QByteArray &name, const QByteArray &help, const QByteArray &labels)
+{
+    Registry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    Series &series = findOrAddSeries(r, name, help, Kind::Gauge, labels);
+    if (!series.gauge)
+        series.gauge = std::make_unique<MetricGauge>();
+    return series.gauge.get();
+}
+
+MetricHistogram *histogram(const QByteArray &name, const QByteArray &help,
+                           const std::vector<double> &upperBounds, const QByteArray &labels)
+{
+    Registry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    Series &series = findOrAddSeries(r, name, help, Kind::Histogram, labels);
+    if (!series.histogram)
+        series.histogram = std::make_unique<MetricHistogram>(upperBounds);
+    return series.histogram.get();
+}
+
+QByteArray exposition()
+{
+    Registry &r = registry();
+
+    collectProcessMetrics();
+
+    QByteArray out;
+    QMutexLocker locker(&r.mutex);
+    for (const Family &family : r.families) {
+        static const char *const typeNames[] = {"counter", "gauge", "histogram"};
+        out += "# HELP " + family.name + ' ' + family.help + '\n';
+        out += "# TYPE " + family.name + ' ' + typeNames[int(family.kind)] + '\n';
+
+        for (const Series &series : family.series) {
+            switch (family.kind) {
+            case Kind::Counter:
+                out += seriesName(family.name, series.labels) + ' '
+                       + QByteArray::number(series.counter->value()) + '\n';
+                break;
+            case Kind::Gauge:
+                out += seriesName(family.name, series.labels) + ' '
+                       + QByteArray::number(series.gauge->value()) + '\n';
+                break;
+            case Kind::Histogram: {
+                const MetricHistogram &h = *series.histogram;
+                const QByteArray bucketName = family.name + "_bucket";
+                quint64 cumulative = 0;
+                for (size_t i = 0; i < h.upperBounds().size(); ++i) {
+                    cumulative += h.bucketCount(i);
+                    out += seriesName(bucketName, series.labels, "le=\"" + number(h.upperBounds()[i]) + '"')
+                           + ' ' + QByteArray::number(cumulative) + '\n';
+                }
+                cumulative += h.bucketCount(h.upperBounds().size());
+                out += seriesName(bucketName, series.labels, "le=\"+Inf\"") + ' '
+                       + QByteArray::number(cumulative) + '\n';
+                out += seriesName(family.name + "_sum", series.labels) + ' ' + number(h.sum()) + '\n';
+                out += seriesName(family.name + "_count", series.labels) + ' '
+                       + QByteArray::number(h.count()) + '\n';
+                break;
+            }
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace Metrics
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QByteArray>
+
+#include <atomic>
+#include <vector>
+
+// Process-wide metrics in Prometheus terms. Instruments are registered once
+// (under a mutex) and then updated with relaxed atomics only, so hot paths
+// never lock and a scrape only reads a snapshot of the atomics.
+class MetricCounter
+{
+public:
+    void increment(quint64 amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+class MetricGauge
+{
+public:
+    void set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(qint64 amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_value{0};
+};
+
+// Fixed upper bounds chosen at registration; observe() is a binary search
+// and two relaxed increments.
+class MetricHistogram
+{
+public:
+    explicit MetricHistogram(std::vector<double> upperBounds);
+
+    void observe(double value);
+
+    const std::vector<double> &upperBounds() const { return m_bounds; }
+    quint64 bucketCount(size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    double sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<double> m_bounds;
+    std::vector<std::atomic<quint64>> m_buckets; // non-cumulative, last is +Inf
+    std::atomic<quint64> m_count{0};
+    std::atomic<double> m_sum{0};
+};
+
+namespace Metrics {
+
+// labels is the inside of a Prometheus label set, e.g. R"(link="udp0")".
+// Registering the same name and labels twice returns the same instrument.
+MetricCounter *counter(const QByteArray &name, const QByteArray &help, const QByteArray &labels = {});
+MetricGauge *gauge(const QByteArray &name, const QByteArray &help, const QByteArray &labels = {});
+MetricHistogram *histogram(const QByteArray &name, const QByteArray &help,
+                           const std::vector<double> &upperBounds, const QByteArray &labels = {});
+
+// Prometheus text exposition format 0.0.4.
+QByteArray exposition();
+
+} // namespace Metrics
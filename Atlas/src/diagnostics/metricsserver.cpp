@@ -0,0 +1,79 @@
+#include "metricsserver.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "diagnostics/metrics.h"
+
+namespace {
+
+constexpr qint64 maxRequestSize = 8 * 1024;
+
+QByteArray response(const QByteArray &status, const QByteArray &contentType, const QByteArray &body)
+{
+    return "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType
+           + "\r\nContent-Length: " + QByteArray::number(body.size())
+           + "\r\nConnection: close\r\n\r\n" + body;
+}
+
+void serve(QTcpSocket *socket)
+{
+    QByteArray request;
+    QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, request]() mutable {
+        request += socket->readAll();
+        if (!request.contains("\r\n\r\n")) {
+            if (request.size() > maxRequestSize)
+                socket->abort();
+            return;
+        }
+
+        const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+        const QByteArray path = requestLine.value(1).split('?').value(0);
+        if (requestLine.value(0) != "GET") {
+            socket->write(response("405 Method Not Allowed", "text/plain", "GET only\n"));
+        } else if (path == "/metrics") {
+            socket->write(response("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                   Metrics::exposition()));
+        } else {
+            socket->write(response("404 Not Found", "text/plain", "Try /metrics\n"));
+        }
+        socket->disconnectFromHost();
+    });
+    QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent)
+    , m_context(new QObject)
+{
+    m_thread.setObjectName(QStringLiteral("AtlasMetrics"));
+    m_context->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread.start();
+}
+
+MetricsServer::~MetricsServer()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void MetricsServer::listen(quint16 port, const QHostAddress &address)
+{
+    QMetaObject::invokeMethod(m_context, [this, port, address] {
+        delete m_server;
+        m_server = nullptr;
+        if (port == 0)
+            return;
+
+        m_server = new QTcpServer(m_context);
+        QObject::connect(m_server, &QTcpServer::newConnection, m_server, [server = m_server] {
+            while (QTcpSocket *socket = server->nextPendingConnection())
+                serve(socket);
+        });
+        if (!m_server->listen(address, port))
+            emit listenFailed(m_server->errorString());
+    }, Qt::QueuedConnection);
+}
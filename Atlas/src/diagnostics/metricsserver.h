@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QHostAddress>
+#include <QObject>
+#include <QThread>
+
+class QTcpServer;
+
+// Serves Metrics::exposition() at http://<address>:<port>/metrics for the
+// NOC's Prometheus. Sockets live on their own thread, so a slow or hung
+// scraper never touches the GUI or ingest threads.
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(QObject *parent = nullptr);
+    ~MetricsServer() override;
+
+    // Port 0 stops listening. Binds to localhost unless told otherwise.
+    void listen(quint16 port, const QHostAddress &address = QHostAddress::LocalHost);
+
+signals:
+    void listenFailed(const QString &error);
+
+private:
+    QThread m_thread;
+    QObject *m_context; // lives on m_thread
+    QTcpServer *m_server = nullptr;
+};
@@ -0,0 +1,214 @@
+#include "startupprofiler.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QQuickWindow>
+#include <QSaveFile>
+#include <QThread>
+
+#include <memory>
+
+#if defined(Q_OS_LINUX)
+#include <time.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace {
+
+// How long the process has existed, in µs. Linux reads the start time from
+// /proc (clock-tick resolution); other platforms fall back to 0, making
+// the first profiler call the origin.
+qint64 processAgeUs()
+{
+#if defined(Q_OS_LINUX)
+    QFile stat(QStringLiteral("/proc/self/stat"));
+    if (!stat.open(QIODevice::ReadOnly))
+        return 0;
+    const QByteArray line = stat.readAll();
+    // Field 22 (starttime); comm (field 2) may contain spaces, so count
+    // from the closing parenthesis.
+    const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 20)
+        return 0;
+    const double startSeconds = fields.at(19).toDouble() / double(sysconf(_SC_CLK_TCK));
+    timespec boot;
+    clock_gettime(CLOCK_BOOTTIME, &boot);
+    const double nowSeconds = double(boot.tv_sec) + double(boot.tv_nsec) / 1e9;
+    return qMax<qint64>(0, qint64((nowSeconds - startSeconds) * 1e6));
+#elif defined(Q_OS_WIN)
+    FILETIME creation, exitTime, kernel, user, now;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user))
+        return 0;
+    GetSystemTimePreciseAsFileTime(&now);
+    const auto ticks = [](const FILETIME &time) {
+        return (quint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return qint64(ticks(now) - ticks(creation)) / 10; // 100 ns units
+#else
+    return 0;
+#endif
+}
+
+quint64 currentThreadKey()
+{
+    return quint64(quintptr(QThread::currentThreadId()));
+}
+
+} // namespace
+
+StartupProfiler *StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return &profiler;
+}
+
+StartupProfiler::StartupProfiler()
+    : m_processAgeAtStart(processAgeUs())
+{
+    m_clock.start();
+    // Everything before the profiler existed is the loader and static
+    // initialisation.
+    m_events.append({QStringLiteral("Process start"), 'X', 0, m_processAgeAtStart, currentThreadKey()});
+}
+
+qint64 StartupProfiler::now() const
+{
+    return m_processAgeAtStart + m_clock.nsecsElapsed() / 1000;
+}
+
+void StartupProfiler::record(const Event &event)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_finished)
+        return;
+    if (!m_threadNames.contains(event.thread)) {
+        QThread *thread = QThread::currentThread();
+        QString name = thread->objectName();
+        if (name.isEmpty())
+            name = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()
+                       ? QStringLiteral("GUI")
+                       : QStringLiteral("Thread %1").arg(m_threadNames.size());
+        m_threadNames.insert(event.thread, name);
+    }
+    m_events.append(event);
+}
+
+void StartupProfiler::begin(const QString &name)
+{
+    const qint64 timestamp = now();
+    QMutexLocker locker(&m_mutex);
+    m_open.insert({currentThreadKey(), name}, timestamp);
+}
+
+void StartupProfiler::end(const QString &name)
+{
+    const qint64 timestamp = now();
+    qint64 start = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto it = m_open.find({currentThreadKey(), name});
+        if (it == m_open.end())
+            return;
+        start = it.value();
+        m_open.erase(it);
+    }
+    complete(name, start, timestamp);
+}
+
+void StartupProfiler::instant(const QString &name)
+{
+    record({name, 'i', now(), 0, currentThreadKey()});
+}
+
+void StartupProfiler::complete(const QString &name, qint64 startUs, qint64 endUs)
+{
+    record({name, 'X', startUs, endUs - startUs, currentThreadKey()});
+}
+
+void StartupProfiler::finishOnFirstFrame(QQuickWindow *window, const QString &path)
+{
+    const qint64 start = now();
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection = connect(window, &QQuickWindow::frameSwapped, this, [this, start, path, connection] {
+        disconnect(*connection);
+        complete(QStringLiteral("First frame"), start, now());
+        if (!writeTrace(path))
+            qWarning("Could not write startup trace to %s", qPrintable(path));
+        QMutexLocker locker(&m_mutex);
+        m_finished = true; // later Loader/QML activity is not startup
+        m_open.clear();
+    });
+}
+
+bool StartupProfiler::writeTrace(const QString &path) const
+{
+    QJsonArray events;
+    {
+        QMutexLocker locker(&m_mutex);
+        QHash<quint64, int> threadIds;
+        const auto threadId = [&threadIds](quint64 key) {
+            return threadIds.contains(key) ? threadIds.value(key)
+                                           : threadIds.insert(key, threadIds.size() + 1).value();
+        };
+
+        const qint64 pid = QCoreApplication::applicationPid();
+        for (auto it = m_threadNames.cbegin(); it != m_threadNames.cend(); ++it) {
+            events.append(QJsonObject{
+                {QStringLiteral("name"), QStringLiteral("thread_name")},
+                {QStringLiteral("ph"), QStringLiteral("M")},
+                {QStringLiteral("pid"), pid},
+                {QStringLiteral("tid"), threadId(it.key())},
+                {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), it.value()}}},
+            });
+        }
+        for (const Event &event : m_events) {
+            QJsonObject object{
+                {QStringLiteral("name"), event.name},
+                {QStringLiteral("cat"), QStringLiteral("startup")},
+                {QStringLiteral("ph"), QString(QLatin1Char(event.phase))},
+                {QStringLiteral("ts"), event.timestamp},
+                {QStringLiteral("pid"), pid},
+                {QStringLiteral("tid"), threadId(event.thread)},
+            };
+            if (event.phase == 'X')
+                object.insert(QStringLiteral("dur"), event.duration);
+            else
+                object.insert(QStringLiteral("s"), QStringLiteral("t"));
+            events.append(object);
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    const QJsonObject trace{
+        {QStringLiteral("traceEvents"), events},
+        {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")},
+    };
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+QUrl StartupUrlInterceptor::intercept(const QUrl &url, DataType type)
+{
+    switch (type) {
+    case QmldirFile:
+        StartupProfiler::instance()->instant(
+            QStringLiteral("Import %1").arg(QFileInfo(url.path()).dir().dirName()));
+        break;
+    case QmlFile:
+        StartupProfiler::instance()->instant(QStringLiteral("Load %1").arg(url.fileName()));
+        break;
+    default:
+        break;
+    }
+    return url;
+}
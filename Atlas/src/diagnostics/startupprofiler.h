@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QQmlAbstractUrlInterceptor>
+#include <QString>
+
+class QQuickWindow;
+
+// Records startup phases and writes them as a Chrome trace
+// (chrome://tracing, ui.perfetto.dev). Timestamps are microseconds since the
+// process was created, so the gap before main() shows up as well. Safe to
+// call from any thread; exposed to QML as StartupTrace.
+class StartupProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StartupProfiler *instance();
+
+    qint64 now() const; // µs since process start
+
+    Q_INVOKABLE void begin(const QString &name);
+    Q_INVOKABLE void end(const QString &name);
+    Q_INVOKABLE void instant(const QString &name);
+    void complete(const QString &name, qint64 startUs, qint64 endUs);
+
+    // Closes the "First frame" phase on the window's first frameSwapped(),
+    // writes the trace to path and stops recording.
+    void finishOnFirstFrame(QQuickWindow *window, const QString &path);
+    bool writeTrace(const QString &path) const;
+
+    class Scope
+    {
+    public:
+        explicit Scope(const QString &name)
+            : m_name(name)
+            , m_start(StartupProfiler::instance()->now())
+        {
+        }
+        ~Scope() { StartupProfiler::instance()->complete(m_name, m_start, StartupProfiler::instance()->now()); }
+        Q_DISABLE_COPY(Scope)
+
+    private:
+        QString m_name;
+        qint64 m_start;
+    };
+
+private:
+    StartupProfiler();
+
+    struct Event
+    {
+        QString name;
+        char phase; // 'X' complete, 'i' instant
+        qint64 timestamp;
+        qint64 duration;
+        quint64 thread;
+    };
+
+    void record(const Event &event);
+
+    QElapsedTimer m_clock;
+    qint64 m_processAgeAtStart = 0;
+    mutable QMutex m_mutex;
+    QList<Event> m_events;
+    QHash<QPair<quint64, QString>, qint64> m_open; // (thread, name) -> begin
+    QHash<quint64, QString> m_threadNames;
+    bool m_finished = false;
+};
+
+// Adds an instant per qmldir and QML file the engine resolves, which is
+// where module imports (Atlas, QtQuick.Studio.*) and compilation show up.
+class StartupUrlInterceptor : public QQmlAbstractUrlInterceptor
+{
+public:
+    QUrl intercept(const QUrl &url, DataType type) override;
+};
@@ -0,0 +1,96 @@
+#include "triangulation.h"
+
+namespace {
+
+double cross(const QPointF &a, const QPointF &b, const QPointF &c)
+{
+    return (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+}
+
+// Inside a counter-clockwise triangle or on its edge: a vertex on the
+// diagonal a-c means clipping the ear would cut the outline.
+bool insideTriangle(const QPointF &p, const QPointF &a, const QPointF &b, const QPointF &c)
+{
+    return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+}
+
+} // namespace
+
+double signedArea2(const std::vector<QPointF> &ring)
+{
+    double area = 0;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+        area += (ring[j].x() - ring[i].x()) * (ring[j].y() + ring[i].y());
+    return area;
+}
+
+std::vector<uint32_t> triangulatePolygon(const std::vector<QPointF> &ring)
+{
+    std::vector<uint32_t> triangles;
+    if (ring.size() < 3)
+        return triangles;
+
+    // A doubly linked list of the remaining vertices, walked counter-clockwise.
+    const size_t n = ring.size();
+    std::vector<uint32_t> next(n), prev(n);
+    const bool counterClockwise = signedArea2(ring) > 0;
+    for (size_t i = 0; i < n; ++i) {
+        next[i] = counterClockwise ? uint32_t((i + 1) % n) : uint32_t((i + n - 1) % n);
+        prev[i] = counterClockwise ? uint32_t((i + n - 1) % n) : uint32_t((i + 1) % n);
+    }
+
+    // Unlink repeated and collinear vertices first: they only make
+    // zero-area triangles, and on an ear's edge they would block it.
+    size_t remaining = n;
+    uint32_t ear = 0;
+    for (size_t unchanged = 0; remaining >= 3 && unchanged < remaining;) {
+        const uint32_t before = prev[ear], after = next[ear];
+        if (ring[ear] == ring[after] || cross(ring[before], ring[ear], ring[after]) == 0) {
+            next[before] = after;
+            prev[after] = before;
+            --remaining;
+            ear = before; // its own neighbours just changed
+            unchanged = 0;
+        } else {
+            ear = after;
+            ++unchanged;
+        }
+    }
+    if (remaining < 3)
+        return triangles;
+
+    triangles.reserve((remaining - 2) * 3);
+    size_t sinceLastEar = 0;
+    while (remaining > 3) {
+        const uint32_t a = prev[ear], b = ear, c = next[ear];
+        bool isEar = cross(ring[a], ring[b], ring[c]) > 0;
+        // No other remaining vertex may sit inside the candidate ear. One
+        // at the same place as a corner is where the outline touches
+        // itself, not an obstruction.
+        for (uint32_t p = next[c]; isEar && p != a; p = next[p]) {
+            if (ring[p] == ring[a] || ring[p] == ring[b] || ring[p] == ring[c])
+                continue;
+            if (insideTriangle(ring[p], ring[a], ring[b], ring[c]))
+                isEar = false;
+        }
+        if (isEar) {
+            triangles.insert(triangles.end(), {a, b, c});
+            next[a] = c;
+            prev[c] = a;
+            --remaining;
+            ear = c;
+            sinceLastEar = 0;
+            continue;
+        }
+        ear = c;
+        // A full lap without an ear: collinear runs or bad input. Clip
+        // what is left as a fan rather than loop forever.
+        if (++sinceLastEar > remaining) {
+            for (uint32_t p = next[ear]; next[p] != ear; p = next[p])
+                triangles.insert(triangles.end(), {ear, p, next[p]});
+            return triangles;
+        }
+    }
+    triangles.insert(triangles.end(), {prev[ear], ear, next[ear]});
+    return triangles;
+}
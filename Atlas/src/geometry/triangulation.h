@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QPointF>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Ear-clipping triangulation of a simple polygon (no holes, no
+// self-intersections), either winding. Returns vertex indices, three per
+// triangle, counter-clockwise; repeated and collinear vertices are left
+// out, and degenerate input gives none. O(n²) in the worst case, which
+// stays cheap for the tens of vertices an operation volume has.
+std::vector<uint32_t> triangulatePolygon(const std::vector<QPointF> &ring);
+
+// Twice the signed area; positive for a counter-clockwise ring.
+double signedArea2(const std::vector<QPointF> &ring);
@@ -0,0 +1,72 @@
+#pragma once
+
+/* Decoder plugin ABI for atlasd. Plain C, so a plugin can be built with any
+ * compiler and without Qt or Atlas sources: include this header, export
+ * atlas_decoder() and drop the shared library into the decoders directory
+ * of the Atlas install.
+ *
+ * A plugin turns the datagrams of one or more links (linkDecoders setting)
+ * into vehicle field samples. The bytes it is given are borrowed straight
+ * from the receive buffers and the samples it publishes go straight into
+ * the traffic snapshot; neither side allocates or copies on the way.
+ * Everything is called on the daemon's event loop thread. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ATLAS_DECODER_ABI_VERSION 1u
+
+#if defined(_WIN32)
+#define ATLAS_DECODER_EXPORT __declspec(dllexport)
+#else
+#define ATLAS_DECODER_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef struct AtlasSample
+{
+    int32_t field; /* from AtlasHost.field_id */
+    double value;  /* in the field's Atlas units (degrees, metres, percent) */
+} AtlasSample;
+
+/* What atlasd offers a plugin. Valid until close(). */
+typedef struct AtlasHost
+{
+    uint32_t abi_version;
+    void *context;
+    /* Id of a vehicle field by its Atlas name ("latitude",
+     * "batteryRemaining", ...), or -1. The link fields are the daemon's own
+     * and not offered. Look ids up in open(); they are fixed for the run. */
+    int32_t (*field_id)(void *context, const char *name);
+    /* Samples one vehicle took together, from inside decode() only; system
+     * ids share the MAVLink id space. vehicle_time_us is the vehicle's own
+     * clock when it took them, or -1 to stamp them with the datagram's
+     * arrival. Returns 0 if they were refused: a system id outside 1..255,
+     * unknown field ids, NaN or infinite values, or no snapshot room for
+     * another vehicle. */
+    int (*publish)(void *context, int32_t system_id, const AtlasSample *samples, size_t count,
+                   int64_t vehicle_time_us);
+    /* A line for the daemon's log. */
+    void (*log)(void *context, const char *message);
+} AtlasHost;
+
+typedef struct AtlasDecoder
+{
+    uint32_t abi_version; /* ATLAS_DECODER_ABI_VERSION */
+    const char *name;     /* what linkDecoders refers to */
+    /* One instance per link. Null refuses the link. */
+    void *(*open)(const AtlasHost *host, const char *link_name);
+    void (*close)(void *decoder);
+    /* One datagram. data is only valid for the duration of the call. */
+    void (*decode)(void *decoder, const uint8_t *data, size_t size);
+} AtlasDecoder;
+
+/* The one symbol atlasd resolves. */
+ATLAS_DECODER_EXPORT const AtlasDecoder *atlas_decoder(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,126 @@
+#include "clocksync.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Drift wanders with temperature, a few hundredths of a ppm per second;
+// the offset itself only by scheduling noise.
+constexpr double driftNoise = 0.01;  // µs²/s³
+constexpr double offsetNoise = 10;   // µs²/s
+constexpr double initialDriftVariance = 100.0 * 100.0; // ±100 ppm crystal
+constexpr double clockResolutionVariance = 50.0 * 50.0; // µs²
+constexpr double rebootJumpUs = 1e6;
+constexpr double outlierSigmas = 5;
+constexpr int outliersBeforeReset = 5;
+
+// Where the reply really crossed is anywhere within half the round trip of
+// the midpoint; the variance of a uniform spread over that.
+double measurementVariance(qint64 roundTripUs)
+{
+    const double half = double(roundTripUs) / 2;
+    return half * half / 3 + clockResolutionVariance;
+}
+
+} // namespace
+
+void ClockSync::reset(Filter &filter, double offset, double variance, qint64 nowUs, qint64 roundTripUs)
+{
+    filter = Filter();
+    filter.offset = offset;
+    filter.p00 = variance;
+    filter.p11 = initialDriftVariance;
+    filter.referenceUs = nowUs;
+    filter.roundTripUs = roundTripUs;
+}
+
+void ClockSync::timesync(int systemId, qint64 sentUs, qint64 vehicleUs, qint64 nowUs)
+{
+    const qint64 roundTripUs = nowUs - sentUs;
+    if (roundTripUs < 0)
+        return;
+    const double measured = double(sentUs + roundTripUs / 2 - vehicleUs);
+    const double variance = measurementVariance(roundTripUs);
+
+    const auto found = m_filters.find(systemId);
+    if (found == m_filters.end()) {
+        reset(m_filters[systemId], measured, variance, nowUs, roundTripUs);
+        return;
+    }
+    Filter &filter = *found;
+
+    // Predict forward to now.
+    const double dt = double(nowUs - filter.referenceUs) / 1e6;
+    if (dt < 0)
+        return;
+    const double offset = filter.offset + filter.drift * dt;
+    const double p00 = filter.p00 + dt * (2 * filter.p01 + dt * filter.p11) + driftNoise * dt * dt * dt / 3
+                       + offsetNoise * dt;
+    const double p01 = filter.p01 + dt * filter.p11 + driftNoise * dt * dt / 2;
+    const double p11 = filter.p11 + driftNoise * dt;
+
+    const double innovation = measured - offset;
+    const double innovationVariance = p00 + variance;
+    if (std::abs(innovation) > rebootJumpUs) {
+        reset(filter, measured, variance, nowUs, roundTripUs);
+        return;
+    }
+    if (innovation * innovation > outlierSigmas * outlierSigmas * innovationVariance) {
+        // One late reply is noise; a run of them means the clock moved.
+        if (++filter.rejected >= outliersBeforeReset)
+            reset(filter, measured, variance, nowUs, roundTripUs);
+        return;
+    }
+
+    const double gainOffset = p00 / innovationVariance;
+    const double gainDrift = p01 / innovationVariance;
+    filter.offset = offset + gainOffset * innovation;
+    filter.drift += gainDrift * innovation;
+    filter.p00 = (1 - gainOffset) * p00;
+    filter.p01 = (1 - gainOffset) * p01;
+    filter.p11 = p11 - gainDrift * p01;
+    filter.referenceUs = nowUs;
+    filter.roundTripUs = roundTripUs;
+    filter.rejected = 0;
+}
+
+ClockSync::Estimate ClockSync::estimate(int systemId, qint64 nowUs) const
+{
+    Estimate estimate;
+    const auto found = m_filters.constFind(systemId);
+    if (found == m_filters.constEnd())
+        return estimate;
+    const Filter &filter = *found;
+    const double dt = double(nowUs - filter.referenceUs) / 1e6;
+    estimate.synchronized = true;
+    estimate.offsetUs = filter.offset + filter.drift * dt;
+    estimate.driftUsPerS = filter.drift;
+    estimate.uncertaintyUs = std::sqrt(filter.p00 + dt * (2 * filter.p01 + dt * filter.p11));
+    estimate.referenceUs = filter.referenceUs;
+    estimate.roundTripUs = filter.roundTripUs;
+    return estimate;
+}
+
+SampleTime ClockSync::sampleTime(int systemId, qint64 vehicleUs, qint64 arrivalUs) const
+{
+    const auto found = m_filters.constFind(systemId);
+    if (found == m_filters.constEnd())
+        return {arrivalUs, -1};
+    const Filter &filter = *found;
+    const double dt = double(vehicleUs + qint64(filter.offset) - filter.referenceUs) / 1e6;
+    const double gcsUs = double(vehicleUs) + filter.offset + filter.drift * dt;
+    const double variance = filter.p00 + dt * (2 * filter.p01 + dt * filter.p11);
+    // A sample cannot have been taken after it arrived.
+    const qint64 monotonicUs = std::min(qint64(std::llround(gcsUs)), arrivalUs);
+    return {monotonicUs, qint32(std::ceil(std::sqrt(std::max(variance, 0.0))))};
+}
+
+SampleTime ClockSync::arrivalTime(int systemId, qint64 arrivalUs) const
+{
+    const auto found = m_filters.constFind(systemId);
+    if (found == m_filters.constEnd())
+        return {arrivalUs, -1};
+    const qint64 oneWayUs = found->roundTripUs / 2;
+    return {arrivalUs - oneWayUs, qint32(oneWayUs)};
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QHash>
+
+#include "state/vehiclestate.h"
+
+// Puts each vehicle's boot-relative clock on the GCS monotonic clock.
+// Every TIMESYNC reply gives one offset measurement, the midpoint of the
+// round trip minus the vehicle's time, good to half the round trip. A
+// two-state Kalman filter per vehicle (offset, and drift in µs per second)
+// weighs each measurement by its round trip, so a reply that sat in a
+// radio queue barely moves the estimate, and tracks crystal drift between
+// replies. A jump of over a second is a reboot and restarts the filter.
+class ClockSync
+{
+public:
+    struct Estimate
+    {
+        bool synchronized = false;
+        double offsetUs = 0;      // GCS time - vehicle time, now
+        double driftUsPerS = 0;   // change of the offset per GCS second (ppm)
+        double uncertaintyUs = 0; // one sigma of the offset, now
+        qint64 referenceUs = 0;   // GCS time of the last accepted reply
+        qint64 roundTripUs = 0;   // of that reply
+    };
+
+    // A TIMESYNC reply: our send time echoed back, the vehicle's clock
+    // when it answered, and when the reply arrived, all in µs.
+    void timesync(int systemId, qint64 sentUs, qint64 vehicleUs, qint64 nowUs);
+
+    Estimate estimate(int systemId, qint64 nowUs) const;
+
+    // GCS time of a sample the vehicle stamped vehicleUs. Unsynchronized
+    // vehicles get arrivalUs and an unknown uncertainty.
+    SampleTime sampleTime(int systemId, qint64 vehicleUs, qint64 arrivalUs) const;
+    // For messages without a vehicle timestamp: arrival, less half the
+    // last round trip, give or take that half.
+    SampleTime arrivalTime(int systemId, qint64 arrivalUs) const;
+
+private:
+    struct Filter
+    {
+        double offset = 0; // µs
+        double drift = 0;  // µs per s
+        double p00 = 0, p01 = 0, p11 = 0;
+        qint64 referenceUs = 0;
+        qint64 roundTripUs = 0;
+        int rejected = 0; // outliers in a row
+    };
+
+    static void reset(Filter &filter, double offset, double variance, qint64 nowUs, qint64 roundTripUs);
+
+    QHash<int, Filter> m_filters;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QDataStream>
+#include <QString>
+
+// Local socket between UI processes and the daemon for everything that
+// flows toward the vehicles. Messages are a type byte followed by the
+// fields below, in QDataStream format; readers use stream transactions so
+// partial messages simply wait for more bytes.
+namespace CommandChannel {
+
+inline QString serverName() { return QStringLiteral("atlas-command"); }
+
+constexpr QDataStream::Version streamVersion = QDataStream::Qt_6_5;
+
+enum class MessageType : quint8 {
+    // UI -> daemon: qint32 systemId, qint32 componentId, quint16 command, float params[7]
+    CommandLong = 1,
+    // daemon -> UI: qint32 systemId, quint16 command, quint8 result
+    CommandAck = 2,
+};
+
+} // namespace CommandChannel
@@ -0,0 +1,63 @@
+#include "commandclient.h"
+
+#include <QDataStream>
+
+#include "ingest/commandchannel.h"
+
+namespace {
+
+constexpr int reconnectIntervalMs = 500;
+
+} // namespace
+
+CommandClient::CommandClient(QObject *parent)
+    : QObject(parent)
+{
+    m_reconnectTimer.setSingleShot(true);
+    m_reconnectTimer.setInterval(reconnectIntervalMs);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &CommandClient::connectToDaemon);
+    connect(&m_socket, &QLocalSocket::readyRead, this, &CommandClient::readMessages);
+    connect(&m_socket, &QLocalSocket::stateChanged, this, [this](QLocalSocket::LocalSocketState state) {
+        if (state == QLocalSocket::ConnectedState || state == QLocalSocket::UnconnectedState)
+            emit connectedChanged();
+        if (state == QLocalSocket::UnconnectedState)
+            m_reconnectTimer.start();
+    });
+}
+
+void CommandClient::connectToDaemon()
+{
+    if (m_socket.state() == QLocalSocket::UnconnectedState)
+        m_socket.connectToServer(CommandChannel::serverName());
+}
+
+bool CommandClient::sendCommandLong(int systemId, int componentId, int command, const QVariantList &params)
+{
+    if (!connected())
+        return false;
+    QDataStream out(&m_socket);
+    out.setVersion(CommandChannel::streamVersion);
+    out << quint8(CommandChannel::MessageType::CommandLong) << qint32(systemId) << qint32(componentId)
+        << quint16(command);
+    for (int i = 0; i < 7; ++i)
+        out << float(params.value(i).toDouble());
+    return out.status() == QDataStream::Ok;
+}
+
+void CommandClient::readMessages()
+{
+    QDataStream in(&m_socket);
+    in.setVersion(CommandChannel::streamVersion);
+    for (;;) {
+        in.startTransaction();
+        quint8 type = 0;
+        qint32 systemId = 0;
+        quint16 command = 0;
+        quint8 result = 0;
+        in >> type >> systemId >> command >> result;
+        if (!in.commitTransaction())
+            return;
+        if (CommandChannel::MessageType(type) == CommandChannel::MessageType::CommandAck)
+            emit commandAcknowledged(systemId, command, result);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QLocalSocket>
+#include <QObject>
+#include <QTimer>
+#include <QVariantList>
+
+// UI end of the CommandChannel. Commands go to the daemon, which owns the
+// links; acknowledgements come back from whichever vehicle answered.
+// Reconnects on its own when the daemon restarts.
+class CommandClient : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool connected READ connected NOTIFY connectedChanged)
+
+public:
+    explicit CommandClient(QObject *parent = nullptr);
+
+    void connectToDaemon();
+    bool connected() const { return m_socket.state() == QLocalSocket::ConnectedState; }
+
+    // MAV_CMD with up to seven parameters. False when the daemon is not
+    // reachable; the command is not queued.
+    Q_INVOKABLE bool sendCommandLong(int systemId, int componentId, int command,
+                                     const QVariantList &params = QVariantList());
+
+signals:
+    void connectedChanged();
+    void commandAcknowledged(int systemId, int command, int result);
+
+private:
+    void readMessages();
+
+    QLocalSocket m_socket;
+    QTimer m_reconnectTimer;
+};
@@ -0,0 +1,114 @@
+#include "decoderplugin.h"
+
+#include <QCoreApplication>
+#include <QDir>
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// The link fields describe links the daemon measures itself.
+bool isLinkField(int field)
+{
+    return field >= int(VehicleField::ActiveLinks) && field <= int(VehicleField::LinkThroughput);
+}
+
+} // namespace
+
+QString DecoderLibrary::defaultDirectory()
+{
+    return QCoreApplication::applicationDirPath() + QStringLiteral("/decoders");
+}
+
+std::vector<std::unique_ptr<DecoderLibrary>> DecoderLibrary::loadAll(const QString &directory)
+{
+    std::vector<std::unique_ptr<DecoderLibrary>> libraries;
+    const QDir dir(directory);
+    for (const QString &file : dir.entryList(QDir::Files, QDir::Name)) {
+        const QString path = dir.filePath(file);
+        if (!QLibrary::isLibrary(path))
+            continue;
+        std::unique_ptr<DecoderLibrary> library(new DecoderLibrary(path));
+        const auto entry = reinterpret_cast<const AtlasDecoder *(*)()>(library->m_library.resolve("atlas_decoder"));
+        if (!entry) {
+            qWarning("atlasd: skipping %s: %s", qPrintable(path), qPrintable(library->m_library.errorString()));
+            continue;
+        }
+        const AtlasDecoder *decoder = entry();
+        if (!decoder || decoder->abi_version != ATLAS_DECODER_ABI_VERSION || !decoder->name || !decoder->open
+            || !decoder->close || !decoder->decode) {
+            qWarning("atlasd: skipping %s: not a version %u decoder", qPrintable(path),
+                     unsigned(ATLAS_DECODER_ABI_VERSION));
+            continue;
+        }
+        library->m_decoder = decoder;
+        libraries.push_back(std::move(library));
+    }
+    return libraries;
+}
+
+DecoderPlugin::DecoderPlugin(const AtlasDecoder *decoder, const QString &linkName, Sink sink)
+    : m_decoder(decoder)
+    , m_linkName(linkName.toUtf8())
+    , m_sink(std::move(sink))
+{
+    m_host.abi_version = ATLAS_DECODER_ABI_VERSION;
+    m_host.context = this;
+    m_host.field_id = &DecoderPlugin::fieldId;
+    m_host.publish = &DecoderPlugin::publish;
+    m_host.log = &DecoderPlugin::log;
+    m_instance = m_decoder->open(&m_host, m_linkName.constData());
+}
+
+DecoderPlugin::~DecoderPlugin()
+{
+    if (m_instance)
+        m_decoder->close(m_instance);
+}
+
+void DecoderPlugin::decode(const uint8_t *data, size_t size, qint64 nowMs, qint64 arrivalUs)
+{
+    m_decoding = true;
+    m_nowMs = nowMs;
+    m_arrivalUs = arrivalUs;
+    m_decoder->decode(m_instance, data, size);
+    m_decoding = false;
+}
+
+int32_t DecoderPlugin::fieldId(void *, const char *name)
+{
+    if (!name)
+        return -1;
+    for (int field = 0; field < VehicleFieldCount; ++field) {
+        if (!isLinkField(field) && std::strcmp(name, vehicleFieldName(VehicleField(field))) == 0)
+            return field;
+    }
+    return -1;
+}
+
+int DecoderPlugin::publish(void *context, int32_t systemId, const AtlasSample *samples, size_t count,
+                           int64_t vehicleTimeUs)
+{
+    auto *plugin = static_cast<DecoderPlugin *>(context);
+    if (!plugin->m_decoding || systemId < 1 || systemId > 255 || count > size_t(VehicleFieldCount)
+        || (count > 0 && !samples))
+        return 0;
+    FieldSample converted[VehicleFieldCount];
+    for (size_t i = 0; i < count; ++i) {
+        if (samples[i].field < 0 || samples[i].field >= VehicleFieldCount || isLinkField(samples[i].field)
+            || !std::isfinite(samples[i].value))
+            return 0;
+        converted[i] = {VehicleField(samples[i].field), samples[i].value};
+    }
+    return plugin->m_sink(int(systemId), converted, count, vehicleTimeUs, plugin->m_nowMs, plugin->m_arrivalUs)
+               ? 1
+               : 0;
+}
+
+void DecoderPlugin::log(void *context, const char *message)
+{
+    auto *plugin = static_cast<DecoderPlugin *>(context);
+    qInfo("atlasd: %s decoder on %s: %s", plugin->m_decoder->name, plugin->m_linkName.constData(),
+          message ? message : "");
+}
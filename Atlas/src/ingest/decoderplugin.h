@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QByteArray>
+#include <QLibrary>
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ingest/atlasdecoder.h"
+#include "ingest/telemetrydecoder.h"
+#include "state/vehiclestate.h"
+
+// A shared library implementing the decoder ABI in atlasdecoder.h. Kept
+// loaded for the life of the daemon.
+class DecoderLibrary
+{
+public:
+    // The decoders directory of the Atlas install (/opt/Atlas/decoders from
+    // the project's targetDirectory), next to the atlasd binary.
+    static QString defaultDirectory();
+    // Every library in directory exporting a decoder of this ABI version;
+    // the rest are skipped with a warning.
+    static std::vector<std::unique_ptr<DecoderLibrary>> loadAll(const QString &directory);
+
+    QString name() const { return QString::fromUtf8(m_decoder->name); }
+    const AtlasDecoder *decoder() const { return m_decoder; }
+
+private:
+    explicit DecoderLibrary(const QString &path) : m_library(path) {}
+
+    QLibrary m_library;
+    const AtlasDecoder *m_decoder = nullptr;
+};
+
+// One link's instance of a decoder. Datagrams go in as borrowed spans;
+// what the plugin publishes from inside decode() reaches the sink as
+// FieldSamples on the stack, with the datagram's times.
+class DecoderPlugin
+{
+public:
+    using Sink = std::function<bool(int systemId, const FieldSample *samples, size_t count, qint64 vehicleUs,
+                                    qint64 nowMs, qint64 arrivalUs)>;
+
+    DecoderPlugin(const AtlasDecoder *decoder, const QString &linkName, Sink sink);
+    ~DecoderPlugin();
+
+    DecoderPlugin(const DecoderPlugin &) = delete;
+    DecoderPlugin &operator=(const DecoderPlugin &) = delete;
+
+    // False if the plugin refused the link.
+    bool isOpen() const { return m_instance != nullptr; }
+    void decode(const uint8_t *data, size_t size, qint64 nowMs, qint64 arrivalUs);
+
+private:
+    static int32_t fieldId(void *context, const char *name);
+    static int publish(void *context, int32_t systemId, const AtlasSample *samples, size_t count,
+                       int64_t vehicleTimeUs);
+    static void log(void *context, const char *message);
+
+    const AtlasDecoder *m_decoder;
+    QByteArray m_linkName;
+    Sink m_sink;
+    AtlasHost m_host = {};
+    void *m_instance = nullptr;
+    bool m_decoding = false;
+    qint64 m_nowMs = 0;
+    qint64 m_arrivalUs = 0;
+};
@@ -0,0 +1,152 @@
+#include "framequeue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+struct PriorityInfo
+{
+    uint32_t messageId;
+    MessagePriority priority;
+};
+
+// common.xml messages that are not Normal. Sorted by message id.
+constexpr PriorityInfo priorities[] = {
+    {0, MessagePriority::Critical},    // HEARTBEAT
+    {1, MessagePriority::Telemetry},   // SYS_STATUS
+    {2, MessagePriority::Telemetry},   // SYSTEM_TIME
+    {22, MessagePriority::Bulk},       // PARAM_VALUE
+    {24, MessagePriority::Telemetry},  // GPS_RAW_INT
+    {26, MessagePriority::Bulk},       // SCALED_IMU
+    {27, MessagePriority::Bulk},       // RAW_IMU
+    {28, MessagePriority::Bulk},       // RAW_PRESSURE
+    {29, MessagePriority::Bulk},       // SCALED_PRESSURE
+    {30, MessagePriority::Telemetry},  // ATTITUDE
+    {33, MessagePriority::Telemetry},  // GLOBAL_POSITION_INT
+    {35, MessagePriority::Bulk},       // RC_CHANNELS_RAW
+    {36, MessagePriority::Bulk},       // SERVO_OUTPUT_RAW
+    {65, MessagePriority::Bulk},       // RC_CHANNELS
+    {74, MessagePriority::Telemetry},  // VFR_HUD
+    {77, MessagePriority::Critical},   // COMMAND_ACK
+    {110, MessagePriority::Bulk},      // FILE_TRANSFER_PROTOCOL
+    {111, MessagePriority::Telemetry}, // TIMESYNC
+    {116, MessagePriority::Bulk},      // SCALED_IMU2
+    {118, MessagePriority::Bulk},      // LOG_ENTRY
+    {120, MessagePriority::Bulk},      // LOG_DATA
+    {129, MessagePriority::Bulk},      // SCALED_IMU3
+    {130, MessagePriority::Bulk},      // DATA_TRANSMISSION_HANDSHAKE
+    {131, MessagePriority::Bulk},      // ENCAPSULATED_DATA
+    {137, MessagePriority::Bulk},      // SCALED_PRESSURE2
+    {143, MessagePriority::Bulk},      // SCALED_PRESSURE3
+    {147, MessagePriority::Telemetry}, // BATTERY_STATUS
+    {234, MessagePriority::Telemetry}, // HIGH_LATENCY
+    {235, MessagePriority::Telemetry}, // HIGH_LATENCY2
+    {241, MessagePriority::Bulk},      // VIBRATION
+    {242, MessagePriority::Telemetry}, // HOME_POSITION
+    {245, MessagePriority::Telemetry}, // EXTENDED_SYS_STATE
+    {246, MessagePriority::Critical},  // ADSB_VEHICLE
+    {247, MessagePriority::Critical},  // COLLISION
+    {249, MessagePriority::Bulk},      // MEMORY_VECT
+    {250, MessagePriority::Bulk},      // DEBUG_VECT
+    {251, MessagePriority::Bulk},      // NAMED_VALUE_FLOAT
+    {252, MessagePriority::Bulk},      // NAMED_VALUE_INT
+    {253, MessagePriority::Critical},  // STATUSTEXT
+    {254, MessagePriority::Bulk},      // DEBUG
+    {290, MessagePriority::Bulk},      // ESC_INFO
+    {291, MessagePriority::Bulk},      // ESC_STATUS
+    {322, MessagePriority::Bulk},      // PARAM_EXT_VALUE
+    {350, MessagePriority::Bulk},      // DEBUG_FLOAT_ARRAY
+};
+
+} // namespace
+
+MessagePriority messagePriority(uint32_t messageId)
+{
+    const auto found = std::lower_bound(std::begin(priorities), std::end(priorities), messageId,
+                                        [](const PriorityInfo &info, uint32_t id) { return info.messageId < id; });
+    if (found == std::end(priorities) || found->messageId != messageId)
+        return MessagePriority::Normal;
+    return found->priority;
+}
+
+const char *messagePriorityName(MessagePriority priority)
+{
+    static const char *const names[MessagePriorityCount] = {"critical", "telemetry", "normal", "bulk"};
+    return names[int(priority)];
+}
+
+FrameQueue::FrameQueue(int capacity)
+    : m_pool(size_t(capacity))
+{
+    m_free.reserve(size_t(capacity));
+    for (int slot = capacity - 1; slot >= 0; --slot)
+        m_free.push_back(slot);
+    for (Fifo &fifo : m_fifos)
+        fifo.ring.resize(size_t(capacity));
+}
+
+bool FrameQueue::push(const Mavlink::Frame &frame, int link, qint64 wallUs, qint64 arrivalUs, MessagePriority &shed)
+{
+    const int priority = int(messagePriority(frame.messageId));
+    bool kept = true;
+    if (m_free.empty()) {
+        // Make room at the bottom: the oldest of the lowest class queued,
+        // this frame's own included, unless everything queued outranks it.
+        int lowest = MessagePriorityCount - 1;
+        while (lowest > priority && m_fifos[size_t(lowest)].count == 0)
+            --lowest;
+        if (m_fifos[size_t(lowest)].count == 0) {
+            shed = MessagePriority(priority);
+            return false;
+        }
+        Fifo &victim = m_fifos[size_t(lowest)];
+        m_free.push_back(victim.ring[size_t(victim.head)]);
+        victim.head = (victim.head + 1) % int(m_pool.size());
+        --victim.count;
+        --m_size;
+        shed = MessagePriority(lowest);
+        kept = false;
+    }
+
+    const int slot = m_free.back();
+    m_free.pop_back();
+    Entry &entry = m_pool[size_t(slot)];
+    std::memcpy(entry.data.data(), frame.data, frame.size);
+    entry.frame = frame;
+    entry.frame.data = entry.data.data();
+    entry.frame.payload = entry.data.data() + (frame.payload - frame.data);
+    entry.link = link;
+    entry.wallUs = wallUs;
+    entry.arrivalUs = arrivalUs;
+
+    Fifo &fifo = m_fifos[size_t(priority)];
+    fifo.ring[size_t((fifo.head + fifo.count) % int(m_pool.size()))] = slot;
+    ++fifo.count;
+    ++m_size;
+    return kept;
+}
+
+int FrameQueue::highestNonEmpty() const
+{
+    for (int priority = 0; priority < MessagePriorityCount; ++priority) {
+        if (m_fifos[size_t(priority)].count > 0)
+            return priority;
+    }
+    return -1;
+}
+
+const FrameQueue::Entry &FrameQueue::front() const
+{
+    const Fifo &fifo = m_fifos[size_t(highestNonEmpty())];
+    return m_pool[size_t(fifo.ring[size_t(fifo.head)])];
+}
+
+void FrameQueue::pop()
+{
+    Fifo &fifo = m_fifos[size_t(highestNonEmpty())];
+    m_free.push_back(fifo.ring[size_t(fifo.head)]);
+    fifo.head = (fifo.head + 1) % int(m_pool.size());
+    --fifo.count;
+    --m_size;
+}
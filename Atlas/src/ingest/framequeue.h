@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <array>
+#include <vector>
+
+#include "ingest/mavlink.h"
+
+// What goes last when the daemon cannot keep up. Heartbeats, command acks,
+// alerts and traffic reports are never shed while anything else is queued;
+// debug, parameter, log and raw sensor streams go first.
+enum class MessagePriority : quint8 {
+    Critical,  // HEARTBEAT, COMMAND_ACK, STATUSTEXT, ADSB_VEHICLE, COLLISION
+    Telemetry, // position, attitude, battery, system status
+    Normal,    // everything not listed
+    Bulk,      // PARAM_VALUE, LOG_DATA, FTP, DEBUG*, raw IMU and RC
+};
+
+constexpr int MessagePriorityCount = int(MessagePriority::Bulk) + 1;
+
+MessagePriority messagePriority(uint32_t messageId);
+const char *messagePriorityName(MessagePriority priority);
+
+// Frames waiting for the decoders and the router once the receive path is
+// over its time budget. Bounded: a pool of capacity slots shared by one
+// FIFO per priority. A frame arriving at a full queue evicts the oldest
+// frame of the lowest class queued at or below its own; within its own
+// class the newer frame wins, as it carries fresher state. It is refused
+// only when everything queued outranks it, so the lowest class always goes
+// first. Frames are copied in, since the receive buffers are reused by the
+// next batch.
+class FrameQueue
+{
+public:
+    struct Entry
+    {
+        Mavlink::Frame frame; // points into data
+        int link = 0;
+        qint64 wallUs = 0;
+        qint64 arrivalUs = 0; // GCS monotonic clock
+        std::array<uint8_t, Mavlink::maxFrameSize> data;
+    };
+
+    explicit FrameQueue(int capacity);
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    // False when a frame had to go to make room or this one was refused;
+    // shed then says which class lost it.
+    bool push(const Mavlink::Frame &frame, int link, qint64 wallUs, qint64 arrivalUs, MessagePriority &shed);
+
+    // Highest priority first, oldest first within a priority. Valid until
+    // the next push().
+    const Entry &front() const;
+    void pop();
+
+private:
+    struct Fifo
+    {
+        std::vector<int> ring; // pool indices
+        int head = 0;
+        int count = 0;
+    };
+
+    int highestNonEmpty() const;
+
+    std::vector<Entry> m_pool;
+    std::vector<int> m_free;
+    std::array<Fifo, MessagePriorityCount> m_fifos;
+    int m_size = 0;
+};
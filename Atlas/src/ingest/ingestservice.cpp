@@ -0,0 +1,509 @@
+#include "ingestservice.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QLocalSocket>
+#include <QVarLengthArray>
+#include <QtEndian>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "diagnostics/metrics.h"
+#include "ingest/commandchannel.h"
+#include "ingest/telemetrydecoder.h"
+
+namespace {
+
+static_assert(LinkManager::maxLinks == TrafficSnapshot::maxLinks, "snapshot names every link");
+static_assert(MessagePriorityCount == TrafficSnapshot::priorityClasses, "snapshot counts every class");
+
+constexpr int tickIntervalMs = 1000;
+// Frames are decoded inline until a wakeup has spent this long; the rest
+// wait in the backlog, which drains in slices of the same length so the
+// sockets are read in between.
+constexpr qint64 processBudgetUs = 2000;
+// About two seconds of a busy link.
+constexpr int backlogCapacity = 2048;
+constexpr uint8_t mavTypeGcs = 6;
+constexpr uint8_t mavAutopilotInvalid = 8;
+constexpr uint8_t mavStateActive = 4;
+
+// Microseconds for the tlog; QDateTime only has ms.
+qint64 wallClockUs()
+{
+    const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    return qint64(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count());
+}
+
+// The GCS monotonic clock: link timing and vehicle sample times. Shared
+// with the UI process, which reads the same steady_clock.
+qint64 monotonicUs()
+{
+    const auto sinceBoot = std::chrono::steady_clock::now().time_since_epoch();
+    return qint64(std::chrono::duration_cast<std::chrono::microseconds>(sinceBoot).count());
+}
+
+} // namespace
+
+IngestService::IngestService(const QString &logDirectory, QObject *parent)
+    : QObject(parent)
+    , m_logDirectory(logDirectory)
+    , m_subscriptionServer(m_subscriptions)
+    , m_pictureServer(m_subscriptions)
+    , m_backlog(backlogCapacity)
+{
+    m_tickTimer.setInterval(tickIntervalMs);
+    connect(&m_tickTimer, &QTimer::timeout, this, &IngestService::tick);
+    m_backlogTimer.setSingleShot(true);
+    m_backlogTimer.setInterval(0);
+    connect(&m_backlogTimer, &QTimer::timeout, this, &IngestService::processBacklog);
+    for (int priority = 0; priority < MessagePriorityCount; ++priority) {
+        m_shedFrames[priority] = Metrics::counter(
+            "atlas_ingest_shed_frames_total", "Frames dropped from a full backlog, by priority class.",
+            QByteArray("class=\"") + messagePriorityName(MessagePriority(priority)) + '"');
+    }
+    m_backlogFrames = Metrics::gauge("atlas_ingest_backlog_frames", "Frames waiting to be decoded and routed.");
+    connect(&m_commandServer, &QLocalServer::newConnection, this, &IngestService::acceptCommandClients);
+    m_router.setVehicleSink([this](const Mavlink::Frame &frame, int targetSystem) {
+        forwardToVehicles(frame, targetSystem);
+    });
+}
+
+IngestService::~IngestService()
+{
+    m_log.flush();
+}
+
+bool IngestService::addUdpLink(const QString &name, quint16 port, const QByteArray &signingKey)
+{
+    if (!signingKey.isEmpty() && signingKey.size() != qsizetype(Mavlink::signingKeySize))
+        return false;
+    const int link = m_linkManager.addLink(name);
+    if (link < 0)
+        return false;
+    UdpLink udpLink;
+    udpLink.port = port;
+    if (!signingKey.isEmpty()) {
+        LinkSigning::Key key;
+        std::memcpy(key.data(), signingKey.constData(), key.size());
+        udpLink.signing.setKey(key, quint8(link));
+    }
+    m_links.push_back(std::move(udpLink));
+    return true;
+}
+
+bool IngestService::setLinkDecoder(const QString &link, const QString &decoder)
+{
+    for (size_t i = 0; i < m_links.size(); ++i) {
+        if (m_linkManager.linkName(int(i)) == link) {
+            m_links[i].decoderName = decoder;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IngestService::start()
+{
+    // A live daemon answers on the command channel; a stale socket file
+    // from a crashed one does not.
+    QLocalSocket probe;
+    probe.connectToServer(CommandChannel::serverName());
+    if (probe.waitForConnected(200)) {
+        m_error = QStringLiteral("another atlasd is already running");
+        return false;
+    }
+    QLocalServer::removeServer(CommandChannel::serverName());
+    if (!m_commandServer.listen(CommandChannel::serverName())) {
+        m_error = m_commandServer.errorString();
+        return false;
+    }
+
+    if (!m_snapshot.create()) {
+        m_error = m_snapshot.errorString();
+        return false;
+    }
+
+    for (size_t link = 0; link < m_links.size(); ++link) {
+        if (!m_links[link].decoderName.isEmpty() && !openDecoder(int(link)))
+            return false;
+        auto receiver = std::make_unique<UdpReceiver>();
+        if (!receiver->bind(m_links[link].port)) {
+            m_error = m_linkManager.linkName(int(link)) + QStringLiteral(": ")
+                      + QString::fromStdString(receiver->errorString());
+            return false;
+        }
+        auto notifier = std::make_unique<QSocketNotifier>(receiver->descriptor(), QSocketNotifier::Read);
+        if (m_links[link].decoder) {
+            connect(notifier.get(), &QSocketNotifier::activated, this,
+                    [this, link] { readDecoderDatagrams(int(link)); });
+        } else {
+            connect(notifier.get(), &QSocketNotifier::activated, this, [this, link] { readDatagrams(int(link)); });
+        }
+        m_snapshot.setLinkName(int(link), m_linkManager.linkName(int(link)));
+        m_linkManager.setHealthBlock(int(link), m_snapshot.linkHealth(int(link)));
+        m_links[link].receiver = std::move(receiver);
+        m_links[link].notifier = std::move(notifier);
+        m_links[link].duplicates = Metrics::counter(
+            "atlas_link_duplicates_total", "Frames dropped because another link delivered them first.",
+            "link=\"" + m_linkManager.linkName(int(link)).toUtf8() + '"');
+        const QByteArray label = "link=\"" + m_linkManager.linkName(int(link)).toUtf8() + "\",reason=";
+        const QByteArray help = "Frames rejected by MAVLink 2 signing before parsing, by reason.";
+        m_links[link].unsignedFrames = Metrics::counter("atlas_signing_rejected_total", help, label + "\"unsigned\"");
+        m_links[link].badSignatures = Metrics::counter("atlas_signing_rejected_total", help, label + "\"signature\"");
+        m_links[link].replays = Metrics::counter("atlas_signing_rejected_total", help, label + "\"replay\"");
+    }
+    if (!m_router.start(&m_error))
+        return false;
+    if (m_subscriptionPort != 0
+        && !m_subscriptionServer.listen(m_subscriptionAddress, m_subscriptionPort, m_subscriptionSecret, &m_error))
+        return false;
+    if (m_picturePort != 0 && !m_pictureServer.listen(m_pictureAddress, m_picturePort, &m_error))
+        return false;
+
+    QDir().mkpath(m_logDirectory);
+    m_log.setFileName(m_logDirectory + QStringLiteral("/")
+                      + QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))
+                      + QStringLiteral(".tlog"));
+    if (!m_log.open(QIODevice::WriteOnly | QIODevice::Append))
+        qWarning("atlasd: cannot write %s: %s", qPrintable(m_log.fileName()), qPrintable(m_log.errorString()));
+
+    tick();
+    m_tickTimer.start();
+    return true;
+}
+
+bool IngestService::openDecoder(int link)
+{
+    UdpLink &udpLink = m_links[size_t(link)];
+    const QString linkName = m_linkManager.linkName(link);
+    if (m_decoderLibraries.empty())
+        m_decoderLibraries = DecoderLibrary::loadAll(m_decoderDirectory);
+    const auto found = std::find_if(m_decoderLibraries.begin(), m_decoderLibraries.end(), [&](const auto &library) {
+        return library->name() == udpLink.decoderName;
+    });
+    if (found == m_decoderLibraries.end()) {
+        m_error = linkName + QStringLiteral(": no decoder plugin \"") + udpLink.decoderName
+                  + QStringLiteral("\" in ") + m_decoderDirectory;
+        return false;
+    }
+    udpLink.decoder = std::make_unique<DecoderPlugin>(
+        (*found)->decoder(), linkName,
+        [this](int systemId, const FieldSample *samples, size_t count, qint64 vehicleUs, qint64 nowMs,
+               qint64 arrivalUs) {
+            const SampleTime time = vehicleUs >= 0 ? m_clockSync.sampleTime(systemId, vehicleUs, arrivalUs)
+                                                   : m_clockSync.arrivalTime(systemId, arrivalUs);
+            return publishSamples(systemId, samples, count, nowMs, time);
+        });
+    if (!udpLink.decoder->isOpen()) {
+        m_error = linkName + QStringLiteral(": decoder plugin \"") + udpLink.decoderName
+                  + QStringLiteral("\" refused the link");
+        return false;
+    }
+    return true;
+}
+
+void IngestService::readDatagrams(int link)
+{
+    static MetricCounter *const datagrams = Metrics::counter(
+        "atlas_ingest_datagrams_total", "UDP datagrams received by the ingest daemon.");
+    static MetricHistogram *const batchSizes = Metrics::histogram(
+        "atlas_ingest_batch_datagrams", "Datagrams read per socket wakeup.", {1, 2, 4, 8, 16, 32, 64, 256});
+    static MetricCounter *const frames = Metrics::counter(
+        "atlas_mavlink_frames_total", "MAVLink frames parsed.");
+    static MetricCounter *const checksumErrors = Metrics::counter(
+        "atlas_mavlink_checksum_errors_total", "MAVLink frames dropped for a bad checksum or header.");
+    static MetricCounter *const skippedBytes = Metrics::counter(
+        "atlas_mavlink_skipped_bytes_total", "Bytes skipped while resynchronising on a frame start.");
+    UdpLink &udpLink = m_links[size_t(link)];
+    Mavlink::ParseStats stats;
+    const qint64 nowUs = wallClockUs();
+    const qint64 arrivalUs = monotonicUs();
+    const uint64_t signingNow = LinkSigning::timestampNow();
+    // Frames are parsed straight out of the receiver's buffers; nothing is
+    // copied until a frame is logged.
+    const size_t count = udpLink.receiver->drain([&](const UdpReceiver::Datagram &datagram) {
+        const Endpoint sender{datagram.address, datagram.port};
+        Mavlink::parse(datagram.data, datagram.size, [&](const Mavlink::Frame &frame) {
+            switch (udpLink.signing.verify(frame, signingNow)) {
+            case LinkSigning::Verdict::Accepted:
+                break;
+            case LinkSigning::Verdict::Unsigned:
+                udpLink.unsignedFrames->increment();
+                return;
+            case LinkSigning::Verdict::BadSignature:
+                udpLink.badSignatures->increment();
+                return;
+            case LinkSigning::Verdict::Replayed:
+                udpLink.replays->increment();
+                return;
+            }
+            if (frame.systemId == Mavlink::gcsSystemId)
+                return;
+            if (!m_linkManager.accept(link, frame, sender, arrivalUs)) {
+                udpLink.duplicates->increment();
+                return;
+            }
+            logFrame(frame, nowUs);
+            // Every frame is logged; only decoding and routing can wait.
+            if (!m_backlog.isEmpty() || monotonicUs() - arrivalUs > processBudgetUs) {
+                queueFrame(frame, link, nowUs, arrivalUs);
+                return;
+            }
+            handleFrame(frame, nowUs / 1000, arrivalUs);
+            m_router.routeFromVehicle(frame, arrivalUs / 1000);
+        }, &stats);
+    });
+    m_router.flush();
+    publishBacklog();
+    datagrams->increment(count);
+    batchSizes->observe(double(count));
+    frames->increment(stats.frames);
+    checksumErrors->increment(stats.checksumErrors);
+    skippedBytes->increment(stats.skippedBytes);
+}
+
+void IngestService::readDecoderDatagrams(int link)
+{
+    static MetricCounter *const datagrams = Metrics::counter(
+        "atlas_ingest_datagrams_total", "UDP datagrams received by the ingest daemon.");
+    UdpLink &udpLink = m_links[size_t(link)];
+    const qint64 nowMs = wallClockUs() / 1000;
+    const qint64 arrivalUs = monotonicUs();
+    // The plugin reads the receive buffers in place.
+    const size_t count = udpLink.receiver->drain([&](const UdpReceiver::Datagram &datagram) {
+        udpLink.decoder->decode(datagram.data, datagram.size, nowMs, arrivalUs);
+    });
+    datagrams->increment(count);
+}
+
+void IngestService::handleFrame(const Mavlink::Frame &frame, qint64 nowMs, qint64 arrivalUs)
+{
+    if (frame.messageId == Mavlink::CommandAck && frame.checksumVerified) {
+        // COMMAND_ACK: command u16 @0, result u8 @2
+        broadcastAck(frame.systemId, frame.field<uint16_t>(0), frame.field<uint8_t>(2));
+        return;
+    }
+    int link = -1;
+    qint64 sentUs = 0, vehicleUs = 0;
+    if (LinkManager::timesyncReply(frame, link, sentUs, vehicleUs)) {
+        m_clockSync.timesync(frame.systemId, sentUs, vehicleUs, arrivalUs);
+        return;
+    }
+
+    FieldSample samples[VehicleFieldCount];
+    const size_t count = decodeTelemetry(frame, samples);
+    if (count == 0)
+        return;
+    // Stamped with when the vehicle took the samples, on our clock.
+    const qint64 bootTimeUs = telemetryBootTimeUs(frame);
+    const SampleTime time = bootTimeUs >= 0 ? m_clockSync.sampleTime(frame.systemId, bootTimeUs, arrivalUs)
+                                            : m_clockSync.arrivalTime(frame.systemId, arrivalUs);
+    publishSamples(frame.systemId, samples, count, nowMs, time);
+}
+
+bool IngestService::publishSamples(int systemId, const FieldSample *samples, size_t count, qint64 nowMs,
+                                   const SampleTime &time)
+{
+    static MetricCounter *const snapshotFull = Metrics::counter(
+        "atlas_snapshot_full_total", "Samples dropped because every snapshot slot is taken.");
+
+    const bool written = m_snapshot.write(systemId, samples, count, nowMs, time);
+    if (!written)
+        snapshotFull->increment();
+    m_subscriptions.update(systemId, samples, count);
+    return written;
+}
+
+void IngestService::queueFrame(const Mavlink::Frame &frame, int link, qint64 nowUs, qint64 arrivalUs)
+{
+    MessagePriority shed = MessagePriority::Normal;
+    if (!m_backlog.push(frame, link, nowUs, arrivalUs, shed)) {
+        m_shedFrames[int(shed)]->increment();
+        m_snapshot.shed(int(shed));
+    }
+    if (!m_backlogTimer.isActive())
+        m_backlogTimer.start();
+}
+
+void IngestService::processBacklog()
+{
+    const qint64 startUs = monotonicUs();
+    while (!m_backlog.isEmpty() && monotonicUs() - startUs < processBudgetUs) {
+        const FrameQueue::Entry &entry = m_backlog.front();
+        handleFrame(entry.frame, entry.wallUs / 1000, entry.arrivalUs);
+        m_router.routeFromVehicle(entry.frame, monotonicUs() / 1000);
+        m_backlog.pop();
+    }
+    m_router.flush();
+    publishBacklog();
+    if (!m_backlog.isEmpty())
+        m_backlogTimer.start();
+}
+
+void IngestService::publishBacklog()
+{
+    m_snapshot.setQueuedFrames(m_backlog.size());
+    m_backlogFrames->set(m_backlog.size());
+}
+
+void IngestService::forwardToVehicles(const Mavlink::Frame &frame, int targetSystem)
+{
+    const qint64 nowMs = monotonicUs() / 1000;
+    QVarLengthArray<std::pair<int, Endpoint>, 8> sent;
+    const auto forward = [&](int systemId) {
+        const int link = m_linkManager.bestLink(systemId, nowMs);
+        const Endpoint *endpoint = m_linkManager.endpoint(systemId, link);
+        if (!endpoint)
+            return;
+        // Aircraft behind one radio share a peer; it gets one copy.
+        for (const auto &[sentLink, peer] : sent) {
+            if (sentLink == link && peer.address == endpoint->address && peer.port == endpoint->port)
+                return;
+        }
+        sent.append({link, *endpoint});
+        // Forwarded as received, sequence and signature intact.
+        m_links[size_t(link)].receiver->sendTo(frame.data, frame.size, endpoint->address, endpoint->port);
+    };
+
+    if (targetSystem != 0) {
+        forward(targetSystem);
+        return;
+    }
+    for (const int systemId : m_linkManager.systemIds())
+        forward(systemId);
+}
+
+void IngestService::logFrame(const Mavlink::Frame &frame, qint64 nowUs)
+{
+    // .tlog: big-endian µs timestamp, then the raw frame, as every MAVLink
+    // ground station reads it.
+    if (!m_log.isOpen())
+        return;
+    const quint64 timestamp = qToBigEndian(quint64(nowUs));
+    m_log.write(reinterpret_cast<const char *>(&timestamp), sizeof(timestamp));
+    m_log.write(reinterpret_cast<const char *>(frame.data), qint64(frame.size));
+}
+
+void IngestService::acceptCommandClients()
+{
+    while (QLocalSocket *client = m_commandServer.nextPendingConnection()) {
+        m_clients.append(client);
+        connect(client, &QLocalSocket::readyRead, this, [this, client] { readCommands(client); });
+        connect(client, &QLocalSocket::disconnected, this, [this, client] {
+            m_clients.removeOne(client);
+            client->deleteLater();
+        });
+    }
+}
+
+void IngestService::readCommands(QLocalSocket *client)
+{
+    QDataStream in(client);
+    in.setVersion(CommandChannel::streamVersion);
+    for (;;) {
+        in.startTransaction();
+        quint8 type = 0;
+        in >> type;
+        if (CommandChannel::MessageType(type) != CommandChannel::MessageType::CommandLong) {
+            if (in.commitTransaction()) {
+                qWarning("atlasd: unknown command channel message %u", unsigned(type));
+                client->abort();
+            }
+            return;
+        }
+
+        qint32 systemId = 0, componentId = 0;
+        quint16 command = 0;
+        float params[7] = {};
+        in >> systemId >> componentId >> command;
+        for (float &param : params)
+            in >> param;
+        if (!in.commitTransaction())
+            return;
+
+        // COMMAND_LONG: param1..7 f32 @0, command u16 @28, target_system
+        // u8 @30, target_component u8 @31, confirmation u8 @32
+        uint8_t payload[33] = {};
+        for (int i = 0; i < 7; ++i)
+            qToLittleEndian(params[i], payload + 4 * i);
+        qToLittleEndian(command, payload + 28);
+        payload[30] = uint8_t(systemId);
+        payload[31] = uint8_t(componentId);
+        const int link = m_linkManager.bestLink(systemId, monotonicUs() / 1000);
+        if (!send(systemId, link, Mavlink::CommandLong, payload, sizeof(payload)))
+            qWarning("atlasd: no link to system %d for command %u", systemId, unsigned(command));
+    }
+}
+
+void IngestService::broadcastAck(int systemId, quint16 command, quint8 result)
+{
+    for (QLocalSocket *client : std::as_const(m_clients)) {
+        QDataStream out(client);
+        out.setVersion(CommandChannel::streamVersion);
+        out << quint8(CommandChannel::MessageType::CommandAck) << qint32(systemId) << command << result;
+    }
+}
+
+bool IngestService::send(int systemId, int link, uint32_t messageId, const uint8_t *payload,
+                         uint8_t payloadLength)
+{
+    const Endpoint *endpoint = m_linkManager.endpoint(systemId, link);
+    if (!endpoint)
+        return false;
+    uint8_t frame[Mavlink::maxFrameSize];
+    const size_t size = m_links[size_t(link)].signing.encode(frame, m_sequence++, Mavlink::gcsSystemId,
+                                                             Mavlink::gcsComponentId, messageId, payload,
+                                                             payloadLength, LinkSigning::timestampNow());
+    return size > 0 && m_links[size_t(link)].receiver->sendTo(frame, size, endpoint->address, endpoint->port);
+}
+
+void IngestService::tick()
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    m_snapshot.heartbeat(nowMs);
+    m_log.flush();
+
+    // Link statistics are ours, exact as of now.
+    const SampleTime now{monotonicUs(), 0};
+    m_linkManager.tick(now.monotonicUs / 1000);
+    FieldSample samples[VehicleFieldCount];
+    for (const int systemId : m_linkManager.systemIds()) {
+        const size_t count = m_linkManager.linkFields(systemId, now.monotonicUs / 1000, samples);
+        m_snapshot.write(systemId, samples, count, nowMs, now);
+        m_subscriptions.update(systemId, samples, count);
+    }
+
+    // Autopilots run their GCS-lost failsafe off our heartbeat, so it must
+    // not depend on a UI being up, and goes out on every link so losing
+    // one does not trip it.
+    uint8_t heartbeat[9] = {};
+    heartbeat[4] = mavTypeGcs;
+    heartbeat[5] = mavAutopilotInvalid;
+    heartbeat[7] = mavStateActive;
+    heartbeat[8] = 3; // mavlink_version
+    uint8_t timesync[LinkManager::timesyncPayloadSize];
+    QVarLengthArray<std::pair<int, Endpoint>, 8> heartbeatSent;
+    for (const int systemId : m_linkManager.systemIds()) {
+        for (int link = 0; link < m_linkManager.linkCount(); ++link) {
+            const Endpoint *endpoint = m_linkManager.endpoint(systemId, link);
+            if (!endpoint)
+                continue;
+            // The heartbeat is not addressed to anyone, so aircraft behind
+            // one radio share a copy, as in forwardToVehicles().
+            bool duplicate = false;
+            for (const auto &[sentLink, peer] : heartbeatSent)
+                duplicate |= sentLink == link && peer.address == endpoint->address && peer.port == endpoint->port;
+            if (!duplicate) {
+                heartbeatSent.append({link, *endpoint});
+                send(systemId, link, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+            }
+            // The reply times this link's round trip and synchronizes the
+            // vehicle's clock.
+            LinkManager::timesyncRequest(systemId, link, monotonicUs(), timesync);
+            send(systemId, link, Mavlink::Timesync, timesync, sizeof(timesync));
+        }
+    }
+}
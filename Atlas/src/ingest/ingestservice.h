@@ -0,0 +1,145 @@
+#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QLocalServer>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <memory>
+#include <vector>
+
+#include "ingest/clocksync.h"
+#include "ingest/decoderplugin.h"
+#include "ingest/framequeue.h"
+#include "ingest/linkmanager.h"
+#include "ingest/linksigning.h"
+#include "ingest/mavlink.h"
+#include "ingest/mavlinkrouter.h"
+#include "ingest/pictureserver.h"
+#include "ingest/subscriptionhub.h"
+#include "ingest/subscriptionserver.h"
+#include "ingest/trafficsnapshot.h"
+#include "ingest/udpreceiver.h"
+
+class MetricCounter;
+class MetricGauge;
+class QLocalSocket;
+
+// The headless half of Atlas (atlasd). Receives MAVLink over one or more
+// UDP links, drops the copies redundant links deliver, writes every unique
+// frame to a .tlog, publishes decoded telemetry to the shared-memory
+// TrafficSnapshot stamped with when the vehicle took it on the GCS clock,
+// serves decimated telemetry to remote subscribers and the WebSocket
+// traffic picture, routes MAVLink to and from other ground stations and
+// sends commands from UI processes on to the vehicles over their healthiest
+// link. Links that carry another protocol go through a decoder plugin
+// (atlasdecoder.h) instead of the MAVLink path. Keeps flying aircraft
+// covered while the UI restarts or hangs. When decoding and routing fall
+// behind the links, frames wait in a bounded priority backlog and bulk
+// streams are shed before anything that keeps the picture current.
+class IngestService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IngestService(const QString &logDirectory, QObject *parent = nullptr);
+    ~IngestService() override;
+
+    // Call before start(). At most LinkManager::maxLinks. With a 32-byte
+    // signing key the link only accepts MAVLink 2 frames signed with it,
+    // and signs what it sends.
+    bool addUdpLink(const QString &name, quint16 port, const QByteArray &signingKey = {});
+    // Call before start(). The link's datagrams go to the named decoder
+    // plugin instead of the MAVLink parser; start() fails if no plugin in
+    // the decoder directory has that name.
+    bool setLinkDecoder(const QString &link, const QString &decoder);
+    void setDecoderDirectory(const QString &directory) { m_decoderDirectory = directory; }
+    // Any time; see MavlinkRouter::setEndpoints().
+    bool setRouterEndpoints(const std::vector<MavlinkRouter::EndpointConfig> &configs, QString *error)
+    {
+        return m_router.setEndpoints(configs, error);
+    }
+    // UDP address and port for SubscriptionServer requests; port 0 (the
+    // default) serves none. See SubscriptionServer for the secret.
+    void setSubscriptionServer(const QHostAddress &address, quint16 port, const QByteArray &secret)
+    {
+        m_subscriptionAddress = address;
+        m_subscriptionPort = port;
+        m_subscriptionSecret = secret;
+    }
+    // WebSocket traffic picture; port 0 (the default) serves none.
+    void setPictureServer(const QHostAddress &address, quint16 port)
+    {
+        m_pictureAddress = address;
+        m_picturePort = port;
+    }
+
+    // False if another daemon is already running or a socket cannot bind;
+    // see errorString().
+    bool start();
+    QString errorString() const { return m_error; }
+
+private:
+    using Endpoint = LinkManager::Endpoint;
+
+    struct UdpLink
+    {
+        quint16 port = 0;
+        std::unique_ptr<UdpReceiver> receiver;
+        std::unique_ptr<QSocketNotifier> notifier;
+        MetricCounter *duplicates = nullptr;
+        LinkSigning signing;
+        MetricCounter *unsignedFrames = nullptr;
+        MetricCounter *badSignatures = nullptr;
+        MetricCounter *replays = nullptr;
+        QString decoderName;
+        std::unique_ptr<DecoderPlugin> decoder;
+    };
+
+    void readDatagrams(int link);
+    bool openDecoder(int link);
+    void readDecoderDatagrams(int link);
+    bool publishSamples(int systemId, const FieldSample *samples, size_t count, qint64 nowMs,
+                        const SampleTime &time);
+    void handleFrame(const Mavlink::Frame &frame, qint64 nowMs, qint64 arrivalUs);
+    void queueFrame(const Mavlink::Frame &frame, int link, qint64 nowUs, qint64 arrivalUs);
+    void processBacklog();
+    void publishBacklog();
+    void forwardToVehicles(const Mavlink::Frame &frame, int targetSystem);
+    void logFrame(const Mavlink::Frame &frame, qint64 nowUs);
+    void acceptCommandClients();
+    void readCommands(QLocalSocket *client);
+    void broadcastAck(int systemId, quint16 command, quint8 result);
+    bool send(int systemId, int link, uint32_t messageId, const uint8_t *payload, uint8_t payloadLength);
+    void tick();
+
+    QString m_logDirectory;
+    QString m_error;
+    QString m_decoderDirectory = DecoderLibrary::defaultDirectory();
+    // Before m_links: their decoders close before the libraries go.
+    std::vector<std::unique_ptr<DecoderLibrary>> m_decoderLibraries;
+    std::vector<UdpLink> m_links; // indexed like m_linkManager's links
+    LinkManager m_linkManager;
+    ClockSync m_clockSync;
+    MavlinkRouter m_router;
+    SubscriptionHub m_subscriptions;
+    SubscriptionServer m_subscriptionServer;
+    QHostAddress m_subscriptionAddress;
+    quint16 m_subscriptionPort = 0;
+    QByteArray m_subscriptionSecret;
+    PictureServer m_pictureServer;
+    QHostAddress m_pictureAddress;
+    quint16 m_picturePort = 0;
+    QLocalServer m_commandServer;
+    QList<QLocalSocket *> m_clients;
+    TrafficSnapshotWriter m_snapshot;
+    FrameQueue m_backlog;
+    QTimer m_backlogTimer;
+    MetricCounter *m_shedFrames[MessagePriorityCount] = {};
+    MetricGauge *m_backlogFrames = nullptr;
+    QFile m_log;
+    QTimer m_tickTimer;
+    quint8 m_sequence = 0;
+};
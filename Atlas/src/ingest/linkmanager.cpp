@@ -0,0 +1,285 @@
+#include "linkmanager.h"
+
+#include <QtEndian>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr qint64 linkTimeoutMs = 3000;
+// Loss within this many points counts as equal; the faster link wins then.
+constexpr double lossTolerancePercent = 1.0;
+constexpr double smoothing = 0.5; // weight of the newest tick
+constexpr double jitterGain = 1.0 / 16;   // RFC 3550
+constexpr double roundTripGain = 1.0 / 8; // TCP's smoothed RTT
+// A transit change this large is a reboot or a stalled stream, not jitter.
+constexpr qint64 transitResetUs = 10000000;
+constexpr qint64 maxRoundTripUs = 10000000;
+constexpr uint8_t autopilotComponentId = 1;
+
+using TrafficSnapshot::healthBucketBoundsMs;
+using TrafficSnapshot::healthBuckets;
+
+int healthBucket(double ms)
+{
+    int bucket = 0;
+    while (bucket < healthBuckets - 1 && ms > healthBucketBoundsMs[bucket])
+        ++bucket;
+    return bucket;
+}
+
+void smooth(double &average, double sample, double gain)
+{
+    average = average < 0 ? sample : average + gain * (sample - average);
+}
+
+inline bool testBit(const std::array<quint64, 4> &bits, quint8 index)
+{
+    return (bits[index >> 6] >> (index & 63)) & 1;
+}
+
+inline void setBit(std::array<quint64, 4> &bits, quint8 index)
+{
+    bits[index >> 6] |= quint64(1) << (index & 63);
+}
+
+inline void clearBit(std::array<quint64, 4> &bits, quint8 index)
+{
+    bits[index >> 6] &= ~(quint64(1) << (index & 63));
+}
+
+} // namespace
+
+int LinkManager::addLink(const QString &name)
+{
+    if (m_linkNames.size() >= maxLinks)
+        return -1;
+    m_linkNames.append(name);
+    return int(m_linkNames.size()) - 1;
+}
+
+void LinkManager::setHealthBlock(int link, TrafficSnapshot::LinkHealth *block)
+{
+    if (link >= 0 && link < maxLinks)
+        m_healthBlocks[size_t(link)] = block;
+}
+
+// Sequence numbers are 8 bits, so "newer" is the half of the ring ahead of
+// head and the other half is the window we remember. Slots passed over
+// while head advances are cleared as they leave the window.
+bool LinkManager::isDuplicate(Sender &sender, quint8 sequence, quint16 checksum)
+{
+    if (!sender.started) {
+        sender.started = true;
+        sender.head = sequence;
+    } else {
+        const quint8 ahead = quint8(sequence - sender.head);
+        if (ahead == 0 || ahead >= 128) {
+            // The checksum covers the payload, so a rebooted sender reusing
+            // a sequence number is not mistaken for a repeat.
+            if (testBit(sender.seen, sequence) && sender.checksums[sequence] == checksum)
+                return true;
+        } else {
+            for (quint8 i = 1; i <= ahead; ++i)
+                clearBit(sender.seen, quint8(sender.head + i));
+            sender.head = sequence;
+        }
+    }
+    setBit(sender.seen, sequence);
+    sender.checksums[sequence] = checksum;
+    return false;
+}
+
+bool LinkManager::accept(int link, const Mavlink::Frame &frame, const Endpoint &sender, qint64 nowUs)
+{
+    Sender &state = m_senders[quint16((frame.systemId << 8) | frame.componentId)];
+
+    LinkSequence &linkSequence = state.links[link];
+    quint64 gap = 0;
+    if (!linkSequence.started) {
+        linkSequence.started = true;
+        linkSequence.last = frame.sequence;
+    } else {
+        // Zero or a step back is a repeat or a late arrival, not progress.
+        const quint8 step = quint8(frame.sequence - linkSequence.last);
+        if (step != 0 && step < 128) {
+            gap = step - 1;
+            linkSequence.last = frame.sequence;
+        }
+    }
+
+    LinkHealth &health = m_vehicles[frame.systemId][link];
+    health.endpoint = sender;
+    health.lastSeenMs = nowUs / 1000;
+    ++health.received;
+    health.lost += gap;
+    if (gap > 0 && m_healthBlocks[size_t(link)])
+        m_healthBlocks[size_t(link)]->lost.fetch_add(gap, std::memory_order_relaxed);
+    measure(link, health, frame, nowUs);
+
+    if (isDuplicate(state, frame.sequence, frame.checksum()))
+        return false;
+    ++health.firstArrivals;
+    return true;
+}
+
+void LinkManager::measure(int link, LinkHealth &health, const Mavlink::Frame &frame, qint64 nowUs)
+{
+    TrafficSnapshot::LinkHealth *block = m_healthBlocks[size_t(link)];
+    health.bytes += frame.size;
+    if (block) {
+        block->frames.fetch_add(1, std::memory_order_relaxed);
+        block->bytes.fetch_add(frame.size, std::memory_order_relaxed);
+    }
+    if (frame.componentId != autopilotComponentId || !frame.checksumVerified)
+        return;
+
+    if (frame.messageId == Mavlink::Attitude || frame.messageId == Mavlink::GlobalPositionInt) {
+        // Both carry time_boot_ms u32 @0. Transit is arrival minus that,
+        // offset by the unknown clock difference, which cancels out of the
+        // change between two frames.
+        const size_t stream = frame.messageId == Mavlink::Attitude ? 0 : 1;
+        const qint64 transitUs = nowUs - qint64(frame.field<uint32_t>(0)) * 1000;
+        const qint64 change = std::llabs(transitUs - health.lastTransitUs[stream]);
+        if (health.hasTransit[stream] && change < transitResetUs) {
+            smooth(health.jitterMs, double(change) / 1000.0, jitterGain);
+            if (block)
+                block->jitterBuckets[healthBucket(double(change) / 1000.0)].fetch_add(1, std::memory_order_relaxed);
+        }
+        health.hasTransit[stream] = true;
+        health.lastTransitUs[stream] = transitUs;
+    } else if (frame.messageId == Mavlink::Timesync) {
+        int requestLink = -1;
+        qint64 sentUs = 0, vehicleUs = 0;
+        if (!timesyncReply(frame, requestLink, sentUs, vehicleUs) || requestLink != link)
+            return;
+        const qint64 roundTripUs = nowUs - sentUs;
+        if (roundTripUs < 0 || roundTripUs > maxRoundTripUs)
+            return;
+        smooth(health.roundTripMs, double(roundTripUs) / 1000.0, roundTripGain);
+        if (block)
+            block->roundTripBuckets[healthBucket(double(roundTripUs) / 1000.0)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LinkManager::timesyncRequest(int systemId, int link, qint64 nowUs, uint8_t payload[timesyncPayloadSize])
+{
+    // TIMESYNC: tc1 i64 @0 (0 asks for a reply), ts1 i64 @8,
+    // target_system u8 @16, target_component u8 @17. ts1 is our clock in
+    // ns, which always ends in three zeros, so the link goes there.
+    std::memset(payload, 0, timesyncPayloadSize);
+    qToLittleEndian(qint64(nowUs * 1000 + link), payload + 8);
+    payload[16] = uint8_t(systemId);
+}
+
+bool LinkManager::timesyncReply(const Mavlink::Frame &frame, int &link, qint64 &sentUs, qint64 &vehicleUs)
+{
+    if (frame.messageId != Mavlink::Timesync || !frame.checksumVerified)
+        return false;
+    // TIMESYNC: tc1 i64 @0, ts1 i64 @8, target_system u8 @16. A reply has
+    // the vehicle's time in tc1 and our ts1 back.
+    const qint64 tc1 = frame.field<int64_t>(0);
+    const qint64 ts1 = frame.field<int64_t>(8);
+    const uint8_t target = frame.field<uint8_t>(16);
+    if (tc1 <= 0 || ts1 <= 0 || ts1 % 1000 >= maxLinks || (target != 0 && target != Mavlink::gcsSystemId))
+        return false;
+    link = int(ts1 % 1000);
+    sentUs = ts1 / 1000;
+    vehicleUs = tc1 / 1000;
+    return true;
+}
+
+void LinkManager::tick(qint64 nowMs)
+{
+    const qint64 elapsedMs = m_lastTickMs > 0 ? nowMs - m_lastTickMs : 0;
+    m_lastTickMs = nowMs;
+    for (VehicleLinks &links : m_vehicles) {
+        quint64 uniqueFrames = 0;
+        for (const LinkHealth &health : links)
+            uniqueFrames += health.firstArrivals - health.firstArrivalsAtTick;
+
+        for (LinkHealth &health : links) {
+            const quint64 received = health.received - health.receivedAtTick;
+            const quint64 lost = health.lost - health.lostAtTick;
+            const quint64 first = health.firstArrivals - health.firstArrivalsAtTick;
+            if (received + lost > 0) {
+                const double loss = 100.0 * double(lost) / double(received + lost);
+                health.lossPercent += smoothing * (loss - health.lossPercent);
+            }
+            if (uniqueFrames > 0)
+                health.firstShare += smoothing * (double(first) / double(uniqueFrames) - health.firstShare);
+            if (elapsedMs > 0) {
+                const double rate = double(health.bytes - health.bytesAtTick) * 1000.0 / double(elapsedMs);
+                health.bytesPerSecond += smoothing * (rate - health.bytesPerSecond);
+            }
+            health.receivedAtTick = health.received;
+            health.lostAtTick = health.lost;
+            health.firstArrivalsAtTick = health.firstArrivals;
+            health.bytesAtTick = health.bytes;
+        }
+    }
+}
+
+bool LinkManager::alive(const LinkHealth &health, qint64 nowMs) const
+{
+    return health.received > 0 && nowMs - health.lastSeenMs < linkTimeoutMs;
+}
+
+int LinkManager::bestLink(int systemId, qint64 nowMs) const
+{
+    const auto found = m_vehicles.constFind(systemId);
+    if (found == m_vehicles.constEnd())
+        return -1;
+
+    int best = -1;
+    for (int link = 0; link < linkCount(); ++link) {
+        const LinkHealth &health = (*found)[link];
+        if (!alive(health, nowMs))
+            continue;
+        if (best < 0) {
+            best = link;
+            continue;
+        }
+        const LinkHealth &current = (*found)[best];
+        const double lossDelta = health.lossPercent - current.lossPercent;
+        if (lossDelta < -lossTolerancePercent
+            || (lossDelta <= lossTolerancePercent && health.firstShare > current.firstShare))
+            best = link;
+    }
+    return best;
+}
+
+const LinkManager::Endpoint *LinkManager::endpoint(int systemId, int link) const
+{
+    const auto found = m_vehicles.constFind(systemId);
+    if (found == m_vehicles.constEnd() || link < 0 || link >= maxLinks || (*found)[link].received == 0)
+        return nullptr;
+    return &(*found)[link].endpoint;
+}
+
+size_t LinkManager::linkFields(int systemId, qint64 nowMs, FieldSample *samples) const
+{
+    const auto found = m_vehicles.constFind(systemId);
+    if (found == m_vehicles.constEnd())
+        return 0;
+
+    int active = 0;
+    for (const LinkHealth &health : *found)
+        active += alive(health, nowMs) ? 1 : 0;
+    const int best = bestLink(systemId, nowMs);
+
+    size_t count = 0;
+    samples[count++] = {VehicleField::ActiveLinks, double(active)};
+    samples[count++] = {VehicleField::BestLink, double(best)};
+    if (best < 0)
+        return count;
+    const LinkHealth &health = (*found)[best];
+    samples[count++] = {VehicleField::LinkLoss, health.lossPercent};
+    samples[count++] = {VehicleField::LinkThroughput, health.bytesPerSecond};
+    if (health.jitterMs >= 0)
+        samples[count++] = {VehicleField::LinkJitter, health.jitterMs};
+    if (health.roundTripMs >= 0)
+        samples[count++] = {VehicleField::LinkRoundTrip, health.roundTripMs};
+    return count;
+}
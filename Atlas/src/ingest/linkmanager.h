@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+#include <array>
+
+#include "ingest/mavlink.h"
+#include "ingest/telemetrydecoder.h"
+#include "ingest/trafficsnapshot.h"
+
+// Redundant links to the same aircraft (900 MHz radio and LTE, say) deliver
+// the same frames twice. LinkManager keeps, per sender (sysid/compid), a
+// 256-slot seen bitmap indexed by MAVLink sequence number plus the checksum
+// seen in each slot, so a duplicate is one bit test and one compare on the
+// receive path. Per-link gaps, bytes, transit jitter, TIMESYNC round trips
+// and first arrivals are measured alongside and turned into loss,
+// throughput and a best-link choice once per tick. Times are on the GCS
+// monotonic clock.
+class LinkManager
+{
+public:
+    static constexpr int maxLinks = 4;
+    static constexpr uint8_t timesyncPayloadSize = 18;
+
+    struct Endpoint
+    {
+        quint32 address = 0; // IPv4, host byte order
+        quint16 port = 0;
+    };
+
+    // -1 once maxLinks are in use.
+    int addLink(const QString &name);
+    int linkCount() const { return int(m_linkNames.size()); }
+    QString linkName(int link) const { return m_linkNames.value(link); }
+    // Where the link's totals and histograms go; the traffic snapshot's
+    // block, so the UI can sample them. Optional.
+    void setHealthBlock(int link, TrafficSnapshot::LinkHealth *block);
+
+    // True for the first copy of a frame, false for a duplicate that
+    // already arrived over another link (or twice over this one). Every
+    // copy counts towards the statistics of the link it came in on.
+    bool accept(int link, const Mavlink::Frame &frame, const Endpoint &sender, qint64 nowUs);
+
+    // Folds the counters since the last tick into per-link loss and
+    // throughput.
+    void tick(qint64 nowMs);
+
+    // TIMESYNC request to send to a vehicle on link; its ts1 names the link
+    // so the reply is timed against the link it went out on.
+    static void timesyncRequest(int systemId, int link, qint64 nowUs, uint8_t payload[timesyncPayloadSize]);
+    // Unpacks a reply to one of those: the link and our send time it
+    // echoes, and the vehicle's clock when it answered, in µs.
+    static bool timesyncReply(const Mavlink::Frame &frame, int &link, qint64 &sentUs, qint64 &vehicleUs);
+
+    // Link to send to systemId on, or -1 if none has heard from it lately.
+    int bestLink(int systemId, qint64 nowMs) const;
+    const Endpoint *endpoint(int systemId, int link) const;
+    QList<int> systemIds() const { return m_vehicles.keys(); }
+
+    // ActiveLinks, BestLink and the best link's loss, jitter, round trip
+    // and throughput for the traffic snapshot.
+    size_t linkFields(int systemId, qint64 nowMs, FieldSample *samples) const;
+
+private:
+    struct LinkSequence
+    {
+        bool started = false;
+        quint8 last = 0;
+    };
+
+    struct Sender
+    {
+        bool started = false;
+        quint8 head = 0; // newest sequence number seen
+        std::array<quint64, 4> seen = {};
+        std::array<quint16, 256> checksums = {};
+        std::array<LinkSequence, maxLinks> links;
+    };
+
+    struct LinkHealth
+    {
+        Endpoint endpoint;
+        qint64 lastSeenMs = 0;
+        quint64 received = 0;
+        quint64 lost = 0;
+        quint64 firstArrivals = 0;
+        // Snapshot at the last tick and what it yielded.
+        quint64 receivedAtTick = 0;
+        quint64 lostAtTick = 0;
+        quint64 firstArrivalsAtTick = 0;
+        double lossPercent = 0;
+        double firstShare = 0; // of this vehicle's unique frames, last tick
+        quint64 bytes = 0;
+        quint64 bytesAtTick = 0;
+        double bytesPerSecond = 0;
+        // RFC 3550 interarrival jitter over the autopilot's time_boot_ms,
+        // one transit baseline per timestamped message.
+        std::array<qint64, 2> lastTransitUs = {};
+        std::array<bool, 2> hasTransit = {};
+        double jitterMs = -1; // -1 until measured
+        double roundTripMs = -1;
+    };
+
+    using VehicleLinks = std::array<LinkHealth, maxLinks>;
+
+    static bool isDuplicate(Sender &sender, quint8 sequence, quint16 checksum);
+    bool alive(const LinkHealth &health, qint64 nowMs) const;
+    void measure(int link, LinkHealth &health, const Mavlink::Frame &frame, qint64 nowUs);
+
+    QStringList m_linkNames;
+    std::array<TrafficSnapshot::LinkHealth *, maxLinks> m_healthBlocks = {};
+    qint64 m_lastTickMs = 0;
+    QHash<quint16, Sender> m_senders;       // (sysid << 8) | compid
+    QHash<int, VehicleLinks> m_vehicles;    // by sysid
+};
@@ -0,0 +1,66 @@
+#include "linksigning.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+constexpr uint64_t unixEpochTo2015Seconds = 1420070400;
+// A stream we have not heard from may open up to a minute in the past
+// (MAVLink signing spec); older is a replay of a capture.
+constexpr uint64_t newStreamWindow = 60 * 100000;
+
+} // namespace
+
+void LinkSigning::setKey(const Key &key, uint8_t linkId)
+{
+    m_key = key;
+    m_linkId = linkId;
+    m_enabled = true;
+}
+
+uint64_t LinkSigning::timestampNow()
+{
+    const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    const uint64_t micros = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count());
+    return micros / 10 - unixEpochTo2015Seconds * 100000;
+}
+
+LinkSigning::Verdict LinkSigning::verify(const Mavlink::Frame &frame, uint64_t now)
+{
+    if (!m_enabled)
+        return Verdict::Accepted;
+    if (!frame.isSigned())
+        return Verdict::Unsigned;
+    // The signature first, so forged frames cannot move the replay window.
+    if (!Mavlink::signatureValid(frame, m_key.data()))
+        return Verdict::BadSignature;
+
+    const uint64_t timestamp = frame.signatureTimestamp();
+    const uint32_t stream = uint32_t(frame.signatureLinkId()) << 16 | uint32_t(frame.systemId) << 8
+                            | frame.componentId;
+    const auto found = m_streams.find(stream);
+    if (found == m_streams.end()) {
+        if (timestamp + newStreamWindow < now)
+            return Verdict::Replayed;
+        m_streams.emplace(stream, timestamp);
+    } else {
+        if (timestamp <= found->second)
+            return Verdict::Replayed;
+        found->second = timestamp;
+    }
+    // Never sign behind a peer whose clock runs ahead of ours.
+    m_lastSent = std::max(m_lastSent, timestamp);
+    return Verdict::Accepted;
+}
+
+size_t LinkSigning::encode(uint8_t *out, uint8_t sequence, uint8_t systemId, uint8_t componentId,
+                           uint32_t messageId, const uint8_t *payload, uint8_t payloadLength, uint64_t now)
+{
+    if (!m_enabled)
+        return Mavlink::encode(out, sequence, systemId, componentId, messageId, payload, payloadLength);
+    // Strictly increasing, even for several frames within 10 µs.
+    m_lastSent = std::max(m_lastSent + 1, now);
+    return Mavlink::encodeSigned(out, sequence, systemId, componentId, messageId, payload, payloadLength,
+                                 m_key.data(), m_linkId, m_lastSent);
+}
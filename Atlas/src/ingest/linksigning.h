@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+#include "ingest/mavlink.h"
+
+// MAVLink 2 signing for one link: its secret key, the newest timestamp
+// seen per (link id, sysid, compid) stream, and the timestamp frames we
+// send carry. Checked in the transport, straight after framing, so an
+// unsigned, forged or replayed frame never reaches deduplication, the
+// decoders or the log. A link without a key passes everything.
+class LinkSigning
+{
+public:
+    enum class Verdict { Accepted, Unsigned, BadSignature, Replayed };
+
+    using Key = std::array<uint8_t, Mavlink::signingKeySize>;
+
+    void setKey(const Key &key, uint8_t linkId);
+    bool enabled() const { return m_enabled; }
+
+    Verdict verify(const Mavlink::Frame &frame, uint64_t now);
+
+    // Signed with this link's key when enabled, plain encode() otherwise.
+    size_t encode(uint8_t *out, uint8_t sequence, uint8_t systemId, uint8_t componentId, uint32_t messageId,
+                  const uint8_t *payload, uint8_t payloadLength, uint64_t now);
+
+    // The current time as a signing timestamp (10 µs since 2015-01-01).
+    static uint64_t timestampNow();
+
+private:
+    Key m_key = {};
+    bool m_enabled = false;
+    uint8_t m_linkId = 0;
+    uint64_t m_lastSent = 0;
+    std::unordered_map<uint32_t, uint64_t> m_streams; // (link id << 16) | (sysid << 8) | compid
+};
@@ -0,0 +1,237 @@
+#include "mavlink.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "ingest/sha256.h"
+
+namespace Mavlink {
+
+namespace {
+
+struct MessageInfo
+{
+    uint32_t messageId;
+    uint8_t crcExtra;
+};
+
+// Sorted by message id.
+constexpr MessageInfo knownMessages[] = {
+    {Heartbeat, 50},
+    {SysStatus, 124},
+    {SystemTime, 137},
+    {Ping, 237},
+    {Attitude, 39},
+    {GlobalPositionInt, 104},
+    {VfrHud, 20},
+    {CommandLong, 152},
+    {CommandAck, 143},
+    {Timesync, 34},
+    {BatteryStatus, 154},
+    {Vibration, 90},
+};
+
+constexpr uint8_t noField = 0xFF;
+
+struct TargetInfo
+{
+    uint32_t messageId;
+    uint8_t systemOffset;
+    uint8_t componentOffset; // noField if the message has none
+};
+
+// Payload offsets of target_system/target_component in common.xml
+// messages a ground station sends or answers with. Sorted by message id.
+constexpr TargetInfo targetedMessages[] = {
+    {4, 12, 13},       // PING
+    {11, 4, noField},  // SET_MODE
+    {20, 2, 3},        // PARAM_REQUEST_READ
+    {21, 0, 1},        // PARAM_REQUEST_LIST
+    {23, 4, 5},        // PARAM_SET
+    {39, 32, 33},      // MISSION_ITEM
+    {40, 2, 3},        // MISSION_REQUEST
+    {41, 2, 3},        // MISSION_SET_CURRENT
+    {43, 0, 1},        // MISSION_REQUEST_LIST
+    {44, 2, 3},        // MISSION_COUNT
+    {45, 0, 1},        // MISSION_CLEAR_ALL
+    {47, 0, 1},        // MISSION_ACK
+    {51, 2, 3},        // MISSION_REQUEST_INT
+    {66, 2, 3},        // REQUEST_DATA_STREAM
+    {69, 10, noField}, // MANUAL_CONTROL
+    {70, 16, 17},      // RC_CHANNELS_OVERRIDE
+    {73, 32, 33},      // MISSION_ITEM_INT
+    {75, 30, 31},      // COMMAND_INT
+    {76, 30, 31},      // COMMAND_LONG
+    {77, 8, 9},        // COMMAND_ACK (extension fields)
+    {84, 50, 51},      // SET_POSITION_TARGET_LOCAL_NED
+    {86, 50, 51},      // SET_POSITION_TARGET_GLOBAL_INT
+    {110, 1, 2},       // FILE_TRANSFER_PROTOCOL
+    {111, 16, 17},     // TIMESYNC (extension fields)
+    {117, 4, 5},       // LOG_REQUEST_LIST
+    {119, 10, 11},     // LOG_REQUEST_DATA
+    {123, 0, 1},       // GPS_INJECT_DATA
+};
+
+// The first 48 bits of SHA-256 over the key and everything in the frame
+// up to the signature: header, payload, checksum, link id and timestamp.
+void computeSignature(const uint8_t *key, const uint8_t *data, size_t size, uint8_t *signature)
+{
+    Sha256 hash;
+    hash.update(key, signingKeySize);
+    hash.update(data, size);
+    uint8_t digest[Sha256::digestSize];
+    hash.finish(digest);
+    std::memcpy(signature, digest, 6);
+}
+
+size_t encodeFrame(uint8_t *out, uint8_t sequence, uint8_t systemId, uint8_t componentId, uint32_t messageId,
+                   const uint8_t *payload, uint8_t payloadLength, uint8_t incompatFlags)
+{
+    uint8_t extra;
+    if (!crcExtra(messageId, extra))
+        return 0;
+
+    // MAVLink 2 drops trailing zero bytes, keeping at least one.
+    while (payloadLength > 1 && payload[payloadLength - 1] == 0)
+        --payloadLength;
+
+    out[0] = v2Magic;
+    out[1] = payloadLength;
+    out[2] = incompatFlags;
+    out[3] = 0; // compat flags
+    out[4] = sequence;
+    out[5] = systemId;
+    out[6] = componentId;
+    out[7] = uint8_t(messageId);
+    out[8] = uint8_t(messageId >> 8);
+    out[9] = uint8_t(messageId >> 16);
+    std::memcpy(out + v2HeaderSize, payload, payloadLength);
+    const size_t checked = v2HeaderSize + payloadLength;
+    const uint16_t checksum = crcAccumulate(extra, crc(out + 1, checked - 1));
+    out[checked] = uint8_t(checksum);
+    out[checked + 1] = uint8_t(checksum >> 8);
+    return checked + checksumSize;
+}
+
+} // namespace
+
+uint16_t crcAccumulate(uint8_t byte, uint16_t crc)
+{
+    uint8_t tmp = byte ^ uint8_t(crc & 0xFF);
+    tmp ^= uint8_t(tmp << 4);
+    return uint16_t((crc >> 8) ^ (uint16_t(tmp) << 8) ^ (uint16_t(tmp) << 3) ^ (tmp >> 4));
+}
+
+uint16_t crc(const uint8_t *data, size_t size, uint16_t crc)
+{
+    for (size_t i = 0; i < size; ++i)
+        crc = crcAccumulate(data[i], crc);
+    return crc;
+}
+
+bool crcExtra(uint32_t messageId, uint8_t &extra)
+{
+    const auto found = std::lower_bound(std::begin(knownMessages), std::end(knownMessages), messageId,
+                                        [](const MessageInfo &info, uint32_t id) { return info.messageId < id; });
+    if (found == std::end(knownMessages) || found->messageId != messageId)
+        return false;
+    extra = found->crcExtra;
+    return true;
+}
+
+bool target(const Frame &frame, uint8_t &system, uint8_t &component)
+{
+    const auto found = std::lower_bound(std::begin(targetedMessages), std::end(targetedMessages),
+                                        frame.messageId,
+                                        [](const TargetInfo &info, uint32_t id) { return info.messageId < id; });
+    if (found == std::end(targetedMessages) || found->messageId != frame.messageId)
+        return false;
+    system = frame.field<uint8_t>(found->systemOffset);
+    component = found->componentOffset == noField ? 0 : frame.field<uint8_t>(found->componentOffset);
+    return true;
+}
+
+FrameResult readFrame(const uint8_t *data, size_t size, Frame &frame)
+{
+    if (size < 2)
+        return FrameResult::Incomplete;
+
+    size_t headerSize;
+    if (data[0] == v2Magic) {
+        headerSize = v2HeaderSize;
+        if (size < headerSize)
+            return FrameResult::Incomplete;
+        frame.version = 2;
+        frame.incompatFlags = data[2];
+        // Flags we do not understand mean we cannot parse the frame at all.
+        if ((frame.incompatFlags & ~incompatSigned) != 0)
+            return FrameResult::Invalid;
+        frame.sequence = data[4];
+        frame.systemId = data[5];
+        frame.componentId = data[6];
+        frame.messageId = uint32_t(data[7]) | (uint32_t(data[8]) << 8) | (uint32_t(data[9]) << 16);
+    } else if (data[0] == v1Magic) {
+        headerSize = v1HeaderSize;
+        if (size < headerSize)
+            return FrameResult::Incomplete;
+        frame.version = 1;
+        frame.incompatFlags = 0;
+        frame.sequence = data[2];
+        frame.systemId = data[3];
+        frame.componentId = data[4];
+        frame.messageId = data[5];
+    } else {
+        return FrameResult::Invalid;
+    }
+
+    frame.payloadLength = data[1];
+    frame.size = headerSize + frame.payloadLength + checksumSize + (frame.isSigned() ? signatureSize : 0);
+    if (size < frame.size)
+        return FrameResult::Incomplete;
+    frame.data = data;
+    frame.payload = data + headerSize;
+
+    uint8_t extra;
+    frame.checksumVerified = crcExtra(frame.messageId, extra);
+    if (frame.checksumVerified) {
+        const size_t checked = headerSize + frame.payloadLength;
+        const uint16_t expected = crcAccumulate(extra, crc(data + 1, checked - 1));
+        const uint16_t actual = uint16_t(data[checked] | (data[checked + 1] << 8));
+        if (expected != actual)
+            return FrameResult::Invalid;
+    }
+    return FrameResult::Complete;
+}
+
+size_t encode(uint8_t *out, uint8_t sequence, uint8_t systemId, uint8_t componentId, uint32_t messageId,
+              const uint8_t *payload, uint8_t payloadLength)
+{
+    return encodeFrame(out, sequence, systemId, componentId, messageId, payload, payloadLength, 0);
+}
+
+size_t encodeSigned(uint8_t *out, uint8_t sequence, uint8_t systemId, uint8_t componentId, uint32_t messageId,
+                    const uint8_t *payload, uint8_t payloadLength, const uint8_t *key, uint8_t linkId,
+                    uint64_t timestamp)
+{
+    // The signed flag is covered by the checksum, so it is set up front.
+    const size_t size = encodeFrame(out, sequence, systemId, componentId, messageId, payload, payloadLength,
+                                    incompatSigned);
+    if (size == 0)
+        return 0;
+    out[size] = linkId;
+    for (int i = 0; i < 6; ++i)
+        out[size + 1 + i] = uint8_t(timestamp >> (8 * i));
+    computeSignature(key, out, size + 7, out + size + 7);
+    return size + signatureSize;
+}
+
+bool signatureValid(const Frame &frame, const uint8_t *key)
+{
+    if (!frame.isSigned())
+        return false;
+    uint8_t signature[6];
+    computeSignature(key, frame.data, frame.size - 6, signature);
+    return std::memcmp(signature, frame.data + frame.size - 6, 6) == 0;
+}
+
+} // namespace Mavlink
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Just enough MAVLink to frame, verify and decode the messages Atlas uses,
+// without the generated headers. Frames are views into the receive buffer;
+// nothing is copied until a decoder reads a field. Kept free of Qt like
+// CsvScanner so the daemon's hot path stays plain C++.
+namespace Mavlink {
+
+constexpr uint8_t v1Magic = 0xFE;
+constexpr uint8_t v2Magic = 0xFD;
+constexpr uint8_t incompatSigned = 0x01;
+constexpr size_t v1HeaderSize = 6;
+constexpr size_t v2HeaderSize = 10;
+constexpr size_t checksumSize = 2;
+constexpr size_t signatureSize = 13;
+constexpr size_t maxFrameSize = v2HeaderSize + 255 + checksumSize + signatureSize;
+constexpr size_t signingKeySize = 32;
+
+// Atlas identifies as a ground station when it originates traffic.
+constexpr uint8_t gcsSystemId = 255;
+constexpr uint8_t gcsComponentId = 190;
+
+enum MessageId : uint32_t {
+    Heartbeat = 0,
+    SysStatus = 1,
+    SystemTime = 2,
+    Ping = 4,
+    Attitude = 30,
+    GlobalPositionInt = 33,
+    VfrHud = 74,
+    CommandLong = 76,
+    CommandAck = 77,
+    Timesync = 111,
+    BatteryStatus = 147,
+    Vibration = 241,
+};
+
+struct Frame
+{
+    const uint8_t *data = nullptr; // magic through checksum (and signature)
+    size_t size = 0;
+    uint8_t version = 0;           // 1 or 2
+    uint8_t incompatFlags = 0;
+    uint8_t sequence = 0;
+    uint8_t systemId = 0;
+    uint8_t componentId = 0;
+    uint32_t messageId = 0;
+    const uint8_t *payload = nullptr;
+    uint8_t payloadLength = 0;
+    bool checksumVerified = false; // false for messages without a known CRC_EXTRA
+
+    bool isSigned() const { return (incompatFlags & incompatSigned) != 0; }
+
+    uint16_t checksum() const
+    {
+        const uint8_t *p = data + size - checksumSize - (isSigned() ? signatureSize : 0);
+        return uint16_t(p[0] | (p[1] << 8));
+    }
+
+    // Signature block of a signed frame: link id, then a 48-bit timestamp
+    // in 10 µs units since 2015-01-01, then the signature itself.
+    uint8_t signatureLinkId() const { return data[size - signatureSize]; }
+    uint64_t signatureTimestamp() const
+    {
+        const uint8_t *p = data + size - signatureSize + 1;
+        uint64_t timestamp = 0;
+        for (int i = 5; i >= 0; --i)
+            timestamp = (timestamp << 8) | p[i];
+        return timestamp;
+    }
+
+    // Little-endian field at offset. MAVLink 2 truncates trailing zero
+    // bytes, so anything past payloadLength reads as zero.
+    template<typename T>
+    T field(size_t offset) const
+    {
+        uint8_t bytes[sizeof(T)] = {};
+        if (offset < payloadLength)
+            std::memcpy(bytes, payload + offset, offset + sizeof(T) <= payloadLength ? sizeof(T)
+                                                                                     : payloadLength - offset);
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+};
+
+struct ParseStats
+{
+    uint64_t frames = 0;
+    uint64_t checksumErrors = 0;
+    uint64_t skippedBytes = 0;
+};
+
+// X.25 CRC as used by MAVLink.
+uint16_t crcAccumulate(uint8_t byte, uint16_t crc);
+uint16_t crc(const uint8_t *data, size_t size, uint16_t crc = 0xFFFF);
+
+// CRC_EXTRA seed for messageId; false for messages Atlas does not know.
+bool crcExtra(uint32_t messageId, uint8_t &extra);
+
+// target_system/target_component of a message addressed to one system.
+// False for broadcast messages (telemetry, and ids missing from the table);
+// a target of 0 also means everyone.
+bool target(const Frame &frame, uint8_t &system, uint8_t &component);
+
+enum class FrameResult { Complete, Incomplete, Invalid };
+
+// Tries to read one frame starting at data[0], which must be a magic byte.
+FrameResult readFrame(const uint8_t *data, size_t size, Frame &frame);
+
+// Calls onFrame(const Frame &) for every valid frame in [data, data + size)
+// and returns the number of bytes consumed. A frame cut off at the end is
+// left unconsumed for stream transports; datagram transports drop it.
+template<typename OnFrame>
+size_t parse(const uint8_t *data, size_t size, OnFrame &&onFrame, ParseStats *stats = nullptr)
+{
+    size_t pos = 0;
+    while (pos < size) {
+        if (data[pos] != v1Magic && data[pos] != v2Magic) {
+            const void *next = std::memchr(data + pos, v2Magic, size - pos);
+            const void *nextV1 = std::memchr(data + pos, v1Magic, size - pos);
+            if (!next || (nextV1 && nextV1 < next))
+                next = nextV1;
+            const size_t skipTo = next ? size_t(static_cast<const uint8_t *>(next) - data) : size;
+            if (stats)
+                stats->skippedBytes += skipTo - pos;
+            pos = skipTo;
+            continue;
+        }
+
+        Frame frame;
+        switch (readFrame(data + pos, size - pos, frame)) {
+        case FrameResult::Complete:
+            if (stats)
+                ++stats->frames;
+            onFrame(frame);
+            pos += frame.size;
+            break;
+        case FrameResult::Incomplete:
+            return pos;
+        case FrameResult::Invalid:
+            // Resynchronise on the next magic byte.
+            if (stats) {
+                ++stats->checksumErrors;
+                ++stats->skippedBytes;
+            }
+            ++pos;
+            break;
+        }
+    }
+    return pos;
+}
+
+// Writes an unsigned MAVLink 2 frame into out (at least maxFrameSize bytes)
+// and returns its size, or 0 if messageId has no known CRC_EXTRA.
+size_t encode(uint8_t *out, uint8_t sequence, uint8_t systemId, uint8_t componentId, uint32_t messageId,
+              const uint8_t *payload, uint8_t payloadLength);
+
+// encode(), signed with key (signingKeySize bytes) as linkId at timestamp.
+size_t encodeSigned(uint8_t *out, uint8_t sequence, uint8_t systemId, uint8_t componentId, uint32_t messageId,
+                    const uint8_t *payload, uint8_t payloadLength, const uint8_t *key, uint8_t linkId,
+                    uint64_t timestamp);
+
+// True if a signed frame's signature was made with key.
+bool signatureValid(const Frame &frame, const uint8_t *key);
+
+} // namespace Mavlink
@@ -0,0 +1,302 @@
+#include "mavlinkrouter.h"
+
+#include <QHostAddress>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "diagnostics/metrics.h"
+
+namespace {
+
+// Token buckets refill on the steady clock, so a wall-clock step can
+// neither stall a capped endpoint nor hand it a burst.
+qint64 steadyNowMs()
+{
+    const auto sinceBoot = std::chrono::steady_clock::now().time_since_epoch();
+    return qint64(std::chrono::duration_cast<std::chrono::milliseconds>(sinceBoot).count());
+}
+
+// "name=host:port", or "host:port" named after itself.
+bool parseTarget(const QString &token, MavlinkRouter::EndpointConfig &config)
+{
+    const qsizetype equals = token.indexOf(QLatin1Char('='));
+    const QString target = equals < 0 ? token : token.mid(equals + 1);
+    config.name = equals < 0 ? token : token.left(equals);
+
+    const qsizetype colon = target.lastIndexOf(QLatin1Char(':'));
+    bool ok = false;
+    const uint port = target.mid(colon + 1).toUInt(&ok);
+    if (colon < 0 || !ok || port == 0 || port > 65535)
+        return false;
+    config.port = quint16(port);
+    config.address = QHostAddress(target.left(colon)).toIPv4Address(&ok);
+    return ok && !config.name.isEmpty();
+}
+
+bool parseMessageIds(const QString &list, std::vector<uint32_t> &ids)
+{
+    for (const QString &id : list.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const uint value = id.toUInt(&ok);
+        if (!ok || value > 0xFFFFFF)
+            return false;
+        ids.push_back(value);
+    }
+    std::sort(ids.begin(), ids.end());
+    return !ids.empty();
+}
+
+bool parseOption(const QString &token, MavlinkRouter::EndpointConfig &config)
+{
+    const QString key = token.section(QLatin1Char('='), 0, 0);
+    const QString value = token.section(QLatin1Char('='), 1);
+    if (key == QLatin1String("rate")) {
+        bool ok = false;
+        config.rateLimit = value.toDouble(&ok);
+        return ok && config.rateLimit >= 0;
+    }
+    // only= and drop= are exclusive; one list per endpoint.
+    if ((key == QLatin1String("only") || key == QLatin1String("drop")) && config.messageIds.empty()) {
+        config.allowList = key == QLatin1String("only");
+        return parseMessageIds(value, config.messageIds);
+    }
+    return false;
+}
+
+bool passesFilter(const MavlinkRouter::EndpointConfig &config, uint32_t messageId)
+{
+    if (config.messageIds.empty())
+        return true;
+    return std::binary_search(config.messageIds.begin(), config.messageIds.end(), messageId) == config.allowList;
+}
+
+} // namespace
+
+std::vector<MavlinkRouter::EndpointConfig> MavlinkRouter::parseEndpoints(const QString &spec, QStringList *errors)
+{
+    std::vector<EndpointConfig> configs;
+    for (const QString &entry : spec.split(QLatin1Char(';'), Qt::SkipEmptyParts)) {
+        const QStringList tokens = entry.simplified().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        if (tokens.isEmpty())
+            continue;
+        EndpointConfig config;
+        bool ok = parseTarget(tokens.first(), config);
+        for (qsizetype i = 1; ok && i < tokens.size(); ++i)
+            ok = parseOption(tokens[i], config);
+        if (ok)
+            configs.push_back(std::move(config));
+        else if (errors)
+            errors->append(entry.trimmed());
+    }
+    return configs;
+}
+
+MavlinkRouter::MavlinkRouter(QObject *parent)
+    : QObject(parent)
+{}
+
+MavlinkRouter::~MavlinkRouter() = default;
+
+void MavlinkRouter::addEndpoint(const EndpointConfig &config)
+{
+    auto endpoint = std::make_unique<Endpoint>();
+    endpoint->config = config;
+    endpoint->tokens = config.rateLimit;
+    const QByteArray name = "endpoint=\"" + config.name.toUtf8() + '"';
+    endpoint->forwarded = Metrics::counter("atlas_router_forwarded_total",
+                                           "Frames the router sent to an endpoint.", name);
+    const QByteArray droppedHelp = "Frames the router did not send to an endpoint, by reason.";
+    endpoint->filtered = Metrics::counter("atlas_router_dropped_total", droppedHelp, name + ",reason=\"filter\"");
+    endpoint->rateLimited = Metrics::counter("atlas_router_dropped_total", droppedHelp, name + ",reason=\"rate\"");
+    endpoint->overflowed = Metrics::counter("atlas_router_dropped_total", droppedHelp, name + ",reason=\"queue\"");
+    m_endpoints.push_back(std::move(endpoint));
+}
+
+bool MavlinkRouter::setEndpoints(const std::vector<EndpointConfig> &configs, QString *error)
+{
+    std::vector<std::unique_ptr<Endpoint>> previous = std::move(m_endpoints);
+    m_endpoints.clear();
+    for (const EndpointConfig &config : configs) {
+        addEndpoint(config);
+        Endpoint &endpoint = *m_endpoints.back();
+        for (const auto &old : previous) {
+            if (old->config.name == config.name && old->config.address == config.address
+                && old->config.port == config.port) {
+                endpoint.systems = old->systems;
+                endpoint.components = old->components;
+                break;
+            }
+        }
+    }
+    for (const auto &old : previous) {
+        for (size_t i = 0; i < old->queued; ++i)
+            release(old->queue[(old->queueHead + i) % queueSize]);
+    }
+    previous.clear(); // closes the old sockets
+    return !m_started || start(error);
+}
+
+bool MavlinkRouter::start(QString *error)
+{
+    m_started = true;
+    for (size_t index = 0; index < m_endpoints.size(); ++index) {
+        Endpoint &endpoint = *m_endpoints[index];
+        // An ephemeral port: the peer sees us as a client, as it would
+        // behind mavlink-router.
+        auto socket = std::make_unique<UdpReceiver>();
+        if (!socket->bind(0)) {
+            *error = endpoint.config.name + QStringLiteral(": ") + QString::fromStdString(socket->errorString());
+            return false;
+        }
+        endpoint.readNotifier = std::make_unique<QSocketNotifier>(socket->descriptor(), QSocketNotifier::Read);
+        connect(endpoint.readNotifier.get(), &QSocketNotifier::activated, this, [this, index] {
+            readEndpoint(index);
+        });
+        endpoint.writeNotifier = std::make_unique<QSocketNotifier>(socket->descriptor(), QSocketNotifier::Write);
+        endpoint.writeNotifier->setEnabled(false);
+        connect(endpoint.writeNotifier.get(), &QSocketNotifier::activated, this, [this, index] {
+            flushEndpoint(*m_endpoints[index]);
+        });
+        endpoint.socket = std::move(socket);
+    }
+    return true;
+}
+
+void MavlinkRouter::routeFromVehicle(const Mavlink::Frame &frame, qint64 nowMs)
+{
+    uint8_t targetSystem = 0;
+    uint8_t targetComponent = 0;
+    Mavlink::target(frame, targetSystem, targetComponent);
+    route(frame, -1, targetSystem, targetComponent, nowMs);
+}
+
+void MavlinkRouter::readEndpoint(size_t index)
+{
+    Endpoint &endpoint = *m_endpoints[index];
+    const qint64 nowMs = steadyNowMs();
+    endpoint.socket->drain([&](const UdpReceiver::Datagram &datagram) {
+        // Only the configured peer may inject traffic toward the aircraft.
+        if (datagram.address != endpoint.config.address || datagram.port != endpoint.config.port)
+            return;
+        Mavlink::parse(datagram.data, datagram.size, [&](const Mavlink::Frame &frame) {
+            endpoint.systems.set(frame.systemId);
+            endpoint.components.set((frame.systemId << 8) | frame.componentId);
+
+            uint8_t targetSystem = 0;
+            uint8_t targetComponent = 0;
+            Mavlink::target(frame, targetSystem, targetComponent);
+            route(frame, int(index), targetSystem, targetComponent, nowMs);
+            if (m_vehicleSink)
+                m_vehicleSink(frame, targetSystem);
+        });
+    });
+    flush();
+}
+
+void MavlinkRouter::route(const Mavlink::Frame &frame, int source, uint8_t targetSystem, uint8_t targetComponent,
+                          qint64 nowMs)
+{
+    Packet *packet = nullptr;
+    for (size_t index = 0; index < m_endpoints.size(); ++index) {
+        Endpoint &endpoint = *m_endpoints[index];
+        if (int(index) == source || !endpoint.socket)
+            continue;
+        if (targetSystem != 0
+            && (!endpoint.systems.test(targetSystem)
+                || (targetComponent != 0 && !endpoint.components.test((targetSystem << 8) | targetComponent))))
+            continue;
+        if (!passesFilter(endpoint.config, frame.messageId)) {
+            endpoint.filtered->increment();
+            continue;
+        }
+        if (!takeToken(endpoint, frame.messageId, nowMs)) {
+            endpoint.rateLimited->increment();
+            continue;
+        }
+        if (endpoint.queued == queueSize) {
+            endpoint.overflowed->increment();
+            continue;
+        }
+        if (!packet)
+            packet = acquire(frame);
+        ++packet->references;
+        endpoint.queue[(endpoint.queueHead + endpoint.queued++) % queueSize] = packet;
+    }
+}
+
+bool MavlinkRouter::takeToken(Endpoint &endpoint, uint32_t messageId, qint64 nowMs)
+{
+    // Heartbeats are exempt so a capped endpoint still sees every vehicle.
+    const double rate = endpoint.config.rateLimit;
+    if (rate <= 0 || messageId == Mavlink::Heartbeat)
+        return true;
+    const qint64 elapsedMs = std::max<qint64>(0, nowMs - endpoint.refilledMs);
+    endpoint.tokens = std::min(rate, endpoint.tokens + rate * double(elapsedMs) / 1000.0);
+    endpoint.refilledMs = std::max(endpoint.refilledMs, nowMs);
+    if (endpoint.tokens < 1)
+        return false;
+    endpoint.tokens -= 1;
+    return true;
+}
+
+void MavlinkRouter::flush()
+{
+    for (const auto &endpoint : m_endpoints) {
+        if (endpoint->queued > 0)
+            flushEndpoint(*endpoint);
+    }
+}
+
+void MavlinkRouter::flushEndpoint(Endpoint &endpoint)
+{
+    const uint8_t *data[UdpReceiver::batchSize];
+    size_t sizes[UdpReceiver::batchSize];
+    while (endpoint.queued > 0) {
+        const int count = int(std::min(endpoint.queued, size_t(UdpReceiver::batchSize)));
+        for (int i = 0; i < count; ++i) {
+            const Packet *packet = endpoint.queue[(endpoint.queueHead + size_t(i)) % queueSize];
+            data[i] = packet->data;
+            sizes[i] = packet->size;
+        }
+        const int sent = endpoint.socket->sendBatch(data, sizes, count, endpoint.config.address,
+                                                    endpoint.config.port);
+        for (int i = 0; i < sent; ++i)
+            release(endpoint.queue[(endpoint.queueHead + size_t(i)) % queueSize]);
+        endpoint.queueHead = (endpoint.queueHead + size_t(sent)) % queueSize;
+        endpoint.queued -= size_t(sent);
+        endpoint.forwarded->increment(quint64(sent));
+        if (sent < count)
+            break;
+    }
+    // A full socket buffer is retried once the socket drains.
+    endpoint.writeNotifier->setEnabled(endpoint.queued > 0);
+}
+
+MavlinkRouter::Packet *MavlinkRouter::acquire(const Mavlink::Frame &frame)
+{
+    if (!m_freePackets) {
+        // Never shrinks; bounded by the endpoint queues.
+        m_packetChunks.push_back(std::make_unique<Packet[]>(packetsPerChunk));
+        Packet *chunk = m_packetChunks.back().get();
+        for (size_t i = 0; i < packetsPerChunk; ++i) {
+            chunk[i].next = m_freePackets;
+            m_freePackets = &chunk[i];
+        }
+    }
+    Packet *packet = m_freePackets;
+    m_freePackets = packet->next;
+    packet->references = 0;
+    packet->size = quint16(frame.size);
+    std::memcpy(packet->data, frame.data, frame.size);
+    return packet;
+}
+
+void MavlinkRouter::release(Packet *packet)
+{
+    if (--packet->references == 0) {
+        packet->next = m_freePackets;
+        m_freePackets = packet;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QObject>
+#include <QSocketNotifier>
+#include <QStringList>
+
+#include <array>
+#include <bitset>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ingest/mavlink.h"
+#include "ingest/udpreceiver.h"
+
+class MetricCounter;
+
+// Forwards the vehicles' traffic to other ground stations and analytics
+// tools over UDP, and their traffic back, so no separate mavlink-router
+// runs beside Atlas. Each endpoint learns which sysid/compid pairs sit
+// behind it from what it sends; a frame addressed to one system goes only
+// where that system was seen, anything else goes everywhere but its
+// source. A frame is copied once into a reference-counted packet however
+// many endpoint queues take it, and queues go out in sendmmsg batches.
+class MavlinkRouter : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct EndpointConfig
+    {
+        QString name;
+        quint32 address = 0; // IPv4, host byte order
+        quint16 port = 0;
+        double rateLimit = 0;             // frames per second, 0 = unlimited
+        std::vector<uint32_t> messageIds; // sorted
+        bool allowList = false;           // forward only messageIds, else all but them
+    };
+
+    // Parses the routerEndpoints setting:
+    //   "observer=10.0.0.7:14550 rate=20 drop=22,253; qgc=127.0.0.1:14560 only=0,30,33"
+    // Entries that do not parse are left out and appended to errors.
+    static std::vector<EndpointConfig> parseEndpoints(const QString &spec, QStringList *errors = nullptr);
+
+    // Receives frames from endpoints that are meant for the vehicles, with
+    // their target system or 0 for all of them.
+    using VehicleSink = std::function<void(const Mavlink::Frame &frame, int targetSystem)>;
+
+    explicit MavlinkRouter(QObject *parent = nullptr);
+    ~MavlinkRouter() override;
+
+    void setVehicleSink(VehicleSink sink) { m_vehicleSink = std::move(sink); }
+
+    // Call before start().
+    void addEndpoint(const EndpointConfig &config);
+    // Replaces every endpoint, before or after start(). An endpoint that
+    // keeps its name and address keeps the systems it learned; frames still
+    // queued for the old sockets are dropped. False with error set if a new
+    // socket cannot be bound.
+    bool setEndpoints(const std::vector<EndpointConfig> &configs, QString *error);
+    int endpointCount() const { return int(m_endpoints.size()); }
+
+    // Binds every endpoint's socket. False with error set if one fails.
+    bool start(QString *error);
+
+    // A unique frame from a vehicle, nowMs on the steady clock. Only queued;
+    // call flush() once the receive batch is done.
+    void routeFromVehicle(const Mavlink::Frame &frame, qint64 nowMs);
+    void flush();
+
+private:
+    static constexpr size_t queueSize = 512;
+    static constexpr size_t packetsPerChunk = 256;
+
+    struct Packet
+    {
+        Packet *next = nullptr; // free list
+        quint32 references = 0;
+        quint16 size = 0;
+        uint8_t data[Mavlink::maxFrameSize];
+    };
+
+    struct Endpoint
+    {
+        EndpointConfig config;
+        std::unique_ptr<UdpReceiver> socket;
+        std::unique_ptr<QSocketNotifier> readNotifier;
+        std::unique_ptr<QSocketNotifier> writeNotifier;
+        // Routing table, learned from the frames this endpoint sends.
+        std::bitset<256> systems;
+        std::bitset<65536> components; // (sysid << 8) | compid
+        // Rate cap as a token bucket holding one second's worth.
+        double tokens = 0;
+        qint64 refilledMs = 0;
+        std::array<Packet *, queueSize> queue = {};
+        size_t queueHead = 0;
+        size_t queued = 0;
+        MetricCounter *forwarded = nullptr;
+        MetricCounter *filtered = nullptr;
+        MetricCounter *rateLimited = nullptr;
+        MetricCounter *overflowed = nullptr;
+    };
+
+    void readEndpoint(size_t index);
+    void route(const Mavlink::Frame &frame, int source, uint8_t targetSystem, uint8_t targetComponent,
+               qint64 nowMs);
+    static bool takeToken(Endpoint &endpoint, uint32_t messageId, qint64 nowMs);
+    void flushEndpoint(Endpoint &endpoint);
+    Packet *acquire(const Mavlink::Frame &frame);
+    void release(Packet *packet);
+
+    std::vector<std::unique_ptr<Endpoint>> m_endpoints;
+    std::vector<std::unique_ptr<Packet[]>> m_packetChunks;
+    Packet *m_freePackets = nullptr;
+    VehicleSink m_vehicleSink;
+    bool m_started = false;
+};
@@ -0,0 +1,239 @@
+#include "pictureserver.h"
+
+#include <QCryptographicHash>
+#include <QTcpSocket>
+#include <QtEndian>
+
+#include "diagnostics/metrics.h"
+
+namespace {
+
+constexpr qsizetype maxHandshakeSize = 8192;
+constexpr quint64 maxIncomingPayload = 4096; // clients only send control frames
+constexpr qint64 maxBacklog = 1 << 20;        // queued bytes before a client is skipped
+
+enum Opcode : quint8 {
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xA,
+};
+
+QByteArray frame(quint8 opcode, const QByteArray &payload)
+{
+    QByteArray out;
+    const qsizetype size = payload.size();
+    out.reserve(size + 10);
+    out.append(char(0x80 | opcode)); // FIN, never fragmented
+    if (size < 126) {
+        out.append(char(size));
+    } else if (size <= 0xFFFF) {
+        out.append(char(126));
+        out.append(char(size >> 8));
+        out.append(char(size));
+    } else {
+        out.append(char(127));
+        for (int shift = 56; shift >= 0; shift -= 8)
+            out.append(char(quint64(size) >> shift));
+    }
+    out.append(payload);
+    return out;
+}
+
+QByteArray headerValue(const QList<QByteArray> &lines, const QByteArray &name)
+{
+    for (const QByteArray &line : lines) {
+        const qsizetype colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == name)
+            return line.mid(colon + 1).trimmed();
+    }
+    return {};
+}
+
+MetricGauge *clientGauge()
+{
+    static MetricGauge *const gauge = Metrics::gauge(
+        "atlas_picture_clients", "WebSocket clients receiving the traffic picture.");
+    return gauge;
+}
+
+} // namespace
+
+PictureServer::PictureServer(SubscriptionHub &hub, QObject *parent)
+    : QObject(parent)
+    , m_hub(hub)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &PictureServer::acceptClients);
+}
+
+PictureServer::~PictureServer()
+{
+    if (m_subscriptionId)
+        m_hub.unsubscribe(m_subscriptionId);
+}
+
+bool PictureServer::listen(const QHostAddress &address, quint16 port, QString *error)
+{
+    if (!m_server.listen(address, port)) {
+        *error = QStringLiteral("picture server: ") + m_server.errorString();
+        return false;
+    }
+    return true;
+}
+
+void PictureServer::acceptClients()
+{
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_clients.insert(socket, Client());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket] { readClient(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket] { removeClient(socket); });
+    }
+}
+
+void PictureServer::readClient(QTcpSocket *socket)
+{
+    const auto found = m_clients.find(socket);
+    if (found == m_clients.end())
+        return;
+    Client &client = *found;
+    client.received.append(socket->readAll());
+    const bool ok = client.open ? readFrames(socket, client) : handshake(socket, client);
+    if (!ok)
+        socket->disconnectFromHost();
+}
+
+bool PictureServer::handshake(QTcpSocket *socket, Client &client)
+{
+    const qsizetype end = client.received.indexOf("\r\n\r\n");
+    if (end < 0)
+        return client.received.size() < maxHandshakeSize;
+
+    const QList<QByteArray> lines = client.received.left(end).split('\n');
+    const QByteArray key = headerValue(lines, "sec-websocket-key");
+    if (!lines.first().startsWith("GET ") || headerValue(lines, "upgrade").toLower() != "websocket"
+        || key.isEmpty()) {
+        socket->write("HTTP/1.1 426 Upgrade Required\r\nUpgrade: websocket\r\nContent-Length: 0\r\n\r\n");
+        return false;
+    }
+
+    const QByteArray accept = QCryptographicHash::hash(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11",
+                                                       QCryptographicHash::Sha1)
+                                  .toBase64();
+    socket->write("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: "
+                  + accept + "\r\n\r\n");
+    client.received.remove(0, end + 4);
+    client.open = true;
+    clientGauge()->set(++m_openClients);
+
+    if (m_subscriptionId) {
+        sendSnapshot(socket);
+    } else {
+        // The first viewer starts the tier; subscribe() hands everyone,
+        // this client included, the full state through broadcast().
+        SubscriptionHub::Subscription subscription;
+        subscription.rateHz = rateHz;
+        subscription.quantized = true;
+        m_subscriptionId = m_hub.subscribe(subscription, [this](const QByteArray &message) { broadcast(message); });
+    }
+    return readFrames(socket, client);
+}
+
+bool PictureServer::readFrames(QTcpSocket *socket, Client &client)
+{
+    for (;;) {
+        const QByteArray &data = client.received;
+        if (data.size() < 2)
+            return true;
+        const quint8 opcode = quint8(data[0]) & 0x0F;
+        const bool masked = quint8(data[1]) & 0x80;
+        quint64 length = quint8(data[1]) & 0x7F;
+        qsizetype offset = 2;
+        if (length == 126) {
+            if (data.size() < 4)
+                return true;
+            length = qFromBigEndian<quint16>(data.constData() + 2);
+            offset = 4;
+        } else if (length == 127) {
+            if (data.size() < 10)
+                return true;
+            length = qFromBigEndian<quint64>(data.constData() + 2);
+            offset = 10;
+        }
+        // Client frames must be masked (RFC 6455 5.1).
+        if (!masked || length > maxIncomingPayload)
+            return false;
+        if (data.size() < offset + 4 + qsizetype(length))
+            return true;
+
+        const char *mask = data.constData() + offset;
+        QByteArray payload = data.mid(offset + 4, qsizetype(length));
+        for (qsizetype i = 0; i < payload.size(); ++i)
+            payload[i] = char(payload[i] ^ mask[i % 4]);
+        client.received.remove(0, offset + 4 + qsizetype(length));
+
+        if (opcode == Close) {
+            socket->write(frame(Close, payload.left(2)));
+            return false;
+        }
+        if (opcode == Ping)
+            socket->write(frame(Pong, payload));
+        // Anything else from a viewer is ignored.
+    }
+}
+
+void PictureServer::removeClient(QTcpSocket *socket)
+{
+    const auto found = m_clients.find(socket);
+    if (found == m_clients.end())
+        return;
+    if (found->open)
+        clientGauge()->set(--m_openClients);
+    m_clients.erase(found);
+    socket->deleteLater();
+
+    // Nobody watching: stop encoding the tier.
+    if (m_openClients == 0 && m_subscriptionId) {
+        m_hub.unsubscribe(m_subscriptionId);
+        m_subscriptionId = 0;
+    }
+}
+
+void PictureServer::broadcast(const QByteArray &message)
+{
+    static MetricCounter *const sentBytes = Metrics::counter(
+        "atlas_picture_sent_bytes_total", "Bytes of traffic picture queued to WebSocket clients.");
+    static MetricCounter *const resyncs = Metrics::counter(
+        "atlas_picture_resyncs_total", "Times a slow WebSocket client was skipped and later resent a snapshot.");
+
+    const QByteArray framed = frame(Binary, message);
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        if (!it->open)
+            continue;
+        QTcpSocket *socket = it.key();
+        if (it->resync) {
+            if (socket->bytesToWrite() > 0)
+                continue;
+            it->resync = false;
+            resyncs->increment();
+            sendSnapshot(socket);
+            continue; // the snapshot already holds this delta
+        }
+        if (socket->bytesToWrite() > maxBacklog) {
+            // A delta it cannot apply in order is worse than none; drop
+            // the rest until it catches up.
+            it->resync = true;
+            continue;
+        }
+        // Queued by reference where the write buffer allows it.
+        socket->write(framed);
+        sentBytes->increment(quint64(framed.size()));
+    }
+}
+
+void PictureServer::sendSnapshot(QTcpSocket *socket)
+{
+    for (const QByteArray &message : m_hub.snapshot(m_subscriptionId))
+        socket->write(frame(Binary, message));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+
+#include "ingest/subscriptionhub.h"
+
+class QTcpSocket;
+
+// The live traffic picture over WebSocket for wall displays and tablets
+// that do not run Atlas. Every client gets the same stream: one quantized
+// 10 Hz SubscriptionHub tier, sent as binary messages in the hub's ATSU
+// format, a full-state message first and then deltas of the fields that
+// moved. Each message is framed once and the same buffer is queued on
+// every socket. A client that falls behind is skipped until its socket
+// drains and then resynchronised with a fresh snapshot. Only as much of
+// RFC 6455 as a server needs: the upgrade, unfragmented binary frames out,
+// close and ping in.
+class PictureServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int rateHz = 10;
+
+    explicit PictureServer(SubscriptionHub &hub, QObject *parent = nullptr);
+    ~PictureServer() override;
+
+    bool listen(const QHostAddress &address, quint16 port, QString *error);
+
+private:
+    struct Client
+    {
+        QByteArray received; // handshake, then partial frames
+        bool open = false;
+        bool resync = false;
+    };
+
+    void acceptClients();
+    void readClient(QTcpSocket *socket);
+    bool handshake(QTcpSocket *socket, Client &client);
+    bool readFrames(QTcpSocket *socket, Client &client);
+    void removeClient(QTcpSocket *socket);
+    void broadcast(const QByteArray &message);
+    void sendSnapshot(QTcpSocket *socket);
+
+    SubscriptionHub &m_hub;
+    QTcpServer m_server;
+    QHash<QTcpSocket *, Client> m_clients;
+    int m_subscriptionId = 0; // while any client is open
+    int m_openClients = 0;
+};
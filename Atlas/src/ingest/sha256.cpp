@@ -0,0 +1,197 @@
+#include "sha256.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ATLAS_SHA_NI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+alignas(16) constexpr uint32_t roundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr uint32_t initialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+inline uint32_t rotr(uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+void compressPortable(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    for (; blocks > 0; --blocks, data += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i)
+            w[i] = uint32_t(data[4 * i]) << 24 | uint32_t(data[4 * i + 1]) << 16 | uint32_t(data[4 * i + 2]) << 8
+                   | uint32_t(data[4 * i + 3]);
+        for (int i = 16; i < 64; ++i) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g))
+                                + roundConstants[i] + w[i];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef ATLAS_SHA_NI
+// The SHA extensions keep the state as ABEF/CDGH halves and take four
+// rounds' worth of message and constants per pair of sha256rnds2.
+__attribute__((target("sha,sse4.1"))) void compressShaNi(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0]));
+    __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4]));
+    const __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+    const __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; blocks > 0; --blocks, data += 64) {
+        const __m128i abefStart = abef;
+        const __m128i cdghStart = cdgh;
+        __m128i message[4];
+        for (int i = 0; i < 4; ++i)
+            message[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16 * i)),
+                                          byteSwap);
+
+        // Unrolled, the schedule stays in registers.
+#pragma GCC unroll 16
+        for (int group = 0; group < 16; ++group) {
+            __m128i words = _mm_add_epi32(
+                message[group & 3], _mm_load_si128(reinterpret_cast<const __m128i *>(&roundConstants[4 * group])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, words);
+            if (group < 12) {
+                // Schedule the words four groups ahead into the slot just used.
+                __m128i next = _mm_sha256msg1_epu32(message[group & 3], message[(group + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(message[(group + 3) & 3], message[(group + 2) & 3], 4));
+                message[group & 3] = _mm_sha256msg2_epu32(next, message[(group + 3) & 3]);
+            }
+            words = _mm_shuffle_epi32(words, 0x0E);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, words);
+        }
+        abef = _mm_add_epi32(abef, abefStart);
+        cdgh = _mm_add_epi32(cdgh, cdghStart);
+    }
+
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    dcba = _mm_blend_epi16(feba, dchg, 0xF0);
+    hgfe = _mm_alignr_epi8(dchg, feba, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), dcba);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), hgfe);
+}
+
+bool cpuHasShaNi()
+{
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1))
+        return false;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 29)); // SHA
+}
+#endif
+
+using Compress = void (*)(uint32_t *, const uint8_t *, size_t);
+
+Compress selectCompress()
+{
+#ifdef ATLAS_SHA_NI
+    if (cpuHasShaNi())
+        return compressShaNi;
+#endif
+    return compressPortable;
+}
+
+const Compress compress = selectCompress();
+
+} // namespace
+
+Sha256::Sha256()
+{
+    std::memcpy(m_state, initialState, sizeof(m_state));
+}
+
+bool Sha256::hardwareAccelerated()
+{
+    return compress != compressPortable;
+}
+
+void Sha256::update(const uint8_t *data, size_t size)
+{
+    m_length += size;
+    if (m_buffered > 0) {
+        const size_t take = size < 64 - m_buffered ? size : 64 - m_buffered;
+        std::memcpy(m_buffer + m_buffered, data, take);
+        m_buffered += take;
+        data += take;
+        size -= take;
+        if (m_buffered < 64)
+            return;
+        compress(m_state, m_buffer, 1);
+        m_buffered = 0;
+    }
+    if (size >= 64) {
+        compress(m_state, data, size / 64);
+        data += size & ~size_t(63);
+        size &= 63;
+    }
+    std::memcpy(m_buffer, data, size);
+    m_buffered = size;
+}
+
+void Sha256::finish(uint8_t digest[digestSize])
+{
+    const uint64_t bits = m_length * 8;
+    m_buffer[m_buffered++] = 0x80;
+    if (m_buffered > 56) {
+        std::memset(m_buffer + m_buffered, 0, 64 - m_buffered);
+        compress(m_state, m_buffer, 1);
+        m_buffered = 0;
+    }
+    std::memset(m_buffer + m_buffered, 0, 56 - m_buffered);
+    for (int i = 0; i < 8; ++i)
+        m_buffer[56 + i] = uint8_t(bits >> (56 - 8 * i));
+    compress(m_state, m_buffer, 1);
+
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = uint8_t(m_state[i] >> 24);
+        digest[4 * i + 1] = uint8_t(m_state[i] >> 16);
+        digest[4 * i + 2] = uint8_t(m_state[i] >> 8);
+        digest[4 * i + 3] = uint8_t(m_state[i]);
+    }
+}
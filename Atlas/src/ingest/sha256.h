@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// SHA-256 for MAVLink 2 signing. Blocks go through the x86 SHA extensions
+// when the CPU has them (checked once at startup) and a portable
+// implementation otherwise; a signed frame is at most five blocks, so
+// per-call overhead matters more than bulk throughput. No Qt, like the
+// rest of the receive path.
+class Sha256
+{
+public:
+    static constexpr size_t digestSize = 32;
+
+    Sha256();
+
+    void update(const uint8_t *data, size_t size);
+    void finish(uint8_t digest[digestSize]);
+
+    static bool hardwareAccelerated();
+
+private:
+    uint32_t m_state[8];
+    uint64_t m_length = 0;
+    uint8_t m_buffer[64];
+    size_t m_buffered = 0;
+};
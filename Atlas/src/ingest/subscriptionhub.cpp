@@ -0,0 +1,358 @@
+#include "subscriptionhub.h"
+
+#include <QDateTime>
+#include <QtAlgorithms>
+#include <QtEndian>
+
+#include <algorithm>
+
+#include "diagnostics/metrics.h"
+
+namespace {
+
+constexpr int timerIntervalMs = 20; // the fastest tier
+constexpr FieldMask allFields = FieldMask(~FieldMask(0) >> (32 - VehicleFieldCount));
+
+template<typename T>
+void append(QByteArray &out, T value)
+{
+    const qsizetype at = out.size();
+    out.resize(at + qsizetype(sizeof(T)));
+    qToLittleEndian(value, out.data() + at);
+}
+
+// Units per VehicleField unit: 1e-7° for positions, decimetres, tenths of a
+// degree, cm/s, centivolts, centiamperes, cm/s².
+constexpr std::array<double, VehicleFieldCount> quantizationScales = {
+    1e7, // Latitude
+    1e7, // Longitude
+    10,  // AltitudeMsl
+    10,  // AltitudeRelative
+    10,  // Heading
+    100, // GroundSpeed
+    100, // ClimbRate
+    10,  // Roll
+    10,  // Pitch
+    10,  // Yaw
+    1,   // BatteryRemaining
+    100, // BatteryVoltage
+    1,   // FlightMode
+    1,   // Armed
+    1,   // ActiveLinks
+    1,   // BestLink
+    10,  // LinkLoss
+    10,  // LinkJitter
+    10,  // LinkRoundTrip
+    1,   // LinkThroughput
+    100, // BatteryCurrent
+    100, // Vibration
+};
+
+// Largest record: sysid, a 32-bit mask as a varint, a 64-bit varint per field.
+constexpr size_t maxRecordSize = 1 + 5 + 10 * VehicleFieldCount;
+
+size_t putVarint(uint8_t *out, quint64 value)
+{
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = uint8_t(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = uint8_t(value);
+    return size;
+}
+
+bool sameRegion(const SubscriptionHub::Region &a, const SubscriptionHub::Region &b)
+{
+    return a.south == b.south && a.west == b.west && a.north == b.north && a.east == b.east;
+}
+
+MetricGauge *tierGauge()
+{
+    static MetricGauge *const gauge = Metrics::gauge(
+        "atlas_subscription_tiers", "Distinct telemetry subscription tiers being encoded.");
+    return gauge;
+}
+
+MetricGauge *subscriberGauge()
+{
+    static MetricGauge *const gauge = Metrics::gauge(
+        "atlas_subscription_subscribers", "Remote telemetry subscribers across all tiers.");
+    return gauge;
+}
+
+} // namespace
+
+SubscriptionHub::SubscriptionHub(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(timerIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &SubscriptionHub::emitDue);
+}
+
+SubscriptionHub::~SubscriptionHub() = default;
+
+int SubscriptionHub::tierRate(double rateHz)
+{
+    // Rounded down, so nobody gets more than they asked for.
+    int rate = rateTiers.front();
+    for (const int tier : rateTiers) {
+        if (tier <= rateHz)
+            rate = tier;
+    }
+    return rate;
+}
+
+double SubscriptionHub::quantizationScale(VehicleField field)
+{
+    return quantizationScales[size_t(field)];
+}
+
+int SubscriptionHub::subscribe(const Subscription &subscription, Sink sink)
+{
+    const int rateHz = tierRate(subscription.rateHz);
+    const FieldMask fields = subscription.fields ? subscription.fields & allFields : allFields;
+    QList<int> systemIds = subscription.systemIds;
+    std::sort(systemIds.begin(), systemIds.end());
+    systemIds.erase(std::unique(systemIds.begin(), systemIds.end()), systemIds.end());
+
+    Tier *tier = nullptr;
+    for (const auto &candidate : m_tiers) {
+        if (candidate->rateHz == rateHz && candidate->fields == fields && candidate->systemIds == systemIds
+            && candidate->hasRegion == subscription.hasRegion
+            && (!subscription.hasRegion || sameRegion(candidate->region, subscription.region))
+            && candidate->quantized == subscription.quantized) {
+            tier = candidate.get();
+            break;
+        }
+    }
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    if (!tier) {
+        auto created = std::make_unique<Tier>();
+        created->rateHz = rateHz;
+        created->fields = fields;
+        created->systemIds = systemIds;
+        created->hasRegion = subscription.hasRegion;
+        created->region = subscription.region;
+        created->quantized = subscription.quantized;
+        created->dueMs = nowMs + 1000 / rateHz;
+        created->keyframeDueMs = nowMs + keyframeIntervalMs;
+        tier = created.get();
+        m_tiers.push_back(std::move(created));
+    }
+
+    // Start from the full picture instead of waiting for every field to
+    // change once. A new tier's first subscriber is all of it, so that
+    // counts as a keyframe.
+    const Encoding encoding = tier->subscribers.isEmpty() ? Encoding::Keyframe : Encoding::Snapshot;
+    for (const QByteArray &datagram : encode(*tier, encoding, nowMs))
+        sink(datagram);
+
+    const int id = m_nextId++;
+    tier->subscribers.insert(id, std::move(sink));
+    m_subscriptionTiers.insert(id, tier);
+    if (!m_timer.isActive())
+        m_timer.start();
+    tierGauge()->set(qint64(m_tiers.size()));
+    subscriberGauge()->set(m_subscriptionTiers.size());
+    return id;
+}
+
+void SubscriptionHub::unsubscribe(int id)
+{
+    Tier *tier = m_subscriptionTiers.take(id);
+    if (!tier)
+        return;
+    tier->subscribers.remove(id);
+    if (tier->subscribers.isEmpty()) {
+        m_tiers.erase(std::find_if(m_tiers.begin(), m_tiers.end(),
+                                   [tier](const std::unique_ptr<Tier> &candidate) { return candidate.get() == tier; }));
+    }
+    if (m_tiers.empty())
+        m_timer.stop();
+    tierGauge()->set(qint64(m_tiers.size()));
+    subscriberGauge()->set(m_subscriptionTiers.size());
+}
+
+QList<QByteArray> SubscriptionHub::snapshot(int id)
+{
+    Tier *tier = m_subscriptionTiers.value(id);
+    return tier ? encode(*tier, Encoding::Snapshot, QDateTime::currentMSecsSinceEpoch()) : QList<QByteArray>();
+}
+
+void SubscriptionHub::update(int systemId, const FieldSample *samples, size_t count)
+{
+    Vehicle &vehicle = m_vehicles[systemId];
+    FieldMask changed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const FieldMask bit = fieldBit(samples[i].field);
+        double &value = vehicle.values[size_t(samples[i].field)];
+        if (!(vehicle.known & bit) || value != samples[i].value) {
+            value = samples[i].value;
+            changed |= bit;
+        }
+    }
+    vehicle.known |= changed;
+    if (changed == 0)
+        return;
+    // Values are held once for every tier; a tier only tracks which of
+    // them it still owes its subscribers.
+    for (const auto &tier : m_tiers) {
+        if (const FieldMask fields = changed & tier->fields)
+            tier->dirty[systemId] |= fields;
+    }
+}
+
+void SubscriptionHub::emitDue()
+{
+    static MetricCounter *const encodedBytes = Metrics::counter(
+        "atlas_subscription_encoded_bytes_total", "Bytes of tier updates encoded, once per tier.");
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (const auto &tier : m_tiers) {
+        if (nowMs < tier->dueMs)
+            continue;
+        // Keep to the tier's period; after a stall, resume rather than
+        // catch up.
+        const int periodMs = 1000 / tier->rateHz;
+        tier->dueMs += periodMs;
+        if (tier->dueMs <= nowMs)
+            tier->dueMs = nowMs + periodMs;
+        Encoding encoding = Encoding::Delta;
+        if (nowMs >= tier->keyframeDueMs) {
+            encoding = Encoding::Keyframe;
+            tier->keyframeDueMs = nowMs + keyframeIntervalMs;
+        } else if (tier->dirty.isEmpty()) {
+            continue;
+        }
+
+        const QList<QByteArray> datagrams = encode(*tier, encoding, nowMs);
+        tier->dirty.clear();
+        for (const QByteArray &datagram : datagrams) {
+            encodedBytes->increment(quint64(datagram.size()));
+            for (const Sink &sink : std::as_const(tier->subscribers))
+                sink(datagram);
+        }
+    }
+}
+
+bool SubscriptionHub::inScope(const Tier &tier, int systemId, const Vehicle &vehicle) const
+{
+    if (!tier.systemIds.isEmpty() && !std::binary_search(tier.systemIds.begin(), tier.systemIds.end(), systemId))
+        return false;
+    if (!tier.hasRegion)
+        return true;
+    // Vehicles without a fix yet are outside every region.
+    const FieldMask position = fieldBit(VehicleField::Latitude) | fieldBit(VehicleField::Longitude);
+    if ((vehicle.known & position) != position)
+        return false;
+    const double latitude = vehicle.values[size_t(VehicleField::Latitude)];
+    const double longitude = vehicle.values[size_t(VehicleField::Longitude)];
+    const Region &region = tier.region;
+    const bool inLongitude = region.west <= region.east
+                                 ? longitude >= region.west && longitude <= region.east
+                                 : longitude >= region.west || longitude <= region.east; // across 180°
+    return latitude >= region.south && latitude <= region.north && inLongitude;
+}
+
+QList<QByteArray> SubscriptionHub::encode(Tier &tier, Encoding encoding, qint64 nowMs)
+{
+    QList<QByteArray> datagrams;
+    QByteArray datagram;
+    quint16 records = 0;
+    const auto finish = [&] {
+        if (records > 0) {
+            qToLittleEndian(records, datagram.data() + 6);
+            datagrams.append(datagram);
+        }
+        datagram.clear();
+        records = 0;
+    };
+    const bool delta = encoding == Encoding::Delta;
+    const quint8 flags = (delta ? 0 : flagFullState) | (tier.quantized ? flagQuantized : 0);
+
+    const auto addRecord = [&](int systemId, FieldMask fields) {
+        const auto found = m_vehicles.constFind(systemId);
+        if (found == m_vehicles.constEnd())
+            return;
+        const Vehicle &vehicle = *found;
+        fields &= tier.fields & vehicle.known;
+        if (fields == 0 || !inScope(tier, systemId, vehicle))
+            return;
+
+        uint8_t record[maxRecordSize];
+        size_t size = 0;
+        record[size++] = uint8_t(systemId);
+        if (tier.quantized) {
+            std::array<qint64, VehicleFieldCount> quantized;
+            // Everyone in the tier sees a delta or keyframe, so both move
+            // what the tier has sent on. A snapshot only reaches one
+            // subscriber: a field it shows differently from what the rest
+            // were last sent is made dirty and forgotten, so the next delta
+            // sends it to everyone and they all agree again. Otherwise the
+            // value could go back to what was sent before, be left out of the
+            // delta, and the newcomer would keep the snapshot's.
+            SentValues &sent = tier.sent[systemId];
+            for (int field = 0; field < VehicleFieldCount; ++field) {
+                const FieldMask bit = fieldBit(VehicleField(field));
+                if (!(fields & bit))
+                    continue;
+                quantized[size_t(field)] = qRound64(vehicle.values[size_t(field)] * quantizationScales[size_t(field)]);
+                const bool unchanged = (sent.known & bit) && sent.values[size_t(field)] == quantized[size_t(field)];
+                if (encoding == Encoding::Snapshot) {
+                    if (!unchanged) {
+                        tier.dirty[systemId] |= bit;
+                        sent.known &= ~bit;
+                    }
+                } else if (delta && unchanged) {
+                    fields &= ~bit;
+                } else {
+                    sent.values[size_t(field)] = quantized[size_t(field)];
+                    sent.known |= bit;
+                }
+            }
+            if (fields == 0)
+                return;
+            size += putVarint(record + size, fields);
+            for (int field = 0; field < VehicleFieldCount; ++field) {
+                if (fields & fieldBit(VehicleField(field))) {
+                    const qint64 value = quantized[size_t(field)];
+                    size += putVarint(record + size, (quint64(value) << 1) ^ quint64(value >> 63));
+                }
+            }
+        } else {
+            qToLittleEndian(quint32(fields), record + size);
+            size += 4;
+            for (int field = 0; field < VehicleFieldCount; ++field) {
+                if (fields & fieldBit(VehicleField(field))) {
+                    qToLittleEndian(vehicle.values[size_t(field)], record + size);
+                    size += 8;
+                }
+            }
+        }
+
+        if (!datagram.isEmpty() && size_t(datagram.size()) + size > size_t(maxDatagramSize))
+            finish();
+        if (datagram.isEmpty()) {
+            datagram.reserve(maxDatagramSize);
+            append<quint32>(datagram, magic);
+            append<quint8>(datagram, version);
+            append<quint8>(datagram, flags);
+            append<quint16>(datagram, 0); // records, filled in by finish()
+            append<qint64>(datagram, nowMs);
+        }
+        datagram.append(reinterpret_cast<const char *>(record), qsizetype(size));
+        ++records;
+    };
+
+    if (delta) {
+        for (auto it = tier.dirty.cbegin(); it != tier.dirty.cend(); ++it)
+            addRecord(it.key(), it.value());
+    } else {
+        for (auto it = m_vehicles.cbegin(); it != m_vehicles.cend(); ++it)
+            addRecord(it.key(), allFields);
+    }
+    finish();
+    return datagrams;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ingest/telemetrydecoder.h"
+#include "state/vehiclestate.h"
+
+// Decimated telemetry for remote consumers on thin links. A subscription
+// names a rate, a field set and optionally the vehicles or a lat/lon box it
+// wants. Rates are rounded down to a fixed ladder, and subscriptions that
+// then ask for the same thing share a tier: the tier remembers which fields
+// changed since it last went out, and once per period encodes one update
+// (newest value per field) that every subscriber in it is handed as the
+// same implicitly shared QByteArray. Encoding work and buffers follow the
+// number of tiers; a subscriber only adds its send.
+//
+// Update datagrams, little-endian:
+//   u32 magic "ATSU", u8 version, u8 flags (1 = full state, 2 = quantized),
+//   u16 records, i64 timestamp ms, then per record: u8 sysid, u32 field
+//   mask (bit N = VehicleField N), f64 per set bit in field order.
+// Quantized tiers write the mask as a LEB128 varint and each field as a
+// zigzag varint of round(value * quantizationScale(field)), and a delta
+// leaves out fields whose quantized value has not moved since the tier
+// last sent it. Every keyframeIntervalMs a tier sends its full state in
+// place of the delta, so a consumer that lost a datagram, or the one field
+// it carried, is whole again within that time.
+class SubscriptionHub : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr std::array<int, 6> rateTiers = {1, 2, 5, 10, 25, 50}; // Hz
+    static constexpr quint32 magic = 0x55535441; // "ATSU"
+    static constexpr quint8 version = 1;
+    static constexpr quint8 flagFullState = 1;
+    static constexpr quint8 flagQuantized = 2;
+    static constexpr int maxDatagramSize = 1200; // under any tunnel's MTU
+    static constexpr int keyframeIntervalMs = 5000;
+
+    struct Region
+    {
+        double south = 0;
+        double west = 0;
+        double north = 0;
+        double east = 0;
+    };
+
+    struct Subscription
+    {
+        double rateHz = 1;
+        FieldMask fields = 0;  // 0 = every field
+        QList<int> systemIds;  // empty = every vehicle
+        bool hasRegion = false;
+        Region region;         // vehicles whose last position is inside
+        bool quantized = false;
+    };
+
+    using Sink = std::function<void(const QByteArray &datagram)>;
+
+    explicit SubscriptionHub(QObject *parent = nullptr);
+    ~SubscriptionHub() override;
+
+    // The sink gets the current state straight away, then updates at the
+    // tier's rate. Returns an id for unsubscribe().
+    int subscribe(const Subscription &subscription, Sink sink);
+    void unsubscribe(int id);
+    int tierCount() const { return int(m_tiers.size()); }
+
+    // Full state encoded for id's tier, for a consumer that fans one
+    // subscription out and has a newcomer to bring up to date. Fields it
+    // shows differently from the tier's last update go out again in the
+    // next one, so the newcomer and the rest stay in step.
+    QList<QByteArray> snapshot(int id);
+
+    // Called for every decoded frame; marks the fields dirty in each tier
+    // that carries them.
+    void update(int systemId, const FieldSample *samples, size_t count);
+
+    static int tierRate(double rateHz);
+    static double quantizationScale(VehicleField field);
+
+private:
+    struct Vehicle
+    {
+        std::array<double, VehicleFieldCount> values = {};
+        FieldMask known = 0;
+    };
+
+    struct SentValues
+    {
+        std::array<qint64, VehicleFieldCount> values = {};
+        FieldMask known = 0;
+    };
+
+    struct Tier
+    {
+        int rateHz = 0;
+        FieldMask fields = 0;
+        QList<int> systemIds; // sorted
+        bool hasRegion = false;
+        Region region;
+        bool quantized = false;
+        qint64 dueMs = 0;
+        qint64 keyframeDueMs = 0;
+        QHash<int, FieldMask> dirty; // by sysid
+        QHash<int, Sink> subscribers; // by subscription id
+        QHash<int, SentValues> sent;  // quantized tiers, by sysid
+    };
+
+    enum class Encoding
+    {
+        Delta,    // the tier's dirty fields its subscribers have not seen
+        Keyframe, // every known field, to every subscriber
+        Snapshot, // every known field, to one subscriber
+    };
+
+    void emitDue();
+    bool inScope(const Tier &tier, int systemId, const Vehicle &vehicle) const;
+    // Records for every in-scope vehicle, split into datagrams.
+    QList<QByteArray> encode(Tier &tier, Encoding encoding, qint64 nowMs);
+
+    QHash<int, Vehicle> m_vehicles;
+    std::vector<std::unique_ptr<Tier>> m_tiers;
+    QHash<int, Tier *> m_subscriptionTiers;
+    QTimer m_timer;
+    int m_nextId = 1;
+};
@@ -0,0 +1,184 @@
+#include "subscriptionserver.h"
+
+#include <QDateTime>
+#include <QList>
+
+#include "diagnostics/metrics.h"
+
+namespace {
+
+constexpr qint64 peerTimeoutMs = 30000;
+constexpr int expiryIntervalMs = 5000;
+
+bool parseField(const QByteArray &name, FieldMask &fields)
+{
+    for (int field = 0; field < VehicleFieldCount; ++field) {
+        if (name == vehicleFieldName(VehicleField(field))) {
+            fields |= fieldBit(VehicleField(field));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Compares every byte, so the time taken says nothing about how much of a
+// guess was right.
+bool sameSecret(const QByteArray &a, const QByteArray &b)
+{
+    if (a.size() != b.size())
+        return false;
+    char difference = 0;
+    for (qsizetype i = 0; i < a.size(); ++i)
+        difference |= char(a[i] ^ b[i]);
+    return difference == 0;
+}
+
+} // namespace
+
+SubscriptionServer::SubscriptionServer(SubscriptionHub &hub, QObject *parent)
+    : QObject(parent)
+    , m_hub(hub)
+{
+    m_expiryTimer.setInterval(expiryIntervalMs);
+    connect(&m_expiryTimer, &QTimer::timeout, this, &SubscriptionServer::expirePeers);
+}
+
+SubscriptionServer::~SubscriptionServer()
+{
+    for (const Peer &peer : std::as_const(m_peers))
+        m_hub.unsubscribe(peer.subscriptionId);
+}
+
+bool SubscriptionServer::listen(const QHostAddress &address, quint16 port, const QByteArray &secret,
+                                QString *error)
+{
+    bool ipv4 = false;
+    const quint32 interfaceAddress = address.toIPv4Address(&ipv4);
+    if (!ipv4) {
+        *error = QStringLiteral("subscriptions: %1 is not an IPv4 address").arg(address.toString());
+        return false;
+    }
+    if (secret.isEmpty() && !address.isLoopback()) {
+        *error = QStringLiteral("subscriptions: listening on %1 needs a secret").arg(address.toString());
+        return false;
+    }
+    m_secret = secret;
+    auto socket = std::make_unique<UdpReceiver>();
+    if (!socket->bind(port, interfaceAddress)) {
+        *error = QStringLiteral("subscriptions: ") + QString::fromStdString(socket->errorString());
+        return false;
+    }
+    m_notifier = std::make_unique<QSocketNotifier>(socket->descriptor(), QSocketNotifier::Read);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &SubscriptionServer::readRequests);
+    m_socket = std::move(socket);
+    m_expiryTimer.start();
+    return true;
+}
+
+bool SubscriptionServer::parseRequest(const QByteArray &request, SubscriptionHub::Subscription &subscription,
+                                      QByteArray *key)
+{
+    for (const QByteArray &token : request.simplified().split(' ')) {
+        const qsizetype equals = token.indexOf('=');
+        if (equals <= 0)
+            return false;
+        const QByteArray name = token.left(equals);
+        const QList<QByteArray> values = token.mid(equals + 1).split(',');
+        bool ok = true;
+        if (name == "rate") {
+            subscription.rateHz = values.first().toDouble(&ok);
+        } else if (name == "fields") {
+            for (const QByteArray &value : values)
+                ok = ok && parseField(value, subscription.fields);
+        } else if (name == "vehicles") {
+            for (const QByteArray &value : values) {
+                bool parsed = false;
+                const int systemId = value.toInt(&parsed);
+                ok = ok && parsed && systemId >= 1 && systemId <= 255;
+                subscription.systemIds.append(systemId);
+            }
+        } else if (name == "key") {
+            if (key)
+                *key = token.mid(equals + 1);
+        } else if (name == "quantized") {
+            subscription.quantized = values.first() == "1";
+        } else if (name == "region" && values.size() == 4) {
+            bool parsed[4];
+            subscription.region = {values[0].toDouble(&parsed[0]), values[1].toDouble(&parsed[1]),
+                                   values[2].toDouble(&parsed[2]), values[3].toDouble(&parsed[3])};
+            subscription.hasRegion = true;
+            ok = parsed[0] && parsed[1] && parsed[2] && parsed[3]
+                 && subscription.region.south <= subscription.region.north;
+        } else {
+            ok = false;
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+void SubscriptionServer::readRequests()
+{
+    m_socket->drain([this](const UdpReceiver::Datagram &datagram) {
+        handleRequest(datagram.address, datagram.port,
+                      QByteArray(reinterpret_cast<const char *>(datagram.data), qsizetype(datagram.size)));
+    });
+}
+
+void SubscriptionServer::handleRequest(quint32 address, quint16 port, const QByteArray &request)
+{
+    static MetricCounter *const sentBytes = Metrics::counter(
+        "atlas_subscription_sent_bytes_total", "Bytes of tier updates sent to UDP subscribers.");
+    static MetricCounter *const badRequests = Metrics::counter(
+        "atlas_subscription_bad_requests_total", "Subscription requests that did not parse.");
+    static MetricCounter *const unauthorized = Metrics::counter(
+        "atlas_subscription_unauthorized_total", "Subscription requests without the right key.");
+
+    const quint64 key = (quint64(address) << 16) | port;
+    const auto found = m_peers.find(key);
+    if (found != m_peers.end() && found->request == request) {
+        found->lastSeenMs = QDateTime::currentMSecsSinceEpoch();
+        return;
+    }
+
+    SubscriptionHub::Subscription subscription;
+    QByteArray key;
+    if (!parseRequest(request, subscription, &key)) {
+        badRequests->increment();
+        return;
+    }
+    if (!m_secret.isEmpty() && !sameSecret(key, m_secret)) {
+        unauthorized->increment();
+        return;
+    }
+    if (found != m_peers.end()) {
+        m_hub.unsubscribe(found->subscriptionId);
+        m_peers.erase(found);
+    }
+    if (subscription.rateHz <= 0)
+        return;
+
+    Peer peer;
+    peer.request = request;
+    peer.lastSeenMs = QDateTime::currentMSecsSinceEpoch();
+    UdpReceiver *socket = m_socket.get();
+    peer.subscriptionId = m_hub.subscribe(subscription, [socket, address, port](const QByteArray &datagram) {
+        if (socket->sendTo(datagram.constData(), size_t(datagram.size()), address, port))
+            sentBytes->increment(quint64(datagram.size()));
+    });
+    m_peers.insert(key, peer);
+}
+
+void SubscriptionServer::expirePeers()
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = m_peers.begin(); it != m_peers.end();) {
+        if (nowMs - it->lastSeenMs > peerTimeoutMs) {
+            m_hub.unsubscribe(it->subscriptionId);
+            it = m_peers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
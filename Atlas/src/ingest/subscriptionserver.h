@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <memory>
+
+#include "ingest/subscriptionhub.h"
+#include "ingest/udpreceiver.h"
+
+// UDP front end to SubscriptionHub. A consumer sends a one-line request,
+//   rate=5 fields=latitude,longitude,altitudeMsl vehicles=3,7 region=36.6,-120.0,36.9,-119.6
+// (every key optional; region is south,west,north,east; field names as in
+// vehicleFieldName(); quantized=1 for the compact encoding) and gets ATSU
+// update datagrams back at the address it asked from. Repeat the request to
+// stay subscribed; a peer silent for 30 s is dropped, and rate=0 leaves at
+// once. With a secret set, a request must also carry key=<secret>; without
+// one the server only listens on a loopback address.
+class SubscriptionServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SubscriptionServer(SubscriptionHub &hub, QObject *parent = nullptr);
+    ~SubscriptionServer() override;
+
+    // address must be IPv4.
+    bool listen(const QHostAddress &address, quint16 port, const QByteArray &secret, QString *error);
+
+    // False for a request that does not parse. The key= value, if any, goes
+    // to key.
+    static bool parseRequest(const QByteArray &request, SubscriptionHub::Subscription &subscription,
+                             QByteArray *key = nullptr);
+
+private:
+    struct Peer
+    {
+        int subscriptionId = 0;
+        QByteArray request;
+        qint64 lastSeenMs = 0;
+    };
+
+    void readRequests();
+    void handleRequest(quint32 address, quint16 port, const QByteArray &request);
+    void expirePeers();
+
+    SubscriptionHub &m_hub;
+    QByteArray m_secret;
+    std::unique_ptr<UdpReceiver> m_socket;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    QHash<quint64, Peer> m_peers; // (address << 16) | port
+    QTimer m_expiryTimer;
+};
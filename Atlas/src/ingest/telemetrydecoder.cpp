@@ -0,0 +1,91 @@
+#include "telemetrydecoder.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+constexpr double radiansToDegrees = 57.29577951308232;
+constexpr uint8_t baseModeSafetyArmed = 0x80;
+constexpr uint8_t autopilotInvalid = 8; // MAV_AUTOPILOT_INVALID: GCS, gimbal, companion
+
+} // namespace
+
+size_t decodeTelemetry(const Mavlink::Frame &frame, FieldSample *samples)
+{
+    // Only checksummed frames; an unverified payload could be anything.
+    if (!frame.checksumVerified)
+        return 0;
+
+    size_t count = 0;
+    const auto add = [&](VehicleField field, double value) { samples[count++] = {field, value}; };
+
+    switch (frame.messageId) {
+    case Mavlink::Heartbeat:
+        if (frame.field<uint8_t>(5) == autopilotInvalid)
+            break;
+        add(VehicleField::FlightMode, frame.field<uint32_t>(0)); // custom_mode
+        add(VehicleField::Armed, (frame.field<uint8_t>(6) & baseModeSafetyArmed) ? 1 : 0);
+        break;
+    case Mavlink::SysStatus: {
+        const uint16_t voltage = frame.field<uint16_t>(14); // mV
+        if (voltage != UINT16_MAX)
+            add(VehicleField::BatteryVoltage, voltage / 1000.0);
+        const int16_t current = frame.field<int16_t>(16); // cA
+        if (current >= 0)
+            add(VehicleField::BatteryCurrent, current / 100.0);
+        const int8_t remaining = frame.field<int8_t>(30);
+        if (remaining >= 0)
+            add(VehicleField::BatteryRemaining, remaining);
+        break;
+    }
+    case Mavlink::Attitude:
+        add(VehicleField::Roll, frame.field<float>(4) * radiansToDegrees);
+        add(VehicleField::Pitch, frame.field<float>(8) * radiansToDegrees);
+        add(VehicleField::Yaw, frame.field<float>(12) * radiansToDegrees);
+        break;
+    case Mavlink::GlobalPositionInt: {
+        add(VehicleField::Latitude, frame.field<int32_t>(4) / 1e7);
+        add(VehicleField::Longitude, frame.field<int32_t>(8) / 1e7);
+        add(VehicleField::AltitudeMsl, frame.field<int32_t>(12) / 1000.0);
+        add(VehicleField::AltitudeRelative, frame.field<int32_t>(16) / 1000.0);
+        const uint16_t heading = frame.field<uint16_t>(26); // cdeg
+        if (heading != UINT16_MAX)
+            add(VehicleField::Heading, heading / 100.0);
+        break;
+    }
+    case Mavlink::VfrHud:
+        add(VehicleField::GroundSpeed, frame.field<float>(4));
+        add(VehicleField::ClimbRate, frame.field<float>(12));
+        break;
+    case Mavlink::BatteryStatus: {
+        const int8_t remaining = frame.field<int8_t>(35);
+        if (remaining >= 0)
+            add(VehicleField::BatteryRemaining, remaining);
+        break;
+    }
+    case Mavlink::Vibration: {
+        const float x = frame.field<float>(8);
+        const float y = frame.field<float>(12);
+        const float z = frame.field<float>(16);
+        add(VehicleField::Vibration, std::sqrt(double(x) * x + double(y) * y + double(z) * z));
+        break;
+    }
+    default:
+        break;
+    }
+    return count;
+}
+
+qint64 telemetryBootTimeUs(const Mavlink::Frame &frame)
+{
+    if (!frame.checksumVerified)
+        return -1;
+    switch (frame.messageId) {
+    case Mavlink::Attitude:
+    case Mavlink::GlobalPositionInt:
+        return qint64(frame.field<uint32_t>(0)) * 1000; // time_boot_ms
+    default:
+        return -1;
+    }
+}
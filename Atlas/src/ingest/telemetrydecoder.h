@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ingest/mavlink.h"
+#include "state/vehiclestate.h"
+
+struct FieldSample
+{
+    VehicleField field;
+    double value;
+};
+
+// Maps the telemetry messages Atlas displays onto VehicleField units
+// (degrees, metres, percent). Writes at most VehicleFieldCount samples and
+// returns how many; fields the vehicle reports as unknown are skipped.
+size_t decodeTelemetry(const Mavlink::Frame &frame, FieldSample *samples);
+
+// The autopilot boot time, in µs, at which the frame's samples were taken,
+// or -1 for messages that do not say.
+qint64 telemetryBootTimeUs(const Mavlink::Frame &frame);
@@ -0,0 +1,154 @@
+#include "trafficsnapshot.h"
+
+#include <cstring>
+#include <limits>
+#include <new>
+
+using namespace TrafficSnapshot;
+
+TrafficSnapshotWriter::TrafficSnapshotWriter()
+    : m_memory(QSharedMemory::legacyNativeKey(sharedMemoryKey()))
+{
+}
+
+TrafficSnapshotWriter::~TrafficSnapshotWriter()
+{
+    m_memory.detach();
+}
+
+bool TrafficSnapshotWriter::create()
+{
+    if (m_memory.create(int(sizeof(Region)))) {
+        m_region = new (m_memory.data()) Region;
+        Header &header = m_region->header;
+        header.magic = magic;
+        header.version = version;
+        header.capacity = capacity;
+        header.slotSize = sizeof(Slot);
+        header.vehicleCount.store(0, std::memory_order_relaxed);
+        header.heartbeatMs.store(0, std::memory_order_relaxed);
+        std::memset(header.linkNames, 0, sizeof(header.linkNames));
+        for (LinkHealth &link : header.links) {
+            link.frames.store(0, std::memory_order_relaxed);
+            link.lost.store(0, std::memory_order_relaxed);
+            link.bytes.store(0, std::memory_order_relaxed);
+            for (auto &bucket : link.jitterBuckets)
+                bucket.store(0, std::memory_order_relaxed);
+            for (auto &bucket : link.roundTripBuckets)
+                bucket.store(0, std::memory_order_relaxed);
+        }
+        for (auto &shed : header.shedFrames)
+            shed.store(0, std::memory_order_relaxed);
+        header.queuedFrames.store(0, std::memory_order_relaxed);
+        for (Slot &slot : m_region->vehicles) {
+            slot.sequence.store(0, std::memory_order_relaxed);
+            slot.systemId.store(0, std::memory_order_relaxed);
+            slot.lastUpdateMs.store(0, std::memory_order_relaxed);
+            for (auto &value : slot.values)
+                value.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_relaxed);
+            for (auto &time : slot.sampleTimesUs)
+                time.store(0, std::memory_order_relaxed);
+            for (auto &uncertainty : slot.sampleUncertaintiesUs)
+                uncertainty.store(-1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // A UI still mapping the previous daemon's region keeps it alive; pick
+    // up where that daemon left off.
+    if (m_memory.error() != QSharedMemory::AlreadyExists || !m_memory.attach(QSharedMemory::ReadWrite))
+        return false;
+    auto *existing = static_cast<Region *>(m_memory.data());
+    if (m_memory.size() < qsizetype(sizeof(Region)) || existing->header.magic != magic
+        || existing->header.version != version || existing->header.slotSize != sizeof(Slot)) {
+        m_memory.detach();
+        return false;
+    }
+    m_region = existing;
+    const quint32 count = m_region->header.vehicleCount.load(std::memory_order_acquire);
+    for (quint32 i = 0; i < count; ++i) {
+        Slot &slot = m_region->vehicles[i];
+        // A crash mid-write leaves the sequence odd; readers would skip the
+        // slot forever.
+        const quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+        if (sequence & 1)
+            slot.sequence.store(sequence + 1, std::memory_order_release);
+        m_slotBySystemId.insert(slot.systemId.load(std::memory_order_relaxed), int(i));
+    }
+    return true;
+}
+
+int TrafficSnapshotWriter::slotFor(int systemId)
+{
+    const auto found = m_slotBySystemId.constFind(systemId);
+    if (found != m_slotBySystemId.constEnd())
+        return *found;
+
+    const quint32 index = m_region->header.vehicleCount.load(std::memory_order_relaxed);
+    if (index >= quint32(capacity))
+        return -1;
+    m_region->vehicles[index].systemId.store(systemId, std::memory_order_relaxed);
+    // Publishing the count releases the slot's system id to readers.
+    m_region->header.vehicleCount.store(index + 1, std::memory_order_release);
+    m_slotBySystemId.insert(systemId, int(index));
+    return int(index);
+}
+
+bool TrafficSnapshotWriter::write(int systemId, const FieldSample *samples, size_t count, qint64 timestampMs,
+                                  const SampleTime &time)
+{
+    if (!m_region)
+        return false;
+    const int index = slotFor(systemId);
+    if (index < 0)
+        return false;
+
+    Slot &slot = m_region->vehicles[index];
+    const quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < count; ++i) {
+        const int field = int(samples[i].field);
+        slot.values[field].store(samples[i].value, std::memory_order_relaxed);
+        slot.sampleTimesUs[field].store(time.monotonicUs, std::memory_order_relaxed);
+        slot.sampleUncertaintiesUs[field].store(time.uncertaintyUs, std::memory_order_relaxed);
+    }
+    slot.lastUpdateMs.store(timestampMs, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+void TrafficSnapshotWriter::setLinkName(int link, const QString &name)
+{
+    if (!m_region || link < 0 || link >= maxLinks)
+        return;
+    const QByteArray utf8 = name.toUtf8().left(linkNameSize - 1);
+    char *target = m_region->header.linkNames[link];
+    std::memset(target, 0, linkNameSize);
+    std::memcpy(target, utf8.constData(), size_t(utf8.size()));
+}
+
+LinkHealth *TrafficSnapshotWriter::linkHealth(int link)
+{
+    if (!m_region || link < 0 || link >= maxLinks)
+        return nullptr;
+    return &m_region->header.links[link];
+}
+
+void TrafficSnapshotWriter::shed(int priorityClass)
+{
+    if (m_region && priorityClass >= 0 && priorityClass < priorityClasses)
+        m_region->header.shedFrames[priorityClass].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TrafficSnapshotWriter::setQueuedFrames(int count)
+{
+    if (m_region)
+        m_region->header.queuedFrames.store(quint32(count), std::memory_order_relaxed);
+}
+
+void TrafficSnapshotWriter::heartbeat(qint64 nowMs)
+{
+    if (m_region)
+        m_region->header.heartbeatMs.store(nowMs, std::memory_order_release);
+}
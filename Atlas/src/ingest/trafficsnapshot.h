@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QHash>
+#include <QSharedMemory>
+#include <QString>
+
+#include <atomic>
+
+#include "ingest/telemetrydecoder.h"
+#include "state/vehiclestate.h"
+
+// The traffic picture the ingest daemon (atlasd) publishes for UI
+// processes. One shared-memory region holds a fixed array of per-vehicle
+// slots; each slot is guarded by its own seqlock, so the single writer
+// never waits for readers and a reader that races a write just retries
+// that slot. Everything in the region is a lock-free atomic, which keeps
+// it valid across processes and free of torn reads.
+namespace TrafficSnapshot {
+
+constexpr quint32 magic = 0x41545346; // "ATSF"
+constexpr quint32 version = 6;
+constexpr int capacity = 4096;
+constexpr int maxLinks = 4;
+constexpr int linkNameSize = 16;
+// Shed-frame counters, one per MessagePriority class.
+constexpr int priorityClasses = 4;
+
+// Jitter and round-trip histograms share these upper bounds, in ms; the
+// last bucket is everything slower.
+constexpr int healthBuckets = 12;
+constexpr double healthBucketBoundsMs[healthBuckets - 1] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000};
+
+inline QString sharedMemoryKey() { return QStringLiteral("AtlasTrafficSnapshot"); }
+
+struct Slot
+{
+    std::atomic<quint32> sequence; // odd while the writer is inside
+    std::atomic<qint32> systemId;
+    std::atomic<qint64> lastUpdateMs;
+    std::atomic<double> values[VehicleFieldCount]; // NaN until first received
+    // SampleTime of each value: GCS monotonic µs and its uncertainty.
+    std::atomic<qint64> sampleTimesUs[VehicleFieldCount];
+    std::atomic<qint32> sampleUncertaintiesUs[VehicleFieldCount];
+};
+
+// Per-link totals since the daemon started, over every vehicle on the
+// link. Only ever incremented, so a reader takes rates and histogram
+// deltas between two samples of its own without any locking.
+struct LinkHealth
+{
+    std::atomic<quint64> frames;
+    std::atomic<quint64> lost;  // sequence gaps
+    std::atomic<quint64> bytes;
+    std::atomic<quint64> jitterBuckets[healthBuckets];    // per sample of transit-time change
+    std::atomic<quint64> roundTripBuckets[healthBuckets]; // per TIMESYNC reply
+};
+
+struct Header
+{
+    quint32 magic;
+    quint32 version;
+    quint32 capacity;
+    quint32 slotSize;
+    std::atomic<quint32> vehicleCount; // slots [0, vehicleCount) are in use; only grows
+    std::atomic<qint64> heartbeatMs;   // daemon wall clock, refreshed every second
+    char linkNames[maxLinks][linkNameSize]; // UTF-8, NUL-padded; set at daemon start
+    LinkHealth links[maxLinks];
+    // Frames the daemon dropped to keep up, by priority class, and how many
+    // are waiting right now.
+    std::atomic<quint64> shedFrames[priorityClasses];
+    std::atomic<quint32> queuedFrames;
+};
+
+struct Region
+{
+    Header header;
+    Slot vehicles[capacity];
+};
+
+static_assert(std::atomic<quint32>::is_always_lock_free && std::atomic<qint64>::is_always_lock_free
+                  && std::atomic<double>::is_always_lock_free,
+              "shared-memory atomics must be lock-free to work across processes");
+
+} // namespace TrafficSnapshot
+
+// Daemon side. Creates the region, or adopts the one left behind by a
+// previous daemon so vehicles survive a daemon restart too.
+class TrafficSnapshotWriter
+{
+public:
+    TrafficSnapshotWriter();
+    ~TrafficSnapshotWriter();
+
+    bool create();
+    QString errorString() const { return m_memory.errorString(); }
+
+    // False once all slots are taken. time applies to every sample.
+    bool write(int systemId, const FieldSample *samples, size_t count, qint64 timestampMs,
+               const SampleTime &time);
+    void heartbeat(qint64 nowMs);
+    // Names BestLink values refer to; truncated to fit.
+    void setLinkName(int link, const QString &name);
+    // Written from the receive path with relaxed increments; null before
+    // create().
+    TrafficSnapshot::LinkHealth *linkHealth(int link);
+    void shed(int priorityClass);
+    void setQueuedFrames(int count);
+
+private:
+    int slotFor(int systemId);
+
+    QSharedMemory m_memory;
+    TrafficSnapshot::Region *m_region = nullptr;
+    QHash<int, int> m_slotBySystemId;
+};
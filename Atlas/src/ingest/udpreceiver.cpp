@@ -0,0 +1,177 @@
+#include "udpreceiver.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#define ATLAS_UDP_RECVMMSG
+#endif
+
+struct UdpReceiver::Native
+{
+    sockaddr_in senders[batchSize];
+#ifdef ATLAS_UDP_RECVMMSG
+    iovec iovecs[batchSize];
+    mmsghdr messages[batchSize];
+    iovec sendIovecs[batchSize];
+    mmsghdr sendMessages[batchSize];
+#endif
+};
+
+namespace {
+
+bool socketFull()
+{
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS;
+}
+
+sockaddr_in socketAddress(uint32_t address, uint16_t port)
+{
+    sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_addr.s_addr = htonl(address);
+    target.sin_port = htons(port);
+    return target;
+}
+
+} // namespace
+
+UdpReceiver::UdpReceiver(bool batched)
+#ifdef ATLAS_UDP_RECVMMSG
+    : m_batched(batched)
+#else
+    : m_batched(false)
+#endif
+    , m_buffers(size_t(batchSize) * bufferSize)
+    , m_lengths(batchSize, 0)
+    , m_native(new Native())
+{
+    (void)batched;
+#ifdef ATLAS_UDP_RECVMMSG
+    // The message headers point at fixed buffers for the receiver's whole
+    // life; a receive only rewrites lengths.
+    for (int i = 0; i < batchSize; ++i) {
+        m_native->iovecs[i].iov_base = m_buffers.data() + size_t(i) * bufferSize;
+        m_native->iovecs[i].iov_len = bufferSize;
+        msghdr &header = m_native->messages[i].msg_hdr;
+        header.msg_name = &m_native->senders[i];
+        header.msg_iov = &m_native->iovecs[i];
+        header.msg_iovlen = 1;
+    }
+#endif
+}
+
+UdpReceiver::~UdpReceiver()
+{
+    if (m_fd >= 0)
+        ::close(m_fd);
+    delete m_native;
+}
+
+bool UdpReceiver::bind(uint16_t port, uint32_t interfaceAddress)
+{
+    m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        m_error = std::strerror(errno);
+        return false;
+    }
+    ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+    // Bursts from dozens of vehicles outrun the default receive queue.
+    const int receiveBuffer = 4 * 1024 * 1024;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(interfaceAddress);
+    address.sin_port = htons(port);
+    if (::bind(m_fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        m_error = std::strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+int UdpReceiver::receiveBatch()
+{
+#ifdef ATLAS_UDP_RECVMMSG
+    if (m_batched) {
+        for (int i = 0; i < batchSize; ++i) {
+            m_native->messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            m_native->messages[i].msg_hdr.msg_flags = 0;
+        }
+        const int count = ::recvmmsg(m_fd, m_native->messages, batchSize, MSG_DONTWAIT, nullptr);
+        for (int i = 0; i < count; ++i)
+            m_lengths[size_t(i)] = m_native->messages[i].msg_len;
+        return count;
+    }
+#endif
+    socklen_t length = sizeof(sockaddr_in);
+    const ssize_t size = ::recvfrom(m_fd, m_buffers.data(), bufferSize, MSG_DONTWAIT,
+                                    reinterpret_cast<sockaddr *>(&m_native->senders[0]), &length);
+    if (size < 0)
+        return -1;
+    m_lengths[0] = size_t(size);
+    return 1;
+}
+
+UdpReceiver::Datagram UdpReceiver::datagram(int index) const
+{
+    const sockaddr_in &sender = m_native->senders[index];
+    return {m_buffers.data() + size_t(index) * bufferSize, m_lengths[size_t(index)],
+            ntohl(sender.sin_addr.s_addr), ntohs(sender.sin_port)};
+}
+
+bool UdpReceiver::sendTo(const void *data, size_t size, uint32_t address, uint16_t port)
+{
+    const sockaddr_in target = socketAddress(address, port);
+    return ::sendto(m_fd, data, size, MSG_DONTWAIT, reinterpret_cast<const sockaddr *>(&target),
+                    sizeof(target))
+           == ssize_t(size);
+}
+
+int UdpReceiver::sendBatch(const uint8_t *const *data, const size_t *sizes, int count, uint32_t address,
+                           uint16_t port)
+{
+    sockaddr_in target = socketAddress(address, port);
+    count = count < batchSize ? count : batchSize;
+    int done = 0;
+#ifdef ATLAS_UDP_RECVMMSG
+    for (int i = 0; i < count; ++i) {
+        m_native->sendIovecs[i].iov_base = const_cast<uint8_t *>(data[i]);
+        m_native->sendIovecs[i].iov_len = sizes[i];
+        m_native->sendMessages[i] = {};
+        msghdr &header = m_native->sendMessages[i].msg_hdr;
+        header.msg_name = &target;
+        header.msg_namelen = sizeof(target);
+        header.msg_iov = &m_native->sendIovecs[i];
+        header.msg_iovlen = 1;
+    }
+    while (done < count) {
+        const int sent = ::sendmmsg(m_fd, m_native->sendMessages + done, unsigned(count - done), MSG_DONTWAIT);
+        if (sent > 0)
+            done += sent;
+        else if (errno == EINTR)
+            continue;
+        else if (socketFull())
+            break;
+        else
+            ++done; // sendmmsg fails on the first message it cannot send
+    }
+#else
+    for (; done < count; ++done) {
+        if (::sendto(m_fd, data[done], sizes[done], MSG_DONTWAIT, reinterpret_cast<const sockaddr *>(&target),
+                     sizeof(target))
+                < 0
+            && socketFull())
+            break;
+    }
+#endif
+    return done;
+}
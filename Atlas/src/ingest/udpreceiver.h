@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bound, non-blocking IPv4 UDP socket read in batches: one recvmmsg call
+// fills up to batchSize preallocated buffers on Linux, other POSIX systems
+// fall back to one recvfrom per datagram. Datagrams are handed to the
+// caller in place, so the MAVLink parser reads straight out of the receive
+// buffers. Plain POSIX, no Qt, so the hot path can be benchmarked alone.
+class UdpReceiver
+{
+public:
+    static constexpr int batchSize = 64;
+    static constexpr size_t bufferSize = 2048; // a MAVLink frame is at most 280
+
+    struct Datagram
+    {
+        const uint8_t *data;
+        size_t size;
+        uint32_t address; // IPv4, host byte order
+        uint16_t port;
+    };
+
+    // batched = false forces the recvfrom path, for comparison.
+    explicit UdpReceiver(bool batched = true);
+    ~UdpReceiver();
+
+    UdpReceiver(const UdpReceiver &) = delete;
+    UdpReceiver &operator=(const UdpReceiver &) = delete;
+
+    // address is IPv4 in host byte order; 0 binds every interface.
+    bool bind(uint16_t port, uint32_t address = 0);
+    int descriptor() const { return m_fd; }
+    const std::string &errorString() const { return m_error; }
+
+    // Reads what is queued, up to maxBatches batches so a flood cannot
+    // starve the caller's event loop, calling onDatagram(const Datagram &)
+    // for each. Returns the number of datagrams read.
+    template<typename OnDatagram>
+    size_t drain(OnDatagram &&onDatagram, int maxBatches = 16)
+    {
+        size_t total = 0;
+        for (int batch = 0; batch < maxBatches; ++batch) {
+            const int count = receiveBatch();
+            for (int i = 0; i < count; ++i)
+                onDatagram(datagram(i));
+            total += size_t(count > 0 ? count : 0);
+            if (count < (m_batched ? batchSize : 1))
+                break;
+        }
+        return total;
+    }
+
+    // Sends from the bound port, so vehicles see replies from the address
+    // they send to. False if the datagram was not sent in full.
+    bool sendTo(const void *data, size_t size, uint32_t address, uint16_t port);
+
+    // Sends up to batchSize datagrams to one peer, with one sendmmsg call
+    // where available. Stops early only when the socket buffer is full;
+    // a datagram refused for any other reason is dropped. Returns how
+    // many were consumed, so the caller retries the rest once writable.
+    int sendBatch(const uint8_t *const *data, const size_t *sizes, int count, uint32_t address, uint16_t port);
+
+private:
+    int receiveBatch();
+    Datagram datagram(int index) const;
+
+    bool m_batched;
+    int m_fd = -1;
+    std::string m_error;
+    std::vector<uint8_t> m_buffers;   // batchSize * bufferSize, allocated once
+    std::vector<size_t> m_lengths;
+    struct Native;                    // iovec/mmsghdr/sockaddr arrays, both directions
+    Native *m_native;
+};
@@ -0,0 +1,167 @@
+#include <QApplication>
+#include <QProcess>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QQmlApplicationEngine>
+#include <QQuickWindow>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QtQml>
+
+#include <memory>
+
+#include "airspace/airspacegeometry.h"
+#include "airspace/airspaceinstancing.h"
+#include "app_environment.h"
+#include "diagnostics/inputrecorder.h"
+#include "diagnostics/metrics.h"
+#include "diagnostics/metricsserver.h"
+#include "diagnostics/startupprofiler.h"
+#include "ingest/commandclient.h"
+#include "map/aircraftmaplayer.h"
+#include "map/densitymaplayer.h"
+#include "map/volumemaplayer.h"
+#include "map/volumemeshcache.h"
+#include "models/linkhealthmodel.h"
+#include "models/livesortfiltermodel.h"
+#include "models/rostermodel.h"
+#include "models/vehiclemodel.h"
+#include "palette/commandpalettemodel.h"
+#include "persistence/database.h"
+#include "persistence/rosterimporter.h"
+#include "plot/streamingplot.h"
+#include "settings/settingspropertymap.h"
+#include "settings/settingsstore.h"
+#include "state/operationvolumestore.h"
+#include "state/snapshotfeed.h"
+#include "state/timeline.h"
+#include "state/trafficdensity.h"
+#include "state/trajectorystore.h"
+#include "state/vehiclestatestore.h"
+
+int main(int argc, char *argv[])
+{
+    StartupProfiler *profiler = StartupProfiler::instance();
+    profiler->instant(QStringLiteral("main()"));
+
+    profiler->begin(QStringLiteral("QApplication"));
+    // widgetApp: true in Atlas.qmlproject, so this has to be a QApplication.
+    QApplication app(argc, argv);
+    app.setOrganizationName(QStringLiteral("CSU Fresno UAS Research Team"));
+    app.setApplicationName(QStringLiteral("Atlas"));
+    profiler->end(QStringLiteral("QApplication"));
+
+    const QString projectRoot = qEnvironmentVariable("ATLAS_ROOT",
+                                                     QCoreApplication::applicationDirPath());
+    set_qt_environment(projectRoot);
+
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    const QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QDir().mkpath(configDir);
+
+    profiler->begin(QStringLiteral("Backend services"));
+    SettingsStore settings(configDir + QStringLiteral("/settings.bin"));
+    settings.load();
+    SettingsPropertyMap settingsMap(&settings);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Settings", &settingsMap);
+
+    MetricsServer metricsServer;
+    metricsServer.listen(quint16(settings.value(QStringLiteral("metricsPort")).toUInt()));
+    settings.onChanged(QStringLiteral("metricsPort"), &metricsServer, [&metricsServer](const QVariant &port) {
+        metricsServer.listen(quint16(port.toUInt()));
+    });
+
+    Database database;
+    database.open(dataDir + QStringLiteral("/atlas.db"));
+
+    VehicleStateStore vehicleStore;
+    VehicleModel vehicles(&vehicleStore);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Vehicles", &vehicles);
+    OperationVolumeStore volumes;
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Volumes", &volumes);
+    VolumeMeshCache volumeMeshes(&volumes);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "VolumeMeshes", &volumeMeshes);
+    TrajectoryStore trajectories(&vehicleStore);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Trajectories", &trajectories);
+    Timeline timeline(&trajectories);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Timeline", &timeline);
+    TrafficDensity density(&vehicleStore);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Density", &density);
+
+    // Telemetry and commands live in atlasd so aircraft stay covered while
+    // the UI restarts; start it if nobody has yet.
+    SnapshotFeed snapshotFeed(&vehicleStore);
+    if (!snapshotFeed.attach())
+        QProcess::startDetached(QCoreApplication::applicationDirPath() + QStringLiteral("/atlasd"));
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Traffic", &snapshotFeed);
+    LinkHealthModel linkHealth(&snapshotFeed);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "LinkHealth", &linkHealth);
+    CommandClient commandClient;
+    commandClient.connectToDaemon();
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Commands", &commandClient);
+
+    RosterModel roster(&database, &vehicleStore);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "Roster", &roster);
+    RosterImporter rosterImporter(&database);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "RosterImport", &rosterImporter);
+    qmlRegisterType<LiveSortFilterModel>("AtlasBackend", 1, 0, "LiveSortFilterModel");
+    qmlRegisterType<AirspaceInstancing>("AtlasBackend", 1, 0, "AirspaceInstancing");
+    qmlRegisterType<AircraftGeometry>("AtlasBackend", 1, 0, "AircraftGeometry");
+    qmlRegisterType<OperationVolumeGeometry>("AtlasBackend", 1, 0, "OperationVolumeGeometry");
+    qmlRegisterType<VolumeMapLayer>("AtlasBackend", 1, 0, "VolumeMapLayer");
+    qmlRegisterType<AircraftMapLayer>("AtlasBackend", 1, 0, "AircraftMapLayer");
+    qmlRegisterType<DensityMapLayer>("AtlasBackend", 1, 0, "DensityMapLayer");
+    qmlRegisterType<StreamingPlot>("AtlasBackend", 1, 0, "StreamingPlot");
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "StartupTrace", profiler);
+
+    InputRecorder inputRecorder(&vehicleStore, dataDir + QStringLiteral("/recordings"));
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "InputRecorder", &inputRecorder);
+    // A replay re-applies the recorded telemetry; live samples would mix in.
+    QObject::connect(&inputRecorder, &InputRecorder::stateChanged, &snapshotFeed,
+                     [&] { snapshotFeed.setPaused(inputRecorder.replaying()); });
+
+    CommandPaletteModel commandPalette(&vehicleStore);
+    qmlRegisterSingletonInstance("AtlasBackend", 1, 0, "CommandPalette", &commandPalette);
+    profiler->end(QStringLiteral("Backend services"));
+
+    profiler->begin(QStringLiteral("QML engine creation"));
+    StartupUrlInterceptor urlInterceptor; // must outlive the engine
+    QQmlApplicationEngine engine;
+    engine.addUrlInterceptor(&urlInterceptor);
+    engine.addImportPath(projectRoot); // importPaths: [ "." ]
+    profiler->end(QStringLiteral("QML engine creation"));
+
+    // Constants loads every font in its fontPath when it is created, so
+    // create it ahead of App.qml to trace that as a phase of its own.
+    profiler->begin(QStringLiteral("Font loading"));
+    engine.singletonInstance<QObject *>("Atlas", "Constants");
+    profiler->end(QStringLiteral("Font loading"));
+
+    profiler->begin(QStringLiteral("QML load"));
+    engine.load(QUrl::fromLocalFile(projectRoot + QStringLiteral("/AtlasContent/App.qml")));
+    profiler->end(QStringLiteral("QML load"));
+    if (engine.rootObjects().isEmpty())
+        return -1;
+
+    if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().constFirst())) {
+        const QString tracePath = qEnvironmentVariable(
+            "ATLAS_STARTUP_TRACE", dataDir + QStringLiteral("/startup-trace.json"));
+        profiler->finishOnFirstFrame(window, tracePath);
+        inputRecorder.setWindow(window);
+
+        // Both signals come from the render thread; the histogram is atomic.
+        MetricHistogram *frameTimes = Metrics::histogram(
+            "atlas_frame_time_seconds", "Scene graph time per frame, frame begin to frame end.",
+            {0.002, 0.004, 0.008, 0.0167, 0.025, 0.0334, 0.05, 0.1, 0.25});
+        auto frameClock = std::make_shared<QElapsedTimer>();
+        QObject::connect(window, &QQuickWindow::beforeFrameBegin, window,
+                         [frameClock] { frameClock->start(); }, Qt::DirectConnection);
+        QObject::connect(window, &QQuickWindow::afterFrameEnd, window, [frameClock, frameTimes] {
+            if (frameClock->isValid())
+                frameTimes->observe(frameClock->nsecsElapsed() / 1e9);
+        }, Qt::DirectConnection);
+    }
+
+    return app.exec();
+}
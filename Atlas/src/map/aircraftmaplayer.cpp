@@ -0,0 +1,120 @@
+#include "aircraftmaplayer.h"
+
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+
+#include "map/webmercator.h"
+
+namespace {
+
+constexpr int verticesPerMarker = 6; // a diamond, two triangles
+
+void setVertex(QSGGeometry::ColoredPoint2D *vertex, float x, float y, const QColor &color)
+{
+    // The material expects premultiplied alpha.
+    const float alpha = float(color.alphaF());
+    vertex->set(x, y, uchar(color.red() * alpha), uchar(color.green() * alpha), uchar(color.blue() * alpha),
+                uchar(color.alpha()));
+}
+
+} // namespace
+
+AircraftMapLayer::AircraftMapLayer(QQuickItem *parent)
+    : MapLayer(parent)
+{
+}
+
+void AircraftMapLayer::setTimeline(Timeline *timeline)
+{
+    if (timeline == m_timeline)
+        return;
+    if (m_timeline) {
+        disconnect(m_timeline, nullptr, this, nullptr);
+        disconnect(m_timeline->trajectories(), nullptr, this, nullptr);
+    }
+    m_timeline = timeline;
+    if (m_timeline) {
+        connect(m_timeline, &Timeline::timeChanged, this, &QQuickItem::update);
+        // While live, new samples move the tracks' ends under the current time.
+        connect(m_timeline->trajectories(), &TrajectoryStore::trajectoriesChanged, this, &QQuickItem::update);
+    }
+    update();
+    emit timelineChanged();
+}
+
+void AircraftMapLayer::setRecordedColor(const QColor &color)
+{
+    if (color == m_recordedColor)
+        return;
+    m_recordedColor = color;
+    update();
+    emit appearanceChanged();
+}
+
+void AircraftMapLayer::setIntentColor(const QColor &color)
+{
+    if (color == m_intentColor)
+        return;
+    m_intentColor = color;
+    update();
+    emit appearanceChanged();
+}
+
+void AircraftMapLayer::setMarkerSize(double size)
+{
+    if (size == m_markerSize)
+        return;
+    m_markerSize = size;
+    update();
+    emit appearanceChanged();
+}
+
+QSGNode *AircraftMapLayer::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto *node = static_cast<QSGGeometryNode *>(oldNode);
+    if (!node) {
+        node = new QSGGeometryNode;
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        geometry->setVertexDataPattern(QSGGeometry::StreamPattern);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGVertexColorMaterial);
+        node->setFlag(QSGNode::OwnsMaterial);
+    }
+
+    // The GUI thread is blocked here, so the store holds still.
+    m_markers.clear();
+    if (m_timeline) {
+        const QPointF center = centerMercator();
+        const double scale = pixelsPerMetre();
+        const QRectF visible = boundingRect().adjusted(-m_markerSize, -m_markerSize, m_markerSize, m_markerSize);
+        m_timeline->trajectories()->forEachAt(
+            m_timeline->timeMs(), [&](const Trajectory &trajectory, const TrackPoint &position) {
+                const QPointF offset = WebMercator::fromLatLon(position.latitude, position.longitude) - center;
+                const QPointF point(width() / 2 + offset.x() * scale, height() / 2 - offset.y() * scale);
+                if (visible.contains(point))
+                    m_markers.push_back({point, trajectory.kind == Trajectory::Kind::Intent});
+            });
+    }
+
+    QSGGeometry *geometry = node->geometry();
+    const int vertexCount = int(m_markers.size()) * verticesPerMarker;
+    if (geometry->vertexCount() != vertexCount)
+        geometry->allocate(vertexCount);
+    QSGGeometry::ColoredPoint2D *vertex = geometry->vertexDataAsColoredPoint2D();
+    const float r = float(m_markerSize / 2);
+    for (const Marker &marker : m_markers) {
+        const QColor &color = marker.intent ? m_intentColor : m_recordedColor;
+        const float x = float(marker.point.x());
+        const float y = float(marker.point.y());
+        setVertex(vertex++, x, y - r, color);
+        setVertex(vertex++, x + r, y, color);
+        setVertex(vertex++, x - r, y, color);
+        setVertex(vertex++, x - r, y, color);
+        setVertex(vertex++, x + r, y, color);
+        setVertex(vertex++, x, y + r, color);
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+    return node;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QColor>
+#include <QPointer>
+
+#include <vector>
+
+#include "map/maplayer.h"
+#include "state/timeline.h"
+
+// Aircraft on the Home map at the Timeline's moment: recorded tracks
+// where vehicles were (or are, while live) and intent trajectories where
+// operations plan to be. Every marker is one vertex-coloured geometry
+// rebuilt per frame, so scrubbing redraws at the display rate; finding
+// the positions is a binary search per visible trajectory.
+class AircraftMapLayer : public MapLayer
+{
+    Q_OBJECT
+    Q_PROPERTY(Timeline *timeline READ timeline WRITE setTimeline NOTIFY timelineChanged)
+    Q_PROPERTY(QColor recordedColor READ recordedColor WRITE setRecordedColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor intentColor READ intentColor WRITE setIntentColor NOTIFY appearanceChanged)
+    Q_PROPERTY(double markerSize READ markerSize WRITE setMarkerSize NOTIFY appearanceChanged) // pixels
+
+public:
+    explicit AircraftMapLayer(QQuickItem *parent = nullptr);
+
+    Timeline *timeline() const { return m_timeline; }
+    void setTimeline(Timeline *timeline);
+    QColor recordedColor() const { return m_recordedColor; }
+    void setRecordedColor(const QColor &color);
+    QColor intentColor() const { return m_intentColor; }
+    void setIntentColor(const QColor &color);
+    double markerSize() const { return m_markerSize; }
+    void setMarkerSize(double size);
+
+signals:
+    void timelineChanged();
+    void appearanceChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    struct Marker
+    {
+        QPointF point;
+        bool intent = false;
+    };
+
+    QPointer<Timeline> m_timeline;
+    QColor m_recordedColor = QColor(0xff, 0xff, 0xff);
+    QColor m_intentColor = QColor(0x3a, 0x8e, 0xe6);
+    double m_markerSize = 8;
+    std::vector<Marker> m_markers; // scratch, kept to avoid reallocating
+};
@@ -0,0 +1,151 @@
+#include "densitymaplayer.h"
+
+#include <QDateTime>
+#include <QQuickWindow>
+#include <QSGSimpleTextureNode>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int refreshIntervalMs = 1000;
+// Re-reads the bins this often without new traffic, so the heatmap fades.
+constexpr int fadeIntervalMs = 30000;
+// Bins smaller than this on screen are too fine to read; use a coarser level.
+constexpr double minCellPixels = 4;
+constexpr int maxTextureSize = 2048;
+
+// Remembers what the texture it shows was rendered from, since the
+// density can grow between refreshes.
+class DensityNode : public QSGSimpleTextureNode
+{
+public:
+    QRect extent;
+    int level = 0;
+};
+
+} // namespace
+
+DensityMapLayer::DensityMapLayer(QQuickItem *parent)
+    : MapLayer(parent)
+{
+    m_refresh.setSingleShot(true);
+    m_refresh.setInterval(refreshIntervalMs);
+    connect(&m_refresh, &QTimer::timeout, this, [this] {
+        m_textureDirty = true;
+        updateLevel(); // the extent may have outgrown the texture limit
+        update();
+    });
+    m_fade.setInterval(fadeIntervalMs);
+    connect(&m_fade, &QTimer::timeout, this, [this] {
+        m_textureDirty = true;
+        update();
+    });
+    m_fade.start();
+    connect(this, &MapLayer::viewChanged, this, &DensityMapLayer::updateLevel);
+}
+
+void DensityMapLayer::setDensity(TrafficDensity *density)
+{
+    if (density == m_density)
+        return;
+    if (m_density)
+        disconnect(m_density, nullptr, this, nullptr);
+    m_density = density;
+    if (m_density) {
+        connect(m_density, &TrafficDensity::densityChanged, this, [this] {
+            if (!m_refresh.isActive())
+                m_refresh.start();
+        });
+    }
+    m_textureDirty = true;
+    updateLevel();
+    update();
+    emit densityChanged();
+}
+
+void DensityMapLayer::setColor(const QColor &color)
+{
+    if (color == m_color)
+        return;
+    m_color = color;
+    m_textureDirty = true;
+    update();
+    emit colorChanged();
+}
+
+void DensityMapLayer::updateLevel()
+{
+    const double scale = pixelsPerMetre();
+    int level = 0;
+    while (level + 1 < TrafficDensity::levelCount
+           && TrafficDensity::cellSize(level + 1) * scale >= minCellPixels)
+        ++level;
+    if (m_density) {
+        while (level > 0 && (m_density->extent(level).width() > maxTextureSize
+                             || m_density->extent(level).height() > maxTextureSize))
+            --level;
+    }
+    if (level == m_level)
+        return;
+    m_level = level;
+    m_textureDirty = true;
+    emit levelChanged();
+}
+
+QImage DensityMapLayer::render() const
+{
+    const QRect extent = m_density ? m_density->extent(m_level) : QRect();
+    if (extent.isEmpty()) {
+        QImage empty(1, 1, QImage::Format_ARGB32_Premultiplied);
+        empty.fill(Qt::transparent);
+        return empty;
+    }
+
+    QImage image(extent.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    // Log scale, so the busiest corridor does not wash everything else out.
+    // Against the peak as of the latest sample, so once traffic stops the
+    // whole map dims as it decays instead of the faded peak staying opaque.
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const double scale = 1 / std::log1p(m_density->peak(m_level, m_density->latestMs()));
+    m_density->forEachBin(m_level, nowMs, [&](const QPoint &cell, double density) {
+        const double alpha = std::min(1.0, std::log1p(density) * scale) * m_color.alphaF();
+        const int x = cell.x() - extent.left();
+        const int y = extent.bottom() - cell.y(); // mercator y grows north
+        image.setPixel(x, y, qRgba(int(m_color.red() * alpha), int(m_color.green() * alpha),
+                                   int(m_color.blue() * alpha), int(255 * alpha)));
+    });
+    return image;
+}
+
+QSGNode *DensityMapLayer::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto *node = static_cast<DensityNode *>(oldNode);
+    if (!node) {
+        node = new DensityNode;
+        node->setOwnsTexture(true);
+        node->setFiltering(QSGTexture::Linear);
+        m_textureDirty = true;
+    }
+    if (m_textureDirty) {
+        // The GUI thread is blocked here, so the bins hold still.
+        node->setTexture(window()->createTextureFromImage(render()));
+        node->extent = m_density ? m_density->extent(m_level) : QRect();
+        node->level = m_level;
+        m_textureDirty = false;
+    }
+
+    if (node->extent.isEmpty()) {
+        node->setRect(QRectF());
+        return node;
+    }
+    const double cell = TrafficDensity::cellSize(node->level);
+    const double scale = pixelsPerMetre();
+    const QPointF center = centerMercator();
+    const double left = width() / 2 + (node->extent.left() * cell - center.x()) * scale;
+    const double top = height() / 2 - ((node->extent.bottom() + 1) * cell - center.y()) * scale;
+    node->setRect(QRectF(left, top, node->extent.width() * cell * scale, node->extent.height() * cell * scale));
+    return node;
+}
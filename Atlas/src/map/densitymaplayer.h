@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QColor>
+#include <QImage>
+#include <QPointer>
+#include <QTimer>
+
+#include "map/maplayer.h"
+#include "state/trafficdensity.h"
+
+// TrafficDensity as a heatmap on the Home map: one texture, one texel per
+// bin of the level whose bins best match the zoom, stretched over the
+// level's extent with linear filtering. Panning only moves the texture and
+// zooming only swaps it for another level's; the bins are re-read at most
+// once per refresh interval, and every fade interval without new traffic.
+class DensityMapLayer : public MapLayer
+{
+    Q_OBJECT
+    Q_PROPERTY(TrafficDensity *density READ density WRITE setDensity NOTIFY densityChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged) // of the densest bin
+    // The level in use, 0 coarsest; follows the zoom.
+    Q_PROPERTY(int level READ level NOTIFY levelChanged)
+
+public:
+    explicit DensityMapLayer(QQuickItem *parent = nullptr);
+
+    TrafficDensity *density() const { return m_density; }
+    void setDensity(TrafficDensity *density);
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+    int level() const { return m_level; }
+
+signals:
+    void densityChanged();
+    void colorChanged();
+    void levelChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    void updateLevel();
+    QImage render() const;
+
+    QPointer<TrafficDensity> m_density;
+    QColor m_color = QColor(0xe6, 0x3a, 0x3a);
+    int m_level = 0;
+    bool m_textureDirty = true;
+    QTimer m_refresh;
+    QTimer m_fade;
+};
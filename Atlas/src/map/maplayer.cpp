@@ -0,0 +1,77 @@
+#include "maplayer.h"
+
+#include "map/webmercator.h"
+
+MapLayer::MapLayer(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents);
+    connect(this, &MapLayer::viewChanged, this, &QQuickItem::update);
+}
+
+void MapLayer::setCenterLatitude(double latitude)
+{
+    if (latitude == m_centerLatitude)
+        return;
+    m_centerLatitude = latitude;
+    emit viewChanged();
+}
+
+void MapLayer::setCenterLongitude(double longitude)
+{
+    if (longitude == m_centerLongitude)
+        return;
+    m_centerLongitude = longitude;
+    emit viewChanged();
+}
+
+void MapLayer::setZoomLevel(double zoom)
+{
+    if (zoom == m_zoomLevel)
+        return;
+    m_zoomLevel = zoom;
+    emit viewChanged();
+}
+
+void MapLayer::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+        update();
+}
+
+QPointF MapLayer::centerMercator() const
+{
+    return WebMercator::fromLatLon(m_centerLatitude, m_centerLongitude);
+}
+
+double MapLayer::pixelsPerMetre() const
+{
+    return WebMercator::pixelsPerMetre(m_zoomLevel);
+}
+
+QPointF MapLayer::toPoint(double latitude, double longitude) const
+{
+    const QPointF offset = WebMercator::fromLatLon(latitude, longitude) - centerMercator();
+    const double scale = pixelsPerMetre();
+    return QPointF(width() / 2 + offset.x() * scale, height() / 2 - offset.y() * scale);
+}
+
+QMatrix4x4 MapLayer::viewMatrix(const QPointF &origin) const
+{
+    const double scale = pixelsPerMetre();
+    const QPointF offset = origin - centerMercator();
+    QMatrix4x4 matrix;
+    matrix.translate(float(width() / 2 + offset.x() * scale), float(height() / 2 - offset.y() * scale));
+    // Mercator y grows north, item y down.
+    matrix.scale(float(scale), float(-scale));
+    return matrix;
+}
+
+QVariantMap MapLayer::toCoordinate(double x, double y) const
+{
+    const double scale = pixelsPerMetre();
+    const QPointF mercator = centerMercator() + QPointF((x - width() / 2) / scale, (height() / 2 - y) / scale);
+    return {{QStringLiteral("latitude"), WebMercator::latitude(mercator.y())},
+            {QStringLiteral("longitude"), WebMercator::longitude(mercator.x())}};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QQuickItem>
+#include <QVariantMap>
+
+// Base of the Home map's layers. Each layer is a full-size item drawing
+// into the same Web Mercator view; QML binds every layer's centre and zoom
+// to the map's, so they pan and zoom together.
+class MapLayer : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(double centerLatitude READ centerLatitude WRITE setCenterLatitude NOTIFY viewChanged)
+    Q_PROPERTY(double centerLongitude READ centerLongitude WRITE setCenterLongitude NOTIFY viewChanged)
+    // Slippy-map zoom: 0 shows the world in 256 pixels, each step doubles.
+    Q_PROPERTY(double zoomLevel READ zoomLevel WRITE setZoomLevel NOTIFY viewChanged)
+
+public:
+    explicit MapLayer(QQuickItem *parent = nullptr);
+
+    double centerLatitude() const { return m_centerLatitude; }
+    void setCenterLatitude(double latitude);
+    double centerLongitude() const { return m_centerLongitude; }
+    void setCenterLongitude(double longitude);
+    double zoomLevel() const { return m_zoomLevel; }
+    void setZoomLevel(double zoom);
+
+    // Item position of a coordinate.
+    Q_INVOKABLE QPointF toPoint(double latitude, double longitude) const;
+    // Coordinate under an item position, as {latitude, longitude}.
+    Q_INVOKABLE QVariantMap toCoordinate(double x, double y) const;
+
+signals:
+    void viewChanged();
+
+protected:
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+    // Mercator metres relative to origin (itself in mercator metres) to
+    // item pixels. Computed in double and only then narrowed, so vertices
+    // stored as float offsets from a nearby origin stay exact at any zoom.
+    QMatrix4x4 viewMatrix(const QPointF &origin) const;
+    QPointF centerMercator() const;
+    double pixelsPerMetre() const;
+
+private:
+    double m_centerLatitude = 36.8;    // Fresno
+    double m_centerLongitude = -119.8;
+    double m_zoomLevel = 10;
+};
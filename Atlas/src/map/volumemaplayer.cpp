@@ -0,0 +1,220 @@
+#include "volumemaplayer.h"
+
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+#include <QSet>
+#include <QStringList>
+
+#include <cstring>
+
+namespace {
+
+using Key = VolumeMeshCache::Key;
+
+QSGGeometry *staticGeometry(const std::vector<QVector2D> &vertices, unsigned int drawingMode)
+{
+    auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), int(vertices.size()));
+    geometry->setDrawingMode(drawingMode);
+    geometry->setLineWidth(1);
+    // Written once; the renderer keeps it in a GPU buffer from then on.
+    geometry->setVertexDataPattern(QSGGeometry::StaticPattern);
+    static_assert(sizeof(QVector2D) == sizeof(QSGGeometry::Point2D), "mesh vertices copy as Point2D");
+    std::memcpy(geometry->vertexData(), vertices.data(), vertices.size() * sizeof(QVector2D));
+    return geometry;
+}
+
+// Owns everything the layer draws with: shared geometries by mesh key,
+// one transform node per map cell, and the per-kind materials.
+class VolumeRootNode : public QSGNode
+{
+public:
+    struct Shared
+    {
+        QSGGeometry *fill = nullptr;
+        QSGGeometry *outline = nullptr;
+        int users = 0;
+    };
+
+    struct Volume
+    {
+        Key key = 0;
+        int kind = 0;
+        QPoint cell;
+        QSGGeometryNode *fill = nullptr;
+        QSGGeometryNode *outline = nullptr;
+    };
+
+    ~VolumeRootNode() override
+    {
+        // The geometry nodes do not own the shared geometries.
+        for (const Volume &volume : std::as_const(volumes)) {
+            delete volume.fill;
+            delete volume.outline;
+        }
+        qDeleteAll(cells);
+        for (const Shared &shared : std::as_const(geometries)) {
+            delete shared.fill;
+            delete shared.outline;
+        }
+    }
+
+    void add(const QString &id, Key key, int kind, const VolumeMesh &mesh)
+    {
+        Shared &shared = geometries[key];
+        if (shared.users++ == 0) {
+            shared.fill = staticGeometry(mesh.fill, QSGGeometry::DrawTriangles);
+            shared.outline = staticGeometry(mesh.outline, QSGGeometry::DrawLines);
+        }
+        QSGTransformNode *&cell = cells[mesh.cell];
+        if (!cell) {
+            cell = new QSGTransformNode;
+            appendChildNode(cell);
+        }
+
+        Volume volume;
+        volume.key = key;
+        volume.kind = kind;
+        volume.cell = mesh.cell;
+        volume.fill = new QSGGeometryNode;
+        volume.fill->setGeometry(shared.fill);
+        volume.fill->setMaterial(&fillMaterials[kind]);
+        volume.outline = new QSGGeometryNode;
+        volume.outline->setGeometry(shared.outline);
+        volume.outline->setMaterial(&outlineMaterials[kind]);
+        cell->appendChildNode(volume.fill);
+        cell->appendChildNode(volume.outline);
+        volumes.insert(id, volume);
+    }
+
+    void remove(QHash<QString, Volume>::iterator found)
+    {
+        const Volume volume = *found;
+        volumes.erase(found);
+        QSGTransformNode *cell = cells.value(volume.cell);
+        cell->removeChildNode(volume.fill);
+        cell->removeChildNode(volume.outline);
+        delete volume.fill;
+        delete volume.outline;
+        if (cell->childCount() == 0) {
+            removeChildNode(cell);
+            cells.remove(volume.cell);
+            delete cell;
+        }
+        const auto shared = geometries.find(volume.key);
+        if (--shared->users == 0) {
+            delete shared->fill;
+            delete shared->outline;
+            geometries.erase(shared);
+        }
+    }
+
+    QHash<Key, Shared> geometries;
+    QHash<QPoint, QSGTransformNode *> cells;
+    QHash<QString, Volume> volumes;
+    QSGFlatColorMaterial fillMaterials[2]; // by OperationVolume::Kind
+    QSGFlatColorMaterial outlineMaterials[2];
+};
+
+} // namespace
+
+VolumeMapLayer::VolumeMapLayer(QQuickItem *parent)
+    : MapLayer(parent)
+{
+}
+
+void VolumeMapLayer::setMeshes(VolumeMeshCache *meshes)
+{
+    if (meshes == m_meshes)
+        return;
+    if (m_meshes)
+        disconnect(m_meshes, nullptr, this, nullptr);
+    m_meshes = meshes;
+    if (m_meshes)
+        connect(m_meshes, &VolumeMeshCache::meshesChanged, this, &VolumeMapLayer::onMeshesChanged);
+    onMeshesChanged();
+    emit meshesChanged();
+}
+
+void VolumeMapLayer::setIntentColor(const QColor &color)
+{
+    if (color == m_intentColor)
+        return;
+    m_intentColor = color;
+    m_colorsDirty = true;
+    update();
+    emit appearanceChanged();
+}
+
+void VolumeMapLayer::setConstraintColor(const QColor &color)
+{
+    if (color == m_constraintColor)
+        return;
+    m_constraintColor = color;
+    m_colorsDirty = true;
+    update();
+    emit appearanceChanged();
+}
+
+void VolumeMapLayer::onMeshesChanged()
+{
+    m_structureDirty = true;
+    update();
+}
+
+QSGNode *VolumeMapLayer::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto *root = static_cast<VolumeRootNode *>(oldNode);
+    if (!root)
+        root = new VolumeRootNode;
+
+    if (m_colorsDirty) {
+        const QColor colors[2] = {m_intentColor, m_constraintColor};
+        for (int kind = 0; kind < 2; ++kind) {
+            root->fillMaterials[kind].setColor(colors[kind]);
+            QColor opaque = colors[kind];
+            opaque.setAlpha(255);
+            root->outlineMaterials[kind].setColor(opaque);
+        }
+        for (const auto &volume : std::as_const(root->volumes)) {
+            volume.fill->markDirty(QSGNode::DirtyMaterial);
+            volume.outline->markDirty(QSGNode::DirtyMaterial);
+        }
+        m_colorsDirty = false;
+    }
+
+    if (m_structureDirty) {
+        // The GUI thread is blocked here, so the store and cache hold still.
+        QSet<QString> present;
+        const OperationVolumeStore *store = m_meshes ? m_meshes->volumes() : nullptr;
+        for (int i = 0; store && i < store->count(); ++i) {
+            const Key key = m_meshes->key(i);
+            if (key == 0)
+                continue; // not meshed yet
+            const OperationVolume &volume = store->at(i);
+            const int kind = int(volume.kind);
+            present.insert(volume.id);
+            const auto found = root->volumes.find(volume.id);
+            if (found != root->volumes.end()) {
+                if (found->key == key && found->kind == kind)
+                    continue;
+                root->remove(found);
+            }
+            root->add(volume.id, key, kind, *m_meshes->mesh(i));
+        }
+        QStringList gone;
+        for (auto it = root->volumes.cbegin(); it != root->volumes.cend(); ++it) {
+            if (!present.contains(it.key()))
+                gone.append(it.key());
+        }
+        for (const QString &id : std::as_const(gone))
+            root->remove(root->volumes.find(id));
+        m_structureDirty = false;
+    }
+
+    for (auto it = root->cells.cbegin(); it != root->cells.cend(); ++it) {
+        const QPointF origin(it.key().x() * VolumeMesh::cellSize, it.key().y() * VolumeMesh::cellSize);
+        it.value()->setMatrix(viewMatrix(origin));
+    }
+    return root;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QColor>
+#include <QPointer>
+
+#include "map/maplayer.h"
+#include "map/volumemeshcache.h"
+
+// Operation volume footprints on the Home map, from a VolumeMeshCache.
+// Each distinct outline becomes one static vertex buffer, shared by every
+// volume with that outline and uploaded once; volumes are grouped under
+// one transform per map cell, so panning and zooming only change a
+// handful of matrices and never touch vertex data. Nodes are only rebuilt
+// for volumes whose mesh, kind or presence changed.
+class VolumeMapLayer : public MapLayer
+{
+    Q_OBJECT
+    Q_PROPERTY(VolumeMeshCache *meshes READ meshes WRITE setMeshes NOTIFY meshesChanged)
+    Q_PROPERTY(QColor intentColor READ intentColor WRITE setIntentColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor constraintColor READ constraintColor WRITE setConstraintColor NOTIFY appearanceChanged)
+
+public:
+    explicit VolumeMapLayer(QQuickItem *parent = nullptr);
+
+    VolumeMeshCache *meshes() const { return m_meshes; }
+    void setMeshes(VolumeMeshCache *meshes);
+    // Fills use the colour's alpha, outlines draw it opaque.
+    QColor intentColor() const { return m_intentColor; }
+    void setIntentColor(const QColor &color);
+    QColor constraintColor() const { return m_constraintColor; }
+    void setConstraintColor(const QColor &color);
+
+signals:
+    void meshesChanged();
+    void appearanceChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    void onMeshesChanged();
+
+    QPointer<VolumeMeshCache> m_meshes;
+    QColor m_intentColor = QColor(0x3a, 0x8e, 0xe6, 0x40);
+    QColor m_constraintColor = QColor(0xe6, 0x3a, 0x3a, 0x40);
+    bool m_structureDirty = true;
+    bool m_colorsDirty = true;
+};
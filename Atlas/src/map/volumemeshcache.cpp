@@ -0,0 +1,142 @@
+#include "volumemeshcache.h"
+
+#include <QtConcurrent>
+
+#include <cmath>
+
+#include "geometry/triangulation.h"
+#include "map/webmercator.h"
+
+VolumeMeshCache::VolumeMeshCache(OperationVolumeStore *volumes, QObject *parent)
+    : QObject(parent)
+    , m_volumes(volumes)
+{
+    connect(m_volumes, &OperationVolumeStore::volumeChanged, this, &VolumeMeshCache::onVolumeChanged);
+    connect(m_volumes, &OperationVolumeStore::volumeRemoved, this, &VolumeMeshCache::onVolumeRemoved);
+    connect(&m_worker, &QFutureWatcher<Result>::finished, this, &VolumeMeshCache::onWorkerFinished);
+    for (int i = 0; i < m_volumes->count(); ++i)
+        onVolumeChanged(i);
+}
+
+VolumeMeshCache::~VolumeMeshCache()
+{
+    m_worker.waitForFinished();
+}
+
+VolumeMeshCache::Key VolumeMeshCache::key(int index) const
+{
+    if (index < 0 || size_t(index) >= m_keys.size())
+        return 0;
+    const Key key = m_keys[size_t(index)];
+    return m_meshes.contains(key) ? key : 0;
+}
+
+std::shared_ptr<const VolumeMesh> VolumeMeshCache::mesh(int index) const
+{
+    return m_meshes.value(key(index));
+}
+
+VolumeMeshCache::Key VolumeMeshCache::outlineKey(const std::vector<QPointF> &outline)
+{
+    static_assert(sizeof(QPointF) == 2 * sizeof(double), "outline hashed as raw doubles");
+    const Key key = Key(qHashBits(outline.data(), outline.size() * sizeof(QPointF), 0x4174736d));
+    return key != 0 ? key : 1; // 0 means not meshed
+}
+
+std::shared_ptr<const VolumeMesh> VolumeMeshCache::build(const std::vector<QPointF> &outline)
+{
+    auto mesh = std::make_shared<VolumeMesh>();
+    if (outline.size() < 3)
+        return mesh;
+
+    std::vector<QPointF> ring;
+    ring.reserve(outline.size());
+    for (const QPointF &point : outline)
+        ring.push_back(WebMercator::fromLatLon(point.y(), point.x()));
+    mesh->cell = QPoint(int(std::floor(ring.front().x() / VolumeMesh::cellSize)),
+                        int(std::floor(ring.front().y() / VolumeMesh::cellSize)));
+    const QPointF origin = mesh->cellOrigin();
+    for (QPointF &point : ring)
+        point -= origin;
+
+    const std::vector<uint32_t> triangles = triangulatePolygon(ring);
+    mesh->fill.reserve(triangles.size());
+    for (const uint32_t index : triangles)
+        mesh->fill.emplace_back(ring[index]);
+    mesh->outline.reserve(ring.size() * 2);
+    for (size_t i = 0; i < ring.size(); ++i) {
+        mesh->outline.emplace_back(ring[i]);
+        mesh->outline.emplace_back(ring[(i + 1) % ring.size()]);
+    }
+    return mesh;
+}
+
+void VolumeMeshCache::onVolumeChanged(int index)
+{
+    if (size_t(index) >= m_keys.size())
+        m_keys.resize(size_t(index) + 1, 0);
+    const OperationVolume &volume = m_volumes->at(index);
+    const Key key = outlineKey(volume.outline);
+    const Key old = m_keys[size_t(index)];
+    if (key != old) {
+        m_keys[size_t(index)] = key;
+        if (m_references[key]++ == 0 && !m_meshes.contains(key)) {
+            m_pending.emplace_back(key, volume.outline);
+            startWorker();
+        }
+        if (old != 0)
+            release(old);
+    }
+    // Kind and altitudes are not in the mesh but still change how it is drawn.
+    emit meshesChanged();
+}
+
+void VolumeMeshCache::onVolumeRemoved(const QString &, int index)
+{
+    // The store moved its last volume into index; follow it.
+    if (size_t(index) >= m_keys.size())
+        return;
+    if (m_keys[size_t(index)] != 0)
+        release(m_keys[size_t(index)]);
+    m_keys[size_t(index)] = m_keys.back();
+    m_keys.pop_back();
+    emit meshesChanged();
+}
+
+void VolumeMeshCache::release(Key key)
+{
+    const auto found = m_references.find(key);
+    if (found == m_references.end() || --*found > 0)
+        return;
+    m_references.erase(found);
+    m_meshes.remove(key);
+}
+
+void VolumeMeshCache::startWorker()
+{
+    if (m_worker.isRunning() || m_pending.empty())
+        return;
+    Job job;
+    job.swap(m_pending);
+    m_worker.setFuture(QtConcurrent::run([job = std::move(job)] {
+        Result result;
+        result.reserve(job.size());
+        for (const auto &[key, outline] : job)
+            result.emplace_back(key, build(outline));
+        return result;
+    }));
+}
+
+void VolumeMeshCache::onWorkerFinished()
+{
+    const Result result = m_worker.result();
+    for (const auto &[key, mesh] : result) {
+        // Dropped if every volume with that outline changed or went away
+        // while it was being built.
+        if (m_references.contains(key))
+            m_meshes.insert(key, mesh);
+    }
+    if (!result.empty())
+        emit meshesChanged();
+    startWorker();
+}
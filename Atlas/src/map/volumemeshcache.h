@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPoint>
+#include <QVector2D>
+
+#include <memory>
+#include <vector>
+
+#include "state/operationvolumestore.h"
+
+// The map footprint of an operation volume: its outline triangulated for
+// the fill and turned into line segments for the outline, in mercator
+// metres from the origin of the map cell it starts in. Offsets within a
+// cell are small enough for float to stay exact to the millimetre.
+struct VolumeMesh
+{
+    static constexpr double cellSize = 100000; // mercator metres
+
+    QPoint cell;
+    std::vector<QVector2D> fill;    // triangle list
+    std::vector<QVector2D> outline; // line list, two vertices per edge
+
+    QPointF cellOrigin() const { return QPointF(cell.x() * cellSize, cell.y() * cellSize); }
+};
+
+// Map meshes of every volume in an OperationVolumeStore, keyed by a hash of
+// the outline. Triangulation and outline building run on a pool thread, so
+// a feed landing thousands of volumes never stalls the GUI. A volume is
+// only re-meshed when its outline changes (not its altitudes, times or
+// kind), and volumes sharing an outline share one mesh. GUI thread only.
+class VolumeMeshCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Key = quint64;
+
+    explicit VolumeMeshCache(OperationVolumeStore *volumes, QObject *parent = nullptr);
+    ~VolumeMeshCache() override;
+
+    OperationVolumeStore *volumes() const { return m_volumes; }
+
+    // The volume at a store index; the key is 0 and the mesh null until its
+    // current outline has been meshed.
+    Key key(int index) const;
+    std::shared_ptr<const VolumeMesh> mesh(int index) const;
+
+    static Key outlineKey(const std::vector<QPointF> &outline);
+    static std::shared_ptr<const VolumeMesh> build(const std::vector<QPointF> &outline);
+
+signals:
+    // Some volume's mesh, key or store index changed.
+    void meshesChanged();
+
+private:
+    using Job = std::vector<std::pair<Key, std::vector<QPointF>>>;
+    using Result = std::vector<std::pair<Key, std::shared_ptr<const VolumeMesh>>>;
+
+    void onVolumeChanged(int index);
+    void onVolumeRemoved(const QString &id, int index);
+    void release(Key key);
+    void startWorker();
+    void onWorkerFinished();
+
+    OperationVolumeStore *m_volumes;
+    std::vector<Key> m_keys; // per store index, outline key even while pending
+    QHash<Key, std::shared_ptr<const VolumeMesh>> m_meshes;
+    QHash<Key, int> m_references; // volumes per key, meshed or pending
+    Job m_pending;
+    QFutureWatcher<Result> m_worker;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QPointF>
+
+#include <algorithm>
+#include <cmath>
+
+// EPSG:3857, in metres; x east, y north. What every slippy map uses, so
+// zooming is a uniform scale of these coordinates.
+namespace WebMercator {
+
+constexpr double earthRadius = 6378137;
+constexpr double maxLatitude = 85.05112878;
+constexpr double tileSize = 256; // pixels per world at zoom 0
+
+inline QPointF fromLatLon(double latitude, double longitude)
+{
+    const double lat = std::clamp(latitude, -maxLatitude, maxLatitude) * M_PI / 180;
+    return QPointF(earthRadius * longitude * M_PI / 180, earthRadius * std::log(std::tan(M_PI / 4 + lat / 2)));
+}
+
+inline double latitude(double y)
+{
+    return (2 * std::atan(std::exp(y / earthRadius)) - M_PI / 2) * 180 / M_PI;
+}
+
+inline double longitude(double x)
+{
+    return x / earthRadius * 180 / M_PI;
+}
+
+// Screen pixels per mercator metre at a zoom level.
+inline double pixelsPerMetre(double zoomLevel)
+{
+    return tileSize * std::exp2(zoomLevel) / (2 * M_PI * earthRadius);
+}
+
+} // namespace WebMercator
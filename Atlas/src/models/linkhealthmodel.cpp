@@ -0,0 +1,210 @@
+#include "linkhealthmodel.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <limits>
+
+using TrafficSnapshot::healthBucketBoundsMs;
+using TrafficSnapshot::healthBuckets;
+
+namespace {
+
+constexpr int sampleIntervalMs = 1000;
+constexpr double noValue = std::numeric_limits<double>::quiet_NaN();
+
+QVariant optional(double value)
+{
+    return std::isnan(value) ? QVariant() : QVariant(value);
+}
+
+QList<qreal> counts(const std::array<quint64, healthBuckets> &buckets)
+{
+    QList<qreal> out;
+    out.reserve(healthBuckets);
+    for (const quint64 count : buckets)
+        out.append(qreal(count));
+    return out;
+}
+
+} // namespace
+
+LinkHealthModel::LinkHealthModel(SnapshotFeed *feed, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_feed(feed)
+{
+    m_sampleTimer.setInterval(sampleIntervalMs);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &LinkHealthModel::sample);
+    m_sampleTimer.start();
+}
+
+int LinkHealthModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_links.size());
+}
+
+QVariant LinkHealthModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+        return {};
+
+    const Link &link = m_links[size_t(index.row())];
+    const Second *latest = link.filled > 0
+                               ? &link.history[size_t((link.head + HistoryLength - 1) % HistoryLength)]
+                               : nullptr;
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return link.name;
+    case LossPercentRole:
+        return latest ? QVariant(latest->lossPercent) : QVariant();
+    case ThroughputRole:
+        return latest ? QVariant(latest->throughput) : QVariant();
+    case JitterRole:
+        return optional(quantile(link.jitterWindow, 0.95));
+    case RoundTripRole:
+        return optional(quantile(link.roundTripWindow, 0.5));
+    case LossHistoryRole:
+        return QVariant::fromValue(history(link, &Second::lossPercent));
+    case ThroughputHistoryRole:
+        return QVariant::fromValue(history(link, &Second::throughput));
+    case JitterHistoryRole:
+        return QVariant::fromValue(history(link, &Second::jitterMs));
+    case RoundTripHistoryRole:
+        return QVariant::fromValue(history(link, &Second::roundTripMs));
+    case JitterBucketsRole:
+        return QVariant::fromValue(counts(link.jitterWindow));
+    case RoundTripBucketsRole:
+        return QVariant::fromValue(counts(link.roundTripWindow));
+    }
+    return {};
+}
+
+QHash<int, QByteArray> LinkHealthModel::roleNames() const
+{
+    return {
+        {NameRole, "name"},
+        {LossPercentRole, "lossPercent"},
+        {ThroughputRole, "throughput"},
+        {JitterRole, "jitter"},
+        {RoundTripRole, "roundTrip"},
+        {LossHistoryRole, "lossHistory"},
+        {ThroughputHistoryRole, "throughputHistory"},
+        {JitterHistoryRole, "jitterHistory"},
+        {RoundTripHistoryRole, "roundTripHistory"},
+        {JitterBucketsRole, "jitterBuckets"},
+        {RoundTripBucketsRole, "roundTripBuckets"},
+    };
+}
+
+QList<qreal> LinkHealthModel::bucketBoundsMs() const
+{
+    return QList<qreal>(std::begin(healthBucketBoundsMs), std::end(healthBucketBoundsMs));
+}
+
+LinkHealthModel::Totals LinkHealthModel::read(const TrafficSnapshot::LinkHealth &health)
+{
+    Totals totals;
+    totals.frames = health.frames.load(std::memory_order_relaxed);
+    totals.lost = health.lost.load(std::memory_order_relaxed);
+    totals.bytes = health.bytes.load(std::memory_order_relaxed);
+    for (int bucket = 0; bucket < healthBuckets; ++bucket) {
+        totals.jitter[size_t(bucket)] = health.jitterBuckets[bucket].load(std::memory_order_relaxed);
+        totals.roundTrip[size_t(bucket)] = health.roundTripBuckets[bucket].load(std::memory_order_relaxed);
+    }
+    return totals;
+}
+
+// Interpolated within the bucket the quantile falls in; the open last
+// bucket reports its lower bound. NaN without samples.
+double LinkHealthModel::quantile(const Buckets &buckets, double q)
+{
+    quint64 total = 0;
+    for (const quint64 count : buckets)
+        total += count;
+    if (total == 0)
+        return noValue;
+
+    const double rank = q * double(total);
+    double below = 0;
+    for (int bucket = 0; bucket < healthBuckets; ++bucket) {
+        const double count = double(buckets[size_t(bucket)]);
+        if (below + count >= rank && count > 0) {
+            if (bucket == healthBuckets - 1)
+                return healthBucketBoundsMs[bucket - 1];
+            const double lower = bucket > 0 ? healthBucketBoundsMs[bucket - 1] : 0;
+            return lower + (healthBucketBoundsMs[bucket] - lower) * (rank - below) / count;
+        }
+        below += count;
+    }
+    return healthBucketBoundsMs[healthBuckets - 2];
+}
+
+QList<qreal> LinkHealthModel::history(const Link &link, double Second::*value) const
+{
+    QList<qreal> points;
+    points.reserve(link.filled);
+    for (int i = link.filled; i > 0; --i)
+        points.append(link.history[size_t((link.head + HistoryLength - i) % HistoryLength)].*value);
+    return points;
+}
+
+void LinkHealthModel::sample()
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const double seconds = m_lastSampleMs > 0 ? double(nowMs - m_lastSampleMs) / 1000.0 : 0;
+    m_lastSampleMs = nowMs;
+
+    // Links are named at daemon start; a restarted daemon may have others.
+    int count = 0;
+    while (count < TrafficSnapshot::maxLinks && m_feed->linkHealth(count) && !m_feed->linkName(count).isEmpty())
+        ++count;
+    bool renamed = count != int(m_links.size());
+    for (int i = 0; i < count && !renamed; ++i)
+        renamed = m_links[size_t(i)].name != m_feed->linkName(i);
+    if (renamed) {
+        beginResetModel();
+        m_links.assign(size_t(count), Link());
+        for (int i = 0; i < count; ++i) {
+            Link &link = m_links[size_t(i)];
+            link.name = m_feed->linkName(i);
+            link.history.resize(HistoryLength);
+            link.last = read(*m_feed->linkHealth(i));
+        }
+        endResetModel();
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        Link &link = m_links[size_t(i)];
+        const Totals now = read(*m_feed->linkHealth(i));
+        if (now.frames < link.last.frames || now.lost < link.last.lost || now.bytes < link.last.bytes) {
+            // A fresh region under the same link names; start over from it.
+            link.last = now;
+            continue;
+        }
+
+        Second &second = link.history[size_t(link.head)];
+        for (int bucket = 0; bucket < healthBuckets; ++bucket) {
+            const size_t b = size_t(bucket);
+            link.jitterWindow[b] -= second.jitter[b];
+            link.roundTripWindow[b] -= second.roundTrip[b];
+            second.jitter[b] = now.jitter[b] - link.last.jitter[b];
+            second.roundTrip[b] = now.roundTrip[b] - link.last.roundTrip[b];
+            link.jitterWindow[b] += second.jitter[b];
+            link.roundTripWindow[b] += second.roundTrip[b];
+        }
+        const quint64 frames = now.frames - link.last.frames;
+        const quint64 lost = now.lost - link.last.lost;
+        second.lossPercent = frames + lost > 0 ? 100.0 * double(lost) / double(frames + lost) : 0;
+        second.throughput = seconds > 0 ? double(now.bytes - link.last.bytes) / seconds : 0;
+        second.jitterMs = quantile(second.jitter, 0.95);
+        second.roundTripMs = quantile(second.roundTrip, 0.5);
+
+        link.head = (link.head + 1) % HistoryLength;
+        link.filled = std::min(link.filled + 1, int(HistoryLength));
+        link.last = now;
+    }
+    if (count > 0)
+        emit dataChanged(index(0), index(count - 1));
+}
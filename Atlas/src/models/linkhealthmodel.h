@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QTimer>
+
+#include <array>
+#include <vector>
+
+#include "state/snapshotfeed.h"
+
+// Link health for the Debug page, one row per daemon link. Once a second
+// the daemon's running totals are read out of the traffic snapshot
+// (relaxed atomic loads, no locks) and the change since the last sample
+// becomes one point of each history. The histograms cover the same
+// rolling window as the histories.
+class LinkHealthModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QList<qreal> bucketBoundsMs READ bucketBoundsMs CONSTANT)
+    Q_PROPERTY(int historyLength READ historyLength CONSTANT)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        LossPercentRole,
+        ThroughputRole,      // bytes per second
+        JitterRole,          // 95th percentile, ms
+        RoundTripRole,       // median, ms
+        LossHistoryRole,     // oldest first, one point per second
+        ThroughputHistoryRole,
+        JitterHistoryRole,
+        RoundTripHistoryRole,
+        JitterBucketsRole,   // counts per bucketBoundsMs bucket, last one open
+        RoundTripBucketsRole,
+    };
+
+    explicit LinkHealthModel(SnapshotFeed *feed, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QList<qreal> bucketBoundsMs() const;
+    int historyLength() const { return HistoryLength; }
+
+private:
+    static constexpr int HistoryLength = 120;
+
+    using Buckets = std::array<quint64, TrafficSnapshot::healthBuckets>;
+
+    struct Totals
+    {
+        quint64 frames = 0;
+        quint64 lost = 0;
+        quint64 bytes = 0;
+        Buckets jitter = {};
+        Buckets roundTrip = {};
+    };
+
+    struct Second
+    {
+        double lossPercent = 0;
+        double throughput = 0;
+        double jitterMs = 0;
+        double roundTripMs = 0;
+        Buckets jitter = {};
+        Buckets roundTrip = {};
+    };
+
+    struct Link
+    {
+        QString name;
+        Totals last;
+        std::vector<Second> history; // ring of HistoryLength
+        int head = 0;                // next slot to write
+        int filled = 0;
+        Buckets jitterWindow = {};   // sums over history
+        Buckets roundTripWindow = {};
+    };
+
+    void sample();
+    static Totals read(const TrafficSnapshot::LinkHealth &health);
+    static double quantile(const Buckets &buckets, double q);
+    QList<qreal> history(const Link &link, double Second::*value) const;
+
+    SnapshotFeed *m_feed;
+    std::vector<Link> m_links;
+    QTimer m_sampleTimer;
+    qint64 m_lastSampleMs = 0;
+};
@@ -0,0 +1,359 @@
+#include "livesortfiltermodel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Source inserts larger than this are cheaper to apply as one reset than as
+// individual binary-search inserts.
+constexpr int LargeInsert = 256;
+
+} // namespace
+
+LiveSortFilterModel::LiveSortFilterModel(QObject *parent)
+    : QAbstractProxyModel(parent)
+{
+}
+
+void LiveSortFilterModel::setSourceModel(QAbstractItemModel *model)
+{
+    if (model == sourceModel())
+        return;
+
+    for (const QMetaObject::Connection &connection : m_connections)
+        disconnect(connection);
+    m_connections.clear();
+
+    QAbstractProxyModel::setSourceModel(model);
+
+    if (model) {
+        m_connections = {
+            connect(model, &QAbstractItemModel::dataChanged, this, &LiveSortFilterModel::onDataChanged),
+            connect(model, &QAbstractItemModel::rowsInserted, this, &LiveSortFilterModel::onRowsInserted),
+            connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+                    &LiveSortFilterModel::onRowsAboutToBeRemoved),
+            connect(model, &QAbstractItemModel::rowsRemoved, this, &LiveSortFilterModel::onRowsRemoved),
+            connect(model, &QAbstractItemModel::rowsMoved, this, &LiveSortFilterModel::rebuild),
+            connect(model, &QAbstractItemModel::layoutChanged, this, &LiveSortFilterModel::rebuild),
+            connect(model, &QAbstractItemModel::modelReset, this, &LiveSortFilterModel::rebuild),
+        };
+    }
+    rebuild();
+}
+
+QModelIndex LiveSortFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!sourceModel() || !proxyIndex.isValid() || proxyIndex.row() >= count())
+        return {};
+    return sourceModel()->index(m_proxyToSource[proxyIndex.row()], proxyIndex.column());
+}
+
+QModelIndex LiveSortFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid() || sourceIndex.parent().isValid()
+        || sourceIndex.row() >= int(m_sourceToProxy.size()))
+        return {};
+    const int row = m_sourceToProxy[sourceIndex.row()];
+    return row < 0 ? QModelIndex() : createIndex(row, sourceIndex.column());
+}
+
+QModelIndex LiveSortFilterModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= count() || column < 0 || column >= columnCount())
+        return {};
+    return createIndex(row, column);
+}
+
+QModelIndex LiveSortFilterModel::parent(const QModelIndex &) const
+{
+    return {};
+}
+
+int LiveSortFilterModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count();
+}
+
+int LiveSortFilterModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() || !sourceModel() ? 0 : sourceModel()->columnCount();
+}
+
+void LiveSortFilterModel::setSortRoleName(const QString &name)
+{
+    if (m_sortRoleName == name)
+        return;
+    m_sortRoleName = name;
+    rebuild();
+    emit sortChanged();
+}
+
+void LiveSortFilterModel::setSortOrder(Qt::SortOrder order)
+{
+    if (m_sortOrder == order)
+        return;
+    m_sortOrder = order;
+    rebuild();
+    emit sortChanged();
+}
+
+void LiveSortFilterModel::setFilterRoleName(const QString &name)
+{
+    if (m_filterRoleName == name)
+        return;
+    m_filterRoleName = name;
+    rebuild();
+    emit filterChanged();
+}
+
+void LiveSortFilterModel::setFilterText(const QString &text)
+{
+    if (m_filterText == text)
+        return;
+    m_filterText = text;
+    rebuild();
+    emit filterChanged();
+}
+
+void LiveSortFilterModel::setFilterPredicate(FilterPredicate predicate)
+{
+    m_predicate = std::move(predicate);
+    rebuild();
+    emit filterChanged();
+}
+
+// Full pass; only used when the source resets or the sort/filter settings
+// themselves change, never for value updates.
+void LiveSortFilterModel::rebuild()
+{
+    beginResetModel();
+    resolveRoles();
+
+    const int rows = sourceModel() ? sourceModel()->rowCount() : 0;
+    m_keys.assign(rows, SortKey());
+    m_sourceToProxy.assign(rows, -1);
+    m_proxyToSource.clear();
+    m_proxyToSource.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        m_keys[row] = readKey(row);
+        if (accepts(row))
+            m_proxyToSource.push_back(row);
+    }
+    std::sort(m_proxyToSource.begin(), m_proxyToSource.end(),
+              [this](int left, int right) { return lessThan(left, right); });
+    renumber(0, count() - 1);
+
+    endResetModel();
+    emit countChanged();
+}
+
+void LiveSortFilterModel::resolveRoles()
+{
+    m_sortRole = -1;
+    m_filterRole = -1;
+    if (!sourceModel())
+        return;
+
+    const QHash<int, QByteArray> names = sourceModel()->roleNames();
+    for (auto it = names.cbegin(); it != names.cend(); ++it) {
+        if (!m_sortRoleName.isEmpty() && it.value() == m_sortRoleName.toUtf8())
+            m_sortRole = it.key();
+        if (!m_filterRoleName.isEmpty() && it.value() == m_filterRoleName.toUtf8())
+            m_filterRole = it.key();
+    }
+}
+
+LiveSortFilterModel::SortKey LiveSortFilterModel::readKey(int sourceRow) const
+{
+    SortKey key;
+    if (m_sortRole < 0)
+        return key;
+
+    const QVariant value = sourceModel()->index(sourceRow, 0).data(m_sortRole);
+    bool ok = false;
+    const double number = value.toDouble(&ok);
+    if (ok && value.typeId() != QMetaType::QString) {
+        key.isNumber = true;
+        key.number = number;
+    } else {
+        key.text = value.toString();
+    }
+    return key;
+}
+
+bool LiveSortFilterModel::accepts(int sourceRow) const
+{
+    const QModelIndex index = sourceModel()->index(sourceRow, 0);
+    if (m_filterRole >= 0 && !m_filterText.isEmpty()
+        && !index.data(m_filterRole).toString().contains(m_filterText, Qt::CaseInsensitive))
+        return false;
+    return !m_predicate || m_predicate(index);
+}
+
+// Strict weak ordering: ties fall back to source row so every row has
+// exactly one valid slot and binary searches are deterministic.
+bool LiveSortFilterModel::lessThan(int leftSourceRow, int rightSourceRow) const
+{
+    const SortKey &left = m_keys[leftSourceRow];
+    const SortKey &right = m_keys[rightSourceRow];
+
+    int order = 0;
+    if (left.isNumber != right.isNumber) {
+        order = left.isNumber ? -1 : 1; // numbers before text
+    } else if (left.isNumber) {
+        if (left.number < right.number || (!std::isnan(left.number) && std::isnan(right.number)))
+            order = -1;
+        else if (right.number < left.number || (std::isnan(left.number) && !std::isnan(right.number)))
+            order = 1;
+    } else {
+        order = left.text.compare(right.text, Qt::CaseInsensitive);
+    }
+
+    if (order != 0)
+        return m_sortOrder == Qt::AscendingOrder ? order < 0 : order > 0;
+    return leftSourceRow < rightSourceRow;
+}
+
+int LiveSortFilterModel::insertionPoint(int sourceRow, int first, int last) const
+{
+    const auto begin = m_proxyToSource.cbegin();
+    return int(std::lower_bound(begin + first, begin + last, sourceRow,
+                                [this](int element, int row) { return lessThan(element, row); })
+               - begin);
+}
+
+void LiveSortFilterModel::renumber(int firstProxyRow, int lastProxyRow)
+{
+    for (int row = firstProxyRow; row <= lastProxyRow; ++row)
+        m_sourceToProxy[m_proxyToSource[row]] = row;
+}
+
+void LiveSortFilterModel::insertVisible(int sourceRow)
+{
+    const int row = insertionPoint(sourceRow, 0, count());
+    beginInsertRows(QModelIndex(), row, row);
+    m_proxyToSource.insert(m_proxyToSource.begin() + row, sourceRow);
+    renumber(row, count() - 1);
+    endInsertRows();
+    emit countChanged();
+}
+
+void LiveSortFilterModel::removeVisible(int sourceRow)
+{
+    const int row = m_sourceToProxy[sourceRow];
+    beginRemoveRows(QModelIndex(), row, row);
+    m_proxyToSource.erase(m_proxyToSource.begin() + row);
+    m_sourceToProxy[sourceRow] = -1;
+    renumber(row, count() - 1);
+    endRemoveRows();
+    emit countChanged();
+}
+
+// Moves one row whose key changed. The common case -- still ordered against
+// both neighbours -- costs two comparisons and emits nothing.
+void LiveSortFilterModel::reposition(int sourceRow)
+{
+    const int from = m_sourceToProxy[sourceRow];
+    const auto begin = m_proxyToSource.begin();
+
+    if (from > 0 && lessThan(sourceRow, m_proxyToSource[from - 1])) {
+        const int to = insertionPoint(sourceRow, 0, from);
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), to);
+        std::rotate(begin + to, begin + from, begin + from + 1);
+        renumber(to, from);
+        endMoveRows();
+    } else if (from + 1 < count() && lessThan(m_proxyToSource[from + 1], sourceRow)) {
+        const int to = insertionPoint(sourceRow, from + 1, count());
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), to);
+        std::rotate(begin + from, begin + from + 1, begin + to);
+        renumber(from, to - 1);
+        endMoveRows();
+    }
+}
+
+void LiveSortFilterModel::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                        const QList<int> &roles)
+{
+    if (topLeft.parent().isValid())
+        return;
+
+    const bool sortTouched = m_sortRole >= 0 && (roles.isEmpty() || roles.contains(m_sortRole));
+    const bool filterTouched = roles.isEmpty() || (m_filterRole >= 0 && roles.contains(m_filterRole));
+
+    for (int sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); ++sourceRow) {
+        if (sortTouched)
+            m_keys[sourceRow] = readKey(sourceRow);
+
+        const bool visible = m_sourceToProxy[sourceRow] >= 0;
+        if (filterTouched) {
+            const bool accepted = accepts(sourceRow);
+            if (accepted && !visible) {
+                insertVisible(sourceRow);
+                continue;
+            }
+            if (!accepted && visible) {
+                removeVisible(sourceRow);
+                continue;
+            }
+        }
+        if (!visible)
+            continue;
+
+        if (sortTouched)
+            reposition(sourceRow);
+
+        const int row = m_sourceToProxy[sourceRow];
+        emit dataChanged(index(row, topLeft.column()), index(row, bottomRight.column()), roles);
+    }
+}
+
+void LiveSortFilterModel::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    const int inserted = last - first + 1;
+    if (inserted > LargeInsert) {
+        rebuild();
+        return;
+    }
+
+    for (int &sourceRow : m_proxyToSource) {
+        if (sourceRow >= first)
+            sourceRow += inserted;
+    }
+    m_keys.insert(m_keys.begin() + first, inserted, SortKey());
+    m_sourceToProxy.insert(m_sourceToProxy.begin() + first, inserted, -1);
+
+    for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+        m_keys[sourceRow] = readKey(sourceRow);
+        if (accepts(sourceRow))
+            insertVisible(sourceRow);
+    }
+}
+
+void LiveSortFilterModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    for (int sourceRow = last; sourceRow >= first; --sourceRow) {
+        if (m_sourceToProxy[sourceRow] >= 0)
+            removeVisible(sourceRow);
+    }
+}
+
+void LiveSortFilterModel::onRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    const int removed = last - first + 1;
+    m_keys.erase(m_keys.begin() + first, m_keys.begin() + last + 1);
+    m_sourceToProxy.erase(m_sourceToProxy.begin() + first, m_sourceToProxy.begin() + last + 1);
+    for (int &sourceRow : m_proxyToSource) {
+        if (sourceRow > last)
+            sourceRow -= removed;
+    }
+}
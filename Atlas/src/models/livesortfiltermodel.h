@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QAbstractProxyModel>
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+// Sort/filter proxy for flat list models whose values change all the time
+// (battery, altitude, link quality). Unlike QSortFilterProxyModel it never
+// re-sorts on dataChanged: only the rows whose sort key changed are moved,
+// one beginMoveRows() each and only when they actually left their slot, and
+// the filter is only re-run for rows whose filter role changed.
+class LiveSortFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString sortRoleName READ sortRoleName WRITE setSortRoleName NOTIFY sortChanged)
+    Q_PROPERTY(Qt::SortOrder sortOrder READ sortOrder WRITE setSortOrder NOTIFY sortChanged)
+    Q_PROPERTY(QString filterRoleName READ filterRoleName WRITE setFilterRoleName NOTIFY filterChanged)
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    using FilterPredicate = std::function<bool(const QModelIndex &sourceIndex)>;
+
+    explicit LiveSortFilterModel(QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QString sortRoleName() const { return m_sortRoleName; }
+    void setSortRoleName(const QString &name);
+    Qt::SortOrder sortOrder() const { return m_sortOrder; }
+    void setSortOrder(Qt::SortOrder order);
+
+    QString filterRoleName() const { return m_filterRoleName; }
+    void setFilterRoleName(const QString &name);
+    QString filterText() const { return m_filterText; }
+    void setFilterText(const QString &text);
+
+    // Optional C++ predicate, applied in addition to filterText. Only rows
+    // whose filter role changes are re-evaluated, so the predicate must
+    // depend on that role alone.
+    void setFilterPredicate(FilterPredicate predicate);
+
+    int count() const { return int(m_proxyToSource.size()); }
+
+signals:
+    void sortChanged();
+    void filterChanged();
+    void countChanged();
+
+private:
+    struct SortKey
+    {
+        bool isNumber = false;
+        double number = 0;
+        QString text;
+    };
+
+    void rebuild();
+    void resolveRoles();
+    SortKey readKey(int sourceRow) const;
+    bool accepts(int sourceRow) const;
+    bool lessThan(int leftSourceRow, int rightSourceRow) const;
+    int insertionPoint(int sourceRow, int first, int last) const;
+    void renumber(int firstProxyRow, int lastProxyRow);
+
+    void insertVisible(int sourceRow);
+    void removeVisible(int sourceRow);
+    void reposition(int sourceRow);
+
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                       const QList<int> &roles);
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent, int first, int last);
+
+    QString m_sortRoleName;
+    QString m_filterRoleName;
+    QString m_filterText;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    FilterPredicate m_predicate;
+    int m_sortRole = -1;
+    int m_filterRole = -1;
+
+    std::vector<int> m_proxyToSource;
+    std::vector<int> m_sourceToProxy; // -1 when filtered out
+    std::vector<SortKey> m_keys;      // indexed by source row
+    std::vector<QMetaObject::Connection> m_connections;
+};
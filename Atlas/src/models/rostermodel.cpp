@@ -0,0 +1,155 @@
+#include "rostermodel.h"
+
+#include <cmath>
+
+RosterModel::RosterModel(Database *database, VehicleStateStore *vehicles, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_database(database)
+    , m_vehicles(vehicles)
+{
+    connect(m_database, &Database::rosterPageReady, this, &RosterModel::onPageReady);
+    connect(m_database, &Database::rosterCountReady, this, &RosterModel::onCountReady);
+    connect(m_database, &Database::rosterChanged, this, &RosterModel::reload);
+    connect(m_database, &Database::opened, this, [this](bool ok) {
+        if (ok)
+            reload();
+    });
+    if (m_vehicles)
+        connect(m_vehicles, &VehicleStateStore::fieldsChanged, this, &RosterModel::onFieldsChanged);
+}
+
+int RosterModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_rows.size());
+}
+
+QVariant RosterModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+        return {};
+
+    const RosterEntry &entry = m_rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case RegistrationRole:
+        return entry.registration;
+    case AirframeIdRole:
+        return entry.airframeId;
+    case MakeModelRole:
+        return entry.makeModel;
+    case SerialNumberRole:
+        return entry.serialNumber;
+    case SystemIdRole:
+        return entry.systemId;
+    case PilotNameRole:
+        return entry.pilotName;
+    case RegistrationExpiryRole:
+        return entry.registrationExpiry;
+    case CertificationExpiryRole:
+        return entry.certificationExpiry;
+    }
+
+    const int field = role - FirstFieldRole;
+    if (!m_vehicles || field < 0 || field >= VehicleFieldCount)
+        return {};
+    const int vehicle = m_vehicles->indexOf(entry.systemId);
+    if (vehicle < 0)
+        return {};
+    const double value = m_vehicles->at(vehicle).published[field];
+    return std::isnan(value) ? QVariant() : QVariant(value);
+}
+
+QHash<int, QByteArray> RosterModel::roleNames() const
+{
+    QHash<int, QByteArray> names = {
+        {AirframeIdRole, "airframeId"},
+        {RegistrationRole, "registration"},
+        {MakeModelRole, "makeModel"},
+        {SerialNumberRole, "serialNumber"},
+        {SystemIdRole, "systemId"},
+        {PilotNameRole, "pilotName"},
+        {RegistrationExpiryRole, "registrationExpiry"},
+        {CertificationExpiryRole, "certificationExpiry"},
+    };
+    for (int field = 0; field < VehicleFieldCount; ++field)
+        names.insert(FirstFieldRole + field, vehicleFieldName(VehicleField(field)));
+    return names;
+}
+
+bool RosterModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_exhausted && m_pendingRequest == 0;
+}
+
+void RosterModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    const qint64 after = m_rows.isEmpty() ? 0 : m_rows.constLast().airframeId;
+    m_pendingRequest = m_database->fetchRosterPage(after, PageSize);
+    emit loadingChanged();
+}
+
+void RosterModel::reload()
+{
+    beginResetModel();
+    m_rows.clear();
+    m_rowsBySystemId.clear();
+    m_exhausted = false;
+    // A page still in flight belongs to the old contents; its reply is
+    // ignored once m_pendingRequest moves on.
+    m_pendingRequest = 0;
+    endResetModel();
+
+    m_database->countRoster();
+    fetchMore(QModelIndex());
+}
+
+void RosterModel::onPageReady(quint64 requestId, const QList<RosterEntry> &rows)
+{
+    if (requestId != m_pendingRequest)
+        return;
+
+    m_pendingRequest = 0;
+    m_exhausted = rows.size() < PageSize;
+    if (!rows.isEmpty()) {
+        const int first = int(m_rows.size());
+        beginInsertRows(QModelIndex(), first, first + int(rows.size()) - 1);
+        m_rows.append(rows);
+        indexSystemIds(first, int(m_rows.size()) - 1);
+        endInsertRows();
+    }
+    emit loadingChanged();
+}
+
+void RosterModel::onCountReady(int count)
+{
+    if (m_totalCount == count)
+        return;
+    m_totalCount = count;
+    emit totalCountChanged();
+}
+
+void RosterModel::indexSystemIds(int first, int last)
+{
+    for (int row = first; row <= last; ++row) {
+        if (m_rows.at(row).systemId > 0)
+            m_rowsBySystemId.insert(m_rows.at(row).systemId, row);
+    }
+}
+
+void RosterModel::onFieldsChanged(const QList<VehicleFieldChange> &changes)
+{
+    for (const VehicleFieldChange &change : changes) {
+        const int systemId = m_vehicles->at(change.index).systemId;
+        auto it = m_rowsBySystemId.constFind(systemId);
+        if (it == m_rowsBySystemId.cend())
+            continue;
+        const QList<int> roles = vehicleFieldRoles(change.fields, FirstFieldRole);
+        for (; it != m_rowsBySystemId.cend() && it.key() == systemId; ++it) {
+            const QModelIndex row = index(it.value());
+            emit dataChanged(row, row, roles);
+        }
+    }
+}
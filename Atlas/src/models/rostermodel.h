@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QMultiHash>
+
+#include "persistence/database.h"
+#include "state/vehiclestatestore.h"
+
+// Roster page model. Rows are paged in from the Database on demand through
+// canFetchMore()/fetchMore(), so opening a large roster only loads what the
+// view is about to show.
+class RosterModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY totalCountChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+
+public:
+    enum Roles {
+        AirframeIdRole = Qt::UserRole + 1,
+        RegistrationRole,
+        MakeModelRole,
+        SerialNumberRole,
+        SystemIdRole,
+        PilotNameRole,
+        RegistrationExpiryRole,
+        CertificationExpiryRole,
+        FirstFieldRole = Qt::UserRole + 32, // live telemetry, + int(VehicleField)
+    };
+
+    // vehicles is optional; with it, rows carry live telemetry for the
+    // airframe's MAVLink system id.
+    explicit RosterModel(Database *database, VehicleStateStore *vehicles = nullptr,
+                         QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    int totalCount() const { return m_totalCount; }
+    bool loading() const { return m_pendingRequest != 0; }
+
+public slots:
+    void reload();
+
+signals:
+    void totalCountChanged();
+    void loadingChanged();
+
+private:
+    void onPageReady(quint64 requestId, const QList<RosterEntry> &rows);
+    void onCountReady(int count);
+    void onFieldsChanged(const QList<VehicleFieldChange> &changes);
+    void indexSystemIds(int first, int last);
+
+    static constexpr int PageSize = 100;
+
+    Database *m_database;
+    VehicleStateStore *m_vehicles;
+    QList<RosterEntry> m_rows;
+    QMultiHash<int, int> m_rowsBySystemId;
+    int m_totalCount = 0;
+    quint64 m_pendingRequest = 0;
+    bool m_exhausted = false;
+};
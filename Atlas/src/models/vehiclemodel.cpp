@@ -0,0 +1,71 @@
+#include "vehiclemodel.h"
+
+#include <cmath>
+
+VehicleModel::VehicleModel(VehicleStateStore *store, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_store(store)
+    , m_rows(store->count())
+{
+    connect(m_store, &VehicleStateStore::vehicleAdded, this, &VehicleModel::onVehicleAdded);
+    connect(m_store, &VehicleStateStore::fieldsChanged, this, &VehicleModel::onFieldsChanged);
+}
+
+int VehicleModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+QVariant VehicleModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+        return {};
+
+    const VehicleState &state = m_store->at(index.row());
+    if (role == Qt::DisplayRole || role == SystemIdRole)
+        return state.systemId;
+    const SampleTime &positionTime = state.sampleTimes[int(VehicleField::Latitude)];
+    if (role == PositionTimeRole) {
+        if (std::isnan(state.values[int(VehicleField::Latitude)]))
+            return {};
+        return positionTime.monotonicUs / 1000.0;
+    }
+    if (role == PositionTimeUncertaintyRole)
+        return positionTime.uncertaintyUs < 0 ? QVariant() : QVariant(positionTime.uncertaintyUs / 1000.0);
+
+    const int field = role - FirstFieldRole;
+    if (field < 0 || field >= VehicleFieldCount)
+        return {};
+    const double value = state.published[field];
+    return std::isnan(value) ? QVariant() : QVariant(value);
+}
+
+QHash<int, QByteArray> VehicleModel::roleNames() const
+{
+    QHash<int, QByteArray> names = {
+        {SystemIdRole, "systemId"},
+        {PositionTimeRole, "positionTime"},
+        {PositionTimeUncertaintyRole, "positionTimeUncertainty"},
+    };
+    for (int field = 0; field < VehicleFieldCount; ++field)
+        names.insert(FirstFieldRole + field, vehicleFieldName(VehicleField(field)));
+    return names;
+}
+
+void VehicleModel::onVehicleAdded(int index)
+{
+    beginInsertRows(QModelIndex(), index, index);
+    m_rows = m_store->count();
+    endInsertRows();
+}
+
+void VehicleModel::onFieldsChanged(const QList<VehicleFieldChange> &changes)
+{
+    for (const VehicleFieldChange &change : changes) {
+        const QModelIndex row = index(change.index);
+        QList<int> roles = vehicleFieldRoles(change.fields, FirstFieldRole);
+        if (change.fields & fieldBit(VehicleField::Latitude))
+            roles << PositionTimeRole << PositionTimeUncertaintyRole;
+        emit dataChanged(row, row, roles);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QAbstractListModel>
+
+#include "state/vehiclestatestore.h"
+
+// Live vehicles for the Home page, one row per VehicleStateStore entry.
+// dataChanged carries only the roles whose fields visibly changed.
+class VehicleModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        SystemIdRole = Qt::UserRole + 1,
+        PositionTimeRole,            // GCS monotonic ms the position was taken at
+        PositionTimeUncertaintyRole, // ms; undefined until the clock is synchronized
+        FirstFieldRole = Qt::UserRole + 32, // + int(VehicleField)
+    };
+
+    explicit VehicleModel(VehicleStateStore *store, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // For views that read the store directly instead of through roles.
+    VehicleStateStore *store() const { return m_store; }
+
+private:
+    void onVehicleAdded(int index);
+    void onFieldsChanged(const QList<VehicleFieldChange> &changes);
+
+    VehicleStateStore *m_store;
+    int m_rows = 0;
+};
@@ -0,0 +1,185 @@
+#include "commandpalettemodel.h"
+
+#include <QElapsedTimer>
+
+#include "diagnostics/metrics.h"
+
+namespace {
+
+constexpr size_t maxRows = 50;
+
+struct BuiltinEntry
+{
+    const char *kind;
+    const char *key;
+    const char *title;
+    const char *detail;
+};
+
+// Commands use the eventIds from EventListModel.qml; pages use the
+// sidebar button labels.
+constexpr BuiltinEntry builtinEntries[] = {
+    {"command", "toggleInputRecording", "Start/stop input recording", "Ctrl+Shift+R"},
+    {"command", "replayInputRecording", "Replay last input recording", "Ctrl+Shift+P"},
+    {"command", "toggleTheme", "Toggle light/dark theme", ""},
+    {"page", "Home", "Go to Home", ""},
+    {"page", "Airspace", "Go to Airspace", ""},
+    {"page", "Command", "Go to Command", ""},
+    {"page", "Roster", "Go to Roster", ""},
+    {"page", "Logs", "Go to Logs", ""},
+    {"page", "Debug", "Go to Debug", ""},
+    {"page", "Settings", "Go to Settings", ""},
+};
+
+QByteArray highlight(const QByteArray &text, const std::vector<uint32_t> &positions)
+{
+    QByteArray out;
+    out.reserve(text.size() + qsizetype(positions.size()) * 7);
+    auto next = positions.begin();
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const char c = text.at(i);
+        const bool matched = next != positions.end() && *next == uint32_t(i);
+        if (matched)
+            ++next;
+        QByteArray escaped = c == '<' ? "&lt;" : c == '>' ? "&gt;" : c == '&' ? "&amp;" : QByteArray(1, c);
+        // Only whole ASCII characters are emphasised; tags must not split a
+        // UTF-8 sequence.
+        if (matched && uchar(c) < 0x80)
+            escaped = "<b>" + escaped + "</b>";
+        out += escaped;
+    }
+    return out;
+}
+
+} // namespace
+
+CommandPaletteModel::CommandPaletteModel(VehicleStateStore *vehicles, QObject *parent)
+    : QAbstractListModel(parent)
+{
+    for (const BuiltinEntry &entry : builtinEntries) {
+        m_entries.push_back({QString::fromLatin1(entry.kind), QString::fromLatin1(entry.key),
+                             QString::fromLatin1(entry.title), QString::fromLatin1(entry.detail)});
+        m_matcher.add(entry.title);
+    }
+
+    if (vehicles) {
+        const auto addVehicle = [this, vehicles](int index) {
+            const int systemId = vehicles->at(index).systemId;
+            addEntry(QStringLiteral("vehicle"), QString::number(systemId),
+                     QStringLiteral("Vehicle %1").arg(systemId), QStringLiteral("MAVLink system"));
+        };
+        for (int index = 0; index < vehicles->count(); ++index)
+            addVehicle(index);
+        connect(vehicles, &VehicleStateStore::vehicleAdded, this, addVehicle);
+    }
+    refresh();
+}
+
+int CommandPaletteModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant CommandPaletteModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+        return {};
+
+    const FuzzyMatcher::Match &match = m_rows[size_t(index.row())];
+    const Entry &entry = m_entries[match.candidate];
+    switch (role) {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return entry.title;
+    case HighlightedTitleRole: {
+        // Computed per visible row only; ranking never needs positions.
+        const std::string_view query(m_queryUtf8.constData(), size_t(m_queryUtf8.size()));
+        return QString::fromUtf8(highlight(entry.title.toUtf8(), m_matcher.positions(match.candidate, query)));
+    }
+    case KindRole:
+        return entry.kind;
+    case KeyRole:
+        return entry.key;
+    case DetailRole:
+        return entry.detail;
+    case ScoreRole:
+        return match.score;
+    }
+    return {};
+}
+
+QHash<int, QByteArray> CommandPaletteModel::roleNames() const
+{
+    return {
+        {KindRole, "kind"},
+        {KeyRole, "key"},
+        {TitleRole, "title"},
+        {HighlightedTitleRole, "highlightedTitle"},
+        {DetailRole, "detail"},
+        {ScoreRole, "score"},
+    };
+}
+
+void CommandPaletteModel::setQuery(const QString &query)
+{
+    if (query == m_query)
+        return;
+    m_query = query;
+    m_queryUtf8 = query.toUtf8();
+    refresh();
+    emit queryChanged();
+}
+
+void CommandPaletteModel::addEntry(const QString &kind, const QString &key, const QString &title,
+                                   const QString &detail)
+{
+    m_entries.push_back({kind, key, title, detail});
+    const QByteArray utf8 = title.toUtf8();
+    const uint32_t candidate = m_matcher.add(std::string_view(utf8.constData(), size_t(utf8.size())));
+    if (m_query.isEmpty()) {
+        // Listed in table order, so it can only join the end, and only
+        // while the list is short.
+        if (m_rows.size() < maxRows) {
+            beginInsertRows(QModelIndex(), count(), count());
+            m_rows.push_back({candidate, 0});
+            endInsertRows();
+            emit countChanged();
+        }
+    } else if (!m_refreshQueued) {
+        // Where it ranks takes a search; do one for a burst of additions,
+        // such as a link bringing in many vehicles at once.
+        m_refreshQueued = true;
+        QMetaObject::invokeMethod(this, [this] {
+            if (m_refreshQueued)
+                refresh();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void CommandPaletteModel::activate(int row)
+{
+    if (row < 0 || row >= count())
+        return;
+    const Entry &entry = m_entries[m_rows[size_t(row)].candidate];
+    emit activated(entry.kind, entry.key);
+}
+
+void CommandPaletteModel::refresh()
+{
+    static MetricHistogram *const searchTimes = Metrics::histogram(
+        "atlas_palette_search_seconds", "Command palette ranking time per query.",
+        {0.0005, 0.001, 0.002, 0.005, 0.01, 0.05});
+
+    QElapsedTimer timer;
+    timer.start();
+    m_refreshQueued = false;
+    const int oldCount = count();
+    beginResetModel();
+    const std::vector<FuzzyMatcher::Match> &matches = m_matcher.search(
+        std::string_view(m_queryUtf8.constData(), size_t(m_queryUtf8.size())), maxRows);
+    m_rows.assign(matches.begin(), matches.end());
+    endResetModel();
+    searchTimes->observe(timer.nsecsElapsed() / 1e9);
+    if (count() != oldCount)
+        emit countChanged();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QAbstractListModel>
+
+#include <vector>
+
+#include "palette/fuzzymatcher.h"
+#include "state/vehiclestatestore.h"
+
+// Rows of the Ctrl+K command palette: built-in commands and pages, every
+// vehicle the state store has seen, and anything registered with
+// addEntry() (saved missions and the like). Setting query re-ranks through
+// FuzzyMatcher; activate() reports the chosen entry back as (kind, key).
+class CommandPaletteModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        KindRole = Qt::UserRole + 1,
+        KeyRole,
+        TitleRole,
+        HighlightedTitleRole, // rich text, matched characters in bold
+        DetailRole,
+        ScoreRole,
+    };
+
+    explicit CommandPaletteModel(VehicleStateStore *vehicles = nullptr, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString query() const { return m_query; }
+    void setQuery(const QString &query);
+    int count() const { return int(m_rows.size()); }
+
+    Q_INVOKABLE void addEntry(const QString &kind, const QString &key, const QString &title,
+                              const QString &detail = QString());
+    Q_INVOKABLE void activate(int row);
+
+signals:
+    void queryChanged();
+    void countChanged();
+    void activated(const QString &kind, const QString &key);
+
+private:
+    struct Entry
+    {
+        QString kind;
+        QString key;
+        QString title;
+        QString detail;
+    };
+
+    void refresh();
+
+    std::vector<Entry> m_entries; // indexed by FuzzyMatcher candidate
+    FuzzyMatcher m_matcher;
+    QString m_query;
+    QByteArray m_queryUtf8;
+    std::vector<FuzzyMatcher::Match> m_rows;
+    bool m_refreshQueued = false;
+};
@@ -0,0 +1,238 @@
+#include "fuzzymatcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Scores follow fzf's v1 matcher so ranking feels familiar to anyone who
+// uses it in a terminal.
+constexpr int32_t scoreMatch = 16;
+constexpr int32_t scoreGapStart = -3;
+constexpr int32_t scoreGapExtension = -1;
+constexpr int8_t bonusBoundary = scoreMatch / 2;
+constexpr int8_t bonusNonWord = scoreMatch / 2;
+constexpr int8_t bonusCamel123 = bonusBoundary + scoreGapExtension;
+constexpr int8_t bonusConsecutive = -(scoreGapStart + scoreGapExtension);
+constexpr int32_t bonusFirstCharMultiplier = 2;
+
+enum class CharClass { NonWord, Lower, Upper, Number, Letter };
+
+CharClass classOf(unsigned char c)
+{
+    if (c >= 'a' && c <= 'z')
+        return CharClass::Lower;
+    if (c >= 'A' && c <= 'Z')
+        return CharClass::Upper;
+    if (c >= '0' && c <= '9')
+        return CharClass::Number;
+    if (c >= 0x80)
+        return CharClass::Letter; // UTF-8 continuation or lead byte
+    return CharClass::NonWord;
+}
+
+int8_t bonusFor(CharClass previous, CharClass current)
+{
+    if (previous == CharClass::NonWord && current != CharClass::NonWord)
+        return bonusBoundary;
+    if ((previous == CharClass::Lower && current == CharClass::Upper)
+        || (previous != CharClass::Number && current == CharClass::Number))
+        return bonusCamel123;
+    if (current == CharClass::NonWord)
+        return bonusNonWord;
+    return 0;
+}
+
+inline char fold(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+inline uint64_t maskBit(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    if (u >= 'a' && u <= 'z')
+        return uint64_t(1) << (u - 'a');
+    if (u >= '0' && u <= '9')
+        return uint64_t(1) << (26 + u - '0');
+    return uint64_t(1) << (36 + u % 28);
+}
+
+uint64_t maskOf(std::string_view folded)
+{
+    uint64_t mask = 0;
+    for (const char c : folded)
+        mask |= maskBit(c);
+    return mask;
+}
+
+} // namespace
+
+uint32_t FuzzyMatcher::add(std::string_view text)
+{
+    const auto candidate = uint32_t(size());
+    CharClass previous = CharClass::NonWord;
+    uint64_t mask = 0;
+    for (const char c : text) {
+        const CharClass current = classOf(static_cast<unsigned char>(c));
+        m_text.push_back(c);
+        m_folded.push_back(fold(c));
+        m_bonus.push_back(bonusFor(previous, current));
+        mask |= maskBit(fold(c));
+        previous = current;
+    }
+    m_offsets.push_back(uint32_t(m_text.size()));
+    m_masks.push_back(mask);
+    m_survivorsValid = false;
+    return candidate;
+}
+
+void FuzzyMatcher::clear()
+{
+    m_text.clear();
+    m_folded.clear();
+    m_bonus.clear();
+    m_offsets.assign(1, 0);
+    m_masks.clear();
+    m_survivors.clear();
+    m_survivorsValid = false;
+    m_results.clear();
+}
+
+std::string_view FuzzyMatcher::text(uint32_t candidate) const
+{
+    return std::string_view(m_text).substr(m_offsets[candidate],
+                                           m_offsets[candidate + 1] - m_offsets[candidate]);
+}
+
+// Greedy forward scan for the first full match, then backwards from its end
+// to find the shortest window ending there.
+bool FuzzyMatcher::locate(uint32_t candidate, std::string_view folded, Span &span) const
+{
+    const char *const begin = m_folded.data() + m_offsets[candidate];
+    const char *const end = m_folded.data() + m_offsets[candidate + 1];
+
+    const char *p = begin;
+    for (const char c : folded) {
+        p = static_cast<const char *>(std::memchr(p, c, size_t(end - p)));
+        if (!p)
+            return false;
+        ++p;
+    }
+
+    const char *start = p;
+    size_t q = folded.size();
+    while (q > 0) {
+        --start;
+        if (*start == folded[q - 1])
+            --q;
+    }
+    span = {uint32_t(start - m_folded.data()), uint32_t(p - m_folded.data())};
+    return true;
+}
+
+int32_t FuzzyMatcher::score(uint32_t candidate, std::string_view folded, Span span,
+                            std::vector<uint32_t> *positions) const
+{
+    int32_t total = 0;
+    size_t q = 0;
+    bool inGap = false;
+    int consecutive = 0;
+    int8_t firstBonus = 0;
+    for (uint32_t i = span.begin; i < span.end; ++i) {
+        if (q < folded.size() && m_folded[i] == folded[q]) {
+            int8_t bonus = m_bonus[i];
+            if (consecutive == 0) {
+                firstBonus = bonus;
+            } else {
+                // A run keeps the bonus of the boundary it started on.
+                if (bonus >= bonusBoundary && bonus > firstBonus)
+                    firstBonus = bonus;
+                bonus = std::max({bonus, firstBonus, bonusConsecutive});
+            }
+            total += scoreMatch + (q == 0 ? bonus * bonusFirstCharMultiplier : bonus);
+            if (positions)
+                positions->push_back(i - m_offsets[candidate]);
+            inGap = false;
+            ++consecutive;
+            ++q;
+        } else {
+            total += inGap ? scoreGapExtension : scoreGapStart;
+            inGap = true;
+            consecutive = 0;
+            firstBonus = 0;
+        }
+    }
+    return total;
+}
+
+const std::vector<FuzzyMatcher::Match> &FuzzyMatcher::search(std::string_view query, size_t limit)
+{
+    std::string folded(query);
+    std::transform(folded.begin(), folded.end(), folded.begin(), fold);
+
+    m_results.clear();
+    if (folded.empty()) {
+        const auto count = uint32_t(std::min(limit, size()));
+        for (uint32_t candidate = 0; candidate < count; ++candidate)
+            m_results.push_back({candidate, 0});
+        m_lastQuery.clear();
+        m_survivorsValid = false;
+        return m_results;
+    }
+
+    // Anything that fails a query also fails every extension of it.
+    const bool narrowing = m_survivorsValid && !m_lastQuery.empty()
+                           && folded.compare(0, m_lastQuery.size(), m_lastQuery) == 0;
+    const uint64_t queryMask = maskOf(folded);
+
+    m_matches.clear();
+    std::vector<uint32_t> survivors;
+    survivors.reserve(narrowing ? m_survivors.size() : size() / 4);
+    const auto consider = [&](uint32_t candidate) {
+        if ((queryMask & ~m_masks[candidate]) != 0)
+            return;
+        Span span;
+        if (!locate(candidate, folded, span))
+            return;
+        survivors.push_back(candidate);
+        m_matches.push_back({candidate, score(candidate, folded, span)});
+    };
+    if (narrowing) {
+        for (const uint32_t candidate : m_survivors)
+            consider(candidate);
+    } else {
+        for (uint32_t candidate = 0; candidate < size(); ++candidate)
+            consider(candidate);
+    }
+    m_survivors = std::move(survivors);
+    m_survivorsValid = true;
+    m_lastQuery = std::move(folded);
+
+    // Higher score, then shorter text, then table order.
+    const auto better = [this](const Match &a, const Match &b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        const uint32_t lengthA = m_offsets[a.candidate + 1] - m_offsets[a.candidate];
+        const uint32_t lengthB = m_offsets[b.candidate + 1] - m_offsets[b.candidate];
+        if (lengthA != lengthB)
+            return lengthA < lengthB;
+        return a.candidate < b.candidate;
+    };
+    const size_t count = std::min(limit, m_matches.size());
+    std::partial_sort(m_matches.begin(), m_matches.begin() + std::ptrdiff_t(count), m_matches.end(), better);
+    m_results.assign(m_matches.begin(), m_matches.begin() + std::ptrdiff_t(count));
+    return m_results;
+}
+
+std::vector<uint32_t> FuzzyMatcher::positions(uint32_t candidate, std::string_view query) const
+{
+    std::string folded(query);
+    std::transform(folded.begin(), folded.end(), folded.begin(), fold);
+
+    std::vector<uint32_t> result;
+    Span span;
+    if (!folded.empty() && locate(candidate, folded, span))
+        score(candidate, folded, span, &result);
+    return result;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// fzf-style fuzzy ranking over a fixed candidate table. Candidate text is
+// interned into one arena together with an ASCII-folded copy, a per-byte
+// boundary bonus and a character-set mask, so a keystroke only walks bytes
+// that can still match. When the query extends the previous one, only the
+// previous survivors are rescanned. Kept free of Qt like CsvScanner.
+class FuzzyMatcher
+{
+public:
+    struct Match
+    {
+        uint32_t candidate;
+        int32_t score;
+    };
+
+    uint32_t add(std::string_view text);
+    void clear();
+
+    size_t size() const { return m_offsets.size() - 1; }
+    std::string_view text(uint32_t candidate) const;
+
+    // Best first, at most limit. An empty query lists candidates in table
+    // order. Case-insensitive for ASCII.
+    const std::vector<Match> &search(std::string_view query, size_t limit);
+
+    // Byte offsets into text(candidate) of the characters that matched,
+    // for highlighting. Empty if the candidate does not match.
+    std::vector<uint32_t> positions(uint32_t candidate, std::string_view query) const;
+
+private:
+    struct Span
+    {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    bool locate(uint32_t candidate, std::string_view folded, Span &span) const;
+    int32_t score(uint32_t candidate, std::string_view folded, Span span,
+                  std::vector<uint32_t> *positions = nullptr) const;
+
+    std::string m_text;
+    std::string m_folded;
+    std::vector<int8_t> m_bonus;          // parallel to m_text
+    std::vector<uint32_t> m_offsets{0};   // size() + 1 entries
+    std::vector<uint64_t> m_masks;        // characters present per candidate
+
+    std::string m_lastQuery;
+    std::vector<uint32_t> m_survivors;    // candidates matching m_lastQuery, table order
+    bool m_survivorsValid = false;
+    std::vector<Match> m_matches;
+    std::vector<Match> m_results;
+};
@@ -0,0 +1,128 @@
+#include "csvscanner.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ATLAS_CSV_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef ATLAS_CSV_SSE2
+namespace {
+
+inline int firstSetBit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+} // namespace
+#endif
+
+CsvScanner::CsvScanner(const char *begin, const char *end, char delimiter)
+    : m_pos(begin)
+    , m_end(end)
+    , m_delimiter(delimiter)
+{
+}
+
+const char *CsvScanner::findSpecial(const char *begin, const char *end, char delimiter)
+{
+    const char *p = begin;
+#ifdef ATLAS_CSV_SSE2
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i quotes = _mm_set1_epi8('"');
+    const __m128i carriageReturns = _mm_set1_epi8('\r');
+    const __m128i lineFeeds = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, quotes)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, carriageReturns), _mm_cmpeq_epi8(block, lineFeeds)));
+        const int mask = _mm_movemask_epi8(hits);
+        if (mask != 0)
+            return p + firstSetBit(unsigned(mask));
+    }
+#endif
+    for (; p < end; ++p) {
+        const char c = *p;
+        if (c == delimiter || c == '"' || c == '\r' || c == '\n')
+            return p;
+    }
+    return end;
+}
+
+bool CsvScanner::next(std::vector<Field> &fields)
+{
+    fields.clear();
+    if (m_pos >= m_end)
+        return false;
+
+    for (;;) {
+        Field field;
+        if (m_pos >= m_end) { // trailing delimiter
+            fields.push_back(field);
+            return true;
+        }
+        if (*m_pos == '"') {
+            const char *start = ++m_pos;
+            for (;;) {
+                const char *quote = static_cast<const char *>(std::memchr(m_pos, '"', size_t(m_end - m_pos)));
+                if (!quote) { // unterminated: take the rest
+                    field.text = std::string_view(start, size_t(m_end - start));
+                    m_pos = m_end;
+                    break;
+                }
+                if (quote + 1 < m_end && quote[1] == '"') {
+                    field.escaped = true;
+                    m_pos = quote + 2;
+                    continue;
+                }
+                field.text = std::string_view(start, size_t(quote - start));
+                m_pos = quote + 1;
+                break;
+            }
+            // Anything between the closing quote and the next separator is
+            // malformed; skip it rather than fail the whole record.
+            while (m_pos < m_end && *m_pos != m_delimiter && *m_pos != '\r' && *m_pos != '\n')
+                ++m_pos;
+        } else {
+            const char *start = m_pos;
+            const char *stop = findSpecial(m_pos, m_end, m_delimiter);
+            while (stop < m_end && *stop == '"') // stray quote inside an unquoted field
+                stop = findSpecial(stop + 1, m_end, m_delimiter);
+            field.text = std::string_view(start, size_t(stop - start));
+            m_pos = stop;
+        }
+        fields.push_back(field);
+
+        if (m_pos >= m_end)
+            return true;
+        const char c = *m_pos++;
+        if (c == m_delimiter)
+            continue;
+        if (c == '\r' && m_pos < m_end && *m_pos == '\n')
+            ++m_pos;
+        return true;
+    }
+}
+
+std::string CsvScanner::unescape(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        result.push_back(text[i]);
+        if (text[i] == '"' && i + 1 < text.size() && text[i + 1] == '"')
+            ++i;
+    }
+    return result;
+}
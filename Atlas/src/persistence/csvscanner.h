@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal RFC 4180 reader over an in-memory buffer (typically a mapped
+// file). Fields are views into the buffer; only quoted fields containing
+// doubled quotes need unescape(). Kept free of Qt so chunks can be scanned
+// from any worker thread without touching shared state.
+class CsvScanner
+{
+public:
+    struct Field
+    {
+        std::string_view text;
+        bool escaped = false; // contains "" pairs, see unescape()
+    };
+
+    CsvScanner(const char *begin, const char *end, char delimiter = ',');
+
+    // Reads the next record into fields. Returns false once the buffer is
+    // exhausted. Blank lines yield a single empty field.
+    bool next(std::vector<Field> &fields);
+
+    const char *position() const { return m_pos; }
+
+    static std::string unescape(std::string_view text);
+
+    // First byte in [begin, end) that is the delimiter, a quote, CR or LF;
+    // end if there is none. Scans 16 bytes per step where SSE2 is available.
+    static const char *findSpecial(const char *begin, const char *end, char delimiter);
+
+private:
+    const char *m_pos;
+    const char *m_end;
+    char m_delimiter;
+};
@@ -0,0 +1,508 @@
+#include "database.h"
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+#include <memory>
+#include <unordered_map>
+
+#include "diagnostics/metrics.h"
+#include "diagnostics/startupprofiler.h"
+
+namespace {
+
+const char *const connectionName = "atlas-db";
+
+const char *const pragmas[] = {
+    // WAL keeps readers from blocking on the importer and vice versa.
+    "PRAGMA journal_mode=WAL",
+    "PRAGMA synchronous=NORMAL",
+    "PRAGMA foreign_keys=ON",
+    "PRAGMA temp_store=MEMORY",
+};
+
+const char *const schema[] = {
+    // Emails compare without case; the unique index and the import's
+    // ON CONFLICT(email) take the column's collation.
+    "CREATE TABLE IF NOT EXISTS pilots ("
+    " id INTEGER PRIMARY KEY,"
+    " name TEXT NOT NULL,"
+    " email TEXT COLLATE NOCASE)",
+
+    "CREATE TABLE IF NOT EXISTS certifications ("
+    " id INTEGER PRIMARY KEY,"
+    " pilot_id INTEGER NOT NULL REFERENCES pilots(id) ON DELETE CASCADE,"
+    " kind TEXT NOT NULL,"
+    " number TEXT NOT NULL,"
+    " issued TEXT,"
+    " expires TEXT,"
+    " UNIQUE(kind, number))",
+
+    // Serial numbers are only unique per manufacturer and model, so an
+    // airframe is the three together; '' rather than NULL when unknown,
+    // since NULLs never conflict.
+    "CREATE TABLE IF NOT EXISTS airframes ("
+    " id INTEGER PRIMARY KEY,"
+    " serial_number TEXT NOT NULL,"
+    " make TEXT NOT NULL DEFAULT '',"
+    " model TEXT NOT NULL DEFAULT '',"
+    " system_id INTEGER,"
+    " pilot_id INTEGER REFERENCES pilots(id) ON DELETE SET NULL,"
+    " UNIQUE(make, model, serial_number))",
+
+    "CREATE TABLE IF NOT EXISTS registrations ("
+    " id INTEGER PRIMARY KEY,"
+    " airframe_id INTEGER NOT NULL REFERENCES airframes(id) ON DELETE CASCADE,"
+    " number TEXT NOT NULL UNIQUE,"
+    " owner TEXT,"
+    " issued TEXT,"
+    " expires TEXT)",
+
+    "CREATE UNIQUE INDEX IF NOT EXISTS pilots_email ON pilots(email)",
+    "CREATE INDEX IF NOT EXISTS pilots_name ON pilots(name) WHERE email IS NULL",
+    "CREATE INDEX IF NOT EXISTS certifications_pilot ON certifications(pilot_id, expires)",
+    "CREATE INDEX IF NOT EXISTS airframes_pilot ON airframes(pilot_id)",
+    "CREATE INDEX IF NOT EXISTS registrations_airframe ON registrations(airframe_id, expires)",
+};
+
+const QString rosterPageSql = QStringLiteral(
+    "SELECT a.id, r.number, a.make, a.model, a.serial_number, a.system_id, p.name, r.expires,"
+    " (SELECT MIN(c.expires) FROM certifications c WHERE c.pilot_id = a.pilot_id)"
+    " FROM airframes a"
+    " LEFT JOIN registrations r ON r.id = (SELECT id FROM registrations"
+    "  WHERE airframe_id = a.id ORDER BY expires DESC LIMIT 1)"
+    " LEFT JOIN pilots p ON p.id = a.pilot_id"
+    " WHERE a.id > ? ORDER BY a.id LIMIT ?");
+
+const QString rosterCountSql = QStringLiteral("SELECT COUNT(*) FROM airframes");
+
+const QString savePilotSql = QStringLiteral(
+    "INSERT INTO pilots(id, name, email) VALUES(NULLIF(?, 0), ?, ?)"
+    " ON CONFLICT(id) DO UPDATE SET name = excluded.name, email = excluded.email");
+
+const QString saveCertificationSql = QStringLiteral(
+    "INSERT INTO certifications(id, pilot_id, kind, number, issued, expires)"
+    " VALUES(NULLIF(?, 0), ?, ?, ?, ?, ?)"
+    " ON CONFLICT(id) DO UPDATE SET pilot_id = excluded.pilot_id, kind = excluded.kind,"
+    " number = excluded.number, issued = excluded.issued, expires = excluded.expires");
+
+const QString saveAirframeSql = QStringLiteral(
+    "INSERT INTO airframes(id, serial_number, make, model, system_id, pilot_id)"
+    " VALUES(NULLIF(?, 0), ?, COALESCE(?, ''), COALESCE(?, ''), ?, NULLIF(?, 0))"
+    " ON CONFLICT(id) DO UPDATE SET serial_number = excluded.serial_number,"
+    " make = excluded.make, model = excluded.model, system_id = excluded.system_id,"
+    " pilot_id = excluded.pilot_id");
+
+const QString saveRegistrationSql = QStringLiteral(
+    "INSERT INTO registrations(id, airframe_id, number, owner, issued, expires)"
+    " VALUES(NULLIF(?, 0), ?, ?, ?, ?, ?)"
+    " ON CONFLICT(id) DO UPDATE SET airframe_id = excluded.airframe_id,"
+    " number = excluded.number, owner = excluded.owner, issued = excluded.issued,"
+    " expires = excluded.expires");
+
+const QString importPilotSql = QStringLiteral(
+    "INSERT INTO pilots(name, email) VALUES(?, NULLIF(?, ''))"
+    " ON CONFLICT(email) DO UPDATE SET name = excluded.name RETURNING id");
+
+// A pilot without an email is the same person when the name matches and so
+// does the certificate, or when neither row has a certificate.
+const QString findPilotSql = QStringLiteral(
+    "SELECT p.id FROM pilots p WHERE p.email IS NULL AND p.name = ? AND ("
+    " EXISTS(SELECT 1 FROM certifications c WHERE c.pilot_id = p.id AND c.kind = ? AND c.number = ?)"
+    " OR (? = '' AND NOT EXISTS(SELECT 1 FROM certifications c WHERE c.pilot_id = p.id)))"
+    " LIMIT 1");
+
+const QString importAirframeSql = QStringLiteral(
+    "INSERT INTO airframes(serial_number, make, model, system_id, pilot_id)"
+    " VALUES(?, COALESCE(?, ''), COALESCE(?, ''), NULLIF(?, 0), NULLIF(?, 0))"
+    " ON CONFLICT(make, model, serial_number) DO UPDATE"
+    " SET system_id = COALESCE(excluded.system_id, system_id),"
+    " pilot_id = COALESCE(excluded.pilot_id, pilot_id) RETURNING id");
+
+const QString importRegistrationSql = QStringLiteral(
+    "INSERT INTO registrations(airframe_id, number, owner, issued, expires)"
+    " VALUES(?, ?, NULLIF(?, ''), ?, ?)"
+    " ON CONFLICT(number) DO UPDATE SET airframe_id = excluded.airframe_id,"
+    " owner = COALESCE(excluded.owner, owner), issued = COALESCE(excluded.issued, issued),"
+    " expires = COALESCE(excluded.expires, expires)");
+
+const QString importCertificationSql = QStringLiteral(
+    "INSERT INTO certifications(pilot_id, kind, number, issued, expires) VALUES(?, ?, ?, ?, ?)"
+    " ON CONFLICT(kind, number) DO UPDATE SET pilot_id = excluded.pilot_id,"
+    " issued = COALESCE(excluded.issued, issued), expires = COALESCE(excluded.expires, expires)");
+
+// Rows per transaction during bulk import. Large enough that commit cost
+// disappears, small enough that progress moves and the WAL stays bounded.
+constexpr int importBatchSize = 20000;
+
+QVariant dateValue(const QDate &date)
+{
+    return date.isValid() ? QVariant(date.toString(Qt::ISODate)) : QVariant();
+}
+
+QDate toDate(const QVariant &value)
+{
+    return QDate::fromString(value.toString(), Qt::ISODate);
+}
+
+// Lowercases ASCII only, as SQLite's NOCASE does, so the import's pilot
+// cache joins exactly the emails the unique index does.
+QString nocaseKey(const QString &text)
+{
+    QString key = text;
+    for (QChar &c : key) {
+        if (c >= u'A' && c <= u'Z')
+            c = QChar(c.unicode() + (u'a' - u'A'));
+    }
+    return key;
+}
+
+} // namespace
+
+// Lives on the DB thread and owns the connection, which Qt only allows to be
+// used from the thread that opened it.
+class DatabaseWorker : public QObject
+{
+public:
+    ~DatabaseWorker() override { close(); }
+
+    bool open(const QString &path, QString *error)
+    {
+        m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QLatin1String(connectionName));
+        m_db.setDatabaseName(path);
+        if (!m_db.open()) {
+            *error = m_db.lastError().text();
+            return false;
+        }
+
+        QSqlQuery query(m_db);
+        for (const char *statement : pragmas) {
+            if (!query.exec(QLatin1String(statement))) {
+                *error = query.lastError().text();
+                return false;
+            }
+        }
+        for (const char *statement : schema) {
+            if (!query.exec(QLatin1String(statement))) {
+                *error = query.lastError().text();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void close()
+    {
+        m_statements.clear();
+        if (!m_db.isValid())
+            return;
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(QLatin1String(connectionName));
+    }
+
+    // Statements are prepared once per SQL string and reused; callers rebind
+    // every placeholder before exec() and finish() afterwards so a cached
+    // SELECT never pins a WAL read snapshot. A statement that fails to
+    // prepare is retried on the next call; until then its exec() fails and
+    // the caller reports lastError() as usual.
+    QSqlQuery &prepared(const QString &sql)
+    {
+        Statement &statement = m_statements[sql];
+        if (!statement.query) {
+            statement.query = std::make_unique<QSqlQuery>(m_db);
+            statement.query->setForwardOnly(true);
+        }
+        if (!statement.ready) {
+            statement.ready = statement.query->prepare(sql);
+            if (!statement.ready) {
+                qWarning("Database: cannot prepare %s: %s", qPrintable(sql),
+                         qPrintable(statement.query->lastError().text()));
+            }
+        }
+        return *statement.query;
+    }
+
+    QSqlDatabase &connection() { return m_db; }
+
+private:
+    struct Statement
+    {
+        std::unique_ptr<QSqlQuery> query;
+        bool ready = false;
+    };
+
+    QSqlDatabase m_db;
+    std::unordered_map<QString, Statement> m_statements;
+};
+
+Database::Database(QObject *parent)
+    : QObject(parent)
+    , m_worker(new DatabaseWorker)
+{
+    qRegisterMetaType<QList<RosterEntry>>();
+
+    m_thread.setObjectName(QStringLiteral("AtlasDatabase"));
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread.start();
+}
+
+Database::~Database()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+template<typename Job>
+void Database::run(Job &&job)
+{
+    static MetricGauge *const queueDepth = Metrics::gauge("atlas_db_queue_depth",
+                                                          "Jobs waiting for the DB thread.");
+    queueDepth->add(1);
+    QMetaObject::invokeMethod(m_worker, [job = std::forward<Job>(job)]() mutable {
+        queueDepth->add(-1);
+        job();
+    }, Qt::QueuedConnection);
+}
+
+void Database::open(const QString &path)
+{
+    run([this, path] {
+        StartupProfiler::Scope trace(QStringLiteral("Database open"));
+        QString message;
+        const bool ok = m_worker->open(path, &message);
+        emit opened(ok, message);
+    });
+}
+
+quint64 Database::fetchRosterPage(qint64 afterAirframeId, int limit)
+{
+    const quint64 requestId = m_nextRequestId++;
+    run([this, requestId, afterAirframeId, limit] {
+        QSqlQuery &query = m_worker->prepared(rosterPageSql);
+        query.bindValue(0, afterAirframeId);
+        query.bindValue(1, limit);
+
+        QList<RosterEntry> rows;
+        if (query.exec()) {
+            rows.reserve(limit);
+            while (query.next()) {
+                RosterEntry entry;
+                entry.airframeId = query.value(0).toLongLong();
+                entry.registration = query.value(1).toString();
+                entry.makeModel = QStringList({query.value(2).toString(), query.value(3).toString()})
+                                      .join(QLatin1Char(' '))
+                                      .trimmed();
+                entry.serialNumber = query.value(4).toString();
+                entry.systemId = query.value(5).toInt();
+                entry.pilotName = query.value(6).toString();
+                entry.registrationExpiry = toDate(query.value(7));
+                entry.certificationExpiry = toDate(query.value(8));
+                rows.append(entry);
+            }
+        } else {
+            emit error(query.lastError().text());
+        }
+        query.finish();
+        emit rosterPageReady(requestId, rows);
+    });
+    return requestId;
+}
+
+void Database::countRoster()
+{
+    run([this] {
+        QSqlQuery &query = m_worker->prepared(rosterCountSql);
+        int count = 0;
+        if (query.exec() && query.next())
+            count = query.value(0).toInt();
+        else
+            emit error(query.lastError().text());
+        query.finish();
+        emit rosterCountReady(count);
+    });
+}
+
+void Database::savePilot(const PilotRecord &pilot)
+{
+    run([this, pilot] {
+        QSqlQuery &query = m_worker->prepared(savePilotSql);
+        query.bindValue(0, pilot.id);
+        query.bindValue(1, pilot.name);
+        query.bindValue(2, pilot.email);
+        if (query.exec())
+            emit rosterChanged();
+        else
+            emit error(query.lastError().text());
+        query.finish();
+    });
+}
+
+void Database::saveCertification(const CertificationRecord &certification)
+{
+    run([this, certification] {
+        QSqlQuery &query = m_worker->prepared(saveCertificationSql);
+        query.bindValue(0, certification.id);
+        query.bindValue(1, certification.pilotId);
+        query.bindValue(2, certification.kind);
+        query.bindValue(3, certification.number);
+        query.bindValue(4, dateValue(certification.issued));
+        query.bindValue(5, dateValue(certification.expires));
+        if (query.exec())
+            emit rosterChanged();
+        else
+            emit error(query.lastError().text());
+        query.finish();
+    });
+}
+
+void Database::saveAirframe(const AirframeRecord &airframe)
+{
+    run([this, airframe] {
+        QSqlQuery &query = m_worker->prepared(saveAirframeSql);
+        query.bindValue(0, airframe.id);
+        query.bindValue(1, airframe.serialNumber);
+        query.bindValue(2, airframe.make);
+        query.bindValue(3, airframe.model);
+        query.bindValue(4, airframe.systemId);
+        query.bindValue(5, airframe.pilotId);
+        if (query.exec())
+            emit rosterChanged();
+        else
+            emit error(query.lastError().text());
+        query.finish();
+    });
+}
+
+void Database::saveRegistration(const RegistrationRecord &registration)
+{
+    run([this, registration] {
+        QSqlQuery &query = m_worker->prepared(saveRegistrationSql);
+        query.bindValue(0, registration.id);
+        query.bindValue(1, registration.airframeId);
+        query.bindValue(2, registration.number);
+        query.bindValue(3, registration.owner);
+        query.bindValue(4, dateValue(registration.issued));
+        query.bindValue(5, dateValue(registration.expires));
+        if (query.exec())
+            emit rosterChanged();
+        else
+            emit error(query.lastError().text());
+        query.finish();
+    });
+}
+
+void Database::importRoster(const QList<RosterImportRecord> &records)
+{
+    run([this, records] {
+        QSqlDatabase &db = m_worker->connection();
+        QSqlQuery &pilotQuery = m_worker->prepared(importPilotSql);
+        QSqlQuery &findPilotQuery = m_worker->prepared(findPilotSql);
+        QSqlQuery &airframeQuery = m_worker->prepared(importAirframeSql);
+        QSqlQuery &registrationQuery = m_worker->prepared(importRegistrationSql);
+        QSqlQuery &certificationQuery = m_worker->prepared(importCertificationSql);
+
+        // Fleet files repeat the same pilot on every aircraft row.
+        QHash<QString, qint64> pilotIds;
+        const auto returnedId = [](QSqlQuery &query) {
+            const qint64 id = query.next() ? query.value(0).toLongLong() : 0;
+            query.finish();
+            return id;
+        };
+
+        const int total = int(records.size());
+        int written = 0;
+        QString failure;
+        while (written < total && failure.isEmpty()) {
+            const int batchEnd = qMin(total, written + importBatchSize);
+            db.transaction();
+            for (int i = written; i < batchEnd && failure.isEmpty(); ++i) {
+                const RosterImportRecord &record = records.at(i);
+
+                qint64 pilotId = 0;
+                if (!record.pilot.name.isEmpty()) {
+                    const QString key = record.pilot.email.isEmpty()
+                                            ? record.pilot.name + QChar(0x1f) + record.certification.kind
+                                                  + QChar(0x1f) + record.certification.number
+                                            : nocaseKey(record.pilot.email);
+                    pilotId = pilotIds.value(key);
+                    if (pilotId == 0 && record.pilot.email.isEmpty()) {
+                        const QString number = record.certification.number.isNull()
+                                                   ? QStringLiteral("")
+                                                   : record.certification.number;
+                        findPilotQuery.bindValue(0, record.pilot.name);
+                        findPilotQuery.bindValue(1, record.certification.kind);
+                        findPilotQuery.bindValue(2, number);
+                        findPilotQuery.bindValue(3, number);
+                        if (!findPilotQuery.exec()) {
+                            failure = findPilotQuery.lastError().text();
+                            break;
+                        }
+                        pilotId = returnedId(findPilotQuery);
+                    }
+                    if (pilotId == 0) {
+                        pilotQuery.bindValue(0, record.pilot.name);
+                        pilotQuery.bindValue(1, record.pilot.email);
+                        if (!pilotQuery.exec()) {
+                            failure = pilotQuery.lastError().text();
+                            break;
+                        }
+                        pilotId = returnedId(pilotQuery);
+                    }
+                    pilotIds.insert(key, pilotId);
+                }
+
+                airframeQuery.bindValue(0, record.airframe.serialNumber);
+                airframeQuery.bindValue(1, record.airframe.make);
+                airframeQuery.bindValue(2, record.airframe.model);
+                airframeQuery.bindValue(3, record.airframe.systemId);
+                airframeQuery.bindValue(4, pilotId);
+                if (!airframeQuery.exec()) {
+                    failure = airframeQuery.lastError().text();
+                    break;
+                }
+                const qint64 airframeId = returnedId(airframeQuery);
+
+                if (!record.registration.number.isEmpty()) {
+                    registrationQuery.bindValue(0, airframeId);
+                    registrationQuery.bindValue(1, record.registration.number);
+                    registrationQuery.bindValue(2, record.registration.owner);
+                    registrationQuery.bindValue(3, dateValue(record.registration.issued));
+                    registrationQuery.bindValue(4, dateValue(record.registration.expires));
+                    if (!registrationQuery.exec())
+                        failure = registrationQuery.lastError().text();
+                    registrationQuery.finish();
+                }
+
+                if (failure.isEmpty() && pilotId != 0 && !record.certification.number.isEmpty()) {
+                    certificationQuery.bindValue(0, pilotId);
+                    certificationQuery.bindValue(1, record.certification.kind);
+                    certificationQuery.bindValue(2, record.certification.number);
+                    certificationQuery.bindValue(3, dateValue(record.certification.issued));
+                    certificationQuery.bindValue(4, dateValue(record.certification.expires));
+                    if (!certificationQuery.exec())
+                        failure = certificationQuery.lastError().text();
+                    certificationQuery.finish();
+                }
+            }
+
+            if (!failure.isEmpty() || !db.commit()) {
+                if (failure.isEmpty())
+                    failure = db.lastError().text();
+                db.rollback();
+                break;
+            }
+            written = batchEnd;
+            emit importProgress(written, total);
+        }
+
+        if (written > 0)
+            emit rosterChanged();
+        emit importFinished(written, failure);
+    });
+}
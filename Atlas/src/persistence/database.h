@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QDate>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+struct PilotRecord
+{
+    qint64 id = 0; // 0 inserts a new row
+    QString name;
+    QString email;
+};
+
+struct CertificationRecord
+{
+    qint64 id = 0;
+    qint64 pilotId = 0;
+    QString kind;   // e.g. "Part 107"
+    QString number;
+    QDate issued;
+    QDate expires;
+};
+
+struct AirframeRecord
+{
+    qint64 id = 0;
+    QString serialNumber;
+    QString make;
+    QString model;
+    int systemId = 0; // MAVLink sysid
+    qint64 pilotId = 0;
+};
+
+struct RegistrationRecord
+{
+    qint64 id = 0;
+    qint64 airframeId = 0;
+    QString number; // FAA registration / N-number
+    QString owner;
+    QDate issued;
+    QDate expires;
+};
+
+// One roster row: an airframe joined with its current registration and
+// assigned pilot.
+struct RosterEntry
+{
+    qint64 airframeId = 0;
+    QString registration;
+    QString makeModel;
+    QString serialNumber;
+    int systemId = 0;
+    QString pilotName;
+    QDate registrationExpiry;
+    QDate certificationExpiry;
+};
+
+// One parsed import row. Ids are ignored; the importer matches existing rows
+// by make, model and serial number, registration number, certificate number,
+// and pilot email or, for a pilot without one, name and certificate.
+struct RosterImportRecord
+{
+    AirframeRecord airframe;
+    RegistrationRecord registration;
+    PilotRecord pilot;
+    CertificationRecord certification;
+};
+
+class DatabaseWorker;
+
+// SQLite persistence for the roster. Every statement runs on a dedicated
+// DB thread; requests return immediately and results arrive as signals
+// (queued back to the receiver's thread). Call the public methods from the
+// GUI thread only.
+class Database : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Database(QObject *parent = nullptr);
+    ~Database() override;
+
+    void open(const QString &path);
+
+    // Keyset pagination on airframe id, so deep pages cost the same as the
+    // first one. Returns the request id echoed by rosterPageReady().
+    quint64 fetchRosterPage(qint64 afterAirframeId, int limit);
+    void countRoster();
+
+    void savePilot(const PilotRecord &pilot);
+    void saveCertification(const CertificationRecord &certification);
+    void saveAirframe(const AirframeRecord &airframe);
+    void saveRegistration(const RegistrationRecord &registration);
+
+    // Upserts the records in large transactions, reporting importProgress()
+    // after each committed batch.
+    void importRoster(const QList<RosterImportRecord> &records);
+
+signals:
+    void opened(bool ok, const QString &error);
+    void rosterPageReady(quint64 requestId, const QList<RosterEntry> &rows);
+    void rosterCountReady(int count);
+    void rosterChanged();
+    void importProgress(int written, int total);
+    void importFinished(int written, const QString &error);
+    void error(const QString &message);
+
+private:
+    template<typename Job>
+    void run(Job &&job);
+
+    QThread m_thread;
+    DatabaseWorker *m_worker = nullptr;
+    quint64 m_nextRequestId = 1;
+};
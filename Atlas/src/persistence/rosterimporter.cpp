@@ -0,0 +1,360 @@
+#include "rosterimporter.h"
+
+#include <QFile>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "persistence/csvscanner.h"
+
+namespace {
+
+constexpr qint64 minimumChunkSize = 1 << 20;
+
+struct Chunk
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+};
+
+struct ChunkResult
+{
+    QList<RosterImportRecord> records;
+    int rejected = 0;
+};
+
+// Column indices resolved from the header row; -1 when absent.
+struct ColumnMap
+{
+    int registration = -1;
+    int serialNumber = -1;
+    int make = -1;
+    int model = -1;
+    int systemId = -1;
+    int owner = -1;
+    int registrationIssued = -1;
+    int registrationExpires = -1;
+    int pilotName = -1;
+    int pilotEmail = -1;
+    int certificateKind = -1;
+    int certificateNumber = -1;
+    int certificateIssued = -1;
+    int certificateExpires = -1;
+    bool faaRegistry = false; // N-numbers are stored without the leading N
+};
+
+QString normalizedHeader(std::string_view text)
+{
+    QString name = QString::fromUtf8(text.data(), qsizetype(text.size())).trimmed().toLower();
+    name.replace(QLatin1Char(' '), QLatin1Char('_'));
+    name.replace(QLatin1Char('-'), QLatin1Char('_'));
+    return name;
+}
+
+ColumnMap mapColumns(const std::vector<CsvScanner::Field> &header)
+{
+    ColumnMap map;
+    const struct
+    {
+        int ColumnMap::*column;
+        std::initializer_list<const char *> names;
+    } aliases[] = {
+        {&ColumnMap::registration, {"registration", "registration_number", "n_number"}},
+        {&ColumnMap::serialNumber, {"serial_number", "serial"}},
+        {&ColumnMap::make, {"make", "manufacturer"}},
+        {&ColumnMap::model, {"model"}},
+        {&ColumnMap::systemId, {"system_id", "sysid", "mavlink_sysid"}},
+        {&ColumnMap::owner, {"owner", "registrant", "name"}},
+        {&ColumnMap::registrationIssued, {"registration_issued", "cert_issue_date"}},
+        {&ColumnMap::registrationExpires, {"registration_expires", "expiration_date"}},
+        {&ColumnMap::pilotName, {"pilot_name", "pilot"}},
+        {&ColumnMap::pilotEmail, {"pilot_email", "email"}},
+        {&ColumnMap::certificateKind, {"certificate_kind"}},
+        {&ColumnMap::certificateNumber, {"certificate_number", "certificate"}},
+        {&ColumnMap::certificateIssued, {"certificate_issued"}},
+        {&ColumnMap::certificateExpires, {"certificate_expires"}},
+    };
+
+    for (int i = 0; i < int(header.size()); ++i) {
+        const QString name = normalizedHeader(header[i].text);
+        if (name == QLatin1String("n_number"))
+            map.faaRegistry = true;
+        for (const auto &alias : aliases) {
+            if (map.*alias.column >= 0)
+                continue;
+            for (const char *candidate : alias.names) {
+                if (name == QLatin1String(candidate)) {
+                    map.*alias.column = i;
+                    break;
+                }
+            }
+        }
+    }
+    return map;
+}
+
+QString field(const std::vector<CsvScanner::Field> &fields, int column)
+{
+    if (column < 0 || column >= int(fields.size()))
+        return QString();
+    const CsvScanner::Field &f = fields[column];
+    if (f.escaped) {
+        const std::string text = CsvScanner::unescape(f.text);
+        return QString::fromUtf8(text.data(), qsizetype(text.size())).trimmed();
+    }
+    return QString::fromUtf8(f.text.data(), qsizetype(f.text.size())).trimmed();
+}
+
+// Accepts YYYYMMDD (FAA) and YYYY-MM-DD without going through QDate's
+// format parser, which dominates the profile on registry-sized files.
+QDate parseDate(const QString &text)
+{
+    int digits[8];
+    int count = 0;
+    for (const QChar c : text) {
+        if (c.isDigit()) {
+            if (count == 8)
+                return QDate();
+            digits[count++] = c.digitValue();
+        }
+    }
+    if (count != 8)
+        return QDate();
+    const int year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+    const int month = digits[4] * 10 + digits[5];
+    const int day = digits[6] * 10 + digits[7];
+    return QDate(year, month, day);
+}
+
+bool validRegistration(const QString &registration)
+{
+    if (registration.isEmpty() || registration.size() > 16)
+        return false;
+    for (const QChar c : registration) {
+        if (!(c.isDigit() || (c >= QLatin1Char('A') && c <= QLatin1Char('Z')) || c == QLatin1Char('-')))
+            return false;
+    }
+    return true;
+}
+
+ChunkResult parseChunk(const Chunk &chunk, const ColumnMap &columns, char delimiter)
+{
+    ChunkResult result;
+    CsvScanner scanner(chunk.begin, chunk.end, delimiter);
+    std::vector<CsvScanner::Field> fields;
+    while (scanner.next(fields)) {
+        if (fields.size() == 1 && fields.front().text.empty())
+            continue; // blank line
+
+        RosterImportRecord record;
+        record.airframe.serialNumber = field(fields, columns.serialNumber);
+        record.airframe.make = field(fields, columns.make);
+        record.airframe.model = field(fields, columns.model);
+
+        QString registration = field(fields, columns.registration).toUpper();
+        if (columns.faaRegistry && !registration.isEmpty() && !registration.startsWith(QLatin1Char('N')))
+            registration.prepend(QLatin1Char('N'));
+
+        bool systemIdOk = true;
+        const QString systemId = field(fields, columns.systemId);
+        if (!systemId.isEmpty()) {
+            record.airframe.systemId = systemId.toInt(&systemIdOk);
+            systemIdOk = systemIdOk && record.airframe.systemId >= 1 && record.airframe.systemId <= 255;
+        }
+
+        if (record.airframe.serialNumber.isEmpty() || !validRegistration(registration) || !systemIdOk) {
+            ++result.rejected;
+            continue;
+        }
+
+        record.registration.number = registration;
+        record.registration.owner = field(fields, columns.owner);
+        record.registration.issued = parseDate(field(fields, columns.registrationIssued));
+        record.registration.expires = parseDate(field(fields, columns.registrationExpires));
+
+        record.pilot.name = field(fields, columns.pilotName);
+        record.pilot.email = field(fields, columns.pilotEmail);
+        record.certification.number = field(fields, columns.certificateNumber);
+        record.certification.kind = field(fields, columns.certificateKind);
+        if (record.certification.kind.isEmpty())
+            record.certification.kind = QStringLiteral("Part 107");
+        record.certification.issued = parseDate(field(fields, columns.certificateIssued));
+        record.certification.expires = parseDate(field(fields, columns.certificateExpires));
+
+        result.records.append(record);
+    }
+    return result;
+}
+
+} // namespace
+
+RosterImporter::RosterImporter(Database *database, QObject *parent)
+    : QObject(parent)
+    , m_database(database)
+{
+    connect(&m_parser, &QFutureWatcher<ParseResult>::finished, this, &RosterImporter::onParsed);
+    connect(m_database, &Database::importProgress, this, &RosterImporter::onImportProgress);
+    connect(m_database, &Database::importFinished, this, &RosterImporter::onImportFinished);
+}
+
+RosterImporter::~RosterImporter()
+{
+    m_parser.waitForFinished();
+}
+
+bool RosterImporter::importFile(const QUrl &fileUrl)
+{
+    if (m_running)
+        return false;
+
+    m_duplicates = 0;
+    m_rejected = 0;
+    setRunning(true);
+    setProgress(QStringLiteral("Parsing"), 0);
+    const QString path = fileUrl.isLocalFile() ? fileUrl.toLocalFile() : fileUrl.toString();
+    m_parser.setFuture(QtConcurrent::run([this, path] { return parse(path); }));
+    return true;
+}
+
+RosterImporter::ParseResult RosterImporter::parse(const QString &path)
+{
+    ParseResult result;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.error = file.errorString();
+        return result;
+    }
+    const qint64 size = file.size();
+    const uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    if (!mapped) {
+        result.error = size > 0 ? file.errorString() : QStringLiteral("File is empty");
+        return result;
+    }
+
+    const char *begin = reinterpret_cast<const char *>(mapped);
+    const char *end = begin + size;
+    if (size >= 3 && std::string_view(begin, 3) == "\xEF\xBB\xBF")
+        begin += 3;
+
+    // Header row decides the delimiter and the column layout.
+    const char *headerEnd = static_cast<const char *>(std::memchr(begin, '\n', size_t(end - begin)));
+    headerEnd = headerEnd ? headerEnd + 1 : end;
+    const std::string_view headerLine(begin, size_t(headerEnd - begin));
+    const char delimiter = std::count(headerLine.begin(), headerLine.end(), '\t')
+                                   > std::count(headerLine.begin(), headerLine.end(), ',')
+                               ? '\t'
+                               : ',';
+    std::vector<CsvScanner::Field> header;
+    CsvScanner(begin, headerEnd, delimiter).next(header);
+    const ColumnMap columns = mapColumns(header);
+    if (columns.serialNumber < 0 || columns.registration < 0) {
+        result.error = QStringLiteral("Missing serial number or registration column");
+        return result;
+    }
+
+    // Newline-aligned chunks, a few per core so uneven chunks balance out.
+    const qint64 body = end - headerEnd;
+    const int chunkCount = int(qBound<qint64>(1, body / minimumChunkSize, QThread::idealThreadCount() * 4));
+    QList<Chunk> chunks;
+    const char *chunkBegin = headerEnd;
+    for (int i = 1; i <= chunkCount && chunkBegin < end; ++i) {
+        const char *chunkEnd = end;
+        if (i < chunkCount) {
+            const char *target = headerEnd + body * i / chunkCount;
+            if (target < chunkBegin)
+                target = chunkBegin;
+            const char *newline = static_cast<const char *>(std::memchr(target, '\n', size_t(end - target)));
+            chunkEnd = newline ? newline + 1 : end;
+        }
+        chunks.append({chunkBegin, chunkEnd});
+        chunkBegin = chunkEnd;
+    }
+
+    std::atomic<int> chunksDone{0};
+    const QList<ChunkResult> parsed = QtConcurrent::blockingMapped<QList<ChunkResult>>(
+        chunks, [&](const Chunk &chunk) {
+            ChunkResult chunkResult = parseChunk(chunk, columns, delimiter);
+            const qreal done = qreal(++chunksDone) / chunks.size();
+            QMetaObject::invokeMethod(this, [this, done] { setProgress(QStringLiteral("Parsing"), done); },
+                                      Qt::QueuedConnection);
+            return chunkResult;
+        });
+
+    // Merge in file order so "first occurrence wins" is deterministic.
+    qsizetype total = 0;
+    for (const ChunkResult &chunkResult : parsed)
+        total += chunkResult.records.size();
+    result.records.reserve(total);
+    QSet<QString> airframes; // make, model and serial number
+    QSet<QString> registrations;
+    airframes.reserve(total);
+    registrations.reserve(total);
+    for (const ChunkResult &chunkResult : parsed) {
+        result.rejected += chunkResult.rejected;
+        for (const RosterImportRecord &record : chunkResult.records) {
+            const QString airframe = record.airframe.make + QChar(0x1f) + record.airframe.model + QChar(0x1f)
+                                     + record.airframe.serialNumber;
+            if (airframes.contains(airframe) || registrations.contains(record.registration.number)) {
+                ++result.duplicates;
+                continue;
+            }
+            airframes.insert(airframe);
+            registrations.insert(record.registration.number);
+            result.records.append(record);
+        }
+    }
+    return result;
+}
+
+void RosterImporter::onParsed()
+{
+    ParseResult result = m_parser.result();
+    m_duplicates = result.duplicates;
+    m_rejected = result.rejected;
+    if (!result.error.isEmpty() || result.records.isEmpty()) {
+        setRunning(false);
+        emit finished(0, m_duplicates, m_rejected, result.error);
+        return;
+    }
+
+    setProgress(QStringLiteral("Writing"), 0);
+    m_database->importRoster(result.records);
+}
+
+void RosterImporter::onImportProgress(int written, int total)
+{
+    if (m_running && total > 0)
+        setProgress(QStringLiteral("Writing"), qreal(written) / total);
+}
+
+void RosterImporter::onImportFinished(int written, const QString &error)
+{
+    if (!m_running)
+        return;
+    setRunning(false);
+    emit finished(written, m_duplicates, m_rejected, error);
+}
+
+void RosterImporter::setProgress(const QString &phase, qreal progress)
+{
+    if (m_phase == phase && qFuzzyCompare(m_progress + 1, progress + 1))
+        return;
+    m_phase = phase;
+    m_progress = progress;
+    emit progressChanged();
+}
+
+void RosterImporter::setRunning(bool running)
+{
+    if (m_running == running)
+        return;
+    m_running = running;
+    emit runningChanged();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+
+#include "persistence/database.h"
+
+// Bulk import of fleet CSVs and FAA registry dumps (MASTER.txt). The file is
+// mapped, split into newline-aligned chunks that are parsed in parallel,
+// validated and de-duplicated in memory, then handed to Database in large
+// transactions. Records are assumed not to contain quoted line breaks,
+// which holds for both formats and is what makes the split safe.
+class RosterImporter : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(QString phase READ phase NOTIFY progressChanged)
+    Q_PROPERTY(qreal progress READ progress NOTIFY progressChanged)
+
+public:
+    explicit RosterImporter(Database *database, QObject *parent = nullptr);
+    ~RosterImporter() override;
+
+    // Returns false if an import is already running.
+    Q_INVOKABLE bool importFile(const QUrl &fileUrl);
+
+    bool running() const { return m_running; }
+    QString phase() const { return m_phase; }
+    qreal progress() const { return m_progress; }
+
+signals:
+    void runningChanged();
+    void progressChanged();
+    void finished(int imported, int duplicates, int rejected, const QString &error);
+
+private:
+    struct ParseResult
+    {
+        QList<RosterImportRecord> records;
+        int duplicates = 0;
+        int rejected = 0;
+        QString error;
+    };
+
+    ParseResult parse(const QString &path);
+    void onParsed();
+    void onImportProgress(int written, int total);
+    void onImportFinished(int written, const QString &error);
+    void setProgress(const QString &phase, qreal progress);
+    void setRunning(bool running);
+
+    Database *m_database;
+    QFutureWatcher<ParseResult> m_parser;
+    bool m_running = false;
+    QString m_phase;
+    qreal m_progress = 0;
+    int m_duplicates = 0;
+    int m_rejected = 0;
+};
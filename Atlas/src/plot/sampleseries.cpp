@@ -0,0 +1,93 @@
+#include "sampleseries.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr float noValue = std::numeric_limits<float>::quiet_NaN();
+constexpr qint64 noColumn = std::numeric_limits<qint64>::min();
+
+} // namespace
+
+SampleSeries::SampleSeries(size_t capacity)
+    : m_times(std::max<size_t>(capacity, 1))
+    , m_values(std::max<size_t>(capacity, 1))
+{
+}
+
+void SampleSeries::clear()
+{
+    m_size = 0;
+    m_appended = 0;
+    m_columnUs = 0;
+    m_columns.clear();
+    m_folded = 0;
+}
+
+void SampleSeries::append(qint64 timeUs, float value)
+{
+    if (value != value || (m_size > 0 && timeUs < m_times[slotOf(m_appended - 1)]))
+        return; // NaN or out of order
+    const size_t slot = slotOf(m_appended);
+    m_times[slot] = timeUs;
+    m_values[slot] = value;
+    ++m_appended;
+    m_size = std::min(m_size + 1, m_times.size());
+}
+
+qint64 SampleSeries::columnOf(qint64 timeUs, qint64 columnUs)
+{
+    return timeUs >= 0 ? timeUs / columnUs : -((-timeUs + columnUs - 1) / columnUs);
+}
+
+void SampleSeries::decimate(qint64 endUs, qint64 columnUs, int columns, PlotColumn *out)
+{
+    if (columns <= 0 || columnUs <= 0)
+        return;
+    const qint64 lastColumn = columnOf(endUs, columnUs);
+    const qint64 firstColumn = lastColumn - columns + 1;
+
+    if (columnUs != m_columnUs || m_columns.size() != size_t(columns)) {
+        // New width or time span: reduce the window again from the ring.
+        m_columnUs = columnUs;
+        m_columns.assign(size_t(columns), {noColumn, {noValue, noValue}});
+        const qint64 startUs = firstColumn * columnUs;
+        quint64 low = oldestSequence();
+        quint64 high = m_appended;
+        while (low < high) {
+            const quint64 middle = low + (high - low) / 2;
+            if (m_times[slotOf(middle)] < startUs)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        m_folded = low;
+    }
+
+    // Samples overwritten before they were drawn are simply lost.
+    quint64 sequence = std::max(m_folded, oldestSequence());
+    for (; sequence < m_appended; ++sequence) {
+        const size_t slot = slotOf(sequence);
+        const qint64 column = columnOf(m_times[slot], columnUs);
+        if (column > lastColumn)
+            break; // ahead of the window; folded once it gets there
+        if (column < firstColumn)
+            continue;
+        const float value = m_values[slot];
+        CachedColumn &cached = m_columns[size_t((column % columns + columns) % columns)];
+        if (cached.column != column) {
+            cached = {column, {value, value}};
+        } else {
+            cached.range.min = std::min(cached.range.min, value);
+            cached.range.max = std::max(cached.range.max, value);
+        }
+    }
+    m_folded = sequence;
+
+    for (int i = 0; i < columns; ++i) {
+        const qint64 column = firstColumn + i;
+        const CachedColumn &cached = m_columns[size_t((column % columns + columns) % columns)];
+        out[i] = cached.column == column ? cached.range : PlotColumn{noValue, noValue};
+    }
+}
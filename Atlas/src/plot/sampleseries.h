@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <cstddef>
+#include <vector>
+
+// Smallest and largest sample in one pixel column; NaN for a column
+// without samples.
+struct PlotColumn
+{
+    float min;
+    float max;
+};
+
+// One plotted signal: a fixed-capacity ring of samples in arrival order,
+// and their min/max per pixel column of a sliding time window. Columns are
+// aligned to multiples of the column width rather than to the window, so
+// as the window scrolls a column already reduced stays valid and only
+// samples that arrived since the last frame are folded in. A frame costs
+// the new samples plus the columns drawn, however many points are visible.
+class SampleSeries
+{
+public:
+    explicit SampleSeries(size_t capacity = 100000);
+
+    size_t capacity() const { return m_times.size(); }
+    size_t size() const { return m_size; }
+    void clear();
+
+    // Times are µs on a monotonic clock; a sample older than the newest
+    // is dropped.
+    void append(qint64 timeUs, float value);
+
+    // Writes columns entries to out, oldest first, covering columnUs each up
+    // to the column holding endUs.
+    void decimate(qint64 endUs, qint64 columnUs, int columns, PlotColumn *out);
+
+private:
+    struct CachedColumn
+    {
+        qint64 column;
+        PlotColumn range;
+    };
+
+    static qint64 columnOf(qint64 timeUs, qint64 columnUs);
+    // Ring position of the sample with a sequence number still held.
+    size_t slotOf(quint64 sequence) const { return size_t(sequence % m_times.size()); }
+    quint64 oldestSequence() const { return m_appended - m_size; }
+
+    std::vector<qint64> m_times;
+    std::vector<float> m_values;
+    size_t m_size = 0;
+    quint64 m_appended = 0; // sequence number of the next sample
+
+    qint64 m_columnUs = 0;
+    std::vector<CachedColumn> m_columns; // ring indexed by column % size
+    quint64 m_folded = 0;                // samples before this are in m_columns
+};
@@ -0,0 +1,303 @@
+#include "streamingplot.h"
+
+#include <QQuickWindow>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr int minimumTimeSpanMs = 100;
+
+// Distinct on dark and light themes alike.
+const QColor palette[StreamingPlot::maxSeries] = {
+    QColor(0xe6, 0x19, 0x4b), QColor(0x3c, 0xb4, 0x4b), QColor(0x43, 0x63, 0xd8), QColor(0xf5, 0x82, 0x31),
+    QColor(0x91, 0x1e, 0xb4), QColor(0x42, 0xd4, 0xf4), QColor(0xf0, 0x32, 0xe6), QColor(0xbf, 0xef, 0x45),
+    QColor(0xfa, 0xbe, 0xd4), QColor(0x46, 0x99, 0x90), QColor(0xdc, 0xbe, 0xff), QColor(0x9a, 0x63, 0x24),
+    QColor(0xff, 0xe1, 0x19), QColor(0x80, 0x00, 0x00), QColor(0xaa, 0xff, 0xc3), QColor(0x80, 0x80, 0x00),
+};
+
+qint64 steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int fieldByName(const QString &name)
+{
+    const QByteArray latin = name.toLatin1();
+    for (int field = 0; field < VehicleFieldCount; ++field) {
+        if (latin == vehicleFieldName(VehicleField(field)))
+            return field;
+    }
+    return -1;
+}
+
+} // namespace
+
+StreamingPlot::StreamingPlot(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents);
+    m_seriesByField.fill(-1);
+}
+
+StreamingPlot::~StreamingPlot()
+{
+    detachTap();
+}
+
+void StreamingPlot::setVehicles(VehicleModel *vehicles)
+{
+    if (vehicles == m_vehicles)
+        return;
+    detachTap();
+    m_vehicles = vehicles;
+    attachTap();
+    emit vehiclesChanged();
+}
+
+void StreamingPlot::setSystemId(int systemId)
+{
+    if (systemId == m_systemId)
+        return;
+    m_systemId = systemId;
+    clear();
+    emit systemIdChanged();
+}
+
+void StreamingPlot::setFields(const QStringList &fields)
+{
+    if (fields == m_fields)
+        return;
+    m_fields = fields;
+    rebuildSeries();
+    emit fieldsChanged();
+}
+
+void StreamingPlot::setColors(const QVariantList &colors)
+{
+    if (colors == m_colors)
+        return;
+    m_colors = colors;
+    for (size_t i = 0; i < m_series.size(); ++i)
+        m_series[i]->color = colorOf(int(i));
+    m_colorsChanged = true;
+    update();
+    emit colorsChanged();
+}
+
+void StreamingPlot::setTimeSpanMs(int timeSpanMs)
+{
+    timeSpanMs = std::max(timeSpanMs, minimumTimeSpanMs);
+    if (timeSpanMs == m_timeSpanMs)
+        return;
+    m_timeSpanMs = timeSpanMs;
+    update();
+    emit timeSpanChanged();
+}
+
+void StreamingPlot::setCapacity(int capacity)
+{
+    capacity = std::max(capacity, 1);
+    if (capacity == m_capacity)
+        return;
+    m_capacity = capacity;
+    rebuildSeries();
+    emit capacityChanged();
+}
+
+void StreamingPlot::setMinimum(double minimum)
+{
+    if (minimum == m_minimum)
+        return;
+    m_minimum = minimum;
+    update();
+    emit rangeChanged();
+}
+
+void StreamingPlot::setMaximum(double maximum)
+{
+    if (maximum == m_maximum)
+        return;
+    m_maximum = maximum;
+    update();
+    emit rangeChanged();
+}
+
+void StreamingPlot::clear()
+{
+    for (const auto &series : m_series)
+        series->samples.clear();
+    update();
+}
+
+QColor StreamingPlot::colorOf(int index) const
+{
+    if (index < m_colors.size()) {
+        const QColor color = m_colors.at(index).value<QColor>();
+        if (color.isValid())
+            return color;
+    }
+    return palette[index % maxSeries];
+}
+
+void StreamingPlot::rebuildSeries()
+{
+    m_series.clear();
+    m_seriesByField.fill(-1);
+    for (const QString &name : std::as_const(m_fields)) {
+        const int field = fieldByName(name);
+        if (field < 0 || m_seriesByField[size_t(field)] >= 0 || int(m_series.size()) == maxSeries)
+            continue;
+        auto series = std::make_unique<Series>(Series{VehicleField(field), colorOf(int(m_series.size())),
+                                                      SampleSeries(size_t(m_capacity)), {}});
+        m_seriesByField[size_t(field)] = int(m_series.size());
+        m_series.push_back(std::move(series));
+    }
+    m_seriesChanged = true;
+    update();
+}
+
+void StreamingPlot::attachTap()
+{
+    if (!m_vehicles)
+        return;
+    m_sampleTap = m_vehicles->store()->addSampleTap(
+        [this](int systemId, VehicleField field, double value, qint64, const SampleTime &time) {
+            if (systemId != m_systemId)
+                return;
+            const int index = m_seriesByField[size_t(field)];
+            if (index < 0)
+                return;
+            // When the vehicle took it if its clock is synchronized, else now.
+            const qint64 timeUs = time.uncertaintyUs >= 0 ? time.monotonicUs : steadyNowUs();
+            m_series[size_t(index)]->samples.append(timeUs, float(value));
+        });
+}
+
+void StreamingPlot::detachTap()
+{
+    if (m_vehicles && m_sampleTap != 0)
+        m_vehicles->store()->removeSampleTap(m_sampleTap);
+    m_sampleTap = 0;
+}
+
+void StreamingPlot::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    if (change == ItemSceneChange) {
+        if (window())
+            disconnect(window(), nullptr, this, nullptr);
+        // Scrolls every frame, so keep asking for the next one.
+        if (value.window)
+            connect(value.window, &QQuickWindow::afterAnimating, this, &QQuickItem::update);
+    }
+    QQuickItem::itemChange(change, value);
+}
+
+QSGNode *StreamingPlot::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    QSGNode *root = oldNode ? oldNode : new QSGNode;
+
+    if (m_seriesChanged) {
+        while (QSGNode *child = root->firstChild()) {
+            root->removeChildNode(child);
+            delete child;
+        }
+        for (size_t i = 0; i < m_series.size(); ++i) {
+            auto *node = new QSGGeometryNode;
+            auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+            geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+            geometry->setLineWidth(1);
+            // Rewritten every frame; the buffer is only reallocated on resize.
+            geometry->setVertexDataPattern(QSGGeometry::StreamPattern);
+            node->setGeometry(geometry);
+            node->setFlag(QSGNode::OwnsGeometry);
+            node->setMaterial(new QSGFlatColorMaterial);
+            node->setFlag(QSGNode::OwnsMaterial);
+            root->appendChildNode(node);
+        }
+        m_seriesChanged = false;
+        m_colorsChanged = true;
+    }
+    if (m_series.empty() || width() < 1 || height() < 1)
+        return root;
+
+    if (m_colorsChanged) {
+        QSGNode *child = root->firstChild();
+        for (const auto &series : m_series) {
+            auto *node = static_cast<QSGGeometryNode *>(child);
+            static_cast<QSGFlatColorMaterial *>(node->material())->setColor(series->color);
+            node->markDirty(QSGNode::DirtyMaterial);
+            child = child->nextSibling();
+        }
+        m_colorsChanged = false;
+    }
+
+    // The GUI thread is blocked here, so the taps are not appending.
+    const int columns = int(width());
+    const qint64 nowUs = steadyNowUs();
+    const qint64 columnUs = std::max<qint64>(1, qint64(m_timeSpanMs) * 1000 / columns);
+    float low = float(m_minimum);
+    float high = float(m_maximum);
+    const bool fit = m_minimum >= m_maximum;
+    if (fit) {
+        low = std::numeric_limits<float>::infinity();
+        high = -low;
+    }
+    for (const auto &series : m_series) {
+        series->columns.resize(size_t(columns));
+        series->samples.decimate(nowUs, columnUs, columns, series->columns.data());
+        if (!fit)
+            continue;
+        for (const PlotColumn &column : series->columns) {
+            if (std::isnan(column.min))
+                continue;
+            low = std::min(low, column.min);
+            high = std::max(high, column.max);
+        }
+    }
+    if (!(low < high)) {
+        // Nothing in view, or a flat line: centre it.
+        const float middle = std::isfinite(low) ? low : 0;
+        low = middle - 1;
+        high = middle + 1;
+    }
+
+    // Columns sit on fixed time boundaries, so they drift left between
+    // frames by however far now moved into the current column.
+    const double pixelsPerColumn = width() / columns;
+    const qint64 firstColumn = nowUs / columnUs - columns + 1; // steady clock, never negative
+    const double yScale = height() / double(high - low);
+    QSGNode *child = root->firstChild();
+    for (const auto &series : m_series) {
+        auto *node = static_cast<QSGGeometryNode *>(child);
+        child = child->nextSibling();
+        QSGGeometry *geometry = node->geometry();
+        if (geometry->vertexCount() != 2 * columns)
+            geometry->allocate(2 * columns);
+        QSGGeometry::Point2D *vertex = geometry->vertexDataAsPoint2D();
+        QSGGeometry::Point2D *const end = vertex + 2 * columns;
+        for (int i = 0; i < columns; ++i) {
+            const PlotColumn &column = series->columns[size_t(i)];
+            if (std::isnan(column.min))
+                continue;
+            const qint64 middleUs = (firstColumn + i) * columnUs + columnUs / 2;
+            const float x = float(width() - double(nowUs - middleUs) / double(columnUs) * pixelsPerColumn);
+            (vertex++)->set(x, float(height() - (column.min - low) * yScale));
+            (vertex++)->set(x, float(height() - (column.max - low) * yScale));
+        }
+        // Empty columns leave a tail; collapse it onto the last point.
+        const QSGGeometry::Point2D last = vertex != geometry->vertexDataAsPoint2D() ? vertex[-1]
+                                                                                   : QSGGeometry::Point2D{0, 0};
+        std::fill(vertex, end, last);
+        node->markDirty(QSGNode::DirtyGeometry);
+    }
+    return root;
+}
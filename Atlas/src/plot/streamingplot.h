@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QColor>
+#include <QPointer>
+#include <QQuickItem>
+#include <QStringList>
+#include <QVariantList>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "models/vehiclemodel.h"
+#include "plot/sampleseries.h"
+
+// Live plot of some of one vehicle's telemetry fields at the rate they
+// arrive. Samples go straight from the state store's sample tap into a
+// ring buffer per series; every frame each series is min/max-reduced to
+// one column per pixel and written into its own line strip geometry node
+// in place, so QML never sees a sample and the work per frame follows the
+// plot's width, not the number of points in view.
+class StreamingPlot : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(VehicleModel *vehicles READ vehicles WRITE setVehicles NOTIFY vehiclesChanged)
+    Q_PROPERTY(int systemId READ systemId WRITE setSystemId NOTIFY systemIdChanged)
+    // vehicleFieldName()s, one series each, at most maxSeries.
+    Q_PROPERTY(QStringList fields READ fields WRITE setFields NOTIFY fieldsChanged)
+    // Series colours in field order; a palette fills in the rest.
+    Q_PROPERTY(QVariantList colors READ colors WRITE setColors NOTIFY colorsChanged)
+    Q_PROPERTY(int timeSpanMs READ timeSpanMs WRITE setTimeSpanMs NOTIFY timeSpanChanged)
+    // Samples kept per series.
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    // Fixed vertical range; fits the visible samples while minimum >= maximum.
+    Q_PROPERTY(double minimum READ minimum WRITE setMinimum NOTIFY rangeChanged)
+    Q_PROPERTY(double maximum READ maximum WRITE setMaximum NOTIFY rangeChanged)
+
+public:
+    static constexpr int maxSeries = 16;
+
+    explicit StreamingPlot(QQuickItem *parent = nullptr);
+    ~StreamingPlot() override;
+
+    VehicleModel *vehicles() const { return m_vehicles; }
+    void setVehicles(VehicleModel *vehicles);
+    int systemId() const { return m_systemId; }
+    void setSystemId(int systemId);
+    QStringList fields() const { return m_fields; }
+    void setFields(const QStringList &fields);
+    QVariantList colors() const { return m_colors; }
+    void setColors(const QVariantList &colors);
+    int timeSpanMs() const { return m_timeSpanMs; }
+    void setTimeSpanMs(int timeSpanMs);
+    int capacity() const { return m_capacity; }
+    void setCapacity(int capacity);
+    double minimum() const { return m_minimum; }
+    void setMinimum(double minimum);
+    double maximum() const { return m_maximum; }
+    void setMaximum(double maximum);
+
+    Q_INVOKABLE void clear();
+
+signals:
+    void vehiclesChanged();
+    void systemIdChanged();
+    void fieldsChanged();
+    void colorsChanged();
+    void timeSpanChanged();
+    void capacityChanged();
+    void rangeChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private:
+    struct Series
+    {
+        VehicleField field;
+        QColor color;
+        SampleSeries samples;
+        std::vector<PlotColumn> columns; // scratch for the frame
+    };
+
+    void attachTap();
+    void detachTap();
+    void rebuildSeries();
+    QColor colorOf(int index) const;
+
+    QPointer<VehicleModel> m_vehicles;
+    int m_sampleTap = 0;
+    int m_systemId = 0;
+    QStringList m_fields;
+    QVariantList m_colors;
+    int m_timeSpanMs = 10000;
+    int m_capacity = 100000;
+    double m_minimum = 0;
+    double m_maximum = 0;
+
+    std::vector<std::unique_ptr<Series>> m_series;
+    std::array<int, VehicleFieldCount> m_seriesByField; // -1 when not plotted
+    bool m_seriesChanged = true;
+    bool m_colorsChanged = true;
+};
@@ -0,0 +1,21 @@
+#include "settingspropertymap.h"
+
+SettingsPropertyMap::SettingsPropertyMap(SettingsStore *store, QObject *parent)
+    : QQmlPropertyMap(this, parent)
+    , m_store(store)
+{
+    for (const SettingDefinition &definition : settingsSchema())
+        insert(definition.key, m_store->value(definition.key));
+    freeze(); // the schema is fixed; QML cannot add keys
+
+    connect(m_store, &SettingsStore::valueChanged, this, [this](const QString &key, const QVariant &value) {
+        if (this->value(key) != value)
+            insert(key, value);
+    });
+}
+
+QVariant SettingsPropertyMap::updateValue(const QString &key, const QVariant &input)
+{
+    m_store->setValue(key, input);
+    return m_store->value(key);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QQmlPropertyMap>
+
+#include "settings/settingsstore.h"
+
+// Exposes SettingsStore to QML with one property per key (Settings.theme),
+// so bindings are notified per key. Writes from QML are validated by the
+// store; rejected values leave the property unchanged.
+class SettingsPropertyMap : public QQmlPropertyMap
+{
+    Q_OBJECT
+
+public:
+    explicit SettingsPropertyMap(SettingsStore *store, QObject *parent = nullptr);
+
+protected:
+    QVariant updateValue(const QString &key, const QVariant &input) override;
+
+private:
+    SettingsStore *m_store;
+};
@@ -0,0 +1,72 @@
+#include "settingsschema.h"
+
+#include <cmath>
+
+bool SettingDefinition::coerce(QVariant &value) const
+{
+    const QMetaType target(type == QMetaType::Int ? QMetaType::LongLong : type);
+    if (!value.isValid() || !value.convert(target))
+        return false;
+
+    switch (type) {
+    case QMetaType::Int:
+    case QMetaType::Double: {
+        const double number = value.toDouble();
+        if (!std::isfinite(number))
+            return false;
+        if (minimum.isValid() && number < minimum.toDouble())
+            return false;
+        if (maximum.isValid() && number > maximum.toDouble())
+            return false;
+        return true;
+    }
+    case QMetaType::QString:
+        return choices.isEmpty() || choices.contains(value.toString());
+    default:
+        return true;
+    }
+}
+
+const QList<SettingDefinition> &settingsSchema()
+{
+    static const QList<SettingDefinition> schema = {
+        {QStringLiteral("theme"), QMetaType::QString, QStringLiteral("dark"), {}, {},
+         {QStringLiteral("dark"), QStringLiteral("light"), QStringLiteral("custom")}},
+        // Prometheus endpoint on localhost; 0 disables it.
+        {QStringLiteral("metricsPort"), QMetaType::Int, 9464, 0, 65535, {}},
+        // atlasd settings below. The UI writes them and the daemon reloads
+        // on every save, but only daemonMetricsPort and routerEndpoints apply
+        // at once; the rest take effect when the daemon restarts.
+        //
+        // atlasd: MAVLink UDP links as "name:port,name:port" (redundant
+        // links to the same aircraft are deduplicated), and its own
+        // Prometheus endpoint.
+        {QStringLiteral("ingestLinks"), QMetaType::QString, QStringLiteral("radio:14550"), {}, {}, {}},
+        {QStringLiteral("daemonMetricsPort"), QMetaType::Int, 9465, 0, 65535, {}},
+        // atlasd: MAVLink 2 signing keys as "name=<64 hex digits>,..." by
+        // ingest link name. A link with a key drops unsigned, forged and
+        // replayed frames and signs what it sends.
+        {QStringLiteral("signingKeys"), QMetaType::QString, QString(), {}, {}, {}},
+        // atlasd: ingest links that are not MAVLink, as "name=decoder,..."
+        // naming a decoder plugin in the decoders directory of the install.
+        {QStringLiteral("linkDecoders"), QMetaType::QString, QString(), {}, {}, {}},
+        // atlasd: other ground stations and tools to route MAVLink to, as
+        // "name=host:port [rate=N] [only=ids | drop=ids]" separated by
+        // ';'. rate caps frames per second (heartbeats always pass); ids
+        // are comma-separated message ids. Empty turns routing off.
+        {QStringLiteral("routerEndpoints"), QMetaType::QString, QString(), {}, {}, {}},
+        // atlasd: UDP port remote observers send subscription requests to
+        // for decimated telemetry (see SubscriptionServer); 0 is off. Listens
+        // on localhost; another address also needs a secret that requests
+        // then carry as key=<secret>.
+        {QStringLiteral("subscriptionPort"), QMetaType::Int, 0, 0, 65535, {}},
+        {QStringLiteral("subscriptionAddress"), QMetaType::QString, QStringLiteral("127.0.0.1"), {}, {}, {}},
+        {QStringLiteral("subscriptionSecret"), QMetaType::QString, QString(), {}, {}, {}},
+        // atlasd: WebSocket traffic picture for wall displays (0 is off).
+        // Listens on localhost unless the address is set to a LAN one or
+        // 0.0.0.0.
+        {QStringLiteral("picturePort"), QMetaType::Int, 8765, 0, 65535, {}},
+        {QStringLiteral("pictureAddress"), QMetaType::QString, QStringLiteral("127.0.0.1"), {}, {}, {}},
+    };
+    return schema;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+// One typed setting. Supported types are Bool, Int (64-bit), Double and
+// QString; minimum/maximum apply to numbers, choices to strings.
+struct SettingDefinition
+{
+    QString key; // also the QML property name, so keep it an identifier
+    QMetaType::Type type = QMetaType::QString;
+    QVariant defaultValue;
+    QVariant minimum;
+    QVariant maximum;
+    QStringList choices;
+
+    // Converts value to this setting's type in place. False when it cannot
+    // be converted or falls outside the allowed range/choices.
+    bool coerce(QVariant &value) const;
+};
+
+const QList<SettingDefinition> &settingsSchema();
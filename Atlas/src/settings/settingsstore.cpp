@@ -0,0 +1,330 @@
+#include "settingsstore.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+
+// Snapshot layout, little endian:
+//   u32 magic, u16 version, u16 count, then per entry
+//   u8 type, u8 key length, key (UTF-8), payload
+// where payload is u8 (Bool), i64 (Int), f64 (Double) or u32 length +
+// UTF-8 (String). Keys are stored by name so reordering or extending the
+// schema keeps old files readable.
+constexpr quint32 snapshotMagic = 0x534c5441; // "ATLS"
+constexpr quint16 snapshotVersion = 1;
+constexpr int saveDebounceMs = 500;
+// A save is a temporary file plus a rename over the old one, seen as a few
+// changes in a row; ReadOnly stores reload once they settle.
+constexpr int reloadDebounceMs = 100;
+
+enum class EntryType : quint8 { Bool = 1, Int, Double, String };
+
+class Reader
+{
+public:
+    Reader(const uchar *data, qint64 size)
+        : m_pos(data)
+        , m_end(data + size)
+    {
+    }
+
+    template<typename T>
+    bool read(T &value)
+    {
+        if (m_end - m_pos < qint64(sizeof(T)))
+            return false;
+        value = qFromLittleEndian<T>(m_pos);
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    bool readBytes(qint64 length, QByteArrayView &bytes)
+    {
+        if (m_end - m_pos < length)
+            return false;
+        bytes = QByteArrayView(m_pos, length);
+        m_pos += length;
+        return true;
+    }
+
+private:
+    const uchar *m_pos;
+    const uchar *m_end;
+};
+
+template<typename T>
+void append(QByteArray &out, T value)
+{
+    const qsizetype at = out.size();
+    out.resize(at + qsizetype(sizeof(T)));
+    qToLittleEndian<T>(value, out.data() + at);
+}
+
+QString writeSnapshot(const QString &path, const QByteArray &bytes)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit())
+        return file.errorString();
+    return QString();
+}
+
+} // namespace
+
+SettingsStore::SettingsStore(const QString &path, Access access, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+    , m_access(access)
+{
+    const QList<SettingDefinition> &schema = settingsSchema();
+    m_values.reserve(schema.size());
+    for (int i = 0; i < schema.size(); ++i) {
+        m_values.append(schema[i].defaultValue);
+        m_indexByKey.insert(schema[i].key, i);
+    }
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(saveDebounceMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &SettingsStore::startSave);
+    connect(&m_saver, &QFutureWatcher<QString>::finished, this, &SettingsStore::onSaveFinished);
+
+    if (m_access == Access::ReadOnly) {
+        m_reloadTimer.setSingleShot(true);
+        m_reloadTimer.setInterval(reloadDebounceMs);
+        connect(&m_reloadTimer, &QTimer::timeout, this, &SettingsStore::load);
+        connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_reloadTimer, qOverload<>(&QTimer::start));
+        connect(&m_watcher, &QFileSystemWatcher::fileChanged, &m_reloadTimer, qOverload<>(&QTimer::start));
+        watch();
+    }
+}
+
+SettingsStore::~SettingsStore()
+{
+    flush();
+}
+
+void SettingsStore::load()
+{
+    if (m_access == Access::ReadOnly)
+        watch(); // a rename over the file ends the watch on the old one
+
+    QList<QVariant> values = m_values;
+    if (!parse(values))
+        return;
+
+    const QList<SettingDefinition> &schema = settingsSchema();
+    for (int i = 0; i < schema.size(); ++i) {
+        if (values[i] == m_values[i])
+            continue;
+        m_values[i] = values[i];
+        emit valueChanged(schema[i].key, values[i]);
+    }
+}
+
+// Reads the file over values. False when there is no readable file; a
+// truncated one still yields the entries before the cut.
+bool SettingsStore::parse(QList<QVariant> &values) const
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+        return false; // first run: defaults
+
+    const uchar *data = file.map(0, file.size());
+    if (!data)
+        return false;
+    Reader reader(data, file.size());
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 count = 0;
+    if (!reader.read(magic) || magic != snapshotMagic || !reader.read(version)
+        || version != snapshotVersion || !reader.read(count)) {
+        qWarning("Ignoring unreadable settings file %s", qPrintable(m_path));
+        return false;
+    }
+
+    const QList<SettingDefinition> &schema = settingsSchema();
+    for (quint16 i = 0; i < count; ++i) {
+        quint8 type = 0;
+        quint8 keyLength = 0;
+        QByteArrayView key;
+        if (!reader.read(type) || !reader.read(keyLength) || !reader.readBytes(keyLength, key))
+            return true;
+
+        QVariant value;
+        switch (EntryType(type)) {
+        case EntryType::Bool: {
+            quint8 flag = 0;
+            if (!reader.read(flag))
+                return true;
+            value = flag != 0;
+            break;
+        }
+        case EntryType::Int: {
+            qint64 number = 0;
+            if (!reader.read(number))
+                return true;
+            value = number;
+            break;
+        }
+        case EntryType::Double: {
+            quint64 bits = 0;
+            if (!reader.read(bits))
+                return true;
+            double number;
+            std::memcpy(&number, &bits, sizeof(number));
+            value = number;
+            break;
+        }
+        case EntryType::String: {
+            quint32 length = 0;
+            QByteArrayView text;
+            if (!reader.read(length) || !reader.readBytes(length, text))
+                return true;
+            value = QString::fromUtf8(text);
+            break;
+        }
+        default:
+            return true; // unknown entry type; its size is unknown too
+        }
+
+        // Keys dropped from the schema are skipped; values that no longer
+        // validate fall back to the default.
+        const int index = m_indexByKey.value(QString::fromUtf8(key), -1);
+        if (index >= 0)
+            values[index] = schema[index].coerce(value) ? value : schema[index].defaultValue;
+    }
+    return true;
+}
+
+QVariant SettingsStore::value(const QString &key) const
+{
+    const int index = m_indexByKey.value(key, -1);
+    return index >= 0 ? m_values[index] : QVariant();
+}
+
+bool SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    const int index = m_indexByKey.value(key, -1);
+    if (index < 0 || m_access == Access::ReadOnly)
+        return false;
+
+    QVariant coerced = value;
+    if (!settingsSchema()[index].coerce(coerced))
+        return false;
+    if (coerced == m_values[index])
+        return true;
+
+    m_values[index] = coerced;
+    emit valueChanged(key, coerced);
+    scheduleSave();
+    return true;
+}
+
+void SettingsStore::watch()
+{
+    // The directory sees the file appear and be replaced; the file itself
+    // sees writes in place.
+    const QString directory = QFileInfo(m_path).absolutePath();
+    if (!m_watcher.directories().contains(directory) && !m_watcher.addPath(directory))
+        qWarning("Cannot watch %s for settings changes", qPrintable(directory));
+    if (QFile::exists(m_path) && !m_watcher.files().contains(m_path))
+        m_watcher.addPath(m_path);
+}
+
+QByteArray SettingsStore::serialize() const
+{
+    const QList<SettingDefinition> &schema = settingsSchema();
+    QByteArray out;
+    out.reserve(16 + schema.size() * 24);
+    append<quint32>(out, snapshotMagic);
+    append<quint16>(out, snapshotVersion);
+    append<quint16>(out, quint16(schema.size()));
+
+    for (int i = 0; i < schema.size(); ++i) {
+        const QByteArray key = schema[i].key.toUtf8();
+        const QVariant &value = m_values[i];
+        switch (schema[i].type) {
+        case QMetaType::Bool:
+            append<quint8>(out, quint8(EntryType::Bool));
+            break;
+        case QMetaType::Int:
+            append<quint8>(out, quint8(EntryType::Int));
+            break;
+        case QMetaType::Double:
+            append<quint8>(out, quint8(EntryType::Double));
+            break;
+        default:
+            append<quint8>(out, quint8(EntryType::String));
+            break;
+        }
+        append<quint8>(out, quint8(key.size()));
+        out.append(key);
+
+        switch (schema[i].type) {
+        case QMetaType::Bool:
+            append<quint8>(out, value.toBool() ? 1 : 0);
+            break;
+        case QMetaType::Int:
+            append<qint64>(out, value.toLongLong());
+            break;
+        case QMetaType::Double: {
+            const double number = value.toDouble();
+            quint64 bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            append<quint64>(out, bits);
+            break;
+        }
+        default: {
+            const QByteArray text = value.toString().toUtf8();
+            append<quint32>(out, quint32(text.size()));
+            out.append(text);
+            break;
+        }
+        }
+    }
+    return out;
+}
+
+void SettingsStore::scheduleSave()
+{
+    m_dirty = true;
+    m_saveTimer.start(); // restarts: bursts of changes coalesce into one write
+}
+
+void SettingsStore::startSave()
+{
+    if (!m_dirty)
+        return;
+    if (m_saver.isRunning())
+        return; // onSaveFinished() picks up the newer state
+
+    m_dirty = false;
+    m_saver.setFuture(QtConcurrent::run(writeSnapshot, m_path, serialize()));
+}
+
+void SettingsStore::onSaveFinished()
+{
+    const QString error = m_saver.result();
+    if (!error.isEmpty())
+        emit saveFailed(error);
+    if (m_dirty && !m_saveTimer.isActive())
+        startSave();
+}
+
+void SettingsStore::flush()
+{
+    m_saveTimer.stop();
+    m_saver.waitForFinished();
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+    const QString error = writeSnapshot(m_path, serialize());
+    if (!error.isEmpty())
+        emit saveFailed(error);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVariant>
+
+#include "settings/settingsschema.h"
+
+// Typed application settings backed by settingsSchema(). The file is a
+// small binary snapshot read through a memory map at startup; changes are
+// validated against the schema, announced per key and written back after a
+// short debounce on a pool thread via QSaveFile (write + atomic rename), so
+// saving never blocks the GUI thread.
+//
+// The UI is the file's only writer. atlasd opens it ReadOnly: it never
+// saves, and reloads whenever the UI replaces the file, announcing the keys
+// that changed.
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Access { ReadWrite, ReadOnly };
+
+    explicit SettingsStore(const QString &path, Access access = Access::ReadWrite, QObject *parent = nullptr);
+    ~SettingsStore() override;
+
+    // Reads the file; keys that changed since are announced. ReadOnly
+    // stores call it again on their own whenever the file changes.
+    void load();
+
+    QVariant value(const QString &key) const;
+    // False for unknown keys, values the schema rejects and ReadOnly stores.
+    bool setValue(const QString &key, const QVariant &value);
+
+    // Calls handler(value) whenever key changes.
+    template<typename Handler>
+    QMetaObject::Connection onChanged(const QString &key, QObject *context, Handler handler)
+    {
+        return connect(this, &SettingsStore::valueChanged, context,
+                       [key, handler](const QString &changedKey, const QVariant &value) {
+                           if (changedKey == key)
+                               handler(value);
+                       });
+    }
+
+    // Writes pending changes now and waits for the write to land.
+    void flush();
+
+signals:
+    void valueChanged(const QString &key, const QVariant &value);
+    void saveFailed(const QString &error);
+
+private:
+    bool parse(QList<QVariant> &values) const;
+    void watch();
+    QByteArray serialize() const;
+    void scheduleSave();
+    void startSave();
+    void onSaveFinished();
+
+    QString m_path;
+    Access m_access;
+    QList<QVariant> m_values;       // parallel to settingsSchema()
+    QHash<QString, int> m_indexByKey;
+    QFileSystemWatcher m_watcher;   // ReadOnly: the file and its directory
+    QTimer m_reloadTimer;
+    QTimer m_saveTimer;
+    QFutureWatcher<QString> m_saver;
+    bool m_dirty = false;
+};
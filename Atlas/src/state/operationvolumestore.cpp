@@ -0,0 +1,78 @@
+#include "operationvolumestore.h"
+
+#include <QVariantMap>
+
+namespace {
+
+bool sameShape(const OperationVolume &a, const OperationVolume &b)
+{
+    return a.kind == b.kind && a.outline == b.outline && a.floorMsl == b.floorMsl && a.ceilingMsl == b.ceilingMsl
+           && a.startMs == b.startMs && a.endMs == b.endMs;
+}
+
+} // namespace
+
+OperationVolumeStore::OperationVolumeStore(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void OperationVolumeStore::setVolume(OperationVolume volume)
+{
+    const int index = indexOf(volume.id);
+    if (index >= 0) {
+        if (sameShape(m_volumes[size_t(index)], volume))
+            return;
+        volume.revision = m_nextRevision++;
+        m_volumes[size_t(index)] = std::move(volume);
+        emit volumeChanged(index);
+        return;
+    }
+    volume.revision = m_nextRevision++;
+    m_indexById.insert(volume.id, count());
+    m_volumes.push_back(std::move(volume));
+    emit countChanged();
+    emit volumeChanged(count() - 1);
+}
+
+void OperationVolumeStore::removeVolume(const QString &id)
+{
+    const int index = indexOf(id);
+    if (index < 0)
+        return;
+    // Swap with the last so indices stay dense.
+    m_indexById.remove(id);
+    if (index != count() - 1) {
+        m_volumes[size_t(index)] = std::move(m_volumes.back());
+        m_indexById.insert(m_volumes[size_t(index)].id, index);
+    }
+    m_volumes.pop_back();
+    emit countChanged();
+    emit volumeRemoved(id, index);
+}
+
+bool OperationVolumeStore::setVolume(const QString &id, const QVariantList &outline, double floorMsl,
+                                     double ceilingMsl, const QString &kind, qint64 startMs, qint64 endMs)
+{
+    if (outline.size() < 3)
+        return false;
+    OperationVolume volume;
+    volume.id = id;
+    volume.kind = kind == QLatin1String("constraint") ? OperationVolume::Kind::Constraint
+                                                      : OperationVolume::Kind::Intent;
+    volume.outline.reserve(size_t(outline.size()));
+    for (const QVariant &point : outline) {
+        const QVariantMap map = point.toMap();
+        volume.outline.emplace_back(map.value(QStringLiteral("longitude")).toDouble(),
+                                    map.value(QStringLiteral("latitude")).toDouble());
+    }
+    // A closed ring repeats its first point; the store keeps rings open.
+    if (volume.outline.size() > 3 && volume.outline.front() == volume.outline.back())
+        volume.outline.pop_back();
+    volume.floorMsl = floorMsl;
+    volume.ceilingMsl = ceilingMsl;
+    volume.startMs = startMs;
+    volume.endMs = endMs;
+    setVolume(std::move(volume));
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPointF>
+#include <QString>
+#include <QVariantList>
+
+#include <vector>
+
+// A 4D volume an operation is approved to fly in (operational intent) or
+// that traffic has to stay out of (constraint): a horizontal outline
+// extruded between two altitudes, over a time window.
+struct OperationVolume
+{
+    enum class Kind { Intent, Constraint };
+
+    QString id;
+    Kind kind = Kind::Intent;
+    std::vector<QPointF> outline; // x longitude, y latitude, degrees; open ring
+    double floorMsl = 0;          // metres
+    double ceilingMsl = 0;
+    qint64 startMs = 0;           // epoch ms; 0 is unbounded
+    qint64 endMs = 0;
+    quint64 revision = 0;         // bumped on every change
+};
+
+// Operation volumes by id, for the map and airspace views. Fed by whatever
+// knows about operations (a USS connection, a planning tool, QML). GUI
+// thread only.
+class OperationVolumeStore : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit OperationVolumeStore(QObject *parent = nullptr);
+
+    int count() const { return int(m_volumes.size()); }
+    const OperationVolume &at(int index) const { return m_volumes[size_t(index)]; }
+    int indexOf(const QString &id) const { return m_indexById.value(id, -1); }
+
+    // Adds or replaces by id. Setting an identical volume is not a change.
+    void setVolume(OperationVolume volume);
+    void removeVolume(const QString &id);
+
+    // outline is a list of {latitude, longitude} objects; kind "intent" or
+    // "constraint". False if the outline has fewer than three points.
+    Q_INVOKABLE bool setVolume(const QString &id, const QVariantList &outline, double floorMsl,
+                               double ceilingMsl, const QString &kind = QStringLiteral("intent"),
+                               qint64 startMs = 0, qint64 endMs = 0);
+    Q_INVOKABLE void remove(const QString &id) { removeVolume(id); }
+
+signals:
+    void countChanged();
+    void volumeChanged(int index);
+    // index now holds what was the last volume.
+    void volumeRemoved(const QString &id, int index);
+
+private:
+    std::vector<OperationVolume> m_volumes;
+    QHash<QString, int> m_indexById;
+    quint64 m_nextRevision = 1;
+};
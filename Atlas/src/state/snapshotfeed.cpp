@@ -0,0 +1,196 @@
+#include "snapshotfeed.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cmath>
+
+#include "diagnostics/metrics.h"
+#include "ingest/framequeue.h"
+
+using namespace TrafficSnapshot;
+
+namespace {
+
+constexpr int pollIntervalMs = 16;
+constexpr int attachRetryMs = 500;
+constexpr qint64 heartbeatTimeoutMs = 3000;
+
+} // namespace
+
+SnapshotFeed::SnapshotFeed(VehicleStateStore *store, QObject *parent)
+    : QObject(parent)
+    , m_store(store)
+    , m_memory(QSharedMemory::legacyNativeKey(sharedMemoryKey()))
+{
+    m_pollTimer.setInterval(pollIntervalMs);
+    connect(&m_pollTimer, &QTimer::timeout, this, &SnapshotFeed::poll);
+    m_attachTimer.setInterval(attachRetryMs);
+    connect(&m_attachTimer, &QTimer::timeout, this, &SnapshotFeed::attach);
+}
+
+SnapshotFeed::~SnapshotFeed()
+{
+    m_memory.detach();
+}
+
+bool SnapshotFeed::attach()
+{
+    if (m_region)
+        return true;
+    if (!m_memory.attach(QSharedMemory::ReadOnly)) {
+        m_attachTimer.start();
+        return false;
+    }
+
+    const auto *region = static_cast<const Region *>(m_memory.constData());
+    if (m_memory.size() < qsizetype(sizeof(Region)) || region->header.magic != magic
+        || region->header.version != version || region->header.slotSize != sizeof(Slot)) {
+        qWarning("SnapshotFeed: traffic snapshot layout does not match this build");
+        m_memory.detach();
+        m_attachTimer.start();
+        return false;
+    }
+
+    m_attachTimer.stop();
+    m_region = region;
+    m_seenSequence.assign(capacity, 0);
+    m_pollTimer.start();
+    poll();
+    return true;
+}
+
+void SnapshotFeed::poll()
+{
+    static MetricCounter *const retries = Metrics::counter(
+        "atlas_snapshot_read_retries_total", "Snapshot slots skipped because the daemon was writing them.");
+
+    const qint64 heartbeatMs = m_region->header.heartbeatMs.load(std::memory_order_acquire);
+    setConnected(QDateTime::currentMSecsSinceEpoch() - heartbeatMs < heartbeatTimeoutMs);
+    pollShedding();
+    if (m_paused)
+        return;
+
+    const quint32 count = std::min(m_region->header.vehicleCount.load(std::memory_order_acquire),
+                                   quint32(capacity));
+    double values[VehicleFieldCount];
+    SampleTime times[VehicleFieldCount];
+    for (quint32 i = 0; i < count; ++i) {
+        const Slot &slot = m_region->vehicles[i];
+        const quint32 before = slot.sequence.load(std::memory_order_acquire);
+        if (before == m_seenSequence[i])
+            continue;
+        if (before & 1) {
+            retries->increment();
+            continue;
+        }
+
+        const int systemId = slot.systemId.load(std::memory_order_relaxed);
+        const qint64 timestampMs = slot.lastUpdateMs.load(std::memory_order_relaxed);
+        for (int field = 0; field < VehicleFieldCount; ++field) {
+            values[field] = slot.values[field].load(std::memory_order_relaxed);
+            times[field] = {slot.sampleTimesUs[field].load(std::memory_order_relaxed),
+                            slot.sampleUncertaintiesUs[field].load(std::memory_order_relaxed)};
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            // Torn read; the next poll gets it.
+            retries->increment();
+            continue;
+        }
+        m_seenSequence[i] = before;
+
+        // Only hand over what moved, so the store's update path (and an
+        // input recording) sees the same samples a direct feed would.
+        const int index = m_store->indexOf(systemId);
+        for (int field = 0; field < VehicleFieldCount; ++field) {
+            if (std::isnan(values[field]))
+                continue;
+            if (index >= 0 && m_store->at(index).values[field] == values[field]
+                && m_store->at(index).sampleTimes[field].monotonicUs == times[field].monotonicUs)
+                continue;
+            m_store->update(systemId, VehicleField(field), values[field], timestampMs, times[field]);
+        }
+    }
+}
+
+void SnapshotFeed::setPaused(bool paused)
+{
+    if (paused == m_paused)
+        return;
+    m_paused = paused;
+    if (!m_paused && m_region) {
+        // The store was written by someone else meanwhile; copy every slot.
+        std::fill(m_seenSequence.begin(), m_seenSequence.end(), 0);
+        poll();
+    }
+}
+
+QString SnapshotFeed::linkName(int link) const
+{
+    if (!m_region || link < 0 || link >= maxLinks)
+        return QString();
+    const char *name = m_region->header.linkNames[link];
+    return QString::fromUtf8(name, qstrnlen(name, linkNameSize));
+}
+
+const LinkHealth *SnapshotFeed::linkHealth(int link) const
+{
+    if (!m_region || link < 0 || link >= maxLinks)
+        return nullptr;
+    return &m_region->header.links[link];
+}
+
+qulonglong SnapshotFeed::shedFrames() const
+{
+    quint64 total = 0;
+    for (const quint64 shed : m_shedFrames)
+        total += shed;
+    return total;
+}
+
+QList<qreal> SnapshotFeed::shedFramesByClass() const
+{
+    QList<qreal> byClass;
+    byClass.reserve(priorityClasses);
+    for (const quint64 shed : m_shedFrames)
+        byClass.append(qreal(shed));
+    return byClass;
+}
+
+QString SnapshotFeed::shedSummary() const
+{
+    return tr("Shed %1 frames, %2 critical, %3 telemetry, %4 queued")
+        .arg(shedFrames())
+        .arg(m_shedFrames[size_t(MessagePriority::Critical)])
+        .arg(m_shedFrames[size_t(MessagePriority::Telemetry)])
+        .arg(m_backlogFrames);
+}
+
+bool SnapshotFeed::shedEssential() const
+{
+    return m_shedFrames[size_t(MessagePriority::Critical)] + m_shedFrames[size_t(MessagePriority::Telemetry)] > 0;
+}
+
+void SnapshotFeed::pollShedding()
+{
+    bool changed = false;
+    for (int priority = 0; priority < priorityClasses; ++priority) {
+        const quint64 shed = m_region->header.shedFrames[priority].load(std::memory_order_relaxed);
+        changed |= shed != m_shedFrames[size_t(priority)];
+        m_shedFrames[size_t(priority)] = shed;
+    }
+    const quint32 queued = m_region->header.queuedFrames.load(std::memory_order_relaxed);
+    changed |= queued != m_backlogFrames;
+    m_backlogFrames = queued;
+    if (changed)
+        emit sheddingChanged();
+}
+
+void SnapshotFeed::setConnected(bool connected)
+{
+    if (connected == m_connected)
+        return;
+    m_connected = connected;
+    emit connectedChanged();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QSharedMemory>
+#include <QTimer>
+
+#include <array>
+#include <vector>
+
+#include "ingest/trafficsnapshot.h"
+#include "state/vehiclestatestore.h"
+
+// UI side of the daemon's traffic snapshot. Maps the region read-only and,
+// once per frame, copies every slot whose seqlock sequence moved into the
+// VehicleStateStore. Nothing is lost while the UI is down: the daemon keeps
+// writing, and the first poll after a restart picks up the whole picture.
+class SnapshotFeed : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool connected READ connected NOTIFY connectedChanged)
+    Q_PROPERTY(qulonglong shedFrames READ shedFrames NOTIFY sheddingChanged)
+    Q_PROPERTY(QList<qreal> shedFramesByClass READ shedFramesByClass NOTIFY sheddingChanged)
+    Q_PROPERTY(int backlogFrames READ backlogFrames NOTIFY sheddingChanged)
+    // The above as one line for a status bar, and whether critical or
+    // telemetry frames were among those shed.
+    Q_PROPERTY(QString shedSummary READ shedSummary NOTIFY sheddingChanged)
+    Q_PROPERTY(bool shedEssential READ shedEssential NOTIFY sheddingChanged)
+
+public:
+    explicit SnapshotFeed(VehicleStateStore *store, QObject *parent = nullptr);
+    ~SnapshotFeed() override;
+
+    // Keeps retrying in the background when the daemon is not up yet.
+    bool attach();
+
+    // Mapped and the daemon's heartbeat is recent.
+    bool connected() const { return m_connected; }
+
+    // While paused the store gets no samples, e.g. so an input replay owns
+    // it. Resuming hands over the whole picture again.
+    void setPaused(bool paused);
+    bool paused() const { return m_paused; }
+
+    // Frames the daemon dropped to keep up since it started, in total and
+    // per priority class (critical, telemetry, normal, bulk), and the
+    // frames waiting in its backlog now.
+    qulonglong shedFrames() const;
+    QList<qreal> shedFramesByClass() const;
+    int backlogFrames() const { return int(m_backlogFrames); }
+    QString shedSummary() const;
+    bool shedEssential() const;
+
+    // Name of the daemon link a BestLink value refers to.
+    Q_INVOKABLE QString linkName(int link) const;
+    // The daemon's running totals for a link, or null while detached.
+    const TrafficSnapshot::LinkHealth *linkHealth(int link) const;
+
+signals:
+    void connectedChanged();
+    void sheddingChanged();
+
+private:
+    void poll();
+    void setConnected(bool connected);
+    void pollShedding();
+
+    VehicleStateStore *m_store;
+    QSharedMemory m_memory;
+    const TrafficSnapshot::Region *m_region = nullptr;
+    std::vector<quint32> m_seenSequence; // per slot
+    QTimer m_pollTimer;
+    QTimer m_attachTimer;
+    bool m_connected = false;
+    bool m_paused = false;
+    std::array<quint64, TrafficSnapshot::priorityClasses> m_shedFrames = {};
+    quint32 m_backlogFrames = 0;
+};
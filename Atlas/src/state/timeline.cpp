@@ -0,0 +1,68 @@
+#include "timeline.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+
+namespace {
+
+constexpr int tickIntervalMs = 1000;
+
+} // namespace
+
+Timeline::Timeline(TrajectoryStore *trajectories, QObject *parent)
+    : QObject(parent)
+    , m_trajectories(trajectories)
+{
+    connect(m_trajectories, &TrajectoryStore::rangeChanged, this, &Timeline::updateRange);
+    m_tick.setInterval(tickIntervalMs);
+    connect(&m_tick, &QTimer::timeout, this, &Timeline::tick);
+    m_tick.start();
+    updateRange();
+}
+
+qint64 Timeline::timeMs() const
+{
+    return m_live ? QDateTime::currentMSecsSinceEpoch() : m_timeMs;
+}
+
+void Timeline::setTimeMs(qint64 timeMs)
+{
+    if (!m_live && timeMs == m_timeMs)
+        return;
+    m_live = false;
+    m_timeMs = timeMs;
+    emit timeChanged();
+}
+
+void Timeline::setLive(bool live)
+{
+    if (live == m_live)
+        return;
+    if (!live)
+        m_timeMs = QDateTime::currentMSecsSinceEpoch();
+    m_live = live;
+    emit timeChanged();
+}
+
+void Timeline::tick()
+{
+    updateRange();
+    // Live time moves on its own; intents have to be redrawn for it.
+    if (m_live)
+        emit timeChanged();
+}
+
+void Timeline::updateRange()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 start = m_trajectories->count() > 0 && m_trajectories->startMs() > 0
+                             ? std::min(m_trajectories->startMs(), now)
+                             : now;
+    const qint64 end = std::max(m_trajectories->endMs(), now);
+    if (start == m_startMs && end == m_endMs)
+        return;
+    m_startMs = start;
+    m_endMs = end;
+    emit rangeChanged();
+}
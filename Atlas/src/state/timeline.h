@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+#include "state/trajectorystore.h"
+
+// The moment the map shows traffic at: now while live, or wherever the
+// dispatcher scrubbed to within the recorded past and planned future.
+// GUI thread only.
+class Timeline : public QObject
+{
+    Q_OBJECT
+    // Epoch ms. Setting it leaves live mode.
+    Q_PROPERTY(qint64 timeMs READ timeMs WRITE setTimeMs NOTIFY timeChanged)
+    Q_PROPERTY(bool live READ isLive WRITE setLive NOTIFY timeChanged)
+    // Scrubbable span: every trajectory, and now.
+    Q_PROPERTY(qint64 startMs READ startMs NOTIFY rangeChanged)
+    Q_PROPERTY(qint64 endMs READ endMs NOTIFY rangeChanged)
+
+public:
+    explicit Timeline(TrajectoryStore *trajectories, QObject *parent = nullptr);
+
+    TrajectoryStore *trajectories() const { return m_trajectories; }
+
+    qint64 timeMs() const;
+    void setTimeMs(qint64 timeMs);
+    bool isLive() const { return m_live; }
+    void setLive(bool live);
+    qint64 startMs() const { return m_startMs; }
+    qint64 endMs() const { return m_endMs; }
+
+signals:
+    void timeChanged();
+    void rangeChanged();
+
+private:
+    void tick();
+    void updateRange();
+
+    TrajectoryStore *m_trajectories;
+    bool m_live = true;
+    qint64 m_timeMs = 0; // while not live
+    qint64 m_startMs = 0;
+    qint64 m_endMs = 0;
+    QTimer m_tick;
+};
@@ -0,0 +1,130 @@
+#include "trafficdensity.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "map/webmercator.h"
+
+namespace {
+
+// Fold the growth factor back in after ten half-lives, before it gets
+// anywhere near overflowing a double.
+const double renormalizeExponent = std::log(1024.0);
+
+// A bin below this after renormalizing is one sample ten half-lives ago
+// or less, and is dropped to keep memory bounded.
+constexpr double fadedDensity = 1e-3;
+
+constexpr FieldMask positionFields = fieldBit(VehicleField::Latitude) | fieldBit(VehicleField::Longitude);
+
+} // namespace
+
+TrafficDensity::TrafficDensity(VehicleStateStore *vehicles, QObject *parent)
+    : QObject(parent)
+    , m_vehicles(vehicles)
+{
+    connect(m_vehicles, &VehicleStateStore::fieldsChanged, this, &TrafficDensity::onVehicleFields);
+}
+
+quint64 TrafficDensity::keyOf(const QPoint &cell)
+{
+    return (quint64(quint32(cell.x())) << 32) | quint32(cell.y());
+}
+
+QPoint TrafficDensity::cellOf(quint64 key)
+{
+    return QPoint(int(qint32(quint32(key >> 32))), int(qint32(quint32(key))));
+}
+
+void TrafficDensity::setHalfLifeMs(qint64 halfLifeMs)
+{
+    if (halfLifeMs <= 0 || halfLifeMs == m_halfLifeMs)
+        return;
+    // Decay so far was at the old rate; only what comes next uses the new.
+    if (m_epochMs != 0)
+        renormalize(m_latestMs);
+    m_halfLifeMs = halfLifeMs;
+    emit halfLifeChanged();
+}
+
+void TrafficDensity::add(double latitude, double longitude, qint64 timeMs, double weight)
+{
+    if (m_epochMs == 0)
+        m_epochMs = timeMs;
+    timeMs = std::max(timeMs, m_latestMs);
+    const double rate = M_LN2 / double(m_halfLifeMs);
+    double exponent = rate * double(timeMs - m_epochMs);
+    if (exponent > renormalizeExponent) {
+        renormalize(timeMs);
+        exponent = 0;
+    }
+
+    const QPointF mercator = WebMercator::fromLatLon(latitude, longitude);
+    const double stored = weight * std::exp(exponent);
+    for (int level = 0; level < levelCount; ++level) {
+        Level &grid = m_levels[size_t(level)];
+        const double size = cellSize(level);
+        const QPoint cell(int(std::floor(mercator.x() / size)), int(std::floor(mercator.y() / size)));
+        double &bin = grid.bins[keyOf(cell)];
+        bin += stored;
+        grid.peak = std::max(grid.peak, bin);
+        grid.extent |= QRect(cell, QSize(1, 1));
+    }
+    m_latestMs = timeMs;
+    ++m_revision;
+}
+
+void TrafficDensity::renormalize(qint64 timeMs)
+{
+    const double factor = std::exp(-M_LN2 / double(m_halfLifeMs) * double(timeMs - m_epochMs));
+    for (Level &level : m_levels) {
+        level.peak = 0;
+        level.extent = QRect();
+        for (auto it = level.bins.begin(); it != level.bins.end();) {
+            const double density = it.value() * factor;
+            if (density < fadedDensity) {
+                it = level.bins.erase(it);
+                continue;
+            }
+            it.value() = density;
+            level.peak = std::max(level.peak, density);
+            level.extent |= QRect(cellOf(it.key()), QSize(1, 1));
+            ++it;
+        }
+    }
+    m_epochMs = timeMs;
+    ++m_revision;
+}
+
+double TrafficDensity::readScale(qint64 nowMs) const
+{
+    if (m_epochMs == 0)
+        return 1; // nothing stored yet
+    return std::exp(-M_LN2 / double(m_halfLifeMs) * double(std::max(nowMs, m_latestMs) - m_epochMs));
+}
+
+void TrafficDensity::onVehicleFields(const QList<VehicleFieldChange> &changes)
+{
+    bool changed = false;
+    for (const VehicleFieldChange &change : changes) {
+        if (!(change.fields & positionFields))
+            continue;
+        if (size_t(change.index) >= m_lastSampleMs.size())
+            m_lastSampleMs.resize(size_t(change.index) + 1, 0);
+        const VehicleState &state = m_vehicles->at(change.index);
+        // A sample per vehicle per interval, so density is aircraft time
+        // rather than however often a vehicle happens to report.
+        qint64 &last = m_lastSampleMs[size_t(change.index)];
+        if (state.lastUpdateMs - last < sampleIntervalMs)
+            continue;
+        const double latitude = state.values[int(VehicleField::Latitude)];
+        const double longitude = state.values[int(VehicleField::Longitude)];
+        if (std::isnan(latitude) || std::isnan(longitude))
+            continue;
+        last = state.lastUpdateMs;
+        add(latitude, longitude, state.lastUpdateMs);
+        changed = true;
+    }
+    if (changed)
+        emit densityChanged();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPoint>
+#include <QRect>
+
+#include <array>
+#include <vector>
+
+#include "state/vehiclestatestore.h"
+
+// Where traffic has been, as exponentially decayed aircraft-seconds per
+// Web Mercator bin, kept at several fixed bin sizes at once. Every vehicle
+// adds one sample per second to one bin per level, so the cost of a sample
+// and the memory held do not grow with the history covered; old traffic
+// fades with the half-life instead of being subtracted. GUI thread only.
+class TrafficDensity : public QObject
+{
+    Q_OBJECT
+    // How fast old traffic fades: an hour's traffic at the default, a day's
+    // at 24 h.
+    Q_PROPERTY(qint64 halfLifeMs READ halfLifeMs WRITE setHalfLifeMs NOTIFY halfLifeChanged)
+
+public:
+    static constexpr int levelCount = 4;
+    static constexpr double coarsestCellSize = 16000; // mercator metres; /4 per level
+    static constexpr qint64 sampleIntervalMs = 1000;
+
+    static constexpr double cellSize(int level) { return coarsestCellSize / double(1 << (2 * level)); }
+
+    explicit TrafficDensity(VehicleStateStore *vehicles, QObject *parent = nullptr);
+
+    qint64 halfLifeMs() const { return m_halfLifeMs; }
+    void setHalfLifeMs(qint64 halfLifeMs);
+
+    void add(double latitude, double longitude, qint64 timeMs, double weight = 1);
+
+    // Bounding box of the bins with traffic at a level, in cell units.
+    QRect extent(int level) const { return m_levels[size_t(level)].extent; }
+    // Densest bin of a level and, through visit(QPoint cell, double
+    // density), every bin with traffic, both decayed to nowMs, so they keep
+    // fading when no traffic comes in.
+    double peak(int level, qint64 nowMs) const { return m_levels[size_t(level)].peak * readScale(nowMs); }
+    template <typename Visit>
+    void forEachBin(int level, qint64 nowMs, Visit &&visit) const
+    {
+        const double scale = readScale(nowMs);
+        const QHash<quint64, double> &bins = m_levels[size_t(level)].bins;
+        for (auto it = bins.cbegin(); it != bins.cend(); ++it)
+            visit(cellOf(it.key()), it.value() * scale);
+    }
+    // Time of the newest sample.
+    qint64 latestMs() const { return m_latestMs; }
+    quint64 revision() const { return m_revision; }
+
+signals:
+    void halfLifeChanged();
+    // Bins changed; at most once per batch of vehicle updates.
+    void densityChanged();
+
+private:
+    struct Level
+    {
+        QHash<quint64, double> bins; // growth-scaled, see m_epochMs
+        QRect extent;
+        double peak = 0; // largest stored bin
+    };
+
+    static quint64 keyOf(const QPoint &cell);
+    static QPoint cellOf(quint64 key);
+    void onVehicleFields(const QList<VehicleFieldChange> &changes);
+    // Turns stored bins into densities at nowMs, never before the latest
+    // sample.
+    double readScale(qint64 nowMs) const;
+    // Folds the pending decay into the stored bins and drops faded ones.
+    void renormalize(qint64 timeMs);
+
+    VehicleStateStore *m_vehicles;
+    std::array<Level, levelCount> m_levels;
+    qint64 m_halfLifeMs = 3600000;
+    // Samples are stored multiplied by exp(rate * (t - m_epochMs)) rather
+    // than decaying every bin as time passes; reads divide it back out.
+    qint64 m_epochMs = 0;
+    qint64 m_latestMs = 0;
+    std::vector<qint64> m_lastSampleMs; // per vehicle index
+    quint64 m_revision = 0;
+};
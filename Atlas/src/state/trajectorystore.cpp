@@ -0,0 +1,287 @@
+#include "trajectorystore.h"
+
+#include <QDateTime>
+#include <QVariantMap>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr FieldMask positionFields = fieldBit(VehicleField::Latitude) | fieldBit(VehicleField::Longitude)
+                                     | fieldBit(VehicleField::AltitudeMsl);
+
+// A recorded track is broken where the vehicle was not heard from for
+// this many record intervals.
+constexpr qint64 recordedGapIntervals = 5;
+
+bool earlier(const TrackPoint &a, const TrackPoint &b)
+{
+    return a.timeMs < b.timeMs;
+}
+
+bool contains(const std::pair<qint64, qint64> &range, qint64 segment)
+{
+    return range.first <= segment && segment <= range.second;
+}
+
+} // namespace
+
+bool Trajectory::positionAt(qint64 timeMs, TrackPoint *position) const
+{
+    if (points.empty() || timeMs < points.front().timeMs)
+        return false;
+    if (timeMs >= points.back().timeMs) {
+        if (timeMs - points.back().timeMs > maxGapMs)
+            return false;
+        *position = points.back();
+        position->timeMs = timeMs;
+        return true;
+    }
+
+    const auto after = std::upper_bound(points.begin(), points.end(), timeMs,
+                                        [](qint64 time, const TrackPoint &point) { return time < point.timeMs; });
+    const auto before = after - 1;
+    const qint64 span = after->timeMs - before->timeMs;
+    if (maxGapMs > 0 && span > maxGapMs)
+        return false;
+    const double f = double(timeMs - before->timeMs) / double(span);
+    position->timeMs = timeMs;
+    position->latitude = before->latitude + (after->latitude - before->latitude) * f;
+    position->longitude = before->longitude + (after->longitude - before->longitude) * f;
+    position->altitudeMsl = before->altitudeMsl + (after->altitudeMsl - before->altitudeMsl) * f;
+    return true;
+}
+
+TrajectoryStore::TrajectoryStore(VehicleStateStore *vehicles, QObject *parent)
+    : QObject(parent)
+    , m_vehicles(vehicles)
+{
+    connect(m_vehicles, &VehicleStateStore::fieldsChanged, this, &TrajectoryStore::onVehicleFields);
+    m_pruneTimer.setInterval(int(segmentMs));
+    connect(&m_pruneTimer, &QTimer::timeout, this, &TrajectoryStore::prune);
+    m_pruneTimer.start();
+}
+
+qint64 TrajectoryStore::segmentOf(qint64 timeMs)
+{
+    // Floor, not truncation, so times before 1970 still land in order.
+    return timeMs >= 0 ? timeMs / segmentMs : -((-timeMs + segmentMs - 1) / segmentMs);
+}
+
+TrajectoryStore::SegmentRange TrajectoryStore::rangeOf(const Trajectory &trajectory)
+{
+    if (trajectory.points.empty())
+        return {1, 0};
+    return {segmentOf(trajectory.startMs()), segmentOf(trajectory.endMs())};
+}
+
+void TrajectoryStore::reindex(int index, SegmentRange range)
+{
+    const SegmentRange old = m_indexed[size_t(index)];
+    if (old == range)
+        return;
+    for (qint64 segment = old.first; segment <= old.second; ++segment) {
+        if (contains(range, segment))
+            continue;
+        const auto found = m_segments.find(segment);
+        std::vector<int> &indices = *found;
+        // Order within a segment does not matter; swap out.
+        *std::find(indices.begin(), indices.end(), index) = indices.back();
+        indices.pop_back();
+        if (indices.empty())
+            m_segments.erase(found);
+    }
+    for (qint64 segment = range.first; segment <= range.second; ++segment) {
+        if (!contains(old, segment))
+            m_segments[segment].push_back(index);
+    }
+    m_indexed[size_t(index)] = range;
+}
+
+int TrajectoryStore::add(Trajectory trajectory)
+{
+    const int index = count();
+    m_indexById.insert(trajectory.id, index);
+    if (trajectory.kind == Trajectory::Kind::Recorded)
+        m_trackBySystemId.insert(trajectory.systemId, index);
+    m_trajectories.push_back(std::move(trajectory));
+    m_indexed.emplace_back(1, 0);
+    reindex(index, rangeOf(m_trajectories.back()));
+    emit countChanged();
+    return index;
+}
+
+void TrajectoryStore::removeAt(int index)
+{
+    const int last = count() - 1;
+    const Trajectory &removed = m_trajectories[size_t(index)];
+    reindex(index, {1, 0});
+    m_indexById.remove(removed.id);
+    if (removed.kind == Trajectory::Kind::Recorded)
+        m_trackBySystemId.remove(removed.systemId);
+
+    // Swap with the last so indices stay dense.
+    if (index != last) {
+        reindex(last, {1, 0});
+        m_trajectories[size_t(index)] = std::move(m_trajectories.back());
+        const Trajectory &moved = m_trajectories[size_t(index)];
+        m_indexById.insert(moved.id, index);
+        if (moved.kind == Trajectory::Kind::Recorded)
+            m_trackBySystemId.insert(moved.systemId, index);
+    }
+    m_trajectories.pop_back();
+    m_indexed.pop_back();
+    if (index != last)
+        reindex(index, rangeOf(m_trajectories[size_t(index)]));
+    emit countChanged();
+}
+
+void TrajectoryStore::updateRange()
+{
+    qint64 start = 0;
+    qint64 end = 0;
+    for (const Trajectory &trajectory : m_trajectories) {
+        if (trajectory.points.empty())
+            continue;
+        start = start == 0 ? trajectory.startMs() : std::min(start, trajectory.startMs());
+        end = std::max(end, trajectory.endMs());
+    }
+    if (start == m_startMs && end == m_endMs)
+        return;
+    m_startMs = start;
+    m_endMs = end;
+    emit rangeChanged();
+}
+
+void TrajectoryStore::onVehicleFields(const QList<VehicleFieldChange> &changes)
+{
+    bool changed = false;
+    for (const VehicleFieldChange &change : changes) {
+        if (!(change.fields & positionFields))
+            continue;
+        const VehicleState &state = m_vehicles->at(change.index);
+        TrackPoint point;
+        point.timeMs = state.lastUpdateMs;
+        point.latitude = state.values[int(VehicleField::Latitude)];
+        point.longitude = state.values[int(VehicleField::Longitude)];
+        point.altitudeMsl = state.values[int(VehicleField::AltitudeMsl)];
+        if (std::isnan(point.latitude) || std::isnan(point.longitude))
+            continue;
+        if (std::isnan(point.altitudeMsl))
+            point.altitudeMsl = 0;
+
+        int index = m_trackBySystemId.value(state.systemId, -1);
+        if (index < 0) {
+            Trajectory track;
+            track.id = QStringLiteral("vehicle:%1").arg(state.systemId);
+            track.kind = Trajectory::Kind::Recorded;
+            track.systemId = state.systemId;
+            track.maxGapMs = recordedGapIntervals * recordIntervalMs;
+            index = add(std::move(track));
+        }
+
+        std::vector<TrackPoint> &points = m_trajectories[size_t(index)].points;
+        if (!points.empty() && point.timeMs <= points.back().timeMs)
+            continue;
+        // The newest point follows the vehicle until it is a record
+        // interval past the one before it, so the track ends where the
+        // vehicle is now but only keeps a point per interval.
+        const size_t size = points.size();
+        if (size >= 2 && point.timeMs - points[size - 2].timeMs < recordIntervalMs)
+            points.back() = point;
+        else
+            points.push_back(point);
+
+        // Trimmed a segment at a time to keep the erase amortized.
+        if (points.front().timeMs < point.timeMs - recordRetentionMs - segmentMs) {
+            TrackPoint cutoff;
+            cutoff.timeMs = point.timeMs - recordRetentionMs;
+            points.erase(points.begin(), std::lower_bound(points.begin(), points.end(), cutoff, earlier));
+        }
+        reindex(index, rangeOf(m_trajectories[size_t(index)]));
+        changed = true;
+    }
+    if (changed) {
+        updateRange();
+        emit trajectoriesChanged();
+    }
+}
+
+void TrajectoryStore::prune()
+{
+    // Tracks of vehicles that went quiet are not trimmed by new samples.
+    TrackPoint cutoff;
+    cutoff.timeMs = QDateTime::currentMSecsSinceEpoch() - recordRetentionMs;
+    bool changed = false;
+    for (int index = count() - 1; index >= 0; --index) {
+        std::vector<TrackPoint> &points = m_trajectories[size_t(index)].points;
+        if (m_trajectories[size_t(index)].kind != Trajectory::Kind::Recorded || points.empty()
+            || points.front().timeMs >= cutoff.timeMs)
+            continue;
+        points.erase(points.begin(), std::lower_bound(points.begin(), points.end(), cutoff, earlier));
+        if (points.empty())
+            removeAt(index);
+        else
+            reindex(index, rangeOf(m_trajectories[size_t(index)]));
+        changed = true;
+    }
+    if (changed) {
+        updateRange();
+        emit trajectoriesChanged();
+    }
+}
+
+void TrajectoryStore::setIntent(const QString &id, std::vector<TrackPoint> points)
+{
+    std::stable_sort(points.begin(), points.end(), earlier);
+    points.erase(std::unique(points.begin(), points.end(),
+                             [](const TrackPoint &a, const TrackPoint &b) { return a.timeMs == b.timeMs; }),
+                 points.end());
+
+    const int index = indexOf(id);
+    if (index >= 0) {
+        Trajectory &trajectory = m_trajectories[size_t(index)];
+        if (trajectory.kind != Trajectory::Kind::Intent)
+            return;
+        trajectory.points = std::move(points);
+        reindex(index, rangeOf(trajectory));
+    } else {
+        Trajectory trajectory;
+        trajectory.id = id;
+        trajectory.kind = Trajectory::Kind::Intent;
+        trajectory.points = std::move(points);
+        add(std::move(trajectory));
+    }
+    updateRange();
+    emit trajectoriesChanged();
+}
+
+void TrajectoryStore::removeIntent(const QString &id)
+{
+    const int index = indexOf(id);
+    if (index < 0 || m_trajectories[size_t(index)].kind != Trajectory::Kind::Intent)
+        return;
+    removeAt(index);
+    updateRange();
+    emit trajectoriesChanged();
+}
+
+bool TrajectoryStore::setIntent(const QString &id, const QVariantList &points)
+{
+    if (points.size() < 2)
+        return false;
+    std::vector<TrackPoint> trajectory;
+    trajectory.reserve(size_t(points.size()));
+    for (const QVariant &point : points) {
+        const QVariantMap map = point.toMap();
+        TrackPoint trackPoint;
+        trackPoint.timeMs = map.value(QStringLiteral("timeMs")).toLongLong();
+        trackPoint.latitude = map.value(QStringLiteral("latitude")).toDouble();
+        trackPoint.longitude = map.value(QStringLiteral("longitude")).toDouble();
+        trackPoint.altitudeMsl = map.value(QStringLiteral("altitudeMsl")).toDouble();
+        trajectory.push_back(trackPoint);
+    }
+    setIntent(id, std::move(trajectory));
+    return true;
+}
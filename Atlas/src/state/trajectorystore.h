@@ -0,0 +1,124 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVariantList>
+
+#include <utility>
+#include <vector>
+
+#include "state/vehiclestatestore.h"
+
+struct TrackPoint
+{
+    qint64 timeMs = 0; // epoch ms
+    double latitude = 0;
+    double longitude = 0;
+    double altitudeMsl = 0;
+};
+
+// Where an aircraft was (a track recorded from telemetry) or is planned to
+// be (an operational intent trajectory), as time-ordered points.
+struct Trajectory
+{
+    enum class Kind { Recorded, Intent };
+
+    QString id;
+    Kind kind = Kind::Recorded;
+    int systemId = 0;               // recorded tracks only
+    std::vector<TrackPoint> points; // strictly increasing timeMs
+    // Points further apart than this are a gap, not a leg to interpolate,
+    // and the last point is held for this long; 0 for no limit and no hold.
+    qint64 maxGapMs = 0;
+
+    qint64 startMs() const { return points.empty() ? 0 : points.front().timeMs; }
+    qint64 endMs() const { return points.empty() ? 0 : points.back().timeMs + maxGapMs; }
+
+    // Interpolated position at timeMs by binary search over the points;
+    // false where the trajectory has no position.
+    bool positionAt(qint64 timeMs, TrackPoint *position) const;
+};
+
+// Recorded tracks of every vehicle in a VehicleStateStore plus intent
+// trajectories fed by whatever plans operations, for scrubbing traffic
+// through time. Trajectories are indexed by fixed time segment, so finding
+// the aircraft at a moment only visits trajectories overlapping it, each
+// with one binary search. GUI thread only.
+class TrajectoryStore : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    // Span covered by all trajectories, epoch ms; both 0 when empty.
+    Q_PROPERTY(qint64 startMs READ startMs NOTIFY rangeChanged)
+    Q_PROPERTY(qint64 endMs READ endMs NOTIFY rangeChanged)
+
+public:
+    static constexpr qint64 segmentMs = 60000;
+    static constexpr qint64 recordIntervalMs = 1000; // between kept track points
+    static constexpr qint64 recordRetentionMs = 30 * 60000;
+
+    explicit TrajectoryStore(VehicleStateStore *vehicles, QObject *parent = nullptr);
+
+    int count() const { return int(m_trajectories.size()); }
+    const Trajectory &at(int index) const { return m_trajectories[size_t(index)]; }
+    int indexOf(const QString &id) const { return m_indexById.value(id, -1); }
+    qint64 startMs() const { return m_startMs; }
+    qint64 endMs() const { return m_endMs; }
+
+    // Calls visit(const Trajectory &, const TrackPoint &) for every
+    // trajectory with a position at timeMs.
+    template <typename Visit>
+    void forEachAt(qint64 timeMs, Visit &&visit) const
+    {
+        const auto found = m_segments.constFind(segmentOf(timeMs));
+        if (found == m_segments.constEnd())
+            return;
+        TrackPoint position;
+        for (const int index : *found) {
+            const Trajectory &trajectory = m_trajectories[size_t(index)];
+            if (trajectory.positionAt(timeMs, &position))
+                visit(trajectory, position);
+        }
+    }
+
+    // Adds or replaces an intent trajectory; points are sorted by time.
+    void setIntent(const QString &id, std::vector<TrackPoint> points);
+    void removeIntent(const QString &id);
+
+    // points is a list of {timeMs, latitude, longitude, altitudeMsl}
+    // objects. False if there are fewer than two.
+    Q_INVOKABLE bool setIntent(const QString &id, const QVariantList &points);
+    Q_INVOKABLE void remove(const QString &id) { removeIntent(id); }
+
+signals:
+    void countChanged();
+    void rangeChanged();
+    // Some trajectory gained, lost or moved points.
+    void trajectoriesChanged();
+
+private:
+    using SegmentRange = std::pair<qint64, qint64>; // first, last; empty if first > last
+
+    static qint64 segmentOf(qint64 timeMs);
+    void onVehicleFields(const QList<VehicleFieldChange> &changes);
+    void prune();
+    int add(Trajectory trajectory);
+    void removeAt(int index);
+    // Moves trajectory index from the segments it is indexed under to range.
+    void reindex(int index, SegmentRange range);
+    static SegmentRange rangeOf(const Trajectory &trajectory);
+    void updateRange();
+
+    VehicleStateStore *m_vehicles;
+    std::vector<Trajectory> m_trajectories;
+    std::vector<SegmentRange> m_indexed; // parallel to m_trajectories
+    QHash<QString, int> m_indexById;
+    QHash<int, int> m_trackBySystemId;
+    QHash<qint64, std::vector<int>> m_segments; // segment -> trajectory indices
+    qint64 m_startMs = 0;
+    qint64 m_endMs = 0;
+    QTimer m_pruneTimer;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QtGlobal>
+
+#include <array>
+#include <limits>
+
+// Telemetry fields tracked per vehicle. Angles are degrees, distances
+// metres, battery and link loss in percent, link jitter and round trip in
+// milliseconds, throughput in bytes per second, current in amperes and
+// vibration in m/s². BestLink indexes the daemon's link list
+// (SnapshotFeed::linkName()); the Link* fields describe that link.
+enum class VehicleField : int {
+    Latitude,
+    Longitude,
+    AltitudeMsl,
+    AltitudeRelative,
+    Heading,
+    GroundSpeed,
+    ClimbRate,
+    Roll,
+    Pitch,
+    Yaw,
+    BatteryRemaining,
+    BatteryVoltage,
+    FlightMode,
+    Armed,
+    ActiveLinks,
+    BestLink,
+    LinkLoss,
+    LinkJitter,
+    LinkRoundTrip,
+    LinkThroughput,
+    BatteryCurrent,
+    Vibration, // magnitude of the accelerometer vibration levels
+};
+
+constexpr int VehicleFieldCount = int(VehicleField::Vibration) + 1;
+
+using FieldMask = quint32;
+static_assert(VehicleFieldCount <= 32, "FieldMask has one bit per field");
+
+constexpr FieldMask fieldBit(VehicleField field)
+{
+    return FieldMask(1) << int(field);
+}
+
+// Smallest change that is visible at display precision. A field is only
+// reported dirty once it has moved this far from the value last published
+// to the views; 0 means any change counts.
+constexpr std::array<double, VehicleFieldCount> defaultDisplayThresholds = {
+    1e-6, // Latitude, ~0.1 m
+    1e-6, // Longitude
+    0.1,  // AltitudeMsl
+    0.1,  // AltitudeRelative
+    1.0,  // Heading
+    0.1,  // GroundSpeed
+    0.1,  // ClimbRate
+    0.5,  // Roll
+    0.5,  // Pitch
+    1.0,  // Yaw
+    1.0,  // BatteryRemaining
+    0.01, // BatteryVoltage
+    0,    // FlightMode
+    0,    // Armed
+    0,    // ActiveLinks
+    0,    // BestLink
+    1.0,  // LinkLoss
+    1.0,  // LinkJitter
+    1.0,  // LinkRoundTrip
+    100,  // LinkThroughput
+    0.1,  // BatteryCurrent
+    0.1,  // Vibration
+};
+
+inline const char *vehicleFieldName(VehicleField field)
+{
+    static const char *const names[VehicleFieldCount] = {
+        "latitude", "longitude", "altitudeMsl", "altitudeRelative", "heading",
+        "groundSpeed", "climbRate", "roll", "pitch", "yaw", "batteryRemaining",
+        "batteryVoltage", "flightMode", "armed", "activeLinks", "bestLink", "linkLoss",
+        "linkJitter", "linkRoundTrip", "linkThroughput", "batteryCurrent", "vibration",
+    };
+    return names[int(field)];
+}
+
+// Model roles for the fields in mask, with field N mapped to firstRole + N.
+inline QList<int> vehicleFieldRoles(FieldMask mask, int firstRole)
+{
+    QList<int> roles;
+    for (int field = 0; mask != 0; ++field, mask >>= 1) {
+        if (mask & 1)
+            roles.append(firstRole + field);
+    }
+    return roles;
+}
+
+// When a sample was taken, on the GCS monotonic clock (std::chrono::
+// steady_clock, µs), and how far off that may be. A negative uncertainty
+// means the vehicle's clock is not synchronized yet and the time is when
+// the sample arrived.
+struct SampleTime
+{
+    qint64 monotonicUs = 0;
+    qint32 uncertaintyUs = -1;
+};
+
+struct VehicleState
+{
+    VehicleState()
+    {
+        values.fill(std::numeric_limits<double>::quiet_NaN());
+        published.fill(std::numeric_limits<double>::quiet_NaN());
+    }
+
+    int systemId = 0;
+    qint64 lastUpdateMs = 0;
+    std::array<double, VehicleFieldCount> values;    // latest received
+    std::array<double, VehicleFieldCount> published; // last reported to views
+    std::array<SampleTime, VehicleFieldCount> sampleTimes;
+};
+
+struct VehicleFieldChange
+{
+    int index = 0; // VehicleStateStore index
+    FieldMask fields = 0;
+};
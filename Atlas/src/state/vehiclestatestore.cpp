@@ -0,0 +1,135 @@
+#include "vehiclestatestore.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "diagnostics/metrics.h"
+
+namespace {
+
+constexpr int publishIntervalMs = 16;
+
+bool visiblyChanged(double published, double value, double threshold)
+{
+    if (std::isnan(published) || std::isnan(value))
+        return std::isnan(published) != std::isnan(value);
+    return threshold > 0 ? std::abs(value - published) >= threshold : value != published;
+}
+
+} // namespace
+
+VehicleStateStore::VehicleStateStore(QObject *parent)
+    : QObject(parent)
+{
+    m_publishTimer.setSingleShot(true);
+    m_publishTimer.setInterval(publishIntervalMs);
+    connect(&m_publishTimer, &QTimer::timeout, this, &VehicleStateStore::publish);
+}
+
+void VehicleStateStore::setDisplayThreshold(VehicleField field, double threshold)
+{
+    m_thresholds[int(field)] = threshold;
+}
+
+int VehicleStateStore::addSampleTap(SampleTap tap)
+{
+    const int id = m_nextSampleTap++;
+    m_sampleTaps.emplace_back(id, std::move(tap));
+    return id;
+}
+
+void VehicleStateStore::removeSampleTap(int id)
+{
+    const auto it = std::find_if(m_sampleTaps.begin(), m_sampleTaps.end(),
+                                 [id](const auto &tap) { return tap.first == id; });
+    if (it == m_sampleTaps.end())
+        return;
+    if (m_sampleTapDepth > 0) {
+        // Erasing would pull the entry out from under update()'s loop, and
+        // maybe destroy the tap that is running.
+        it->first = 0;
+        m_sampleTapsRemoved = true;
+        return;
+    }
+    m_sampleTaps.erase(it);
+}
+
+void VehicleStateStore::runSampleTaps(int systemId, VehicleField field, double value, qint64 timestampMs,
+                                      const SampleTime &time)
+{
+    ++m_sampleTapDepth;
+    for (std::size_t i = 0, n = m_sampleTaps.size(); i < n; ++i) {
+        if (m_sampleTaps[i].first != 0)
+            m_sampleTaps[i].second(systemId, field, value, timestampMs, time);
+    }
+    if (--m_sampleTapDepth > 0 || !m_sampleTapsRemoved)
+        return;
+    m_sampleTaps.erase(std::remove_if(m_sampleTaps.begin(), m_sampleTaps.end(),
+                                      [](const auto &tap) { return tap.first == 0; }),
+                       m_sampleTaps.end());
+    m_sampleTapsRemoved = false;
+}
+
+int VehicleStateStore::ensureVehicle(int systemId)
+{
+    int index = indexOf(systemId);
+    if (index >= 0)
+        return index;
+
+    index = count();
+    VehicleState state;
+    state.systemId = systemId;
+    m_vehicles.push_back(state);
+    m_dirty.push_back(0);
+    m_indexBySystemId.insert(systemId, index);
+    Metrics::gauge("atlas_vehicles", "Vehicles known to the state store.")->set(count());
+    emit vehicleAdded(index);
+    return index;
+}
+
+void VehicleStateStore::update(int systemId, VehicleField field, double value, qint64 timestampMs,
+                               const SampleTime &time)
+{
+    static MetricCounter *const updates = Metrics::counter(
+        "atlas_telemetry_field_updates_total", "Telemetry field updates applied to the state store.");
+    updates->increment();
+    runSampleTaps(systemId, field, value, timestampMs, time);
+
+    const int index = ensureVehicle(systemId);
+    VehicleState &state = m_vehicles[index];
+    const int f = int(field);
+    state.values[f] = value;
+    state.sampleTimes[f] = time;
+    state.lastUpdateMs = timestampMs;
+
+    if (!visiblyChanged(state.published[f], value, m_thresholds[f]))
+        return;
+
+    // Compare against the published value, not the previous sample, so slow
+    // drift still surfaces once it adds up to a visible step.
+    state.published[f] = value;
+    if (m_dirty[index] == 0)
+        m_dirtyVehicles.push_back(index);
+    m_dirty[index] |= fieldBit(field);
+    if (!m_publishTimer.isActive())
+        m_publishTimer.start();
+}
+
+void VehicleStateStore::publish()
+{
+    static MetricCounter *const published = Metrics::counter(
+        "atlas_telemetry_published_vehicles_total",
+        "Per-vehicle change batches published to the views.");
+    if (m_dirtyVehicles.empty())
+        return;
+    published->increment(m_dirtyVehicles.size());
+
+    QList<VehicleFieldChange> changes;
+    changes.reserve(qsizetype(m_dirtyVehicles.size()));
+    for (const int index : m_dirtyVehicles) {
+        changes.append({index, m_dirty[index]});
+        m_dirty[index] = 0;
+    }
+    m_dirtyVehicles.clear();
+    emit fieldsChanged(changes);
+}
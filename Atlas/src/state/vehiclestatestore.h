@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "state/vehiclestate.h"
+
+// Live per-vehicle telemetry. Updates mark per-field dirty bits only when a
+// value crosses its display threshold; dirty fields are then published at
+// most once per frame as one fieldsChanged() batch so models can emit
+// dataChanged for exactly the roles that visibly changed. GUI thread only.
+class VehicleStateStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VehicleStateStore(QObject *parent = nullptr);
+
+    int count() const { return int(m_vehicles.size()); }
+    const VehicleState &at(int index) const { return m_vehicles[index]; }
+    int indexOf(int systemId) const { return m_indexBySystemId.value(systemId, -1); }
+
+    // time is when the vehicle took the sample, on the GCS monotonic clock.
+    void update(int systemId, VehicleField field, double value, qint64 timestampMs, const SampleTime &time = {});
+    void setDisplayThreshold(VehicleField field, double threshold);
+
+    // Sees every raw sample before thresholding; used by InputRecorder and
+    // the Debug page plots. addSampleTap() returns an id for removeSampleTap().
+    // A tap may add or remove taps, itself included, while it runs; a tap
+    // added then first sees the next sample.
+    using SampleTap = std::function<void(int systemId, VehicleField field, double value, qint64 timestampMs,
+                                         const SampleTime &time)>;
+    int addSampleTap(SampleTap tap);
+    void removeSampleTap(int id);
+
+signals:
+    void vehicleAdded(int index);
+    void fieldsChanged(const QList<VehicleFieldChange> &changes);
+
+private:
+    int ensureVehicle(int systemId);
+    void runSampleTaps(int systemId, VehicleField field, double value, qint64 timestampMs, const SampleTime &time);
+    void publish();
+
+    std::vector<VehicleState> m_vehicles;
+    std::vector<FieldMask> m_dirty; // per vehicle, parallel to m_vehicles
+    std::vector<int> m_dirtyVehicles;
+    QHash<int, int> m_indexBySystemId;
+    std::array<double, VehicleFieldCount> m_thresholds = defaultDisplayThresholds;
+    QTimer m_publishTimer;
+    // A deque so a tap added mid-dispatch leaves the running one in place.
+    // Taps removed mid-dispatch get id 0 and are swept once it unwinds.
+    std::deque<std::pair<int, SampleTap>> m_sampleTaps;
+    int m_nextSampleTap = 1;
+    int m_sampleTapDepth = 0;
+    bool m_sampleTapsRemoved = false;
+};
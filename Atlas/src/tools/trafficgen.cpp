@@ -0,0 +1,195 @@
+// atlas-trafficgen: synthetic MAVLink load for atlasd on loopback. Each
+// simulated vehicle circles Fresno sending GLOBAL_POSITION_INT, ATTITUDE
+// and a HEARTBEAT every 50th round; datagrams go out in sendmmsg batches so the
+// generator outruns the receiver being measured.
+//
+//   atlas-trafficgen [--port 14550] [--vehicles 100] [--rate 50000]
+//                    [--seconds 10] [--also-port 14551] [--sign-key HEX]
+//
+// --rate is datagrams per second in total (0 = as fast as possible).
+// --also-port repeats every datagram to a second port, as a redundant
+// link would. --sign-key signs every frame with a 64-hex-digit MAVLink 2
+// key, as on a network that requires signing.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ingest/linksigning.h"
+#include "ingest/mavlink.h"
+
+namespace {
+
+constexpr int batchSize = 64;
+
+struct Options
+{
+    uint16_t port = 14550;
+    uint16_t alsoPort = 0;
+    int vehicles = 100;
+    double rate = 50000;
+    double seconds = 10;
+    bool sign = false;
+    LinkSigning::Key key = {};
+};
+
+bool parseKey(const char *hex, LinkSigning::Key &key)
+{
+    if (std::strlen(hex) != 2 * key.size())
+        return false;
+    for (size_t i = 0; i < key.size(); ++i) {
+        char digits[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        char *end = nullptr;
+        key[i] = uint8_t(std::strtoul(digits, &end, 16));
+        if (end != digits + 2)
+            return false;
+    }
+    return true;
+}
+
+bool parseOptions(int argc, char *argv[], Options &options)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string name = argv[i];
+        const char *value = argv[i + 1];
+        if (name == "--port")
+            options.port = uint16_t(std::atoi(value));
+        else if (name == "--also-port")
+            options.alsoPort = uint16_t(std::atoi(value));
+        else if (name == "--vehicles")
+            options.vehicles = std::max(1, std::atoi(value));
+        else if (name == "--rate")
+            options.rate = std::atof(value);
+        else if (name == "--seconds")
+            options.seconds = std::atof(value);
+        else if (name == "--sign-key" && parseKey(value, options.key))
+            options.sign = true;
+        else
+            return false;
+    }
+    return argc % 2 == 1;
+}
+
+template<typename T>
+void put(uint8_t *payload, size_t offset, T value)
+{
+    std::memcpy(payload + offset, &value, sizeof(T));
+}
+
+// One frame per datagram, cycling through the message mix.
+size_t nextFrame(uint8_t *out, uint64_t counter, int vehicles, std::vector<uint8_t> &sequences,
+                 LinkSigning &signing)
+{
+    const int vehicle = int(counter % uint64_t(vehicles));
+    const uint64_t round = counter / uint64_t(vehicles);
+    const uint8_t systemId = uint8_t(1 + vehicle % 250);
+    const double angle = double(round) * 0.01 + vehicle;
+    uint8_t payload[33] = {};
+
+    if (round % 50 == 0) {
+        payload[4] = 2;    // MAV_TYPE_QUADROTOR
+        payload[5] = 3;    // MAV_AUTOPILOT_ARDUPILOTMEGA
+        payload[6] = 0x80; // armed
+        payload[8] = 3;
+        return signing.encode(out, sequences[size_t(vehicle)]++, systemId, 1, Mavlink::Heartbeat, payload, 9,
+                              LinkSigning::timestampNow());
+    }
+    if (round % 2 == 0) {
+        put<uint32_t>(payload, 0, uint32_t(round * 100));
+        put<int32_t>(payload, 4, int32_t((36.7378 + 0.01 * std::sin(angle)) * 1e7));
+        put<int32_t>(payload, 8, int32_t((-119.7871 + 0.01 * std::cos(angle)) * 1e7));
+        put<int32_t>(payload, 12, 120000 + vehicle * 10);
+        put<int32_t>(payload, 16, 30000);
+        put<uint16_t>(payload, 26, uint16_t(int(angle * 5729.58) % 36000));
+        return signing.encode(out, sequences[size_t(vehicle)]++, systemId, 1, Mavlink::GlobalPositionInt,
+                              payload, 28, LinkSigning::timestampNow());
+    }
+    put<float>(payload, 4, float(0.1 * std::sin(angle)));
+    put<float>(payload, 8, float(0.05 * std::cos(angle)));
+    put<float>(payload, 12, float(std::fmod(angle, 6.283)));
+    return signing.encode(out, sequences[size_t(vehicle)]++, systemId, 1, Mavlink::Attitude, payload, 28,
+                          LinkSigning::timestampNow());
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr,
+                     "usage: %s [--port P] [--vehicles N] [--rate PPS] [--seconds S] [--also-port P]"
+                     " [--sign-key HEX]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::perror("socket");
+        return 1;
+    }
+
+    const int targets = options.alsoPort ? 2 : 1;
+    sockaddr_in addresses[2] = {};
+    for (int t = 0; t < targets; ++t) {
+        addresses[t].sin_family = AF_INET;
+        addresses[t].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addresses[t].sin_port = htons(t == 0 ? options.port : options.alsoPort);
+    }
+
+    std::vector<uint8_t> buffers(size_t(batchSize) * Mavlink::maxFrameSize);
+    std::vector<uint8_t> sequences(size_t(options.vehicles), 0);
+    LinkSigning signing;
+    if (options.sign)
+        signing.setKey(options.key, 0);
+    iovec iovecs[batchSize];
+    mmsghdr messages[batchSize];
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration<double>(options.seconds);
+    uint64_t counter = 0;
+    uint64_t sent = 0;
+    while (Clock::now() < end) {
+        const int frames = batchSize / targets;
+        int count = 0;
+        for (int f = 0; f < frames; ++f, ++counter) {
+            uint8_t *frame = buffers.data() + size_t(f) * Mavlink::maxFrameSize;
+            const size_t size = nextFrame(frame, counter, options.vehicles, sequences, signing);
+            for (int t = 0; t < targets; ++t, ++count) {
+                iovecs[count] = {frame, size};
+                messages[count] = {};
+                messages[count].msg_hdr.msg_name = &addresses[t];
+                messages[count].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                messages[count].msg_hdr.msg_iov = &iovecs[count];
+                messages[count].msg_hdr.msg_iovlen = 1;
+            }
+        }
+        const int result = ::sendmmsg(fd, messages, unsigned(count), 0);
+        if (result > 0)
+            sent += uint64_t(result);
+
+        if (options.rate > 0) {
+            const auto due = start + std::chrono::duration<double>(double(sent) / options.rate);
+            std::this_thread::sleep_until(due);
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("sent %llu datagrams in %.2f s (%.0f/s) for %d vehicles\n", static_cast<unsigned long long>(sent),
+                elapsed, double(sent) / elapsed, options.vehicles);
+    ::close(fd);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <QtTest>
+
+#include <cmath>
+
+#include "ingest/clocksync.h"
+
+namespace {
+
+constexpr int systemId = 1;
+constexpr qint64 startUs = 1000000000; // GCS monotonic clock
+
+// A vehicle whose clock reads gcs - offsetUs - driftPpm * elapsed, and
+// answers each TIMESYNC at the midpoint of the round trip.
+struct SimulatedVehicle
+{
+    double offsetUs = 0;
+    double driftPpm = 0;
+
+    double trueOffset(qint64 gcsUs) const { return offsetUs + driftPpm * double(gcsUs - startUs) / 1e6; }
+    qint64 clock(qint64 gcsUs) const { return gcsUs - qint64(std::llround(trueOffset(gcsUs))); }
+
+    void reply(ClockSync &sync, qint64 sentUs, qint64 roundTripUs) const
+    {
+        sync.timesync(systemId, sentUs, clock(sentUs + roundTripUs / 2), sentUs + roundTripUs);
+    }
+};
+
+// One reply a second for the given number of seconds; returns the GCS time
+// of the last one.
+qint64 run(ClockSync &sync, const SimulatedVehicle &vehicle, int seconds, qint64 roundTripUs, qint64 fromUs = startUs)
+{
+    qint64 sentUs = fromUs;
+    for (int i = 0; i < seconds; ++i, sentUs += 1000000)
+        vehicle.reply(sync, sentUs, roundTripUs);
+    return sentUs - 1000000 + roundTripUs;
+}
+
+} // namespace
+
+class TestClockSync : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void unsynchronizedFallsBackToArrival();
+    void convergesOnOffset();
+    void tracksDrift();
+    void slowReplyBarelyMoves();
+    void rebootRestartsFilter();
+    void sampleTimeNeverAfterArrival();
+    void arrivalTimeLessHalfRoundTrip();
+};
+
+void TestClockSync::unsynchronizedFallsBackToArrival()
+{
+    ClockSync sync;
+    QVERIFY(!sync.estimate(systemId, startUs).synchronized);
+    const SampleTime sample = sync.sampleTime(systemId, 123, startUs);
+    QCOMPARE(sample.monotonicUs, startUs);
+    QCOMPARE(sample.uncertaintyUs, -1);
+    QCOMPARE(sync.arrivalTime(systemId, startUs).uncertaintyUs, -1);
+}
+
+void TestClockSync::convergesOnOffset()
+{
+    ClockSync sync;
+    const SimulatedVehicle vehicle{5e6, 0};
+    const qint64 lastUs = run(sync, vehicle, 30, 20000);
+
+    const ClockSync::Estimate estimate = sync.estimate(systemId, lastUs);
+    QVERIFY(estimate.synchronized);
+    QVERIFY2(std::abs(estimate.offsetUs - 5e6) < 10, qPrintable(QString::number(estimate.offsetUs)));
+    QVERIFY(std::abs(estimate.driftUsPerS) < 1);
+    // Many replies pin it down far tighter than one round trip.
+    QVERIFY(estimate.uncertaintyUs < 10000 / 2);
+    QCOMPARE(estimate.referenceUs, lastUs);
+    QCOMPARE(estimate.roundTripUs, qint64(20000));
+}
+
+void TestClockSync::tracksDrift()
+{
+    ClockSync sync;
+    const SimulatedVehicle vehicle{-2e6, 50};
+    const qint64 lastUs = run(sync, vehicle, 300, 10000);
+
+    const ClockSync::Estimate estimate = sync.estimate(systemId, lastUs);
+    QVERIFY2(std::abs(estimate.driftUsPerS - 50) < 5, qPrintable(QString::number(estimate.driftUsPerS)));
+    // Predicted ahead, the drift keeps the offset right between replies.
+    const qint64 laterUs = lastUs + 10000000;
+    QVERIFY(std::abs(sync.estimate(systemId, laterUs).offsetUs - vehicle.trueOffset(laterUs)) < 100);
+}
+
+void TestClockSync::slowReplyBarelyMoves()
+{
+    ClockSync sync;
+    const SimulatedVehicle vehicle{5e6, 0};
+    const qint64 lastUs = run(sync, vehicle, 30, 20000);
+    const double before = sync.estimate(systemId, lastUs).offsetUs;
+
+    // Answered at once, then sat in a radio queue for most of a second:
+    // the midpoint is far off, but so is the round trip.
+    const qint64 sentUs = lastUs + 1000000;
+    sync.timesync(systemId, sentUs, vehicle.clock(sentUs + 5000), sentUs + 900000);
+    const double after = sync.estimate(systemId, sentUs + 900000).offsetUs;
+    QVERIFY2(std::abs(after - before) < 100, qPrintable(QString::number(after - before)));
+}
+
+void TestClockSync::rebootRestartsFilter()
+{
+    ClockSync sync;
+    const qint64 lastUs = run(sync, SimulatedVehicle{5e6, 0}, 30, 20000);
+
+    // The vehicle's clock went back to zero.
+    const SimulatedVehicle rebooted{double(lastUs), 0};
+    const qint64 sentUs = lastUs + 1000000;
+    rebooted.reply(sync, sentUs, 20000);
+    const ClockSync::Estimate estimate = sync.estimate(systemId, sentUs + 20000);
+    QVERIFY(std::abs(estimate.offsetUs - rebooted.offsetUs) < 1);
+    QCOMPARE(estimate.referenceUs, sentUs + 20000);
+}
+
+void TestClockSync::sampleTimeNeverAfterArrival()
+{
+    ClockSync sync;
+    const SimulatedVehicle vehicle{5e6, 0};
+    const qint64 lastUs = run(sync, vehicle, 30, 20000);
+
+    const qint64 takenUs = lastUs + 500000;
+    SampleTime sample = sync.sampleTime(systemId, vehicle.clock(takenUs), takenUs + 30000);
+    QVERIFY(std::abs(sample.monotonicUs - takenUs) < 10);
+    QVERIFY(sample.uncertaintyUs >= 0);
+    QVERIFY(sample.uncertaintyUs < 10000);
+
+    sample = sync.sampleTime(systemId, vehicle.clock(takenUs), takenUs - 1000);
+    QCOMPARE(sample.monotonicUs, takenUs - 1000);
+}
+
+void TestClockSync::arrivalTimeLessHalfRoundTrip()
+{
+    ClockSync sync;
+    const qint64 lastUs = run(sync, SimulatedVehicle{5e6, 0}, 3, 20000);
+    const SampleTime sample = sync.arrivalTime(systemId, lastUs + 100000);
+    QCOMPARE(sample.monotonicUs, lastUs + 100000 - 10000);
+    QCOMPARE(sample.uncertaintyUs, 10000);
+}
+
+QTEST_GUILESS_MAIN(TestClockSync)
+#include "tst_clocksync.moc"
@@ -0,0 +1,122 @@
+#include <QtTest>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "persistence/csvscanner.h"
+
+namespace {
+
+// Every record in text, each field unescaped.
+std::vector<std::vector<std::string>> scan(std::string_view text, char delimiter = ',')
+{
+    std::vector<std::vector<std::string>> records;
+    CsvScanner scanner(text.data(), text.data() + text.size(), delimiter);
+    std::vector<CsvScanner::Field> fields;
+    while (scanner.next(fields)) {
+        std::vector<std::string> record;
+        for (const CsvScanner::Field &field : fields)
+            record.push_back(field.escaped ? CsvScanner::unescape(field.text) : std::string(field.text));
+        records.push_back(record);
+    }
+    return records;
+}
+
+using Records = std::vector<std::vector<std::string>>;
+
+} // namespace
+
+class TestCsvScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void splitsFields();
+    void lineEndings();
+    void emptyFields();
+    void quotedFields();
+    void doubledQuotes();
+    void malformedQuotes();
+    void tabDelimited();
+    void findSpecialMatchesBytewise();
+};
+
+void TestCsvScanner::splitsFields()
+{
+    QCOMPARE(scan("N123AB,DJI,M300\nN456CD,Skydio,X10\n"),
+             (Records{{"N123AB", "DJI", "M300"}, {"N456CD", "Skydio", "X10"}}));
+    // No newline after the last record.
+    QCOMPARE(scan("a,b"), (Records{{"a", "b"}}));
+}
+
+void TestCsvScanner::lineEndings()
+{
+    QCOMPARE(scan("a,b\r\nc,d\r\n"), (Records{{"a", "b"}, {"c", "d"}}));
+    QCOMPARE(scan("a\rb\n"), (Records{{"a"}, {"b"}}));
+}
+
+void TestCsvScanner::emptyFields()
+{
+    QCOMPARE(scan(",,\n"), (Records{{"", "", ""}}));
+    QCOMPARE(scan("a,\n"), (Records{{"a", ""}}));
+    QCOMPARE(scan("a,"), (Records{{"a", ""}}));
+    QCOMPARE(scan("a\n\nb\n"), (Records{{"a"}, {""}, {"b"}}));
+}
+
+void TestCsvScanner::quotedFields()
+{
+    // Delimiters and line breaks inside quotes belong to the field.
+    QCOMPARE(scan("\"Smith, J\",\"a\nb\",c\n"), (Records{{"Smith, J", "a\nb", "c"}}));
+    QCOMPARE(scan("\"\",x\n"), (Records{{"", "x"}}));
+
+    const std::string_view text = "\"plain\"";
+    CsvScanner scanner(text.data(), text.data() + text.size());
+    std::vector<CsvScanner::Field> fields;
+    QVERIFY(scanner.next(fields));
+    QCOMPARE(fields.size(), size_t(1));
+    QVERIFY(!fields[0].escaped);
+    QCOMPARE(fields[0].text, std::string_view("plain"));
+    QVERIFY(!scanner.next(fields));
+}
+
+void TestCsvScanner::doubledQuotes()
+{
+    QCOMPARE(scan("\"6\"\" prop\",b\n"), (Records{{"6\" prop", "b"}}));
+    QCOMPARE(scan("\"\"\"\"\n"), (Records{{"\""}}));
+    QCOMPARE(CsvScanner::unescape("a\"\"b\"\"\"\"c"), std::string("a\"b\"\"c"));
+}
+
+void TestCsvScanner::malformedQuotes()
+{
+    // Text after a closing quote is dropped; a stray quote inside an
+    // unquoted field is kept; an unterminated quote runs to the end.
+    QCOMPARE(scan("\"a\"junk,b\n"), (Records{{"a", "b"}}));
+    QCOMPARE(scan("6\" prop,b\n"), (Records{{"6\" prop", "b"}}));
+    QCOMPARE(scan("a,\"open\nrest"), (Records{{"a", "open\nrest"}}));
+}
+
+void TestCsvScanner::tabDelimited()
+{
+    QCOMPARE(scan("N123AB\tSmith, J\t\"x\"\n", '\t'), (Records{{"N123AB", "Smith, J", "x"}}));
+}
+
+void TestCsvScanner::findSpecialMatchesBytewise()
+{
+    // Long enough to cover the 16-byte blocks and the tail, with the
+    // special byte at every offset.
+    for (const char special : {',', '"', '\r', '\n'}) {
+        for (int at = 0; at < 40; ++at) {
+            std::string text(40, 'x');
+            text[size_t(at)] = special;
+            const char *begin = text.data();
+            QCOMPARE(int(CsvScanner::findSpecial(begin, begin + text.size(), ',') - begin), at);
+            QCOMPARE(int(CsvScanner::findSpecial(begin, begin + at, ',') - begin), at);
+        }
+    }
+    const std::string text(40, 'x');
+    QCOMPARE(int(CsvScanner::findSpecial(text.data(), text.data() + text.size(), ',') - text.data()), 40);
+}
+
+QTEST_GUILESS_MAIN(TestCsvScanner)
+#include "tst_csvscanner.moc"
@@ -0,0 +1,163 @@
+#include <QtTest>
+
+#include <array>
+#include <memory>
+
+#include "ingest/framequeue.h"
+
+namespace {
+
+// A frame of messageId whose sequence number tells the frames apart,
+// encoded into its own buffer.
+struct TestFrame
+{
+    std::array<uint8_t, Mavlink::maxFrameSize> data;
+    Mavlink::Frame frame;
+};
+
+std::unique_ptr<TestFrame> makeFrame(uint32_t messageId, uint8_t sequence)
+{
+    auto test = std::make_unique<TestFrame>();
+    const uint8_t payload[4] = {sequence, 1, 2, 3};
+    const size_t size = Mavlink::encode(test->data.data(), sequence, 1, 1, messageId, payload, sizeof(payload));
+    Mavlink::readFrame(test->data.data(), size, test->frame);
+    return test;
+}
+
+// One message per class; all have a known CRC_EXTRA, so encode() takes them.
+constexpr uint32_t critical = Mavlink::Heartbeat;
+constexpr uint32_t telemetry = Mavlink::GlobalPositionInt;
+constexpr uint32_t normal = Mavlink::Ping;
+constexpr uint32_t bulk = Mavlink::Vibration;
+
+bool push(FrameQueue &queue, uint32_t messageId, uint8_t sequence, MessagePriority &shed)
+{
+    return queue.push(makeFrame(messageId, sequence)->frame, 0, 0, 0, shed);
+}
+
+bool push(FrameQueue &queue, uint32_t messageId, uint8_t sequence)
+{
+    MessagePriority shed;
+    return push(queue, messageId, sequence, shed);
+}
+
+uint8_t popSequence(FrameQueue &queue)
+{
+    const uint8_t sequence = queue.front().frame.sequence;
+    queue.pop();
+    return sequence;
+}
+
+} // namespace
+
+class TestFrameQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void priorityTable();
+    void highestClassFirstThenOldest();
+    void copiesFrames();
+    void fullQueueShedsLowestClass();
+    void fullClassDropsItsOldest();
+    void refusesWhenEverythingOutranks();
+};
+
+void TestFrameQueue::priorityTable()
+{
+    QCOMPARE(messagePriority(critical), MessagePriority::Critical);
+    QCOMPARE(messagePriority(Mavlink::CommandAck), MessagePriority::Critical);
+    QCOMPARE(messagePriority(telemetry), MessagePriority::Telemetry);
+    QCOMPARE(messagePriority(normal), MessagePriority::Normal);
+    QCOMPARE(messagePriority(bulk), MessagePriority::Bulk);
+    QCOMPARE(messagePriority(0xFFFFFF), MessagePriority::Normal);
+    QCOMPARE(QByteArray(messagePriorityName(MessagePriority::Bulk)), QByteArray("bulk"));
+}
+
+void TestFrameQueue::highestClassFirstThenOldest()
+{
+    FrameQueue queue(8);
+    QVERIFY(push(queue, bulk, 1));
+    QVERIFY(push(queue, telemetry, 2));
+    QVERIFY(push(queue, critical, 3));
+    QVERIFY(push(queue, telemetry, 4));
+    QVERIFY(push(queue, normal, 5));
+    QCOMPARE(queue.size(), 5);
+
+    QCOMPARE(popSequence(queue), uint8_t(3));
+    QCOMPARE(popSequence(queue), uint8_t(2));
+    QCOMPARE(popSequence(queue), uint8_t(4));
+    QCOMPARE(popSequence(queue), uint8_t(5));
+    QCOMPARE(popSequence(queue), uint8_t(1));
+    QVERIFY(queue.isEmpty());
+}
+
+void TestFrameQueue::copiesFrames()
+{
+    FrameQueue queue(2);
+    auto source = makeFrame(telemetry, 7);
+    MessagePriority shed;
+    QVERIFY(queue.push(source->frame, 3, 1000, 2000, shed));
+    // The receive buffer is reused by the next batch.
+    source->data.fill(0);
+
+    const FrameQueue::Entry &entry = queue.front();
+    QCOMPARE(entry.link, 3);
+    QCOMPARE(entry.wallUs, qint64(1000));
+    QCOMPARE(entry.arrivalUs, qint64(2000));
+    QCOMPARE(entry.frame.data, entry.data.data());
+    QCOMPARE(entry.frame.sequence, uint8_t(7));
+    QCOMPARE(entry.frame.field<uint8_t>(0), uint8_t(7));
+    QCOMPARE(entry.data[0], Mavlink::v2Magic);
+}
+
+void TestFrameQueue::fullQueueShedsLowestClass()
+{
+    FrameQueue queue(3);
+    QVERIFY(push(queue, bulk, 1));
+    QVERIFY(push(queue, normal, 2));
+    QVERIFY(push(queue, telemetry, 3));
+
+    MessagePriority shed = MessagePriority::Critical;
+    QVERIFY(!push(queue, critical, 4, shed));
+    QCOMPARE(shed, MessagePriority::Bulk);
+    QVERIFY(!push(queue, telemetry, 5, shed));
+    QCOMPARE(shed, MessagePriority::Normal);
+    QCOMPARE(queue.size(), 3);
+
+    QCOMPARE(popSequence(queue), uint8_t(4));
+    QCOMPARE(popSequence(queue), uint8_t(3));
+    QCOMPARE(popSequence(queue), uint8_t(5));
+    QVERIFY(queue.isEmpty());
+}
+
+void TestFrameQueue::fullClassDropsItsOldest()
+{
+    // Nothing lower is queued: the newer frame of the same class wins.
+    FrameQueue queue(2);
+    QVERIFY(push(queue, telemetry, 1));
+    QVERIFY(push(queue, telemetry, 2));
+
+    MessagePriority shed = MessagePriority::Critical;
+    QVERIFY(!push(queue, telemetry, 3, shed));
+    QCOMPARE(shed, MessagePriority::Telemetry);
+    QCOMPARE(popSequence(queue), uint8_t(2));
+    QCOMPARE(popSequence(queue), uint8_t(3));
+}
+
+void TestFrameQueue::refusesWhenEverythingOutranks()
+{
+    FrameQueue queue(2);
+    QVERIFY(push(queue, critical, 1));
+    QVERIFY(push(queue, telemetry, 2));
+
+    MessagePriority shed = MessagePriority::Critical;
+    QVERIFY(!push(queue, bulk, 3, shed));
+    QCOMPARE(shed, MessagePriority::Bulk);
+    QCOMPARE(queue.size(), 2);
+    QCOMPARE(popSequence(queue), uint8_t(1));
+    QCOMPARE(popSequence(queue), uint8_t(2));
+}
+
+QTEST_GUILESS_MAIN(TestFrameQueue)
+#include "tst_framequeue.moc"
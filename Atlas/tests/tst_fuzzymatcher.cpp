@@ -0,0 +1,128 @@
+#include <QtTest>
+
+#include <string>
+#include <vector>
+
+#include "palette/fuzzymatcher.h"
+
+namespace {
+
+std::vector<std::string> titles(const FuzzyMatcher &matcher, const std::vector<FuzzyMatcher::Match> &matches)
+{
+    std::vector<std::string> result;
+    for (const FuzzyMatcher::Match &match : matches)
+        result.emplace_back(matcher.text(match.candidate));
+    return result;
+}
+
+FuzzyMatcher paletteMatcher()
+{
+    FuzzyMatcher matcher;
+    for (const char *title : {"Start/stop input recording", "Toggle light/dark theme", "Go to Home", "Go to Settings",
+                              "Go to Roster", "Cargo hold", "Vehicle 12", "Vehicle 120"})
+        matcher.add(title);
+    return matcher;
+}
+
+} // namespace
+
+class TestFuzzyMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyQueryListsTableOrder();
+    void subsequenceMatchesOnly();
+    void caseInsensitive();
+    void wordBoundariesRankFirst();
+    void tiesGoToShorterText();
+    void limitKeepsTheBest();
+    void narrowingMatchesFreshSearch();
+    void positionsForHighlighting();
+};
+
+void TestFuzzyMatcher::emptyQueryListsTableOrder()
+{
+    FuzzyMatcher matcher = paletteMatcher();
+    QCOMPARE(matcher.size(), size_t(8));
+    const std::vector<FuzzyMatcher::Match> &matches = matcher.search("", 3);
+    QCOMPARE(matches.size(), size_t(3));
+    for (uint32_t i = 0; i < 3; ++i)
+        QCOMPARE(matches[i].candidate, i);
+}
+
+void TestFuzzyMatcher::subsequenceMatchesOnly()
+{
+    FuzzyMatcher matcher = paletteMatcher();
+    const std::vector<std::string> found = titles(matcher, matcher.search("gtset", 50));
+    QCOMPARE(found, std::vector<std::string>{"Go to Settings"});
+    QVERIFY(matcher.search("zzz", 50).empty());
+    // Out of order is not a match.
+    QVERIFY(titles(matcher, matcher.search("emoh", 50)).empty());
+}
+
+void TestFuzzyMatcher::caseInsensitive()
+{
+    FuzzyMatcher matcher = paletteMatcher();
+    const std::vector<std::string> lower = titles(matcher, matcher.search("home", 50));
+    const std::vector<std::string> upper = titles(matcher, matcher.search("HOME", 50));
+    QCOMPARE(lower, upper);
+    QVERIFY(!lower.empty());
+    QCOMPARE(lower.front(), std::string("Go to Home"));
+}
+
+void TestFuzzyMatcher::wordBoundariesRankFirst()
+{
+    // "go" starts a word in "Go to ..." but sits inside "Cargo".
+    FuzzyMatcher matcher = paletteMatcher();
+    const std::vector<FuzzyMatcher::Match> matches = matcher.search("go", 50);
+    const std::vector<std::string> found = titles(matcher, matches);
+    QCOMPARE(found.size(), size_t(4));
+    QCOMPARE(found.back(), std::string("Cargo hold"));
+    QVERIFY(matches.front().score > matches.back().score);
+}
+
+void TestFuzzyMatcher::tiesGoToShorterText()
+{
+    FuzzyMatcher matcher = paletteMatcher();
+    const std::vector<std::string> found = titles(matcher, matcher.search("vehicle 12", 50));
+    QCOMPARE(found, (std::vector<std::string>{"Vehicle 12", "Vehicle 120"}));
+}
+
+void TestFuzzyMatcher::limitKeepsTheBest()
+{
+    FuzzyMatcher matcher = paletteMatcher();
+    const std::vector<std::string> all = titles(matcher, matcher.search("o", 50));
+    const std::vector<std::string> best = titles(matcher, matcher.search("o", 2));
+    QCOMPARE(best.size(), size_t(2));
+    QCOMPARE(best, std::vector<std::string>(all.begin(), all.begin() + 2));
+}
+
+void TestFuzzyMatcher::narrowingMatchesFreshSearch()
+{
+    // Typing reuses the previous survivors; backspacing must not.
+    FuzzyMatcher typed = paletteMatcher();
+    for (const char *query : {"g", "go", "go ", "go t", "go to r"})
+        typed.search(query, 50);
+    FuzzyMatcher fresh = paletteMatcher();
+    QCOMPARE(titles(typed, typed.search("go to r", 50)), titles(fresh, fresh.search("go to r", 50)));
+    QCOMPARE(titles(typed, typed.search("go", 50)), titles(fresh, fresh.search("go", 50)));
+
+    // A candidate added between keystrokes is still considered.
+    typed.search("ve", 50);
+    typed.add("Vehicle 7");
+    QCOMPARE(typed.search("veh", 50).size(), size_t(3));
+}
+
+void TestFuzzyMatcher::positionsForHighlighting()
+{
+    FuzzyMatcher matcher = paletteMatcher();
+    const uint32_t home = 2;
+    QCOMPARE(matcher.positions(home, "home"), (std::vector<uint32_t>{6, 7, 8, 9}));
+    QCOMPARE(matcher.positions(home, "gth"), (std::vector<uint32_t>{0, 3, 6}));
+    QVERIFY(matcher.positions(home, "xyz").empty());
+    QVERIFY(matcher.positions(home, "").empty());
+}
+
+QTEST_GUILESS_MAIN(TestFuzzyMatcher)
+#include "tst_fuzzymatcher.moc"
@@ -0,0 +1,231 @@
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QtTest>
+
+#include "models/livesortfiltermodel.h"
+
+namespace {
+
+constexpr int NameRole = Qt::UserRole + 1;
+constexpr int BatteryRole = Qt::UserRole + 2;
+
+QStandardItem *vehicle(const QString &name, double battery)
+{
+    auto *item = new QStandardItem;
+    item->setData(name, NameRole);
+    item->setData(battery, BatteryRole);
+    return item;
+}
+
+// a 50, b 20, c 80, d 35: sorted by battery, b d a c.
+void populate(QStandardItemModel &source)
+{
+    source.setItemRoleNames({{NameRole, "name"}, {BatteryRole, "battery"}});
+    source.appendRow(vehicle(QStringLiteral("a"), 50));
+    source.appendRow(vehicle(QStringLiteral("b"), 20));
+    source.appendRow(vehicle(QStringLiteral("c"), 80));
+    source.appendRow(vehicle(QStringLiteral("d"), 35));
+}
+
+QStringList names(const QAbstractItemModel &model)
+{
+    QStringList result;
+    for (int row = 0; row < model.rowCount(); ++row)
+        result.append(model.index(row, 0).data(NameRole).toString());
+    return result;
+}
+
+QStandardItem *find(const QStandardItemModel &source, const QString &name)
+{
+    for (int row = 0; row < source.rowCount(); ++row) {
+        if (source.item(row)->data(NameRole).toString() == name)
+            return source.item(row);
+    }
+    return nullptr;
+}
+
+} // namespace
+
+class TestLiveSortFilterModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sortsBySortRole();
+    void keyChangeMovesOneRow();
+    void keyChangeInPlaceOnlyUpdates();
+    void otherRolesDoNotResort();
+    void filterRunsOnlyForFilterRole();
+    void sourceInsertAndRemove();
+};
+
+void TestLiveSortFilterModel::sortsBySortRole()
+{
+    QStandardItemModel source;
+    populate(source);
+    LiveSortFilterModel proxy;
+    QAbstractItemModelTester tester(&proxy, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    proxy.setSourceModel(&source);
+    QCOMPARE(names(proxy), QStringList({"a", "b", "c", "d"}));
+
+    proxy.setSortRoleName(QStringLiteral("battery"));
+    QCOMPARE(names(proxy), QStringList({"b", "d", "a", "c"}));
+    proxy.setSortOrder(Qt::DescendingOrder);
+    QCOMPARE(names(proxy), QStringList({"c", "a", "d", "b"}));
+    proxy.setSortRoleName(QStringLiteral("name"));
+    QCOMPARE(names(proxy), QStringList({"d", "c", "b", "a"}));
+}
+
+void TestLiveSortFilterModel::keyChangeMovesOneRow()
+{
+    QStandardItemModel source;
+    populate(source);
+    LiveSortFilterModel proxy;
+    QAbstractItemModelTester tester(&proxy, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    proxy.setSortRoleName(QStringLiteral("battery"));
+    proxy.setSourceModel(&source);
+
+    QSignalSpy moved(&proxy, &QAbstractItemModel::rowsMoved);
+    QSignalSpy changed(&proxy, &QAbstractItemModel::dataChanged);
+    QSignalSpy reset(&proxy, &QAbstractItemModel::modelReset);
+
+    // Down: b from the top to between a and c.
+    find(source, QStringLiteral("b"))->setData(60, BatteryRole);
+    QCOMPARE(names(proxy), QStringList({"d", "a", "b", "c"}));
+    QCOMPARE(moved.count(), 1);
+    QCOMPARE(moved.at(0).at(1).toInt(), 0);
+    QCOMPARE(moved.at(0).at(2).toInt(), 0);
+    QCOMPARE(moved.at(0).at(4).toInt(), 3); // the row it lands before, in the old order
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(qvariant_cast<QModelIndex>(changed.at(0).at(0)).row(), 2);
+
+    // Up: c from the bottom to the top.
+    find(source, QStringLiteral("c"))->setData(10, BatteryRole);
+    QCOMPARE(names(proxy), QStringList({"c", "d", "a", "b"}));
+    QCOMPARE(moved.count(), 2);
+    QCOMPARE(moved.at(1).at(1).toInt(), 3);
+    QCOMPARE(moved.at(1).at(4).toInt(), 0);
+    QCOMPARE(qvariant_cast<QModelIndex>(changed.at(1).at(0)).row(), 0);
+    QCOMPARE(reset.count(), 0);
+}
+
+void TestLiveSortFilterModel::keyChangeInPlaceOnlyUpdates()
+{
+    QStandardItemModel source;
+    populate(source);
+    LiveSortFilterModel proxy;
+    QAbstractItemModelTester tester(&proxy, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    proxy.setSortRoleName(QStringLiteral("battery"));
+    proxy.setSourceModel(&source);
+
+    QSignalSpy moved(&proxy, &QAbstractItemModel::rowsMoved);
+    QSignalSpy changed(&proxy, &QAbstractItemModel::dataChanged);
+
+    // Still between d (35) and c (80).
+    find(source, QStringLiteral("a"))->setData(79, BatteryRole);
+    QCOMPARE(names(proxy), QStringList({"b", "d", "a", "c"}));
+    QCOMPARE(moved.count(), 0);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(qvariant_cast<QModelIndex>(changed.at(0).at(0)).row(), 2);
+    QCOMPARE(changed.at(0).at(2).value<QList<int>>(), QList<int>({BatteryRole}));
+
+    // A tie keeps source order.
+    find(source, QStringLiteral("c"))->setData(79, BatteryRole);
+    QCOMPARE(names(proxy), QStringList({"b", "d", "a", "c"}));
+    QCOMPARE(moved.count(), 0);
+}
+
+void TestLiveSortFilterModel::otherRolesDoNotResort()
+{
+    QStandardItemModel source;
+    populate(source);
+    LiveSortFilterModel proxy;
+    QAbstractItemModelTester tester(&proxy, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    proxy.setSortRoleName(QStringLiteral("battery"));
+    proxy.setSourceModel(&source);
+
+    QSignalSpy moved(&proxy, &QAbstractItemModel::rowsMoved);
+    QSignalSpy changed(&proxy, &QAbstractItemModel::dataChanged);
+
+    // Renaming b to sort last by name moves nothing while sorting by battery.
+    find(source, QStringLiteral("b"))->setData(QStringLiteral("z"), NameRole);
+    QCOMPARE(names(proxy), QStringList({"z", "d", "a", "c"}));
+    QCOMPARE(moved.count(), 0);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(qvariant_cast<QModelIndex>(changed.at(0).at(0)).row(), 0);
+}
+
+void TestLiveSortFilterModel::filterRunsOnlyForFilterRole()
+{
+    QStandardItemModel source;
+    populate(source);
+    LiveSortFilterModel proxy;
+    QAbstractItemModelTester tester(&proxy, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    proxy.setSortRoleName(QStringLiteral("battery"));
+    proxy.setFilterRoleName(QStringLiteral("name"));
+    proxy.setSourceModel(&source);
+
+    int calls = 0;
+    proxy.setFilterPredicate([&calls](const QModelIndex &index) {
+        ++calls;
+        return !index.data(NameRole).toString().startsWith(QLatin1Char('x'));
+    });
+    QCOMPARE(calls, 4);
+    QCOMPARE(proxy.count(), 4);
+
+    // Battery updates never reach the predicate.
+    find(source, QStringLiteral("a"))->setData(10, BatteryRole);
+    QCOMPARE(calls, 4);
+    QCOMPARE(names(proxy), QStringList({"a", "b", "d", "c"}));
+
+    // A rename re-runs it for that row alone, which then leaves the view and
+    // comes back in its sorted place.
+    QSignalSpy removed(&proxy, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy inserted(&proxy, &QAbstractItemModel::rowsInserted);
+    QSignalSpy countChanged(&proxy, &LiveSortFilterModel::countChanged);
+    find(source, QStringLiteral("d"))->setData(QStringLiteral("xd"), NameRole);
+    QCOMPARE(calls, 5);
+    QCOMPARE(names(proxy), QStringList({"a", "b", "c"}));
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(removed.at(0).at(1).toInt(), 2);
+    find(source, QStringLiteral("xd"))->setData(QStringLiteral("d"), NameRole);
+    QCOMPARE(calls, 6);
+    QCOMPARE(names(proxy), QStringList({"a", "b", "d", "c"}));
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 2);
+    QCOMPARE(countChanged.count(), 2);
+
+    // The text filter matches anywhere in the role, ignoring case.
+    proxy.setFilterText(QStringLiteral("C"));
+    QCOMPARE(names(proxy), QStringList({"c"}));
+    find(source, QStringLiteral("b"))->setData(QStringLiteral("bc"), NameRole);
+    QCOMPARE(names(proxy), QStringList({"bc", "c"}));
+}
+
+void TestLiveSortFilterModel::sourceInsertAndRemove()
+{
+    QStandardItemModel source;
+    populate(source);
+    LiveSortFilterModel proxy;
+    QAbstractItemModelTester tester(&proxy, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    proxy.setSortRoleName(QStringLiteral("battery"));
+    proxy.setSourceModel(&source);
+
+    QSignalSpy reset(&proxy, &QAbstractItemModel::modelReset);
+    source.insertRow(0, vehicle(QStringLiteral("e"), 40));
+    QCOMPARE(names(proxy), QStringList({"b", "d", "e", "a", "c"}));
+    source.removeRow(find(source, QStringLiteral("d"))->row());
+    QCOMPARE(names(proxy), QStringList({"b", "e", "a", "c"}));
+    QCOMPARE(reset.count(), 0);
+
+    // Source rows after the removed one shifted; updates still land on the
+    // right proxy row.
+    find(source, QStringLiteral("c"))->setData(5, BatteryRole);
+    QCOMPARE(names(proxy), QStringList({"c", "b", "e", "a"}));
+    for (int row = 0; row < proxy.rowCount(); ++row)
+        QCOMPARE(proxy.mapFromSource(proxy.mapToSource(proxy.index(row, 0))).row(), row);
+}
+
+QTEST_MAIN(TestLiveSortFilterModel)
+#include "tst_livesortfiltermodel.moc"
@@ -0,0 +1,318 @@
+#include <QtTest>
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "ingest/linksigning.h"
+#include "ingest/mavlink.h"
+#include "ingest/sha256.h"
+
+namespace {
+
+using Buffer = std::array<uint8_t, Mavlink::maxFrameSize>;
+
+// HEARTBEAT: custom_mode, type, autopilot, base_mode, system_status,
+// mavlink_version.
+constexpr uint8_t heartbeat[9] = {0, 0, 0, 0, 2, 3, 0x51, 4, 3};
+
+std::vector<Mavlink::Frame> parseAll(const uint8_t *data, size_t size, Mavlink::ParseStats *stats = nullptr)
+{
+    std::vector<Mavlink::Frame> frames;
+    Mavlink::parse(data, size, [&](const Mavlink::Frame &frame) { frames.push_back(frame); }, stats);
+    return frames;
+}
+
+LinkSigning::Key makeKey(uint8_t seed)
+{
+    LinkSigning::Key key;
+    for (size_t i = 0; i < key.size(); ++i)
+        key[i] = uint8_t(seed + i);
+    return key;
+}
+
+QByteArray sha256Hex(const QByteArray &message)
+{
+    Sha256 hash;
+    hash.update(reinterpret_cast<const uint8_t *>(message.constData()), size_t(message.size()));
+    uint8_t digest[Sha256::digestSize];
+    hash.finish(digest);
+    return QByteArray(reinterpret_cast<const char *>(digest), Sha256::digestSize).toHex();
+}
+
+} // namespace
+
+class TestMavlink : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void crcCheckValue();
+    void sha256KnownAnswers();
+    void encodeParseRoundTrip();
+    void truncatedPayloadReadsZero();
+    void parsesVersion1();
+    void unknownMessageIsUnverified();
+    void resynchronisesAfterGarbage();
+    void rejectsCorruptChecksum();
+    void leavesIncompleteFrame();
+    void targetOfAddressedMessage();
+    void signatureRoundTrip();
+    void linkSigningVerdicts();
+    void linkSigningTimestampsIncrease();
+};
+
+void TestMavlink::crcCheckValue()
+{
+    // CRC-16/MCRF4XX, which MAVLink calls X.25.
+    const char check[] = "123456789";
+    QCOMPARE(Mavlink::crc(reinterpret_cast<const uint8_t *>(check), 9), uint16_t(0x6F91));
+}
+
+void TestMavlink::sha256KnownAnswers()
+{
+    // FIPS 180-2 examples, one block and two.
+    QCOMPARE(sha256Hex("abc"), QByteArray("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    QCOMPARE(sha256Hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+             QByteArray("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+    QCOMPARE(sha256Hex(QByteArray()),
+             QByteArray("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+}
+
+void TestMavlink::encodeParseRoundTrip()
+{
+    Buffer buffer;
+    const size_t size = Mavlink::encode(buffer.data(), 7, 12, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    QCOMPARE(size, Mavlink::v2HeaderSize + sizeof(heartbeat) + Mavlink::checksumSize);
+
+    Mavlink::ParseStats stats;
+    const std::vector<Mavlink::Frame> frames = parseAll(buffer.data(), size, &stats);
+    QCOMPARE(frames.size(), size_t(1));
+    const Mavlink::Frame &frame = frames.front();
+    QCOMPARE(frame.version, uint8_t(2));
+    QCOMPARE(frame.sequence, uint8_t(7));
+    QCOMPARE(frame.systemId, uint8_t(12));
+    QCOMPARE(frame.componentId, uint8_t(1));
+    QCOMPARE(frame.messageId, uint32_t(Mavlink::Heartbeat));
+    QCOMPARE(frame.size, size);
+    QVERIFY(frame.checksumVerified);
+    QVERIFY(!frame.isSigned());
+    QCOMPARE(frame.field<uint8_t>(4), uint8_t(2));
+    QCOMPARE(frame.field<uint8_t>(8), uint8_t(3));
+    QCOMPARE(stats.frames, uint64_t(1));
+    QCOMPARE(stats.skippedBytes, uint64_t(0));
+}
+
+void TestMavlink::truncatedPayloadReadsZero()
+{
+    // ATTITUDE with only time_boot_ms set: MAVLink 2 sends two bytes.
+    uint8_t attitude[28] = {};
+    const uint32_t timeBootMs = 1000;
+    std::memcpy(attitude, &timeBootMs, sizeof(timeBootMs));
+    Buffer buffer;
+    const size_t size = Mavlink::encode(buffer.data(), 0, 1, 1, Mavlink::Attitude, attitude, sizeof(attitude));
+
+    const std::vector<Mavlink::Frame> frames = parseAll(buffer.data(), size);
+    QCOMPARE(frames.size(), size_t(1));
+    QCOMPARE(frames.front().payloadLength, uint8_t(2));
+    QCOMPARE(frames.front().field<uint32_t>(0), timeBootMs);
+    QCOMPARE(frames.front().field<float>(4), 0.0f);
+    QCOMPARE(frames.front().field<float>(24), 0.0f);
+}
+
+void TestMavlink::parsesVersion1()
+{
+    Buffer buffer;
+    buffer[0] = Mavlink::v1Magic;
+    buffer[1] = sizeof(heartbeat);
+    buffer[2] = 9;  // sequence
+    buffer[3] = 42; // system
+    buffer[4] = 1;  // component
+    buffer[5] = Mavlink::Heartbeat;
+    std::memcpy(buffer.data() + Mavlink::v1HeaderSize, heartbeat, sizeof(heartbeat));
+    const size_t checked = Mavlink::v1HeaderSize + sizeof(heartbeat);
+    uint8_t extra = 0;
+    QVERIFY(Mavlink::crcExtra(Mavlink::Heartbeat, extra));
+    const uint16_t checksum = Mavlink::crcAccumulate(extra, Mavlink::crc(buffer.data() + 1, checked - 1));
+    buffer[checked] = uint8_t(checksum);
+    buffer[checked + 1] = uint8_t(checksum >> 8);
+
+    const std::vector<Mavlink::Frame> frames = parseAll(buffer.data(), checked + Mavlink::checksumSize);
+    QCOMPARE(frames.size(), size_t(1));
+    QCOMPARE(frames.front().version, uint8_t(1));
+    QCOMPARE(frames.front().sequence, uint8_t(9));
+    QCOMPARE(frames.front().systemId, uint8_t(42));
+    QVERIFY(frames.front().checksumVerified);
+    QCOMPARE(frames.front().checksum(), checksum);
+}
+
+void TestMavlink::unknownMessageIsUnverified()
+{
+    const uint8_t payload[4] = {1, 2, 3, 4};
+    Buffer buffer;
+    QCOMPARE(Mavlink::encode(buffer.data(), 0, 1, 1, 9999, payload, sizeof(payload)), size_t(0));
+
+    // Without a CRC_EXTRA the checksum cannot be checked, only framed.
+    const uint8_t frame[] = {Mavlink::v2Magic, 4, 0, 0, 0, 1, 1, 0x0F, 0x27, 0x00, 1, 2, 3, 4, 0xAB, 0xCD};
+    const std::vector<Mavlink::Frame> frames = parseAll(frame, sizeof(frame));
+    QCOMPARE(frames.size(), size_t(1));
+    QCOMPARE(frames.front().messageId, uint32_t(9999));
+    QVERIFY(!frames.front().checksumVerified);
+}
+
+void TestMavlink::resynchronisesAfterGarbage()
+{
+    Buffer frame;
+    const size_t size = Mavlink::encode(frame.data(), 0, 1, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    QByteArray stream("\x00\x11\x22", 3);
+    stream.append(reinterpret_cast<const char *>(frame.data()), qsizetype(size));
+    stream.append('\x33');
+    stream.append(reinterpret_cast<const char *>(frame.data()), qsizetype(size));
+
+    Mavlink::ParseStats stats;
+    const auto *data = reinterpret_cast<const uint8_t *>(stream.constData());
+    const std::vector<Mavlink::Frame> frames = parseAll(data, size_t(stream.size()), &stats);
+    QCOMPARE(frames.size(), size_t(2));
+    QCOMPARE(stats.frames, uint64_t(2));
+    QCOMPARE(stats.skippedBytes, uint64_t(4));
+    QCOMPARE(frames[0].data, data + 3);
+    QCOMPARE(frames[1].data, data + 4 + size);
+}
+
+void TestMavlink::rejectsCorruptChecksum()
+{
+    Buffer frame;
+    const size_t size = Mavlink::encode(frame.data(), 0, 1, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    frame[Mavlink::v2HeaderSize + 4] ^= 0x01;
+
+    Mavlink::ParseStats stats;
+    QVERIFY(parseAll(frame.data(), size, &stats).empty());
+    QCOMPARE(stats.checksumErrors, uint64_t(1));
+    QCOMPARE(stats.frames, uint64_t(0));
+}
+
+void TestMavlink::leavesIncompleteFrame()
+{
+    Buffer frame;
+    const size_t size = Mavlink::encode(frame.data(), 0, 1, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    size_t calls = 0;
+    const size_t consumed = Mavlink::parse(frame.data(), size - 1, [&](const Mavlink::Frame &) { ++calls; });
+    QCOMPARE(consumed, size_t(0));
+    QCOMPARE(calls, size_t(0));
+}
+
+void TestMavlink::targetOfAddressedMessage()
+{
+    // COMMAND_LONG: target_system and target_component at 30 and 31.
+    uint8_t command[33] = {};
+    command[28] = 1; // command 400, low byte
+    command[30] = 42;
+    command[31] = 1;
+    Buffer buffer;
+    const size_t size = Mavlink::encode(buffer.data(), 0, Mavlink::gcsSystemId, Mavlink::gcsComponentId,
+                                        Mavlink::CommandLong, command, sizeof(command));
+    const std::vector<Mavlink::Frame> frames = parseAll(buffer.data(), size);
+    QCOMPARE(frames.size(), size_t(1));
+
+    uint8_t system = 0;
+    uint8_t component = 0;
+    QVERIFY(Mavlink::target(frames.front(), system, component));
+    QCOMPARE(system, uint8_t(42));
+    QCOMPARE(component, uint8_t(1));
+
+    const size_t broadcast = Mavlink::encode(buffer.data(), 0, 1, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    QVERIFY(!Mavlink::target(parseAll(buffer.data(), broadcast).front(), system, component));
+}
+
+void TestMavlink::signatureRoundTrip()
+{
+    const LinkSigning::Key key = makeKey(1);
+    const LinkSigning::Key otherKey = makeKey(2);
+    const uint64_t timestamp = 0x123456789ABCull;
+    Buffer buffer;
+    const size_t size = Mavlink::encodeSigned(buffer.data(), 3, 1, 1, Mavlink::Heartbeat, heartbeat,
+                                              sizeof(heartbeat), key.data(), 5, timestamp);
+    QCOMPARE(size, Mavlink::v2HeaderSize + sizeof(heartbeat) + Mavlink::checksumSize + Mavlink::signatureSize);
+
+    std::vector<Mavlink::Frame> frames = parseAll(buffer.data(), size);
+    QCOMPARE(frames.size(), size_t(1));
+    const Mavlink::Frame &frame = frames.front();
+    QVERIFY(frame.isSigned());
+    QVERIFY(frame.checksumVerified);
+    QCOMPARE(frame.signatureLinkId(), uint8_t(5));
+    QCOMPARE(frame.signatureTimestamp(), timestamp);
+    QVERIFY(Mavlink::signatureValid(frame, key.data()));
+    QVERIFY(!Mavlink::signatureValid(frame, otherKey.data()));
+
+    // The checksum does not cover the signature, so a tampered one still
+    // frames but no longer verifies.
+    buffer[size - 1] ^= 0x80;
+    frames = parseAll(buffer.data(), size);
+    QCOMPARE(frames.size(), size_t(1));
+    QVERIFY(!Mavlink::signatureValid(frames.front(), key.data()));
+}
+
+void TestMavlink::linkSigningVerdicts()
+{
+    const uint64_t now = 100000000ull * 60; // an hour after the signing epoch
+    LinkSigning receiver;
+    receiver.setKey(makeKey(1), 0);
+    LinkSigning sender;
+    sender.setKey(makeKey(1), 1);
+    LinkSigning forger;
+    forger.setKey(makeKey(2), 1);
+
+    Buffer buffer;
+    size_t size = sender.encode(buffer.data(), 0, 1, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat), now);
+    const Mavlink::Frame accepted = parseAll(buffer.data(), size).front();
+    QCOMPARE(receiver.verify(accepted, now), LinkSigning::Verdict::Accepted);
+    QCOMPARE(receiver.verify(accepted, now), LinkSigning::Verdict::Replayed);
+
+    Buffer unsignedBuffer;
+    const size_t unsignedSize = Mavlink::encode(unsignedBuffer.data(), 0, 1, 1, Mavlink::Heartbeat, heartbeat,
+                                                sizeof(heartbeat));
+    const Mavlink::Frame unsignedFrame = parseAll(unsignedBuffer.data(), unsignedSize).front();
+    QCOMPARE(receiver.verify(unsignedFrame, now), LinkSigning::Verdict::Unsigned);
+
+    Buffer forgedBuffer;
+    size = forger.encode(forgedBuffer.data(), 0, 1, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat), now + 10);
+    QCOMPARE(receiver.verify(parseAll(forgedBuffer.data(), size).front(), now), LinkSigning::Verdict::BadSignature);
+
+    // A stream not heard from before may open at most a minute in the past.
+    Buffer oldBuffer;
+    size = Mavlink::encodeSigned(oldBuffer.data(), 0, 2, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat),
+                                 makeKey(1).data(), 1, now - 61 * 100000);
+    QCOMPARE(receiver.verify(parseAll(oldBuffer.data(), size).front(), now), LinkSigning::Verdict::Replayed);
+    size = Mavlink::encodeSigned(oldBuffer.data(), 0, 3, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat),
+                                 makeKey(1).data(), 1, now - 59 * 100000);
+    QCOMPARE(receiver.verify(parseAll(oldBuffer.data(), size).front(), now), LinkSigning::Verdict::Accepted);
+
+    // Without a key everything passes.
+    LinkSigning open;
+    QCOMPARE(open.verify(unsignedFrame, now), LinkSigning::Verdict::Accepted);
+}
+
+void TestMavlink::linkSigningTimestampsIncrease()
+{
+    const uint64_t now = 100000000ull * 60;
+    LinkSigning sender;
+    sender.setKey(makeKey(1), 1);
+    LinkSigning receiver;
+    receiver.setKey(makeKey(1), 0);
+
+    // Frames sent within the same 10 µs still carry distinct timestamps,
+    // so none of them reads as a replay.
+    uint64_t previous = 0;
+    for (int i = 0; i < 3; ++i) {
+        Buffer buffer;
+        const size_t size = sender.encode(buffer.data(), uint8_t(i), 1, 1, Mavlink::Heartbeat, heartbeat,
+                                          sizeof(heartbeat), now);
+        const Mavlink::Frame frame = parseAll(buffer.data(), size).front();
+        QVERIFY(frame.signatureTimestamp() > previous);
+        previous = frame.signatureTimestamp();
+        QCOMPARE(receiver.verify(frame, now), LinkSigning::Verdict::Accepted);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestMavlink)
+#include "tst_mavlink.moc"
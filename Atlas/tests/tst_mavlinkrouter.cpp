@@ -0,0 +1,137 @@
+#include <QNetworkDatagram>
+#include <QUdpSocket>
+#include <QtTest>
+
+#include <array>
+#include <vector>
+
+#include "ingest/mavlink.h"
+#include "ingest/mavlinkrouter.h"
+
+namespace {
+
+// HEARTBEAT: custom_mode, type, autopilot, base_mode, system_status,
+// mavlink_version.
+constexpr uint8_t heartbeat[9] = {0, 0, 0, 0, 2, 3, 0x51, 4, 3};
+
+// A frame that stays valid while the test routes it.
+struct EncodedFrame
+{
+    std::array<uint8_t, Mavlink::maxFrameSize> buffer = {};
+    Mavlink::Frame frame;
+};
+
+void encode(EncodedFrame &out, uint8_t systemId, uint32_t messageId, const uint8_t *payload, uint8_t size)
+{
+    const size_t length = Mavlink::encode(out.buffer.data(), 0, systemId, 1, messageId, payload, size);
+    Mavlink::parse(out.buffer.data(), length, [&](const Mavlink::Frame &frame) { out.frame = frame; });
+}
+
+// COMMAND_LONG from a vehicle to targetSystem (component 0, any).
+void encodeCommand(EncodedFrame &out, uint8_t systemId, uint8_t targetSystem)
+{
+    uint8_t payload[33] = {};
+    payload[28] = 1; // command
+    payload[30] = targetSystem;
+    encode(out, systemId, Mavlink::CommandLong, payload, sizeof(payload));
+}
+
+MavlinkRouter::EndpointConfig endpointFor(const QString &name, const QUdpSocket &peer)
+{
+    MavlinkRouter::EndpointConfig config;
+    config.name = name;
+    config.address = QHostAddress(QHostAddress::LocalHost).toIPv4Address();
+    config.port = peer.localPort();
+    return config;
+}
+
+} // namespace
+
+class TestMavlinkRouter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void replacesEndpointsWhileRunning();
+    void keepsLearnedSystems();
+};
+
+void TestMavlinkRouter::replacesEndpointsWhileRunning()
+{
+    QUdpSocket first;
+    QUdpSocket second;
+    QVERIFY(first.bind(QHostAddress::LocalHost, 0));
+    QVERIFY(second.bind(QHostAddress::LocalHost, 0));
+
+    MavlinkRouter router;
+    QString error;
+    QVERIFY(router.setEndpoints({endpointFor(QStringLiteral("first"), first)}, &error));
+    QVERIFY2(router.start(&error), qPrintable(error));
+
+    EncodedFrame frame;
+    encode(frame, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    router.routeFromVehicle(frame.frame, 0);
+    router.flush();
+    QTRY_VERIFY(first.hasPendingDatagrams());
+    QCOMPARE(first.receiveDatagram().data().size(), qsizetype(frame.frame.size));
+
+    QVERIFY2(router.setEndpoints({endpointFor(QStringLiteral("second"), second)}, &error), qPrintable(error));
+    QCOMPARE(router.endpointCount(), 1);
+    router.routeFromVehicle(frame.frame, 0);
+    router.flush();
+    QTRY_VERIFY(second.hasPendingDatagrams());
+    QTest::qWait(50);
+    QVERIFY(!first.hasPendingDatagrams());
+
+    // No endpoints turns routing off.
+    QVERIFY(router.setEndpoints({}, &error));
+    QCOMPARE(router.endpointCount(), 0);
+    router.routeFromVehicle(frame.frame, 0);
+    router.flush();
+}
+
+void TestMavlinkRouter::keepsLearnedSystems()
+{
+    QUdpSocket gcs;
+    QUdpSocket added;
+    QVERIFY(gcs.bind(QHostAddress::LocalHost, 0));
+    QVERIFY(added.bind(QHostAddress::LocalHost, 0));
+
+    MavlinkRouter router;
+    int fromGcs = 0;
+    router.setVehicleSink([&](const Mavlink::Frame &, uint8_t) { ++fromGcs; });
+    QString error;
+    QVERIFY(router.setEndpoints({endpointFor(QStringLiteral("gcs"), gcs)}, &error));
+    QVERIFY2(router.start(&error), qPrintable(error));
+
+    // The ground station only learns the router's port from its traffic.
+    EncodedFrame vehicleHeartbeat;
+    encode(vehicleHeartbeat, 1, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    router.routeFromVehicle(vehicleHeartbeat.frame, 0);
+    router.flush();
+    QTRY_VERIFY(gcs.hasPendingDatagrams());
+    const QNetworkDatagram fromRouter = gcs.receiveDatagram();
+
+    EncodedFrame gcsHeartbeat;
+    encode(gcsHeartbeat, Mavlink::gcsSystemId, Mavlink::Heartbeat, heartbeat, sizeof(heartbeat));
+    gcs.writeDatagram(reinterpret_cast<const char *>(gcsHeartbeat.frame.data), qint64(gcsHeartbeat.frame.size),
+                      fromRouter.senderAddress(), quint16(fromRouter.senderPort()));
+    QTRY_COMPARE(fromGcs, 1);
+
+    // gcs keeps its name and address, so a command for it still reaches
+    // it and not the endpoint that has never shown system 255.
+    const std::vector<MavlinkRouter::EndpointConfig> endpoints = {endpointFor(QStringLiteral("gcs"), gcs),
+                                                                  endpointFor(QStringLiteral("added"), added)};
+    QVERIFY2(router.setEndpoints(endpoints, &error), qPrintable(error));
+    EncodedFrame command;
+    encodeCommand(command, 1, Mavlink::gcsSystemId);
+    router.routeFromVehicle(command.frame, 0);
+    router.flush();
+    QTRY_VERIFY(gcs.hasPendingDatagrams());
+    QCOMPARE(gcs.receiveDatagram().data().size(), qsizetype(command.frame.size));
+    QTest::qWait(50);
+    QVERIFY(!added.hasPendingDatagrams());
+}
+
+QTEST_GUILESS_MAIN(TestMavlinkRouter)
+#include "tst_mavlinkrouter.moc"
@@ -0,0 +1,160 @@
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <memory>
+
+#include "persistence/database.h"
+#include "persistence/rosterimporter.h"
+
+class TestRosterImporter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void dedupesWhileParsing();
+    void registryNumbersGetTheirPrefix();
+    void pilotEmailIgnoresCase();
+
+private:
+    // Imports csv and returns RosterImporter::finished()'s arguments.
+    QList<QVariant> importCsv(const QByteArray &csv);
+    QList<RosterEntry> roster();
+
+    std::unique_ptr<QTemporaryDir> m_dir;
+    std::unique_ptr<Database> m_database;
+    std::unique_ptr<RosterImporter> m_importer;
+    int m_files = 0;
+};
+
+void TestRosterImporter::init()
+{
+    m_dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_dir->isValid());
+    m_database = std::make_unique<Database>();
+    m_importer = std::make_unique<RosterImporter>(m_database.get());
+
+    // Database signals come from its thread; take them queued rather than
+    // through a QSignalSpy.
+    bool done = false;
+    bool ok = false;
+    QString message;
+    const auto connection = connect(m_database.get(), &Database::opened, this,
+                                    [&](bool opened, const QString &error) {
+                                        ok = opened;
+                                        message = error;
+                                        done = true;
+                                    });
+    m_database->open(m_dir->filePath(QStringLiteral("roster.db")));
+    const bool answered = QTest::qWaitFor([&done] { return done; }, 10000);
+    disconnect(connection);
+    QVERIFY(answered);
+    QVERIFY2(ok, qPrintable(message));
+}
+
+void TestRosterImporter::cleanup()
+{
+    m_importer.reset();
+    m_database.reset();
+    m_dir.reset();
+}
+
+QList<QVariant> TestRosterImporter::importCsv(const QByteArray &csv)
+{
+    QFile file(m_dir->filePath(QStringLiteral("import%1.csv").arg(++m_files)));
+    if (!file.open(QIODevice::WriteOnly) || file.write(csv) != csv.size())
+        return {};
+    file.close();
+
+    QSignalSpy finished(m_importer.get(), &RosterImporter::finished);
+    if (!m_importer->importFile(QUrl::fromLocalFile(file.fileName())))
+        return {};
+    if (!finished.wait(10000))
+        return {};
+    return finished.at(0);
+}
+
+QList<RosterEntry> TestRosterImporter::roster()
+{
+    QList<RosterEntry> rows;
+    bool ready = false;
+    const auto connection = connect(m_database.get(), &Database::rosterPageReady, this,
+                                    [&](quint64, const QList<RosterEntry> &page) {
+                                        rows = page;
+                                        ready = true;
+                                    });
+    m_database->fetchRosterPage(0, 100);
+    if (!QTest::qWaitFor([&ready] { return ready; }, 10000))
+        rows.clear();
+    disconnect(connection);
+    return rows;
+}
+
+void TestRosterImporter::dedupesWhileParsing()
+{
+    // The first occurrence of a registration or an airframe wins; rows
+    // without a serial number or with an unusable registration are rejected.
+    const QList<QVariant> result = importCsv("registration,serial_number,make,model,pilot_name,pilot_email\n"
+                                             "N123AB,S1,DJI,M300,Alice Smith,alice@example.com\n"
+                                             "n123ab,S2,DJI,M300,Bob Jones,bob@example.com\n"
+                                             "N456CD,S1,DJI,M300,Bob Jones,bob@example.com\n"
+                                             "N456CD,S1,Skydio,X10,Bob Jones,bob@example.com\n"
+                                             "N7!,S3,DJI,M300,,\n"
+                                             "N789EF,,DJI,M300,,\n");
+    QCOMPARE(result.size(), 4);
+    QCOMPARE(result.at(0).toInt(), 2);
+    QCOMPARE(result.at(1).toInt(), 2);
+    QCOMPARE(result.at(2).toInt(), 2);
+    QCOMPARE(result.at(3).toString(), QString());
+
+    const QList<RosterEntry> rows = roster();
+    QCOMPARE(rows.size(), 2);
+    QCOMPARE(rows.at(0).registration, QStringLiteral("N123AB"));
+    QCOMPARE(rows.at(0).makeModel, QStringLiteral("DJI M300"));
+    QCOMPARE(rows.at(0).pilotName, QStringLiteral("Alice Smith"));
+    QCOMPARE(rows.at(1).registration, QStringLiteral("N456CD"));
+    QCOMPARE(rows.at(1).makeModel, QStringLiteral("Skydio X10"));
+    QCOMPARE(rows.at(1).pilotName, QStringLiteral("Bob Jones"));
+}
+
+void TestRosterImporter::registryNumbersGetTheirPrefix()
+{
+    // FAA registry dumps store N-numbers without the N, so 123AB and N123AB
+    // are the same aircraft.
+    const QList<QVariant> result = importCsv("N-NUMBER,SERIAL NUMBER,NAME\n"
+                                             "123AB,S1,Acme Aerial\n"
+                                             "N123AB,S2,Acme Aerial\n");
+    QCOMPARE(result.size(), 4);
+    QCOMPARE(result.at(0).toInt(), 1);
+    QCOMPARE(result.at(1).toInt(), 1);
+
+    const QList<RosterEntry> rows = roster();
+    QCOMPARE(rows.size(), 1);
+    QCOMPARE(rows.at(0).registration, QStringLiteral("N123AB"));
+    QCOMPARE(rows.at(0).serialNumber, QStringLiteral("S1"));
+}
+
+void TestRosterImporter::pilotEmailIgnoresCase()
+{
+    QList<QVariant> result = importCsv("registration,serial_number,pilot_name,pilot_email\n"
+                                       "N1,S1,Alice Smith,alice@example.com\n"
+                                       "N2,S2,Alice Smith,Alice@Example.com\n");
+    QCOMPARE(result.value(0).toInt(), 2);
+
+    // A later file that spells the email differently still finds her, and
+    // renames her on every airframe she flies.
+    result = importCsv("registration,serial_number,pilot_name,pilot_email\n"
+                       "N3,S3,A. Smith,ALICE@EXAMPLE.COM\n");
+    QCOMPARE(result.value(0).toInt(), 1);
+
+    const QList<RosterEntry> rows = roster();
+    QCOMPARE(rows.size(), 3);
+    for (const RosterEntry &row : rows)
+        QCOMPARE(row.pilotName, QStringLiteral("A. Smith"));
+}
+
+QTEST_GUILESS_MAIN(TestRosterImporter)
+#include "tst_rosterimporter.moc"
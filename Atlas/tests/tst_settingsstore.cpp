@@ -0,0 +1,119 @@
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "settings/settingsstore.h"
+
+class TestSettingsStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void rejectsInvalidValues();
+    void readOnlyNeverWrites();
+    void readOnlyFollowsSaves();
+    void readOnlySeesFirstSave();
+};
+
+void TestSettingsStore::roundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("settings.bin"));
+    {
+        SettingsStore settings(path);
+        settings.load();
+        QCOMPARE(settings.value(QStringLiteral("theme")).toString(), QStringLiteral("dark"));
+        QVERIFY(settings.setValue(QStringLiteral("theme"), QStringLiteral("light")));
+        QVERIFY(settings.setValue(QStringLiteral("metricsPort"), 9000));
+        QVERIFY(settings.setValue(QStringLiteral("routerEndpoints"), QStringLiteral("qgc=127.0.0.1:14560")));
+        settings.flush();
+    }
+
+    SettingsStore settings(path);
+    settings.load();
+    QCOMPARE(settings.value(QStringLiteral("theme")).toString(), QStringLiteral("light"));
+    QCOMPARE(settings.value(QStringLiteral("metricsPort")).toInt(), 9000);
+    QCOMPARE(settings.value(QStringLiteral("routerEndpoints")).toString(), QStringLiteral("qgc=127.0.0.1:14560"));
+}
+
+void TestSettingsStore::rejectsInvalidValues()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SettingsStore settings(dir.filePath(QStringLiteral("settings.bin")));
+    QSignalSpy changed(&settings, &SettingsStore::valueChanged);
+    QVERIFY(!settings.setValue(QStringLiteral("theme"), QStringLiteral("sepia")));
+    QVERIFY(!settings.setValue(QStringLiteral("metricsPort"), 70000));
+    QVERIFY(!settings.setValue(QStringLiteral("noSuchKey"), 1));
+    QVERIFY(settings.setValue(QStringLiteral("metricsPort"), QStringLiteral("9100")));
+    QCOMPARE(settings.value(QStringLiteral("metricsPort")).toInt(), 9100);
+    QCOMPARE(changed.count(), 1);
+}
+
+void TestSettingsStore::readOnlyNeverWrites()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("settings.bin"));
+    {
+        SettingsStore settings(path, SettingsStore::Access::ReadOnly);
+        settings.load();
+        QVERIFY(!settings.setValue(QStringLiteral("theme"), QStringLiteral("light")));
+        QCOMPARE(settings.value(QStringLiteral("theme")).toString(), QStringLiteral("dark"));
+        settings.flush();
+    }
+    QVERIFY(!QFile::exists(path));
+}
+
+void TestSettingsStore::readOnlyFollowsSaves()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("settings.bin"));
+    SettingsStore writer(path);
+    writer.load();
+    QVERIFY(writer.setValue(QStringLiteral("metricsPort"), 9000));
+    writer.flush();
+
+    SettingsStore reader(path, SettingsStore::Access::ReadOnly);
+    reader.load();
+    QCOMPARE(reader.value(QStringLiteral("metricsPort")).toInt(), 9000);
+
+    // Only the keys that changed are announced, once per save.
+    QSignalSpy changed(&reader, &SettingsStore::valueChanged);
+    QVERIFY(writer.setValue(QStringLiteral("routerEndpoints"), QStringLiteral("qgc=127.0.0.1:14560")));
+    writer.flush();
+    QTRY_COMPARE(changed.count(), 1);
+    QCOMPARE(changed.at(0).at(0).toString(), QStringLiteral("routerEndpoints"));
+    QCOMPARE(reader.value(QStringLiteral("routerEndpoints")).toString(), QStringLiteral("qgc=127.0.0.1:14560"));
+
+    // The save replaced the file; the reader still follows the next one.
+    QVERIFY(writer.setValue(QStringLiteral("daemonMetricsPort"), 9500));
+    writer.flush();
+    QTRY_COMPARE(changed.count(), 2);
+    QCOMPARE(reader.value(QStringLiteral("daemonMetricsPort")).toInt(), 9500);
+    QCOMPARE(reader.value(QStringLiteral("metricsPort")).toInt(), 9000);
+}
+
+void TestSettingsStore::readOnlySeesFirstSave()
+{
+    // The daemon may start before the UI has ever saved.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("settings.bin"));
+    SettingsStore reader(path, SettingsStore::Access::ReadOnly);
+    reader.load();
+    QSignalSpy changed(&reader, &SettingsStore::valueChanged);
+
+    SettingsStore writer(path);
+    QVERIFY(writer.setValue(QStringLiteral("subscriptionPort"), 14600));
+    writer.flush();
+    QTRY_COMPARE(changed.count(), 1);
+    QCOMPARE(reader.value(QStringLiteral("subscriptionPort")).toInt(), 14600);
+}
+
+QTEST_GUILESS_MAIN(TestSettingsStore)
+#include "tst_settingsstore.moc"
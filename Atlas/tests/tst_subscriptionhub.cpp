@@ -0,0 +1,243 @@
+#include <QtEndian>
+#include <QtTest>
+
+#include <vector>
+
+#include "ingest/subscriptionhub.h"
+
+namespace {
+
+constexpr FieldMask position = fieldBit(VehicleField::Latitude) | fieldBit(VehicleField::Longitude);
+
+// Walks one update datagram in the layout documented on SubscriptionHub.
+struct Reader
+{
+    const QByteArray &datagram;
+    qsizetype at = 0;
+
+    template<typename T>
+    T read()
+    {
+        const T value = qFromLittleEndian<T>(datagram.constData() + at);
+        at += qsizetype(sizeof(T));
+        return value;
+    }
+
+    quint64 varint()
+    {
+        quint64 value = 0;
+        for (int shift = 0;; shift += 7) {
+            const quint8 byte = read<quint8>();
+            value |= quint64(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+    }
+
+    qint64 zigzag()
+    {
+        const quint64 value = varint();
+        return qint64(value >> 1) ^ -qint64(value & 1);
+    }
+
+    bool atEnd() const { return at == datagram.size(); }
+};
+
+struct Header
+{
+    quint32 magic = 0;
+    quint8 version = 0;
+    quint8 flags = 0;
+    quint16 records = 0;
+    qint64 timestampMs = 0;
+};
+
+Header readHeader(Reader &reader)
+{
+    Header header;
+    header.magic = reader.read<quint32>();
+    header.version = reader.read<quint8>();
+    header.flags = reader.read<quint8>();
+    header.records = reader.read<quint16>();
+    header.timestampMs = reader.read<qint64>();
+    return header;
+}
+
+void update(SubscriptionHub &hub, int systemId, std::vector<FieldSample> samples)
+{
+    hub.update(systemId, samples.data(), samples.size());
+}
+
+SubscriptionHub::Subscription subscription(double rateHz, FieldMask fields, bool quantized = false)
+{
+    SubscriptionHub::Subscription result;
+    result.rateHz = rateHz;
+    result.fields = fields;
+    result.quantized = quantized;
+    return result;
+}
+
+} // namespace
+
+class TestSubscriptionHub : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void tierRateRoundsDown();
+    void nothingKnownSendsNothing();
+    void subscribeSendsKeyframe();
+    void deltaCarriesChangedFieldsOnly();
+    void quantizedVarints();
+    void regionScopesVehicles();
+    void matchingSubscriptionsShareATier();
+};
+
+void TestSubscriptionHub::tierRateRoundsDown()
+{
+    QCOMPARE(SubscriptionHub::tierRate(0.5), 1);
+    QCOMPARE(SubscriptionHub::tierRate(1), 1);
+    QCOMPARE(SubscriptionHub::tierRate(4.9), 2);
+    QCOMPARE(SubscriptionHub::tierRate(9.99), 5);
+    QCOMPARE(SubscriptionHub::tierRate(10), 10);
+    QCOMPARE(SubscriptionHub::tierRate(1000), 50);
+}
+
+void TestSubscriptionHub::nothingKnownSendsNothing()
+{
+    SubscriptionHub hub;
+    QList<QByteArray> received;
+    hub.subscribe(subscription(10, 0), [&received](const QByteArray &datagram) { received.append(datagram); });
+    QVERIFY(received.isEmpty());
+    QCOMPARE(hub.tierCount(), 1);
+}
+
+void TestSubscriptionHub::subscribeSendsKeyframe()
+{
+    SubscriptionHub hub;
+    update(hub, 3, {{VehicleField::Latitude, 47.5}, {VehicleField::Longitude, 8.25}, {VehicleField::AltitudeMsl, 420}});
+    QList<QByteArray> received;
+    hub.subscribe(subscription(10, position), [&received](const QByteArray &datagram) { received.append(datagram); });
+    QCOMPARE(received.size(), 1);
+
+    Reader reader{received.front()};
+    const Header header = readHeader(reader);
+    QCOMPARE(header.magic, SubscriptionHub::magic);
+    QCOMPARE(header.version, SubscriptionHub::version);
+    QCOMPARE(header.flags, SubscriptionHub::flagFullState);
+    QCOMPARE(header.records, quint16(1));
+    QVERIFY(header.timestampMs > 0);
+    QCOMPARE(reader.read<quint8>(), quint8(3));
+    QCOMPARE(reader.read<quint32>(), quint32(position));
+    QCOMPARE(reader.read<double>(), 47.5);
+    QCOMPARE(reader.read<double>(), 8.25);
+    QVERIFY(reader.atEnd());
+}
+
+void TestSubscriptionHub::deltaCarriesChangedFieldsOnly()
+{
+    SubscriptionHub hub;
+    update(hub, 3, {{VehicleField::Latitude, 47.5}, {VehicleField::AltitudeMsl, 420}});
+    QList<QByteArray> received;
+    hub.subscribe(subscription(50, 0), [&received](const QByteArray &datagram) { received.append(datagram); });
+    received.clear();
+
+    // Latitude repeats its value, so only the altitude is owed.
+    update(hub, 3, {{VehicleField::Latitude, 47.5}, {VehicleField::AltitudeMsl, 425}});
+    QTRY_COMPARE(received.size(), 1);
+
+    Reader reader{received.front()};
+    const Header header = readHeader(reader);
+    QCOMPARE(header.flags, quint8(0));
+    QCOMPARE(header.records, quint16(1));
+    QCOMPARE(reader.read<quint8>(), quint8(3));
+    QCOMPARE(reader.read<quint32>(), quint32(fieldBit(VehicleField::AltitudeMsl)));
+    QCOMPARE(reader.read<double>(), 425.0);
+    QVERIFY(reader.atEnd());
+
+    // Nothing new, nothing sent until the keyframe.
+    QTest::qWait(100);
+    QCOMPARE(received.size(), 1);
+}
+
+void TestSubscriptionHub::quantizedVarints()
+{
+    const FieldMask fields = fieldBit(VehicleField::Latitude) | fieldBit(VehicleField::Heading);
+    SubscriptionHub hub;
+    update(hub, 7, {{VehicleField::Latitude, 47.1234567}, {VehicleField::Heading, -12.3}});
+    QList<QByteArray> received;
+    hub.subscribe(subscription(50, fields, true), [&received](const QByteArray &datagram) { received.append(datagram); });
+    QCOMPARE(received.size(), 1);
+
+    Reader keyframe{received.front()};
+    QCOMPARE(readHeader(keyframe).flags, quint8(SubscriptionHub::flagFullState | SubscriptionHub::flagQuantized));
+    QCOMPARE(keyframe.read<quint8>(), quint8(7));
+    QCOMPARE(keyframe.varint(), quint64(fields));
+    QCOMPARE(keyframe.zigzag(), qint64(471234567));
+    QCOMPARE(keyframe.zigzag(), qint64(-123));
+    QVERIFY(keyframe.atEnd());
+    received.clear();
+
+    // A heading change under a tenth of a degree is not resent.
+    update(hub, 7, {{VehicleField::Latitude, 47.1234568}, {VehicleField::Heading, -12.34}});
+    QTRY_COMPARE(received.size(), 1);
+    Reader delta{received.front()};
+    QCOMPARE(readHeader(delta).flags, SubscriptionHub::flagQuantized);
+    QCOMPARE(delta.read<quint8>(), quint8(7));
+    QCOMPARE(delta.varint(), quint64(fieldBit(VehicleField::Latitude)));
+    QCOMPARE(delta.zigzag(), qint64(471234568));
+    QVERIFY(delta.atEnd());
+}
+
+void TestSubscriptionHub::regionScopesVehicles()
+{
+    SubscriptionHub hub;
+    update(hub, 1, {{VehicleField::Latitude, 47.5}, {VehicleField::Longitude, 8.5}});
+    update(hub, 2, {{VehicleField::Latitude, -33.9}, {VehicleField::Longitude, 151.2}});
+    update(hub, 3, {{VehicleField::AltitudeMsl, 100}}); // no fix yet
+
+    SubscriptionHub::Subscription alps = subscription(1, 0);
+    alps.hasRegion = true;
+    alps.region = {45, 5, 48, 11};
+    QList<QByteArray> received;
+    hub.subscribe(alps, [&received](const QByteArray &datagram) { received.append(datagram); });
+    QCOMPARE(received.size(), 1);
+    Reader reader{received.front()};
+    QCOMPARE(readHeader(reader).records, quint16(1));
+    QCOMPARE(reader.read<quint8>(), quint8(1));
+}
+
+void TestSubscriptionHub::matchingSubscriptionsShareATier()
+{
+    SubscriptionHub hub;
+    update(hub, 1, {{VehicleField::Latitude, 47.5}});
+    int fullStates = 0;
+    const auto sink = [&fullStates](const QByteArray &datagram) {
+        Reader reader{datagram};
+        if (readHeader(reader).flags & SubscriptionHub::flagFullState)
+            ++fullStates;
+    };
+
+    // 12 Hz rounds down to the 10 Hz tier; the newcomer still gets the
+    // full state.
+    const int first = hub.subscribe(subscription(10, position), sink);
+    const int second = hub.subscribe(subscription(12, position), sink);
+    QCOMPARE(hub.tierCount(), 1);
+    QCOMPARE(fullStates, 2);
+    QCOMPARE(hub.snapshot(second).size(), 1);
+
+    const int other = hub.subscribe(subscription(10, position, true), sink);
+    QCOMPARE(hub.tierCount(), 2);
+
+    hub.unsubscribe(first);
+    QCOMPARE(hub.tierCount(), 2);
+    hub.unsubscribe(second);
+    QCOMPARE(hub.tierCount(), 1);
+    QVERIFY(hub.snapshot(second).isEmpty());
+    hub.unsubscribe(other);
+    hub.unsubscribe(other);
+    QCOMPARE(hub.tierCount(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestSubscriptionHub)
+#include "tst_subscriptionhub.moc"
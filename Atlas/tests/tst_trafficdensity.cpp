@@ -0,0 +1,199 @@
+#include <QSignalSpy>
+#include <QtTest>
+
+#include <algorithm>
+#include <cmath>
+
+#include "state/trafficdensity.h"
+#include "state/vehiclestatestore.h"
+
+namespace {
+
+// Timestamps start well clear of zero, which TrafficDensity reads as "no
+// sample yet".
+constexpr qint64 startMs = 1000000;
+constexpr qint64 halfLifeMs = 60000;
+
+int binCount(const TrafficDensity &density, int level, qint64 nowMs)
+{
+    int count = 0;
+    density.forEachBin(level, nowMs, [&count](QPoint, double) { ++count; });
+    return count;
+}
+
+bool fuzzyEqual(double a, double b)
+{
+    return std::abs(a - b) < 1e-9 * std::max(1.0, std::abs(b));
+}
+
+} // namespace
+
+class TestTrafficDensity : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void oneSampleEveryLevel();
+    void sameBinAccumulates();
+    void levelsNest();
+    void decaysWithHalfLife();
+    void readBeforeLatestDoesNotGrow();
+    void renormalizeDropsFadedBins();
+    void halfLifeChange();
+    void samplesVehiclesOncePerInterval();
+};
+
+void TestTrafficDensity::oneSampleEveryLevel()
+{
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    for (int level = 0; level < TrafficDensity::levelCount; ++level) {
+        QCOMPARE(density.peak(level, startMs), 0.0);
+        QVERIFY(density.extent(level).isNull());
+    }
+
+    density.add(47.0, 8.0, startMs);
+    QCOMPARE(density.latestMs(), startMs);
+    for (int level = 0; level < TrafficDensity::levelCount; ++level) {
+        QCOMPARE(density.peak(level, startMs), 1.0);
+        QCOMPARE(binCount(density, level, startMs), 1);
+        QCOMPARE(density.extent(level).size(), QSize(1, 1));
+    }
+}
+
+void TestTrafficDensity::sameBinAccumulates()
+{
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    density.setHalfLifeMs(halfLifeMs);
+    const quint64 before = density.revision();
+    density.add(47.0, 8.0, startMs, 2);
+    density.add(47.0, 8.0, startMs, 3);
+    QVERIFY(density.revision() > before);
+    QVERIFY(fuzzyEqual(density.peak(0, startMs), 5));
+    QCOMPARE(binCount(density, 0, startMs), 1);
+}
+
+void TestTrafficDensity::levelsNest()
+{
+    // A few hundred metres apart: split on the finest level, one bin on the
+    // coarsest.
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    const int finest = TrafficDensity::levelCount - 1;
+    QVERIFY(TrafficDensity::cellSize(finest) < 500);
+    density.add(0.0, 0.0005, startMs);
+    density.add(0.0, 0.0005 + 500 / 111320.0, startMs);
+    QCOMPARE(binCount(density, 0, startMs), 1);
+    QCOMPARE(binCount(density, finest, startMs), 2);
+    QCOMPARE(density.extent(finest).height(), 1);
+    QVERIFY(density.extent(finest).width() >= 2);
+
+    double total = 0;
+    density.forEachBin(finest, startMs, [&total](QPoint, double value) { total += value; });
+    QVERIFY(fuzzyEqual(total, density.peak(0, startMs)));
+}
+
+void TestTrafficDensity::decaysWithHalfLife()
+{
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    density.setHalfLifeMs(halfLifeMs);
+    density.add(47.0, 8.0, startMs);
+    QVERIFY(fuzzyEqual(density.peak(0, startMs + halfLifeMs), 0.5));
+    QVERIFY(fuzzyEqual(density.peak(2, startMs + 2 * halfLifeMs), 0.25));
+
+    // A second sample a half-life later adds to what is left of the first.
+    density.add(47.0, 8.0, startMs + halfLifeMs);
+    QVERIFY(fuzzyEqual(density.peak(0, startMs + halfLifeMs), 1.5));
+    density.forEachBin(1, startMs + 2 * halfLifeMs,
+                       [](QPoint, double value) { QVERIFY(fuzzyEqual(value, 0.75)); });
+}
+
+void TestTrafficDensity::readBeforeLatestDoesNotGrow()
+{
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    density.setHalfLifeMs(halfLifeMs);
+    density.add(47.0, 8.0, startMs);
+    density.add(47.0, 8.0, startMs + halfLifeMs);
+    QCOMPARE(density.peak(0, startMs), density.peak(0, startMs + halfLifeMs));
+
+    // A late sample counts as arriving with the latest one.
+    density.add(47.0, 8.0, startMs);
+    QCOMPARE(density.latestMs(), startMs + halfLifeMs);
+    QVERIFY(fuzzyEqual(density.peak(0, startMs + halfLifeMs), 2.5));
+}
+
+void TestTrafficDensity::renormalizeDropsFadedBins()
+{
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    density.setHalfLifeMs(halfLifeMs);
+    density.add(47.0, 8.0, startMs);
+    density.add(51.5, -0.1, startMs, 100);
+
+    // Past ten half-lives the next sample folds the decay into the bins:
+    // one sample, now 2^-11, is gone; a hundred of them are not.
+    qint64 nowMs = startMs + 11 * halfLifeMs;
+    density.add(-33.9, 151.2, nowMs);
+    QCOMPARE(binCount(density, 0, nowMs), 2);
+    QVERIFY(fuzzyEqual(density.peak(0, nowMs), 1));
+
+    nowMs += 11 * halfLifeMs;
+    density.add(-33.9, 151.2, nowMs);
+    QCOMPARE(binCount(density, 0, nowMs), 1);
+    QCOMPARE(density.extent(0).size(), QSize(1, 1));
+    QVERIFY(fuzzyEqual(density.peak(0, nowMs), 1));
+}
+
+void TestTrafficDensity::halfLifeChange()
+{
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    QSignalSpy changed(&density, &TrafficDensity::halfLifeChanged);
+    density.setHalfLifeMs(halfLifeMs);
+    density.setHalfLifeMs(halfLifeMs);
+    density.setHalfLifeMs(0);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(density.halfLifeMs(), halfLifeMs);
+
+    // Decay already done stays at the old rate.
+    density.add(47.0, 8.0, startMs);
+    density.add(47.0, 8.0, startMs + halfLifeMs, 0);
+    density.setHalfLifeMs(2 * halfLifeMs);
+    QVERIFY(fuzzyEqual(density.peak(0, startMs + 3 * halfLifeMs), 0.25));
+}
+
+void TestTrafficDensity::samplesVehiclesOncePerInterval()
+{
+    VehicleStateStore vehicles;
+    TrafficDensity density(&vehicles);
+    density.setHalfLifeMs(1000 * halfLifeMs);
+    QSignalSpy published(&vehicles, &VehicleStateStore::fieldsChanged);
+    QSignalSpy changed(&density, &TrafficDensity::densityChanged);
+
+    // Five position reports inside one interval, each published on its own,
+    // count once.
+    for (int i = 0; i < 5; ++i) {
+        vehicles.update(1, VehicleField::Latitude, 47.0 + i * 1e-5, startMs + i * 200);
+        vehicles.update(1, VehicleField::Longitude, 8.0, startMs + i * 200);
+        QTRY_COMPARE(published.count(), i + 1);
+    }
+    QCOMPARE(changed.count(), 1);
+    QVERIFY(fuzzyEqual(density.peak(0, startMs), 1));
+
+    // An interval after that sample comes the second; a vehicle without a
+    // longitude adds nothing.
+    const qint64 nextMs = startMs + TrafficDensity::sampleIntervalMs;
+    vehicles.update(1, VehicleField::Latitude, 47.0002, nextMs);
+    vehicles.update(2, VehicleField::Latitude, 47.0, nextMs);
+    QTRY_COMPARE(changed.count(), 2);
+    QCOMPARE(density.latestMs(), nextMs);
+    double total = 0;
+    density.forEachBin(0, nextMs, [&total](QPoint, double value) { total += value; });
+    QVERIFY(total > 1.99);
+}
+
+QTEST_GUILESS_MAIN(TestTrafficDensity)
+#include "tst_trafficdensity.moc"
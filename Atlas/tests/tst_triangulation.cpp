@@ -0,0 +1,120 @@
+#include <QtTest>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "geometry/triangulation.h"
+
+namespace {
+
+double triangleArea2(const std::vector<QPointF> &ring, const std::vector<uint32_t> &triangles, size_t i)
+{
+    return signedArea2({ring[triangles[i]], ring[triangles[i + 1]], ring[triangles[i + 2]]});
+}
+
+// Every triangle counter-clockwise and non-degenerate, none holding
+// another vertex of the ring, and together covering the polygon's area.
+bool isTriangulation(const std::vector<QPointF> &ring, const std::vector<uint32_t> &triangles)
+{
+    if (triangles.empty() || triangles.size() % 3 != 0)
+        return false;
+    double total = 0;
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+        if (std::any_of(triangles.begin() + std::ptrdiff_t(i), triangles.begin() + std::ptrdiff_t(i + 3),
+                        [&ring](uint32_t index) { return index >= ring.size(); }))
+            return false;
+        const double area = triangleArea2(ring, triangles, i);
+        if (area <= 0)
+            return false;
+        total += area;
+        const QPointF &a = ring[triangles[i]];
+        const QPointF &b = ring[triangles[i + 1]];
+        const QPointF &c = ring[triangles[i + 2]];
+        for (const QPointF &p : ring) {
+            if (signedArea2({a, b, p}) > 0 && signedArea2({b, c, p}) > 0 && signedArea2({c, a, p}) > 0)
+                return false;
+        }
+    }
+    return std::abs(total - std::abs(signedArea2(ring))) < 1e-9 * std::max(1.0, total);
+}
+
+} // namespace
+
+class TestTriangulation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void signedArea();
+    void convex();
+    void clockwiseComesOutCounterClockwise();
+    void concave();
+    void skipsRepeatedAndCollinearVertices();
+    void degenerateGivesNothing();
+};
+
+void TestTriangulation::signedArea()
+{
+    const std::vector<QPointF> square = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    QCOMPARE(signedArea2(square), 2.0);
+    QCOMPARE(signedArea2({square.rbegin(), square.rend()}), -2.0);
+}
+
+void TestTriangulation::convex()
+{
+    std::vector<QPointF> hexagon;
+    for (int i = 0; i < 6; ++i)
+        hexagon.emplace_back(std::cos(i * M_PI / 3), std::sin(i * M_PI / 3));
+    const std::vector<uint32_t> triangles = triangulatePolygon(hexagon);
+    QCOMPARE(triangles.size(), size_t(3 * 4));
+    QVERIFY(isTriangulation(hexagon, triangles));
+}
+
+void TestTriangulation::clockwiseComesOutCounterClockwise()
+{
+    const std::vector<QPointF> square = {{0, 0}, {0, 1}, {1, 1}, {1, 0}};
+    const std::vector<uint32_t> triangles = triangulatePolygon(square);
+    QCOMPARE(triangles.size(), size_t(6));
+    QVERIFY(isTriangulation(square, triangles));
+}
+
+void TestTriangulation::concave()
+{
+    // An L and a five-pointed star: ears have to skip the reflex corners.
+    const std::vector<QPointF> ell = {{0, 0}, {2, 0}, {2, 1}, {1, 1}, {1, 2}, {0, 2}};
+    std::vector<uint32_t> triangles = triangulatePolygon(ell);
+    QCOMPARE(triangles.size(), size_t(3 * 4));
+    QVERIFY(isTriangulation(ell, triangles));
+
+    std::vector<QPointF> star;
+    for (int i = 0; i < 10; ++i) {
+        const double radius = i % 2 ? 0.4 : 1.0;
+        star.emplace_back(radius * std::cos(i * M_PI / 5), radius * std::sin(i * M_PI / 5));
+    }
+    triangles = triangulatePolygon(star);
+    QCOMPARE(triangles.size(), size_t(3 * 8));
+    QVERIFY(isTriangulation(star, triangles));
+}
+
+void TestTriangulation::skipsRepeatedAndCollinearVertices()
+{
+    // A closed ring (first point repeated), a doubled corner and a point
+    // in the middle of an edge, as digitised boundaries often have.
+    const std::vector<QPointF> ring = {{0, 0}, {1, 0}, {2, 0}, {2, 2}, {2, 2}, {0, 2}, {0, 0}};
+    const std::vector<uint32_t> triangles = triangulatePolygon(ring);
+    QCOMPARE(triangles.size(), size_t(6));
+    QVERIFY(isTriangulation(ring, triangles));
+    QVERIFY(std::find(triangles.begin(), triangles.end(), 1u) == triangles.end());
+}
+
+void TestTriangulation::degenerateGivesNothing()
+{
+    QVERIFY(triangulatePolygon({}).empty());
+    QVERIFY(triangulatePolygon({{0, 0}, {1, 1}}).empty());
+    QVERIFY(triangulatePolygon({{0, 0}, {1, 1}, {2, 2}, {3, 3}}).empty());
+    QVERIFY(triangulatePolygon({{0, 0}, {1, 0}, {1, 0}, {0, 0}}).empty());
+}
+
+QTEST_GUILESS_MAIN(TestTriangulation)
+#include "tst_triangulation.moc"
@@ -0,0 +1,99 @@
+#include <QSignalSpy>
+#include <QtTest>
+
+#include <utility>
+#include <vector>
+
+#include "state/vehiclestatestore.h"
+
+namespace {
+
+constexpr qint64 startMs = 1000000;
+
+} // namespace
+
+class TestVehicleStateStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void publishesVisibleChangesOnce();
+    void tapRemovesItself();
+    void tapRemovesAnother();
+    void tapAddedDuringDispatch();
+};
+
+void TestVehicleStateStore::publishesVisibleChangesOnce()
+{
+    VehicleStateStore vehicles;
+    QList<VehicleFieldChange> changes;
+    connect(&vehicles, &VehicleStateStore::fieldsChanged, this,
+            [&changes](const QList<VehicleFieldChange> &batch) { changes += batch; });
+    QSignalSpy published(&vehicles, &VehicleStateStore::fieldsChanged);
+    vehicles.update(1, VehicleField::Heading, 90, startMs);
+    vehicles.update(1, VehicleField::Heading, 90.4, startMs + 10); // under the 1° threshold
+    vehicles.update(1, VehicleField::GroundSpeed, 12, startMs + 20);
+    QTRY_COMPARE(published.count(), 1);
+
+    QCOMPARE(changes.size(), 1);
+    QCOMPARE(changes.at(0).index, vehicles.indexOf(1));
+    QCOMPARE(changes.at(0).fields, fieldBit(VehicleField::Heading) | fieldBit(VehicleField::GroundSpeed));
+    QCOMPARE(vehicles.at(0).values[int(VehicleField::Heading)], 90.4);
+    QCOMPARE(vehicles.at(0).published[int(VehicleField::Heading)], 90.0);
+}
+
+void TestVehicleStateStore::tapRemovesItself()
+{
+    VehicleStateStore vehicles;
+    int first = 0;
+    int second = 0;
+    int id = 0;
+    id = vehicles.addSampleTap([&](int, VehicleField, double, qint64, const SampleTime &) {
+        ++first;
+        vehicles.removeSampleTap(id);
+    });
+    vehicles.addSampleTap([&](int, VehicleField, double, qint64, const SampleTime &) { ++second; });
+
+    vehicles.update(1, VehicleField::Heading, 90, startMs);
+    vehicles.update(1, VehicleField::Heading, 91, startMs + 10);
+    QCOMPARE(first, 1);
+    QCOMPARE(second, 2);
+}
+
+void TestVehicleStateStore::tapRemovesAnother()
+{
+    VehicleStateStore vehicles;
+    std::vector<int> calls;
+    int later = 0;
+    vehicles.addSampleTap([&](int, VehicleField, double, qint64, const SampleTime &) {
+        calls.push_back(1);
+        vehicles.removeSampleTap(later);
+    });
+    later = vehicles.addSampleTap([&](int, VehicleField, double, qint64, const SampleTime &) { calls.push_back(2); });
+
+    vehicles.update(1, VehicleField::Heading, 90, startMs);
+    vehicles.update(1, VehicleField::Heading, 91, startMs + 10);
+    QCOMPARE(calls, (std::vector<int>{1, 1}));
+}
+
+void TestVehicleStateStore::tapAddedDuringDispatch()
+{
+    VehicleStateStore vehicles;
+    int added = 0;
+    bool once = false;
+    vehicles.addSampleTap([&](int, VehicleField, double, qint64, const SampleTime &) {
+        if (std::exchange(once, true))
+            return;
+        // Enough to move a deque's blocks around.
+        for (int i = 0; i < 100; ++i)
+            vehicles.addSampleTap([&](int, VehicleField, double, qint64, const SampleTime &) { ++added; });
+    });
+
+    vehicles.update(1, VehicleField::Heading, 90, startMs);
+    QCOMPARE(added, 0);
+    vehicles.update(1, VehicleField::Heading, 91, startMs + 10);
+    QCOMPARE(added, 100);
+}
+
+QTEST_GUILESS_MAIN(TestVehicleStateStore)
+#include "tst_vehiclestatestore.moc"